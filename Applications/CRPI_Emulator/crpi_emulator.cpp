@@ -0,0 +1,479 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Controller Emulators
+//  Workfile:        crpi_emulator.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Connection handling, fault injection, and entry point of the controller
+//  emulators.
+//
+//  Usage:  crpi_emulator <ur|abb|robotiq> <config.xml> [-drop p] [-split n]
+//                        [-delay ms] [-jitter ms] [-hangup n] [-object pos]
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <iostream>
+#include <fstream>
+#include <sstream>
+#include "crpi_emulator.h"
+#include "crpi_robot_xml.h"
+
+using namespace std;
+using namespace crpi_robot;
+
+namespace crpi_emulator
+{
+  //! @brief One listening port
+  //!
+  struct emuListener
+  {
+    ulapi_integer server;
+    emuHandler handler;
+    void *data;
+    const emuFaults *faults;
+  };
+
+
+  //! @brief One accepted connection waiting for its handler thread
+  //!
+  struct emuConnection
+  {
+    EmuLink *link;
+    emuHandler handler;
+    void *data;
+  };
+
+
+  void emuConnectionThread (void *param)
+  {
+    emuConnection *conn = (emuConnection*)param;
+
+    conn->handler(*conn->link, conn->data);
+    delete conn->link;
+    delete conn;
+  }
+
+
+  void emuAcceptThread (void *param)
+  {
+    emuListener *listener = (emuListener*)param;
+    emuConnection *conn;
+    ulapi_integer id;
+    void *task;
+
+    while (true)
+    {
+      id = ulapi_socket_get_connection_id(listener->server);
+      if (id < 0)
+      {
+        Sleep(10);
+        continue;
+      }
+      ulapi_socket_set_blocking(id);
+
+      conn = new emuConnection;
+      conn->link = new EmuLink(id, *listener->faults);
+      conn->handler = listener->handler;
+      conn->data = listener->data;
+      task = ulapi_task_new();
+      ulapi_task_start((ulapi_task_struct*)task, emuConnectionThread, conn, ulapi_prio_lowest(), 0);
+    }
+  }
+
+
+  EmuLink::EmuLink (ulapi_integer id, const emuFaults &faults) :
+    id_(id),
+    faults_(faults),
+    sent_(0),
+    open_(true)
+  {
+  }
+
+
+  EmuLink::~EmuLink ()
+  {
+    if (open_)
+    {
+      ulapi_socket_close(id_);
+    }
+  }
+
+
+  bool EmuLink::send (const char *mssg, int length)
+  {
+    double ms;
+    int done, chunk, x;
+
+    if (!open_)
+    {
+      return false;
+    }
+
+    ms = faults_.delay;
+    if (faults_.jitter > 0.0)
+    {
+      ms += faults_.jitter * ((2.0 * rand() / RAND_MAX) - 1.0);
+    }
+    if (ms > 0.0)
+    {
+      ulapi_sleep(ms / 1000.0);
+    }
+
+    if (faults_.drop > 0.0 && ((double)rand() / RAND_MAX) < faults_.drop)
+    {
+      //! Lost on the way; the sender does not know
+      return true;
+    }
+
+    for (done = 0; done < length; done += x)
+    {
+      chunk = length - done;
+      if (faults_.split > 0)
+      {
+        //! Deliver in pieces with a gap between them so they arrive as separate reads
+        x = 1 + (rand() % faults_.split);
+        chunk = (x < chunk ? x : chunk);
+        if (done > 0)
+        {
+          Sleep(1);
+        }
+      }
+      x = ulapi_socket_write(id_, mssg + done, chunk);
+      if (x <= 0)
+      {
+        ulapi_socket_close(id_);
+        open_ = false;
+        return false;
+      }
+    }
+
+    if (faults_.hangup > 0 && ++sent_ >= (unsigned long)faults_.hangup)
+    {
+      ulapi_socket_close(id_);
+      open_ = false;
+      return false;
+    }
+    return true;
+  }
+
+
+  int EmuLink::read (char *buffer, int length)
+  {
+    if (!open_)
+    {
+      return -1;
+    }
+    return ulapi_socket_read(id_, buffer, length);
+  }
+
+
+  bool EmuLink::open ()
+  {
+    return open_;
+  }
+
+
+  bool emuListen (int port, emuHandler handler, void *data, const emuFaults &faults)
+  {
+    emuListener *listener;
+    void *task;
+    ulapi_integer server = ulapi_socket_get_server_id(port);
+
+    if (server < 0)
+    {
+      cout << "Could not open port " << port << endl;
+      return false;
+    }
+
+    listener = new emuListener;
+    listener->server = server;
+    listener->handler = handler;
+    listener->data = data;
+    listener->faults = &faults;
+    task = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task, emuAcceptThread, listener, ulapi_prio_lowest(), 0);
+    return true;
+  }
+
+
+  void emuRpyToMatrix (const double *rpy, double r[3][3])
+  {
+    double d2r = 3.14159265358979323846 / 180.0;
+    double sa = sin(rpy[2] * d2r), sb = sin(rpy[1] * d2r), sg = sin(rpy[0] * d2r);
+    double ca = cos(rpy[2] * d2r), cb = cos(rpy[1] * d2r), cg = cos(rpy[0] * d2r);
+
+    r[0][0] = ca * cb;
+    r[0][1] = ca * sb * sg - sa * cg;
+    r[0][2] = ca * sb * cg + sa * sg;
+    r[1][0] = sa * cb;
+    r[1][1] = sa * sb * sg + ca * cg;
+    r[1][2] = sa * sb * cg - ca * sg;
+    r[2][0] = -sb;
+    r[2][1] = cb * sg;
+    r[2][2] = cb * cg;
+  }
+
+
+  void emuMatrixToRpy (double r[3][3], double *rpy)
+  {
+    double r2d = 180.0 / 3.14159265358979323846;
+    double half = 3.14159265358979323846 / 2.0;
+    double yr = atan2(-r[2][0], sqrt((r[0][0] * r[0][0]) + (r[1][0] * r[1][0])));
+
+    //! Same branches as Math::matrix::rotMatrixEulerConvert so the drivers read back what was sent
+    if (fabs(yr - half) < 1.0e-4)
+    {
+      rpy[0] = atan2(r[0][1], r[1][1]) * r2d;
+      rpy[1] = 90.0;
+      rpy[2] = 0.0;
+    }
+    else if (fabs(yr + half) < 1.0e-4)
+    {
+      rpy[0] = -atan2(r[0][1], r[1][1]) * r2d;
+      rpy[1] = -90.0;
+      rpy[2] = 0.0;
+    }
+    else
+    {
+      rpy[0] = atan2(r[2][1], r[2][2]) * r2d;
+      rpy[1] = yr * r2d;
+      rpy[2] = atan2(r[1][0], r[0][0]) * r2d;
+    }
+  }
+
+
+  void emuRotvecToMatrix (const double *v, double r[3][3])
+  {
+    double angle = sqrt((v[0] * v[0]) + (v[1] * v[1]) + (v[2] * v[2]));
+    double x, y, z, c, s, t;
+
+    if (angle < 1.0e-12)
+    {
+      memset(r, 0, 9 * sizeof(double));
+      r[0][0] = r[1][1] = r[2][2] = 1.0;
+      return;
+    }
+    x = v[0] / angle;
+    y = v[1] / angle;
+    z = v[2] / angle;
+    c = cos(angle);
+    s = sin(angle);
+    t = 1.0 - c;
+
+    r[0][0] = (x * x * t) + c;
+    r[0][1] = (x * y * t) - (z * s);
+    r[0][2] = (x * z * t) + (y * s);
+    r[1][0] = (y * x * t) + (z * s);
+    r[1][1] = (y * y * t) + c;
+    r[1][2] = (y * z * t) - (x * s);
+    r[2][0] = (z * x * t) - (y * s);
+    r[2][1] = (z * y * t) + (x * s);
+    r[2][2] = (z * z * t) + c;
+  }
+
+
+  void emuMatrixToRotvec (double r[3][3], double *v)
+  {
+    double q[4], n, angle;
+
+    //! Through the quaternion, which has no singularity at a half turn
+    emuMatrixToQuaternion(r, q);
+    n = sqrt((q[1] * q[1]) + (q[2] * q[2]) + (q[3] * q[3]));
+    if (n < 1.0e-12)
+    {
+      v[0] = v[1] = v[2] = 0.0;
+      return;
+    }
+    angle = 2.0 * atan2(n, q[0]);
+    v[0] = q[1] / n * angle;
+    v[1] = q[2] / n * angle;
+    v[2] = q[3] / n * angle;
+  }
+
+
+  void emuQuaternionToMatrix (const double *q, double r[3][3])
+  {
+    double w = q[0], x = q[1], y = q[2], z = q[3];
+    double n = (w * w) + (x * x) + (y * y) + (z * z);
+    double s = (n > 0.0 ? 2.0 / n : 0.0);
+
+    r[0][0] = 1.0 - s * ((y * y) + (z * z));
+    r[0][1] = s * ((x * y) - (z * w));
+    r[0][2] = s * ((x * z) + (y * w));
+    r[1][0] = s * ((x * y) + (z * w));
+    r[1][1] = 1.0 - s * ((x * x) + (z * z));
+    r[1][2] = s * ((y * z) - (x * w));
+    r[2][0] = s * ((x * z) - (y * w));
+    r[2][1] = s * ((y * z) + (x * w));
+    r[2][2] = 1.0 - s * ((x * x) + (y * y));
+  }
+
+
+  void emuMatrixToQuaternion (double r[3][3], double *q)
+  {
+    double t = r[0][0] + r[1][1] + r[2][2], s;
+
+    //! Divide by the largest component (w, x, y, or z) to stay well conditioned
+    if (t > 0.0)
+    {
+      s = 2.0 * sqrt(1.0 + t);
+      q[0] = 0.25 * s;
+      q[1] = (r[2][1] - r[1][2]) / s;
+      q[2] = (r[0][2] - r[2][0]) / s;
+      q[3] = (r[1][0] - r[0][1]) / s;
+    }
+    else if (r[0][0] > r[1][1] && r[0][0] > r[2][2])
+    {
+      s = 2.0 * sqrt(1.0 + r[0][0] - r[1][1] - r[2][2]);
+      q[0] = (r[2][1] - r[1][2]) / s;
+      q[1] = 0.25 * s;
+      q[2] = (r[0][1] + r[1][0]) / s;
+      q[3] = (r[0][2] + r[2][0]) / s;
+    }
+    else if (r[1][1] > r[2][2])
+    {
+      s = 2.0 * sqrt(1.0 + r[1][1] - r[0][0] - r[2][2]);
+      q[0] = (r[0][2] - r[2][0]) / s;
+      q[1] = (r[0][1] + r[1][0]) / s;
+      q[2] = 0.25 * s;
+      q[3] = (r[1][2] + r[2][1]) / s;
+    }
+    else
+    {
+      s = 2.0 * sqrt(1.0 + r[2][2] - r[0][0] - r[1][1]);
+      q[0] = (r[1][0] - r[0][1]) / s;
+      q[1] = (r[0][2] + r[2][0]) / s;
+      q[2] = (r[1][2] + r[2][1]) / s;
+      q[3] = 0.25 * s;
+    }
+
+    //! Keep w non-negative, as the controllers report it
+    if (q[0] < 0.0)
+    {
+      q[0] = -q[0];
+      q[1] = -q[1];
+      q[2] = -q[2];
+      q[3] = -q[3];
+    }
+  }
+
+} // crpi_emulator
+
+
+using namespace crpi_emulator;
+
+int main (int argc, char *argv[])
+{
+  CrpiRobotParams params;
+  emuFaults faults;
+  UrEmulator *ur = NULL;
+  AbbEmulator *abb = NULL;
+  RobotiqEmulator *robotiq = NULL;
+  int object = -1;
+  bool started = false;
+  char line[1024];
+  int i;
+
+  if (argc < 3)
+  {
+    cout << "Usage:  crpi_emulator <ur|abb|robotiq> <config.xml> [-drop p] [-split n] [-delay ms]" << endl
+         << "                      [-jitter ms] [-hangup n] [-object pos]" << endl;
+    return 1;
+  }
+
+  for (i = 3; i < argc - 1; i += 2)
+  {
+    if (strcmp(argv[i], "-drop") == 0)
+    {
+      faults.drop = atof(argv[i + 1]);
+    }
+    else if (strcmp(argv[i], "-split") == 0)
+    {
+      faults.split = atoi(argv[i + 1]);
+    }
+    else if (strcmp(argv[i], "-delay") == 0)
+    {
+      faults.delay = atof(argv[i + 1]);
+    }
+    else if (strcmp(argv[i], "-jitter") == 0)
+    {
+      faults.jitter = atof(argv[i + 1]);
+    }
+    else if (strcmp(argv[i], "-hangup") == 0)
+    {
+      faults.hangup = atoi(argv[i + 1]);
+    }
+    else if (strcmp(argv[i], "-object") == 0)
+    {
+      object = atoi(argv[i + 1]);
+    }
+    else
+    {
+      cout << "Unknown option " << argv[i] << endl;
+      return 1;
+    }
+  }
+
+  //! Same configuration format as the drivers; <Simulation> sets the emulated dynamics
+  ifstream inputs(argv[2]);
+  if (!inputs)
+  {
+    cout << "Could not open file " << argv[2] << endl;
+    return 1;
+  }
+  stringstream text;
+  while (inputs.getline(line, 1024))
+  {
+    text << line;
+  }
+  inputs.close();
+  Xml::CrpiRobotXml robXML(&params);
+  robXML.parse(text.str());
+
+  if (ulapi_init() != ULAPI_OK)
+  {
+    cout << "Could not initialize ulapi" << endl;
+    return 1;
+  }
+
+  if (strcmp(argv[1], "ur") == 0)
+  {
+    ur = new UrEmulator(params, faults);
+    started = ur->start();
+  }
+  else if (strcmp(argv[1], "abb") == 0)
+  {
+    abb = new AbbEmulator(params, faults);
+    started = abb->start();
+  }
+  else if (strcmp(argv[1], "robotiq") == 0)
+  {
+    robotiq = new RobotiqEmulator(params, faults, object);
+    started = robotiq->start();
+  }
+  else
+  {
+    cout << "Unknown controller " << argv[1] << endl;
+    return 1;
+  }
+
+  if (!started)
+  {
+    return 1;
+  }
+  cout << "Emulating " << argv[1] << " from " << argv[2] << endl;
+
+  while (true)
+  {
+    ulapi_sleep(1.0);
+  }
+
+  return 0;
+}
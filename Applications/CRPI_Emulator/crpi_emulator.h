@@ -0,0 +1,277 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Controller Emulators
+//  Workfile:        crpi_emulator.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Protocol-level emulators of the robot controllers used by the CRPI
+//  drivers, for exercising the real drivers without hardware.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_EMULATOR_H
+#define CRPI_EMULATOR_H
+
+#include <string>
+#include "crpi.h"
+#include "crpi_sim.h"
+#include "ulapi.h"
+
+#define EMU_BUFFER 8192             //! Receive buffer of one connection
+#define EMU_UR_REALTIME_PORT 30003  //! UR realtime state stream
+#define EMU_UR_SCRIPT_PORT 30002    //! UR script port (if the configuration does not give one)
+#define EMU_UR_PACKET 1044          //! UR realtime packet length (controller 3.0 - 3.1)
+#define EMU_UR_RATE 125.0           //! UR realtime stream rate (Hz)
+#define EMU_ABB_STATE_RATE 30.0     //! ABB CRPI_StateServer push rate (Hz)
+#define EMU_ROBOTIQ_RATE 100.0      //! Robotiq finger simulation rate (Hz)
+#define EMU_ROBOTIQ_REGISTERS 15    //! Robotiq request and status registers
+
+namespace crpi_emulator
+{
+  //! @brief Faults injected into everything an emulator sends
+  //!
+  struct emuFaults
+  {
+    //! @brief Probability [0, 1] that a message is silently dropped
+    //!
+    double drop;
+
+    //! @brief If > 0, every message is written in pieces of 1 to split bytes so that the
+    //!        receiver sees partial reads
+    //!
+    int split;
+
+    //! @brief Delay (ms) before each message is sent, and the range of the uniform jitter added
+    //!        to it
+    //!
+    double delay;
+    double jitter;
+
+    //! @brief If > 0, the connection is closed after this many messages
+    //!
+    int hangup;
+
+    emuFaults () :
+      drop(0.0),
+      split(0),
+      delay(0.0),
+      jitter(0.0),
+      hangup(0)
+    {
+    }
+  };
+
+
+  //! @brief One accepted connection, with fault injection on its outgoing messages
+  //!
+  class EmuLink
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    //! @param id     The connected socket
+    //! @param faults Faults to inject (shared by every connection of the emulator)
+    //!
+    EmuLink (ulapi_integer id, const emuFaults &faults);
+
+    //! @brief Default destructor (closes the socket)
+    //!
+    ~EmuLink ();
+
+    //! @brief Send one message, subject to the injected faults
+    //!
+    //! @return False if the connection is closed (by the peer or by an injected hangup)
+    //!
+    bool send (const char *mssg, int length);
+
+    //! @brief Read whatever is available (blocking)
+    //!
+    //! @return The number of bytes read, or <= 0 if the connection closed
+    //!
+    int read (char *buffer, int length);
+
+    //! @brief Whether or not the connection is still open
+    //!
+    bool open ();
+
+  private:
+    ulapi_integer id_;
+    const emuFaults &faults_;
+    unsigned long sent_;
+    bool open_;
+  }; // EmuLink
+
+
+  //! @brief Connection handler, run on its own thread for every accepted connection
+  //!
+  //! @param link The connection (deleted by the caller when the handler returns)
+  //! @param data The pointer given to emuListen
+  //!
+  typedef void (*emuHandler) (EmuLink &link, void *data);
+
+  //! @brief Accept connections on a port in the background, running a handler for each
+  //!
+  //! @return False if the port could not be opened
+  //!
+  bool emuListen (int port, emuHandler handler, void *data, const emuFaults &faults);
+
+  //! @brief Rotation conversions between the controllers' wire formats and the roll, pitch, yaw
+  //!        (degrees, R = Rz * Ry * Rx) used by CrpiSim
+  //!
+  //! @note These stay well defined at half-turn rotations (e.g., a tool pointing straight down),
+  //!       where the textbook formulas divide by zero.
+  //!
+  void emuRpyToMatrix (const double *rpy, double r[3][3]);
+  void emuMatrixToRpy (double r[3][3], double *rpy);
+  void emuRotvecToMatrix (const double *v, double r[3][3]);
+  void emuMatrixToRotvec (double r[3][3], double *v);
+  void emuQuaternionToMatrix (const double *q, double r[3][3]);
+  void emuMatrixToQuaternion (double r[3][3], double *q);
+
+
+  //! @brief Universal Robots controller:  the 30003 realtime stream and the script port
+  //!
+  //! @note Programs sent to the script port replace the running program, as on the controller.
+  //!       movej, movel, stopj, stopl, and set_digital_out statements are executed; anything
+  //!       else is accepted and ignored.  Digital outputs are looped back to the inputs.  Only the
+  //!       realtime stream is emulated, not RTDE.
+  //!
+  class UrEmulator
+  {
+  public:
+    UrEmulator (CrpiRobotParams &params, const emuFaults &faults);
+    ~UrEmulator ();
+
+    //! @brief Open the ports
+    //!
+    bool start ();
+
+    //! @brief Stream realtime packets to one client
+    //!
+    void realtime (EmuLink &link);
+
+    //! @brief Receive programs from one client
+    //!
+    void script (EmuLink &link);
+
+    //! @brief Execute received programs (thread body)
+    //!
+    void runPrograms ();
+
+  private:
+    //! @brief Build one realtime packet from the simulated state
+    //!
+    void packState (char *packet, double started);
+
+    //! @brief Queue a complete program, stopping the one that is running
+    //!
+    void submit (const std::string &program);
+
+    //! @brief Execute one statement of a program
+    //!
+    void execute (const std::string &line);
+
+    CrpiRobotParams &params_;
+    const emuFaults &faults_;
+    crpi_robot::CrpiSim *sim_;
+    ulapi_mutex_struct *lock_;
+    std::string pending_;
+    bool havePending_;
+    bool runThread_;
+    void *task_;
+  }; // UrEmulator
+
+
+  //! @brief ABB IRC5 controller:  the CRPI_Handler command socket (text or binary frames) and
+  //!        the CRPI_StateServer push stream
+  //!
+  class AbbEmulator
+  {
+  public:
+    AbbEmulator (CrpiRobotParams &params, const emuFaults &faults);
+    ~AbbEmulator ();
+
+    //! @brief Open the ports
+    //!
+    bool start ();
+
+    //! @brief Answer commands from one client
+    //!
+    void commands (EmuLink &link);
+
+    //! @brief Push state messages to one client
+    //!
+    void state (EmuLink &link);
+
+    //! @brief The configuration and the injected faults
+    //!
+    CrpiRobotParams &params ();
+    const emuFaults &faults ();
+
+  private:
+    //! @brief Execute one command and fill in the 8-value reply
+    //!
+    void execute (const double *in, double *out);
+
+    //! @brief Current pose as x, y, z, q1..q4 (mm and quaternion)
+    //!
+    void pose (double *out);
+
+    CrpiRobotParams &params_;
+    const emuFaults &faults_;
+    crpi_robot::CrpiSim *sim_;
+  }; // AbbEmulator
+
+
+  //! @brief Robotiq 3-finger gripper:  Modbus-TCP request (function 16) and status (function 4)
+  //!        registers
+  //!
+  //! @note Fingers move toward their requested positions at a speed set by the request; closing
+  //!       fingers stop at the object position, if one is given.
+  //!
+  class RobotiqEmulator
+  {
+  public:
+    //! @param object Finger position (0 - 255) at which closing fingers meet an object, or -1
+    //!
+    RobotiqEmulator (CrpiRobotParams &params, const emuFaults &faults, int object);
+    ~RobotiqEmulator ();
+
+    //! @brief Open the port
+    //!
+    bool start ();
+
+    //! @brief Answer Modbus requests from one client
+    //!
+    void serve (EmuLink &link);
+
+    //! @brief Move the fingers (thread body)
+    //!
+    void run ();
+
+  private:
+    //! @brief Encode the status registers (lock held)
+    //!
+    void status (unsigned char *data);
+
+    CrpiRobotParams &params_;
+    const emuFaults &faults_;
+    int object_;
+    ulapi_mutex_struct *lock_;
+    unsigned char request_[2 * EMU_ROBOTIQ_REGISTERS];
+    double pos_[4];
+    int gDT_[4];
+    int gIMC_;
+    int mode_;
+    double settle_;
+    bool runThread_;
+    void *task_;
+  }; // RobotiqEmulator
+
+} // crpi_emulator
+
+#endif
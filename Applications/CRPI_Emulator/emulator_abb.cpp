@@ -0,0 +1,408 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Controller Emulators
+//  Workfile:        emulator_abb.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  ABB IRC5 controller emulator:  the CRPI_Handler and CRPI_StateServer
+//  RAPID tasks.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <stdio.h>
+#include <string.h>
+#include <iostream>
+#include "crpi_emulator.h"
+#include "crpi_abb.h"
+
+using namespace std;
+using namespace crpi_robot;
+
+namespace crpi_emulator
+{
+  void abbCommandHandler (EmuLink &link, void *data)
+  {
+    ((AbbEmulator*)data)->commands(link);
+  }
+
+
+  void abbStateHandler (EmuLink &link, void *data)
+  {
+    ((AbbEmulator*)data)->state(link);
+  }
+
+
+  //! @brief Connect to a driver whose observer listens for the state server (Client="false")
+  //!
+  void abbStateClientThread (void *param)
+  {
+    AbbEmulator *abb = (AbbEmulator*)param;
+    ulapi_integer id;
+
+    while (true)
+    {
+      id = ulapi_socket_get_client_id(abb->params().obs_tcp_ip_port, abb->params().obs_tcp_ip_addr);
+      if (id < 0)
+      {
+        Sleep(500);
+        continue;
+      }
+      ulapi_socket_set_blocking(id);
+      EmuLink link(id, abb->faults());
+      abb->state(link);
+    }
+  }
+
+
+  //! @brief Send one "[id,v1,...,v7]" text message, NUL-terminated as RAPID sends it
+  //!
+  static bool sendText (EmuLink &link, const double *values)
+  {
+    char mssg[256];
+    int length;
+
+    length = snprintf(mssg, sizeof(mssg), "[%d,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f,%.4f]", (int)values[0],
+                      values[1], values[2], values[3], values[4], values[5], values[6], values[7]);
+    return link.send(mssg, length + 1);
+  }
+
+
+  AbbEmulator::AbbEmulator (CrpiRobotParams &params, const emuFaults &faults) :
+    params_(params),
+    faults_(faults)
+  {
+    sim_ = new CrpiSim(params_);
+  }
+
+
+  AbbEmulator::~AbbEmulator ()
+  {
+    delete sim_;
+  }
+
+
+  CrpiRobotParams &AbbEmulator::params ()
+  {
+    return params_;
+  }
+
+
+  const emuFaults &AbbEmulator::faults ()
+  {
+    return faults_;
+  }
+
+
+  bool AbbEmulator::start ()
+  {
+    void *task;
+
+    if (!emuListen(params_.tcp_ip_port, abbCommandHandler, this, faults_))
+    {
+      return false;
+    }
+    if (params_.obs_tcp_ip_port <= 0)
+    {
+      return true;
+    }
+    if (params_.obs_tcp_ip_client)
+    {
+      return emuListen(params_.obs_tcp_ip_port, abbStateHandler, this, faults_);
+    }
+    task = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task, abbStateClientThread, this, ulapi_prio_lowest(), 0);
+    return true;
+  }
+
+
+  void AbbEmulator::commands (EmuLink &link)
+  {
+    char buffer[EMU_BUFFER];
+    char frame[ABB_FRAME_SIZE];
+    double in[ABB_FRAME_VALUES + 1], out[ABB_FRAME_VALUES + 1];
+    const char *pos;
+    char *end;
+    int have = 0, get, start, i, j;
+
+    while ((get = link.read(buffer + have, EMU_BUFFER - have)) > 0)
+    {
+      have += get;
+      start = 0;
+
+      while (start < have)
+      {
+        if (buffer[start] == '[')
+        {
+          //! Text request, NUL-terminated
+          for (i = start; i < have && buffer[i] != '\0'; ++i);
+          if (i == have)
+          {
+            break;
+          }
+          pos = buffer + start + 1;
+          for (j = 0; j <= ABB_FRAME_VALUES; ++j)
+          {
+            in[j] = strtod(pos, &end);
+            pos = end;
+            while (*pos == ' ' || *pos == ',')
+            {
+              ++pos;
+            }
+          }
+          start = i + 1;
+          execute(in, out);
+          if (!sendText(link, out))
+          {
+            return;
+          }
+        }
+        else if (buffer[start] == '\0')
+        {
+          ++start;
+        }
+        else
+        {
+          //! Binary request, fixed-size frame
+          if (have - start < ABB_FRAME_SIZE)
+          {
+            break;
+          }
+          if (!abbUnpackFrame(buffer + start, in))
+          {
+            //! Out of step with the sender; nothing to resynchronize on
+            return;
+          }
+          start += ABB_FRAME_SIZE;
+          execute(in, out);
+          abbPackFrame(frame, (int)out[0], out + 1, ABB_FRAME_VALUES);
+          if (!link.send(frame, ABB_FRAME_SIZE))
+          {
+            return;
+          }
+        }
+      }
+
+      memmove(buffer, buffer + start, have - start);
+      have -= start;
+      if (have == EMU_BUFFER)
+      {
+        return;
+      }
+    }
+  }
+
+
+  void AbbEmulator::state (EmuLink &link)
+  {
+    double values[8], wake = ulapi_time(), now;
+    robotAxes axes, torques;
+    robotIO io;
+    int i;
+
+    while (true)
+    {
+      wake += 1.0 / EMU_ABB_STATE_RATE;
+      now = ulapi_time();
+      if (wake > now)
+      {
+        ulapi_sleep(wake - now);
+      }
+      else
+      {
+        wake = now;
+      }
+
+      //! Pose, joints, torques, and digital inputs, in that order
+      values[0] = 1.0;
+      pose(values + 1);
+      if (!sendText(link, values))
+      {
+        return;
+      }
+
+      sim_->GetRobotAxes(&axes);
+      values[0] = 2.0;
+      for (i = 0; i < 7; ++i)
+      {
+        values[i + 1] = (i < axes.axes ? axes.axis.at(i) : 0.0);
+      }
+      if (!sendText(link, values))
+      {
+        return;
+      }
+
+      sim_->GetRobotTorques(&torques);
+      values[0] = 3.0;
+      for (i = 0; i < 7; ++i)
+      {
+        values[i + 1] = (i < torques.axes ? torques.axis.at(i) : 0.0);
+      }
+      if (!sendText(link, values))
+      {
+        return;
+      }
+
+      sim_->GetRobotIO(&io);
+      values[0] = 4.0;
+      for (i = 0; i < 7; ++i)
+      {
+        values[i + 1] = ((i < io.ndio && io.dio[i]) ? 1.0 : 0.0);
+      }
+      if (!sendText(link, values))
+      {
+        return;
+      }
+    }
+  }
+
+
+  void AbbEmulator::execute (const double *in, double *out)
+  {
+    int cmd = (int)in[0];
+    double cur[7], r[3][3], d[3][3], c[3][3], rpy[3];
+    robotPose target, forces;
+    robotAxes axes;
+    robotIO io;
+    CanonReturn status = CANON_SUCCESS;
+    int i, j, k;
+
+    memset(out, 0, (ABB_FRAME_VALUES + 1) * sizeof(double));
+
+    if (cmd < 20)
+    {
+      //! Tool (binary or analog); the driver sends the complement of the requested value
+      sim_->SetTool(in[1]);
+    }
+    else if (cmd == 100)
+    {
+      //! TCP speed (mm/s)
+      status = sim_->SetAbsoluteSpeed(in[1] < params_.sim_cart_speed ? in[1] : params_.sim_cart_speed);
+    }
+    else if (cmd == 200 || cmd == 201 || cmd == 300 || cmd == 301)
+    {
+      //! Cartesian target:  x, y, z (mm) and a quaternion (w first)
+      emuQuaternionToMatrix(in + 4, r);
+      if (cmd % 10 == 1)
+      {
+        //! Relative to the current pose
+        pose(cur);
+        emuQuaternionToMatrix(cur + 3, c);
+        for (i = 0; i < 3; ++i)
+        {
+          for (j = 0; j < 3; ++j)
+          {
+            d[i][j] = 0.0;
+            for (k = 0; k < 3; ++k)
+            {
+              d[i][j] += r[i][k] * c[k][j];
+            }
+          }
+        }
+        memcpy(r, d, sizeof(r));
+      }
+      emuMatrixToRpy(r, rpy);
+      target.x = in[1] + (cmd % 10 == 1 ? cur[0] : 0.0);
+      target.y = in[2] + (cmd % 10 == 1 ? cur[1] : 0.0);
+      target.z = in[3] + (cmd % 10 == 1 ? cur[2] : 0.0);
+      target.xrot = rpy[0];
+      target.yrot = rpy[1];
+      target.zrot = rpy[2];
+      status = (cmd < 300 ? sim_->MoveTo(target) : sim_->MoveStraightTo(target));
+      pose(out + 1);
+    }
+    else if (cmd == 210 || cmd == 211)
+    {
+      //! Joint target (degrees)
+      sim_->GetRobotAxes(&axes);
+      for (i = 0; i < axes.axes && i < 7; ++i)
+      {
+        axes.axis.at(i) = in[i + 1] + (cmd == 211 ? axes.axis.at(i) : 0.0);
+      }
+      status = sim_->MoveToAxisTarget(axes);
+      sim_->GetRobotAxes(&axes);
+      for (i = 0; i < axes.axes && i < 7; ++i)
+      {
+        out[i + 1] = axes.axis.at(i);
+      }
+    }
+    else if (cmd == 400)
+    {
+      status = sim_->SetRobotDO((int)in[1], in[2] > 0.5);
+    }
+    else if (cmd == 410)
+    {
+      sim_->GetRobotIO(&io);
+      if ((int)in[1] >= 0 && (int)in[1] < io.naio)
+      {
+        io.aio[(int)in[1]] = in[2];
+        status = sim_->SetRobotIO(io);
+      }
+    }
+    else if (cmd == 500)
+    {
+      pose(out + 1);
+    }
+    else if (cmd == 600 || cmd == 800)
+    {
+      if (cmd == 600)
+      {
+        sim_->GetRobotAxes(&axes);
+      }
+      else
+      {
+        sim_->GetRobotTorques(&axes);
+      }
+      for (i = 0; i < axes.axes && i < 7; ++i)
+      {
+        out[i + 1] = axes.axis.at(i);
+      }
+    }
+    else if (cmd == 700)
+    {
+      sim_->GetRobotForces(&forces);
+      out[1] = forces.x;
+      out[2] = forces.y;
+      out[3] = forces.z;
+      out[4] = forces.xrot;
+      out[5] = forces.yrot;
+      out[6] = forces.zrot;
+    }
+    else if (cmd == 900)
+    {
+      sim_->GetRobotIO(&io);
+      for (i = 0; i < 7 && i < io.ndio; ++i)
+      {
+        out[i + 1] = (io.dio[i] ? 1.0 : 0.0);
+      }
+    }
+    else
+    {
+      status = CANON_REJECT;
+    }
+
+    out[0] = (status == CANON_SUCCESS ? 1.0 : 0.0);
+  }
+
+
+  void AbbEmulator::pose (double *out)
+  {
+    robotPose cur;
+    double rpy[3], r[3][3];
+
+    sim_->GetRobotPose(&cur);
+    rpy[0] = cur.xrot;
+    rpy[1] = cur.yrot;
+    rpy[2] = cur.zrot;
+    emuRpyToMatrix(rpy, r);
+    out[0] = cur.x;
+    out[1] = cur.y;
+    out[2] = cur.z;
+    emuMatrixToQuaternion(r, out + 3);
+  }
+
+} // crpi_emulator
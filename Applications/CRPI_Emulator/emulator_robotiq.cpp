@@ -0,0 +1,295 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Controller Emulators
+//  Workfile:        emulator_robotiq.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Robotiq 3-finger gripper emulator:  Modbus-TCP server and finger
+//  dynamics.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <math.h>
+#include <iostream>
+#include "crpi_emulator.h"
+#include "crpi_robotiq_modbus.h"
+
+using namespace std;
+using namespace crpi_robot;
+
+#define ROBOTIQ_ACTIVATE_TIME 0.5   //! Activation time (s)
+#define ROBOTIQ_MODE_TIME 0.2       //! Grasping mode change time (s)
+
+namespace crpi_emulator
+{
+  void robotiqHandler (EmuLink &link, void *data)
+  {
+    ((RobotiqEmulator*)data)->serve(link);
+  }
+
+
+  void robotiqThread (void *param)
+  {
+    ((RobotiqEmulator*)param)->run();
+  }
+
+
+  RobotiqEmulator::RobotiqEmulator (CrpiRobotParams &params, const emuFaults &faults, int object) :
+    params_(params),
+    faults_(faults),
+    object_(object),
+    gIMC_(0),
+    mode_(0),
+    settle_(0.0),
+    runThread_(true)
+  {
+    memset(request_, 0, sizeof(request_));
+    for (int i = 0; i < 4; ++i)
+    {
+      pos_[i] = 0.0;
+      gDT_[i] = 0;
+    }
+    lock_ = ulapi_mutex_new(56);
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, robotiqThread, this, ulapi_prio_lowest(), 0);
+  }
+
+
+  RobotiqEmulator::~RobotiqEmulator ()
+  {
+    runThread_ = false;
+    Sleep(50);
+  }
+
+
+  bool RobotiqEmulator::start ()
+  {
+    return emuListen(params_.tcp_ip_port > 0 ? params_.tcp_ip_port : 502, robotiqHandler, this, faults_);
+  }
+
+
+  void RobotiqEmulator::serve (EmuLink &link)
+  {
+    unsigned char buffer[EMU_BUFFER], reply[ROBOTIQ_FRAME], *adu, *pdu;
+    unsigned char data[2 * EMU_ROBOTIQ_REGISTERS];
+    int have = 0, get, start, size, addr, count, length, act;
+
+    while ((get = link.read((char*)buffer + have, EMU_BUFFER - have)) > 0)
+    {
+      have += get;
+      start = 0;
+
+      //! Answer every complete ADU; the MBAP length counts the unit ID and the PDU
+      while ((have - start) >= ROBOTIQ_MBAP_SIZE)
+      {
+        adu = buffer + start;
+        size = 6 + ((adu[4] << 8) | adu[5]);
+        if (size < ROBOTIQ_MBAP_SIZE + 1 || size > ROBOTIQ_FRAME)
+        {
+          //! Not Modbus; drop the connection as the gripper does
+          return;
+        }
+        if ((have - start) < size)
+        {
+          break;
+        }
+        start += size;
+
+        pdu = reply + ROBOTIQ_MBAP_SIZE;
+        addr = (adu[8] << 8) | adu[9];
+        count = (adu[10] << 8) | adu[11];
+        pdu[0] = adu[7];
+        length = 0;
+
+        if (adu[7] == 0x10 && size >= 13 && size >= 13 + adu[12])
+        {
+          //! Preset Multiple Registers:  the request registers
+          if (count < 1 || (addr + count) > EMU_ROBOTIQ_REGISTERS || adu[12] != 2 * count)
+          {
+            length = -2;
+          }
+          else
+          {
+            ulapi_mutex_take(lock_);
+            act = request_[0] & 0x01;
+            memcpy(request_ + (2 * addr), adu + 13, 2 * count);
+            if (!act && (request_[0] & 0x01))
+            {
+              //! Activation runs once; the fingers are found open
+              gIMC_ = 1;
+              settle_ = ulapi_time() + ROBOTIQ_ACTIVATE_TIME;
+              mode_ = request_[0] & 0x06;
+            }
+            else if (!(request_[0] & 0x01))
+            {
+              gIMC_ = 0;
+            }
+            else if ((request_[0] & 0x06) != mode_)
+            {
+              gIMC_ = 2;
+              settle_ = ulapi_time() + ROBOTIQ_MODE_TIME;
+              mode_ = request_[0] & 0x06;
+            }
+            ulapi_mutex_give(lock_);
+            memcpy(pdu + 1, adu + 8, 4);
+            length = 5;
+          }
+        }
+        else if ((adu[7] == 0x04 || adu[7] == 0x03) && size >= 12)
+        {
+          //! Read Input Registers (the status) or Read Holding Registers (the request)
+          if (count < 1 || (addr + count) > EMU_ROBOTIQ_REGISTERS)
+          {
+            length = -2;
+          }
+          else
+          {
+            ulapi_mutex_take(lock_);
+            if (adu[7] == 0x04)
+            {
+              status(data);
+            }
+            else
+            {
+              memcpy(data, request_, sizeof(data));
+            }
+            ulapi_mutex_give(lock_);
+            pdu[1] = (unsigned char)(2 * count);
+            memcpy(pdu + 2, data + (2 * addr), 2 * count);
+            length = 2 + (2 * count);
+          }
+        }
+        else
+        {
+          length = -1;
+        }
+
+        if (length < 0)
+        {
+          //! Exception:  illegal function (1) or illegal data address (2)
+          pdu[0] = adu[7] | 0x80;
+          pdu[1] = (unsigned char)(-length);
+          length = 2;
+        }
+
+        memcpy(reply, adu, 4);
+        reply[4] = (unsigned char)(((length + 1) >> 8) & 0xFF);
+        reply[5] = (unsigned char)((length + 1) & 0xFF);
+        reply[6] = adu[6];
+        if (!link.send((char*)reply, ROBOTIQ_MBAP_SIZE + length))
+        {
+          return;
+        }
+      }
+
+      memmove(buffer, buffer + start, have - start);
+      have -= start;
+      if (have == EMU_BUFFER)
+      {
+        return;
+      }
+    }
+  }
+
+
+  void RobotiqEmulator::run ()
+  {
+    double wake = ulapi_time(), now, step, target;
+    bool individual, scissor;
+    int i, speed;
+
+    while (runThread_)
+    {
+      wake += 1.0 / EMU_ROBOTIQ_RATE;
+      now = ulapi_time();
+      if (wake > now)
+      {
+        ulapi_sleep(wake - now);
+      }
+      else
+      {
+        wake = now;
+      }
+
+      ulapi_mutex_take(lock_);
+      if ((gIMC_ == 1 || gIMC_ == 2) && ulapi_time() >= settle_)
+      {
+        gIMC_ = 3;
+      }
+
+      //! Fingers only move once activated and told to go (rGTO)
+      if (gIMC_ != 3 || !(request_[0] & 0x08))
+      {
+        ulapi_mutex_give(lock_);
+        continue;
+      }
+
+      individual = ((request_[1] & 0x04) != 0);
+      scissor = ((request_[1] & 0x08) != 0);
+      for (i = 0; i < 4; ++i)
+      {
+        if (i == 3 && !scissor)
+        {
+          //! The scissor axis holds unless individually controlled
+          gDT_[i] = 3;
+          continue;
+        }
+        target = request_[(individual || i == 3) ? (3 + (3 * i)) : 3];
+        speed = request_[(individual || i == 3) ? (4 + (3 * i)) : 4];
+        step = (60.0 + (170.0 * speed / 255.0)) / EMU_ROBOTIQ_RATE;
+
+        if (fabs(target - pos_[i]) <= step)
+        {
+          pos_[i] = target;
+          gDT_[i] = 3;
+        }
+        else if (i < 3 && object_ >= 0 && target > object_ && pos_[i] <= object_ && (pos_[i] + step) >= object_)
+        {
+          //! Closing onto the object
+          pos_[i] = object_;
+          gDT_[i] = 2;
+        }
+        else
+        {
+          pos_[i] += (target > pos_[i] ? step : -step);
+          gDT_[i] = 0;
+        }
+      }
+      ulapi_mutex_give(lock_);
+    }
+  }
+
+
+  void RobotiqEmulator::status (unsigned char *data)
+  {
+    bool individual = ((request_[1] & 0x04) != 0);
+    int i, moving = 0, contact = 0, sta = 0;
+
+    memset(data, 0, 2 * EMU_ROBOTIQ_REGISTERS);
+    for (i = 0; i < 3; ++i)
+    {
+      moving += (gDT_[i] == 0 ? 1 : 0);
+      contact += ((gDT_[i] == 1 || gDT_[i] == 2) ? 1 : 0);
+    }
+    if (gIMC_ == 3 && (request_[0] & 0x08) && moving == 0)
+    {
+      //! 1:  some fingers stopped early, 2:  all stopped early, 3:  all at the requested position
+      sta = (contact == 0 ? 3 : (contact == 3 ? 2 : 1));
+    }
+
+    data[0] = (unsigned char)((request_[0] & 0x01) | mode_ | (request_[0] & 0x08) | (gIMC_ << 4) | (sta << 6));
+    for (i = 0; i < 4; ++i)
+    {
+      data[1] |= (unsigned char)((gDT_[i] & 0x03) << (2 * i));
+      data[3 + (3 * i)] = request_[(individual || i == 3) ? (3 + (3 * i)) : 3];
+      data[4 + (3 * i)] = (unsigned char)(pos_[i] + 0.5);
+      data[5 + (3 * i)] = (unsigned char)(gDT_[i] == 2 ? request_[(individual || i == 3) ? (5 + (3 * i)) : 5] / 4 : 0);
+    }
+  }
+
+} // crpi_emulator
@@ -0,0 +1,414 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Controller Emulators
+//  Workfile:        emulator_ur.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Universal Robots controller emulator:  realtime state stream and script
+//  port.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include <iostream>
+#include "crpi_emulator.h"
+
+using namespace std;
+using namespace crpi_robot;
+
+#define UR_DEFAULT_JOINT_SPEED 1.05 //! movej speed (rad/s) when the statement does not give one
+#define UR_DEFAULT_LINEAR_SPEED 0.25 //! movel speed (m/s) when the statement does not give one
+
+namespace crpi_emulator
+{
+  static const double d2r = 3.14159265358979323846 / 180.0;
+
+  void urRealtimeHandler (EmuLink &link, void *data)
+  {
+    ((UrEmulator*)data)->realtime(link);
+  }
+
+
+  void urScriptHandler (EmuLink &link, void *data)
+  {
+    ((UrEmulator*)data)->script(link);
+  }
+
+
+  void urProgramThread (void *param)
+  {
+    ((UrEmulator*)param)->runPrograms();
+  }
+
+
+  //! @brief Store a double in network byte order
+  //!
+  static void putDouble (char *out, double val)
+  {
+    unsigned char raw[8];
+    int i;
+
+    memcpy(raw, &val, 8);
+    for (i = 0; i < 8; ++i)
+    {
+      out[i] = (char)raw[7 - i];
+    }
+  }
+
+
+  //! @brief Strip leading and trailing whitespace
+  //!
+  static string trim (const string &str)
+  {
+    size_t first = str.find_first_not_of(" \t\r\n");
+    if (first == string::npos)
+    {
+      return string();
+    }
+    return str.substr(first, str.find_last_not_of(" \t\r\n") - first + 1);
+  }
+
+
+  UrEmulator::UrEmulator (CrpiRobotParams &params, const emuFaults &faults) :
+    params_(params),
+    faults_(faults),
+    havePending_(false),
+    runThread_(true)
+  {
+    sim_ = new CrpiSim(params_);
+    lock_ = ulapi_mutex_new(55);
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, urProgramThread, this, ulapi_prio_lowest(), 0);
+  }
+
+
+  UrEmulator::~UrEmulator ()
+  {
+    runThread_ = false;
+    sim_->StopMotion();
+    Sleep(10);
+    delete sim_;
+  }
+
+
+  bool UrEmulator::start ()
+  {
+    int port = (params_.tcp_ip_port > 0 ? params_.tcp_ip_port : EMU_UR_SCRIPT_PORT);
+
+    return (emuListen(EMU_UR_REALTIME_PORT, urRealtimeHandler, this, faults_) &&
+            emuListen(port, urScriptHandler, this, faults_));
+  }
+
+
+  void UrEmulator::realtime (EmuLink &link)
+  {
+    char packet[EMU_UR_PACKET];
+    double started = ulapi_time();
+    double wake = started, now;
+
+    while (true)
+    {
+      //! Fixed schedule, as the controller sends regardless of the reader
+      wake += 1.0 / EMU_UR_RATE;
+      now = ulapi_time();
+      if (wake > now)
+      {
+        ulapi_sleep(wake - now);
+      }
+      else
+      {
+        wake = now;
+      }
+
+      packState(packet, started);
+      if (!link.send(packet, EMU_UR_PACKET))
+      {
+        return;
+      }
+    }
+  }
+
+
+  void UrEmulator::script (EmuLink &link)
+  {
+    char buffer[EMU_BUFFER];
+    string text, line, program;
+    bool inDef = false;
+    size_t end;
+    int get, i;
+
+    while ((get = link.read(buffer, EMU_BUFFER)) > 0)
+    {
+      for (i = 0; i < get; ++i)
+      {
+        if (buffer[i] != '\0')
+        {
+          text += buffer[i];
+        }
+      }
+
+      //! Programs arrive as "def name():" ... "end"; a bare statement is a program by itself
+      while ((end = text.find('\n')) != string::npos)
+      {
+        line = text.substr(0, end);
+        text.erase(0, end + 1);
+
+        if (line.compare(0, 4, "def ") == 0)
+        {
+          inDef = true;
+          program.clear();
+        }
+        else if (inDef && trim(line) == "end" && line[0] == 'e')
+        {
+          inDef = false;
+          submit(program);
+        }
+        else if (inDef)
+        {
+          program += trim(line) + "\n";
+        }
+        else if (!trim(line).empty())
+        {
+          submit(trim(line) + "\n");
+        }
+      }
+    }
+  }
+
+
+  void UrEmulator::submit (const string &program)
+  {
+    ulapi_mutex_take(lock_);
+    pending_ = program;
+    havePending_ = true;
+    ulapi_mutex_give(lock_);
+
+    //! A new program replaces the running one, including any motion in progress
+    sim_->StopMotion();
+  }
+
+
+  void UrEmulator::runPrograms ()
+  {
+    string program, line;
+    size_t start, end;
+    bool preempted;
+
+    while (runThread_)
+    {
+      ulapi_mutex_take(lock_);
+      if (!havePending_)
+      {
+        ulapi_mutex_give(lock_);
+        Sleep(1);
+        continue;
+      }
+      program = pending_;
+      havePending_ = false;
+      ulapi_mutex_give(lock_);
+
+      for (start = 0; start < program.length(); start = end + 1)
+      {
+        end = program.find('\n', start);
+        if (end == string::npos)
+        {
+          end = program.length();
+        }
+        line = program.substr(start, end - start);
+        execute(line);
+
+        ulapi_mutex_take(lock_);
+        preempted = havePending_;
+        ulapi_mutex_give(lock_);
+        if (preempted || !runThread_)
+        {
+          break;
+        }
+      }
+    }
+  }
+
+
+  void UrEmulator::execute (const string &line)
+  {
+    size_t open = line.find('('), bracket, speed;
+    string name = trim(line.substr(0, open));
+    const char *pos;
+    char *end;
+    double values[6], v[CRPI_AXES_MAX], r[3][3];
+    robotPose pose;
+    robotAxes axes;
+    int i, count;
+
+    if (open == string::npos)
+    {
+      return;
+    }
+
+    if (name == "movej" || name == "movel")
+    {
+      bracket = line.find('[', open);
+      if (bracket == string::npos)
+      {
+        return;
+      }
+      pos = line.c_str() + bracket + 1;
+      for (count = 0; count < 6; ++count)
+      {
+        values[count] = strtod(pos, &end);
+        if (end == pos)
+        {
+          break;
+        }
+        pos = end;
+        while (*pos == ' ' || *pos == ',')
+        {
+          ++pos;
+        }
+      }
+      if (count < 6)
+      {
+        return;
+      }
+
+      speed = line.find("v=", bracket);
+      v[0] = (speed == string::npos ? 0.0 : atof(line.c_str() + speed + 2));
+
+      if (line.compare(bracket - 1, 1, "p") == 0)
+      {
+        //! Pose:  meters and a rotation vector
+        pose.x = values[0] * 1000.0;
+        pose.y = values[1] * 1000.0;
+        pose.z = values[2] * 1000.0;
+        emuRotvecToMatrix(values + 3, r);
+        emuMatrixToRpy(r, values + 3);
+        pose.xrot = values[3];
+        pose.yrot = values[4];
+        pose.zrot = values[5];
+
+        if (name == "movel")
+        {
+          v[0] = (v[0] > 0.0 ? v[0] : UR_DEFAULT_LINEAR_SPEED) * 1000.0;
+          sim_->SetAbsoluteSpeed(v[0] < params_.sim_cart_speed ? v[0] : params_.sim_cart_speed);
+          sim_->MoveStraightTo(pose);
+          return;
+        }
+        sim_->MoveTo(pose);
+        return;
+      }
+
+      //! Joints:  radians
+      v[0] = (v[0] > 0.0 ? v[0] : UR_DEFAULT_JOINT_SPEED) / d2r;
+      v[0] = (v[0] < params_.sim_joint_speed ? v[0] : params_.sim_joint_speed);
+      axes.axis.resize(params_.sim_axes);
+      axes.axes = params_.sim_axes;
+      for (i = 0; i < params_.sim_axes; ++i)
+      {
+        axes.axis.at(i) = (i < 6 ? values[i] / d2r : 0.0);
+        v[i] = v[0];
+      }
+      sim_->SetAxialSpeeds(v);
+      sim_->MoveToAxisTarget(axes);
+    }
+    else if (name == "stopj" || name == "stopl")
+    {
+      sim_->StopMotion();
+    }
+    else if (name == "set_digital_out" || name == "set_standard_digital_out")
+    {
+      i = atoi(line.c_str() + open + 1);
+      sim_->SetRobotDO(i, line.find("True", open) != string::npos);
+    }
+    else if (name == "sleep")
+    {
+      ulapi_sleep(atof(line.c_str() + open + 1));
+    }
+  }
+
+
+  void UrEmulator::packState (char *packet, double started)
+  {
+    double values[(EMU_UR_PACKET - 4) / 8];
+    double r[3][3], rpy[3], now = ulapi_time();
+    robotPose pose, speed, forces;
+    robotAxes axes, axisSpeeds;
+    robotIO io;
+    int i, bits = 0;
+
+    sim_->GetRobotPose(&pose);
+    sim_->GetRobotSpeed(&speed);
+    sim_->GetRobotForces(&forces);
+    sim_->GetRobotAxes(&axes);
+    sim_->GetRobotSpeed(&axisSpeeds);
+    sim_->GetRobotIO(&io);
+
+    memset(values, 0, sizeof(values));
+    values[0] = now - started;
+    for (i = 0; i < 6; ++i)
+    {
+      values[1 + i] = (i < axes.axes ? axes.axis.at(i) * d2r : 0.0);
+      values[7 + i] = (i < axisSpeeds.axes ? axisSpeeds.axis.at(i) * d2r : 0.0);
+      values[31 + i] = values[1 + i];
+      values[37 + i] = values[7 + i];
+      values[86 + i] = 35.0;
+      values[95 + i] = 253.0;
+      values[124 + i] = 48.0;
+    }
+
+    //! Tool vector (actual and target):  meters and a rotation vector
+    rpy[0] = pose.xrot;
+    rpy[1] = pose.yrot;
+    rpy[2] = pose.zrot;
+    emuRpyToMatrix(rpy, r);
+    values[55] = values[73] = pose.x / 1000.0;
+    values[56] = values[74] = pose.y / 1000.0;
+    values[57] = values[75] = pose.z / 1000.0;
+    emuMatrixToRotvec(r, values + 58);
+    memcpy(values + 76, values + 58, 3 * sizeof(double));
+
+    //! TCP speed (actual and target) and force
+    values[61] = values[79] = speed.x / 1000.0;
+    values[62] = values[80] = speed.y / 1000.0;
+    values[63] = values[81] = speed.z / 1000.0;
+    values[64] = values[82] = speed.xrot * d2r;
+    values[65] = values[83] = speed.yrot * d2r;
+    values[66] = values[84] = speed.zrot * d2r;
+    values[67] = forces.x;
+    values[68] = forces.y;
+    values[69] = forces.z;
+    values[70] = forces.xrot;
+    values[71] = forces.yrot;
+    values[72] = forces.zrot;
+
+    //! Digital outputs are wired back to the inputs
+    for (i = 0; i < io.ndio && i < 16; ++i)
+    {
+      bits |= (io.dio[i] ? (1 << i) : 0);
+    }
+    values[85] = (double)bits;
+
+    values[92] = now - started;
+    values[94] = 7.0;               //! ROBOT_MODE_RUNNING
+    values[101] = 1.0;              //! Normal safety mode
+    values[117] = 1.0;              //! No speed scaling
+    values[121] = 48.0;
+    values[122] = 48.0;
+    values[123] = 1.0;
+
+    packet[0] = (char)((EMU_UR_PACKET >> 24) & 0xFF);
+    packet[1] = (char)((EMU_UR_PACKET >> 16) & 0xFF);
+    packet[2] = (char)((EMU_UR_PACKET >> 8) & 0xFF);
+    packet[3] = (char)(EMU_UR_PACKET & 0xFF);
+    for (i = 0; i < (EMU_UR_PACKET - 4) / 8; ++i)
+    {
+      putDouble(packet + 4 + (8 * i), values[i]);
+    }
+  }
+
+} // crpi_emulator
@@ -41,6 +41,9 @@ void main ()
   CrpiRobot<CrpiAbb> arm("abb_irb14000_right.xml");
   //CrpiRobot<CrpiUniversal> arm("universal_ur10_right.xml");
   //CrpiRobot<CrpiKukaLWR> arm("kuka_lwr.xml");
+  //! Against the controller emulators (Applications/CRPI_Emulator) on this machine
+  //CrpiRobot<CrpiUniversal> arm("universal_ur5_emulator.xml");
+  //CrpiRobot<CrpiAbb> arm("abb_irb14000_emulator.xml");
 
   arm.SetAngleUnits("degree");
   arm.SetLengthUnits("mm");
@@ -9,7 +9,7 @@
 //  ===========
 //  CRPI XML handler application.  Creates threads for each robot specified
 //  in settings.dat, each of which opens a server on a specified port that
-//  takes XML commands from a remote client.
+//  takes XML commands from remote clients.
 ///////////////////////////////////////////////////////////////////////////////
 
 #include <iostream>
@@ -23,6 +23,7 @@
 #include "crpi_kuka_lwr.h"
 #include "crpi_universal.h"
 #include "crpi_robotiq.h"
+#include "crpi_xml_server.h"
 #include "ulapi.h"
 
 //#define XMLINTERFACE_NOISY
@@ -65,6 +66,24 @@ struct globalHandle
 };
 
 
+//! @brief Serve XML commands to a robot from any number of remote clients
+//!
+//! @param gH   Pointer to a globalHandle object containing runtime instructions
+//! @param arm  The robot being commanded
+//! @param name Name of the robot for console messages
+//!
+//! @note One client at a time holds control of the robot; the others may monitor it with
+//!       Get* queries, which are answered while the robot moves (see XmlServer).
+//!
+template <class T> void serveArm (globalHandle *gH, CrpiRobot<T> &arm, const char *name)
+{
+  CrpiXmlTarget<T> target(&arm);
+  XmlServer server(&target, gH->port, name);
+
+  server.run(gH->runThread);
+}
+
+
 //! @brief Thread method for communicating with an ABB robot
 //!
 //! @param param Pointer to a globalHandle object containing runtime instructions
@@ -73,46 +92,8 @@ void armABBHandlerThread(void *param)
 {
   globalHandle *gH = (globalHandle*)param;
   CrpiRobot<CrpiAbb> arm(gH->path.c_str());
-  ulapi_integer server, client;
-  bool clientConnected = false;
-
-  crpi_timer timer;
-  char buffer[2048];
-  string str;
-  ulapi_integer rec, sent;
-
-  //! Create socket connection
-  server = ulapi_socket_get_server_id(gH->port);
-  ulapi_socket_set_blocking(server);
-
-  while (gH->runThread)
-  {
-    if (!clientConnected)
-    {
-      cout << "Running XML Interface on port " << gH->port << " for the ABB arm" << endl;
-      client = ulapi_socket_get_connection_id(server);
-      ulapi_socket_set_blocking(client);
-      clientConnected = true;
-      cout << "Remote ABB client connected..." << endl;
-    }
-
-    while (clientConnected && gH->runThread)
-    {
-      rec = ulapi_socket_read(client, buffer, 2048);
-      if (rec > 0)
-      {
-        str = buffer;
-        arm.CrpiXmlHandler(str);
-        arm.CrpiXmlResponse(buffer);
-        sent = ulapi_socket_write(client, buffer, strlen(buffer));
-      }
-      else
-      {
-        timer.waitUntil(5);
-      }
-    } // while (clientConnected && gH->runThread)
-  } // while (gH->runThread)
 
+  serveArm(gH, arm, "ABB");
   gH = NULL;
   return;
 }
@@ -128,47 +109,8 @@ void armUniversalHandlerThread(void *param)
   cout << "Creating robot using " << gH->path.c_str() << endl;
   CrpiRobot<CrpiUniversal> arm(gH->path.c_str());
   cout << "Robot Created" << endl;
-  ulapi_integer server, client;
-  bool clientConnected = false;
-
-  crpi_timer timer;
-  char buffer[2048];
-  string str;
-  ulapi_integer rec, sent;
-
-  //! Create socket connection
-  server = ulapi_socket_get_server_id(gH->port);
-  ulapi_socket_set_blocking(server);
-
-  while (gH->runThread)
-  {
-    if (!clientConnected)
-    {
-      cout << "Running XML Interface on port " << gH->port << " for the Universal arm" << endl;
-      client = ulapi_socket_get_connection_id(server);
-      ulapi_socket_set_blocking(client);
-      clientConnected = true;
-      cout << "Remote Universal client connected..." << endl;
-    }
-
-    while (clientConnected && gH->runThread)
-    {
-      rec = ulapi_socket_read(client, buffer, 2048);
-      if (rec > 0)
-      {
-        str = buffer;
-        arm.CrpiXmlHandler(str);
-
-        arm.CrpiXmlResponse(buffer);
-        sent = ulapi_socket_write(client, buffer, strlen(buffer));
-      }
-      else
-      {
-        timer.waitUntil(5);
-      }
-    } // while (clientConnected && gH->runThread)
-  } // while (gH->runThread)
 
+  serveArm(gH, arm, "Universal");
   gH = NULL;
   return;
 }
@@ -182,46 +124,8 @@ void armKukaHandlerThread(void *param)
 {
   globalHandle *gH = (globalHandle*)param;
   CrpiRobot<CrpiKukaLWR> arm(gH->path.c_str());
-  ulapi_integer server, client;
-  bool clientConnected = false;
-
-  crpi_timer timer;
-  char buffer[2048];
-  string str;
-  ulapi_integer rec, sent;
-
-  //! Create socket connection
-  server = ulapi_socket_get_server_id(gH->port);
-  ulapi_socket_set_blocking(server);
-
-  while (gH->runThread)
-  {
-    if (!clientConnected)
-    {
-      cout << "Running XML Interface on port " << gH->port << " for the KUKA arm" << endl;
-      client = ulapi_socket_get_connection_id(server);
-      ulapi_socket_set_blocking(client);
-      clientConnected = true;
-      cout << "Remote KUKA client connected..." << endl;
-    }
-
-    while (clientConnected && gH->runThread)
-    {
-      rec = ulapi_socket_read(client, buffer, 2048);
-      if (rec > 0)
-      {
-        str = buffer;
-        arm.CrpiXmlHandler(str);
-        arm.CrpiXmlResponse(buffer);
-        sent = ulapi_socket_write(client, buffer, strlen(buffer));
-      }
-      else
-      {
-        timer.waitUntil(5);
-      }
-    } // while (clientConnected && gH->runThread)
-  } // while (gH->runThread)
 
+  serveArm(gH, arm, "KUKA");
   gH = NULL;
   return;
 }
@@ -235,46 +139,8 @@ void armRobotiqHandlerThread(void *param)
 {
   globalHandle *gH = (globalHandle*)param;
   CrpiRobot<CrpiRobotiq> arm(gH->path.c_str());
-  ulapi_integer server, client;
-  bool clientConnected = false;
-
-  crpi_timer timer;
-  char buffer[2048];
-  string str;
-  ulapi_integer rec, sent;
-
-  //! Create socket connection
-  server = ulapi_socket_get_server_id(gH->port);
-  ulapi_socket_set_blocking(server);
-
-  while (gH->runThread)
-  {
-    if (!clientConnected)
-    {
-      cout << "Running XML Interface on port " << gH->port << " for the Robotiq arm" << endl;
-      client = ulapi_socket_get_connection_id(server);
-      ulapi_socket_set_blocking(client);
-      clientConnected = true;
-      cout << "Remote RObotiq client connected..." << endl;
-    }
-
-    while (clientConnected && gH->runThread)
-    {
-      rec = ulapi_socket_read(client, buffer, 2048);
-      if (rec > 0)
-      {
-        str = buffer;
-        arm.CrpiXmlHandler(str);
-        arm.CrpiXmlResponse(buffer);
-        sent = ulapi_socket_write(client, buffer, strlen(buffer));
-      }
-      else
-      {
-        timer.waitUntil(5);
-      }
-    } // while (clientConnected && gH->runThread)
-  } // while (gH->runThread)
 
+  serveArm(gH, arm, "Robotiq");
   gH = NULL;
   return;
 }
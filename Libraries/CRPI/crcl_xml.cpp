@@ -14,6 +14,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "crpi_xml.h"
+#include "crpi_xml_names.h"
 #include <iostream>
 
 using namespace std;
@@ -33,335 +34,9 @@ namespace Xml
   }
 
 
-  LIBRARY_API bool CrclXml::characters(const vector<string>& ch)
-  {
-    vector<string>::const_iterator chIter = ch.begin();
-
-    for (; chIter != ch.end(); ++chIter)
-    {
-    }
-
-    return true;
-  }
-
-
   LIBRARY_API bool CrclXml::parse (const string &line)
   {
-    static char buff[1024];
-    bool readTags = false;
-    bool state = true;
-    bool error = false;
-
-    xmlAttributes attr;
-    vector<string> chars;
-
-    int marker = 0;
-    int openTags = 0;
-    bool tagActive = false;
-    bool start = false;
-    bool single = false;
-    bool validXML = false;
-
-    int strLength = line.length();
-    int count;
-    string temp;
-    string name;
-    string attrname;
-    string attrval;
-    try
-    {
-      //! JAM:  TODO, STRIP OFF WHITE SPACE:  Carriage returns, tabs, etc.
-
-      while (marker < strLength && !error && line[marker] != '\0')
-      {
-        if (line[marker] == '<')
-        {
-          //! ***** Handle tags *****
-          tagActive = true;
-          for (int i = 0; i < 20; i++)
-          {
-            buff[i] = ' ';
-          }
-
-          name = "";
-          ++marker;
-
-          //! Skip white space
-          while (line[marker] == ' ' || line[marker] == '\t' || line[marker] == '?')
-          {
-            ++marker;
-            if (marker >= (strLength - 1))
-            {
-              break;
-            }
-          }
-
-          if (marker >= (strLength - 1))
-          {
-            //! Ill-formed XML string (end encountered before closing tags
-            error = true;
-            break;
-          }
-
-          if (line[marker] == '/')
-          {
-            start = false;
-            marker++;
-          }
-          else
-          {
-            start = true;
-          }
-
-          int count = 0;
-          while (line[marker] != ' ' && line[marker] != '\t' &&
-                 line[marker] != '/' && line[marker] != '>' &&
-                 line[marker] != '?' && marker <= (strLength - 1))
-          {
-            buff[count] = line[marker];
-            count++;
-            marker++;
-            if (marker >= (strLength - 1))
-            {
-              break;
-            }
-          }
-          if (marker > (strLength - 1))
-          {
-            //! Ill-formed XML string (end encountered before closing tags
-            error = true;
-            break;
-          }
-
-          buff[count] = '\0';
-          name = buff;
-          name = name.substr(0, count);
-
-          if (start)
-          {
-            //! Look for attributes of opening tags
-            while (line[marker] != '/' && line[marker] != '>' &&
-                   line[marker] != '?' && marker <= (strLength -1))
-            {
-              if (line[marker] != ' ' && line[marker] != '\t' &&
-                  line[marker] != '?' && line[marker] != '\n')
-              {
-                //! Non-white-space character & non-terminating element
-                //! Ergo, an attribute
-                count = 0;
-
-                //! grab the attribute name
-                while (line[marker] != '=' && line[marker] != ' ' && line[marker] != '?')
-                {
-                  buff[count++] = line[marker++];
-                  if (marker >= strLength - 1)
-                  {
-                    break;
-                  }
-                }
-                if (marker >= strLength - 1)
-                {
-                  break;
-                }
-                buff[count] = '\0';
-                attrname = buff;
-                attrname = attrname.substr(0, count);
-                attr.name.push_back(attrname);
-
-                //! grab the attribute value
-                while (line[marker] != '\"')
-                {
-                  marker++;
-                  if (marker >= strLength - 1)
-                  {
-                    break;
-                  }
-                }
-                marker++;
-                if (marker >= strLength - 1)
-                {
-                  break;
-                }
-
-                count = 0;
-                while (line[marker] != '\"')
-                {
-                  buff[count++] = line[marker++];
-                  if (marker >= strLength - 1)
-                  {
-                    break;
-                  }
-                }
-                buff[count] = '\0';
-                attrval = buff;
-                attrval = attrval.substr(0, count);
-                attr.val.push_back(attrval);
-              } // if (line[marker] != ' ' && line[marker] != '\t' && line[marker] != '\n' && line[marker] != '?')
-              marker++;
-              if (marker > strLength - 1)
-              {
-                break;
-              }
-            } // while (line[marker] != '/' && line[marker] != '>' && line[marker] != '?')
-
-            if (marker > (strLength - 1))
-            {
-              //! Ill-formed XML string (end encountered before closing tags
-              error = true;
-              break;
-            } // if (marker > (strLength - 1))
-
-            //! Test for single-tag XML lines (ex. <tag/>
-            if (line[marker] == '/')
-            {
-              single = true;
-            }
-            while (line[marker] != '>')
-            {
-              marker++;
-              if (marker >= strLength - 1)
-              {
-                break;
-              }
-            } // while (line[marker] != '>')
-          } // if (start)
-
-          if (error)
-          {
-            break;
-          }
-
-          //! Pass tag information for data structure assignment
-          if (start)
-          {
-            if (state && startElement (name, attr))
-            {
-              state = true;
-              attr.name.clear();
-              attr.val.clear();
-            }
-            else
-            {
-              state = false;
-            }
-
-            validXML = false;
-            openTags++;
-            readTags = true;
-            if (single)
-            {
-              tagActive = false;
-              validXML = true;
-              if (state && endElement (name))
-              {
-                state = true;
-              }
-              else
-              {
-                state = false;
-              }
-              openTags--;
-              start = false;
-            }
-          } // if (start)
-          else
-          {
-            tagActive = false;
-            validXML = true;
-            if (state && endElement (name))
-            {
-              state = true;
-            }
-            else
-            {
-              state = false;
-            }
-            openTags--;
-          } // if (start) ... else
-        } // if (line[marker] == '<')
-        else if (tagActive)
-        {
-          //! ***** Handle text between tags *****
-          while(start)
-          {
-            if (marker > strLength || line[marker] == '<')
-            {
-              marker--;
-              break;
-            }
-
-            //! Skip white space
-            while (line[marker] == ' ' || line[marker] == '\t' ||
-                   line[marker] == '\n' || line[marker] == ',' ||
-                   line[marker] == '?')
-            {
-              marker++;
-              if (marker >= strLength)
-              {
-                break;
-              }
-            }
-
-            if (marker > strLength || line[marker] == '<')
-            {
-              marker--;
-              break;
-            }
-
-            count = 0;
-            while (line[marker] != ',' && line[marker] != '<')
-            {
-              buff[count++] = line[marker++];
-              if (marker >= strLength - 1)
-              {
-                break;
-              }
-            }
-            if (marker >= (strLength - 1))
-            {
-              //! Ill-formed XML string (end encountered before closing tags
-              error = true;
-              break;
-            }
-            if (count > 0)
-            {
-              temp = buff;
-              temp = temp.substr (0, count);
-              chars.push_back (temp);
-            }
-          } // while(start)
-          if (start)
-          {
-            if (state && interTagElement (name, chars))
-            {
-              state = true;
-            }
-            else
-            {
-              state = false;
-            }
-            chars.clear ();
-          }
-          start = false;
-        } // else if (tagActive)
-
-        ++marker;
-        if (openTags < 1 && readTags)
-        {
-//          break;
-        }
-      } // while (marker < strLength && marker < 1024)
-    } // try
-    catch (...)
-    {
-      return false;
-    }
-
-    if (error)
-    {
-      //! Exiting with errors
-    }
-    return state;
+    return saxParse(line.data(), line.length(), *this);
   }
 
   /*
@@ -399,149 +74,45 @@ namespace Xml
     </CRCLCommandInstance>
   */
 
-  LIBRARY_API bool CrclXml::startElement (const string& tagName, 
+  LIBRARY_API bool CrclXml::startElement (const xmlView& tagName, 
                                           const xmlAttributes& attr)
   {
     bool flag = true;
-    std::vector<std::string>::const_iterator nameiter = attr.name.begin();
-    std::vector<std::string>::const_iterator valiter = attr.val.begin();
+    xmlViewList::const_iterator nameiter = attr.name.begin();
+    xmlViewList::const_iterator valiter = attr.val.begin();
 
     try
     {
-      if (strcmp (tagName.c_str(), "CRCLCommand") == 0)
+      switch (xmlLookup(tagName).token)
       {
+      case TokCRCLCommand:
+        //<CRCLCommand xsi:type="MoveToType">
         for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp (nameiter->c_str(), "xsi:type") == 0)
+          if (xmlLookup(*nameiter).token == TokXsiType)
           {
-            if (strcmp (valiter->c_str(), "ActuateJointsType") == 0)
-            {
-              params_->cmd = CmdMoveToAxisTarget;
-            }
-            else if (strcmp (valiter->c_str(), "CloseToolChangerType") == 0)
-            {
-              params_->cmd = CmdCouple;
-            }
-            else if (strcmp (valiter->c_str(), "ConfigureJointReportsType") == 0)
+            //! Command types without a CRPI equivalent leave the command unchanged
+            const xmlName &cmd = xmlLookup(*valiter);
+            if (cmd.token == TokCrclCommand && cmd.field >= 0)
             {
-              //! JAM: No CRPI equivalent
+              params_->cmd = (CanonCommand)cmd.field;
             }
-            else if (strcmp (valiter->c_str(), "DwellType") == 0)
-            {
-              //! No CRPI equivalent
-              params_->cmd = CmdDwell;
-            }
-            else if (strcmp (valiter->c_str(), "EndCanonType") == 0)
-            {
-              //! No CRPI equivalent
-              params_->cmd = CmdEndCanon;
-            }
-            else if (strcmp (valiter->c_str(), "GetStatusType") == 0)
-            {
-              params_->cmd = CmdGetRobotPose;
-            }
-            else if (strcmp (valiter->c_str(), "InitCanonType") == 0)
-            {
-              params_->cmd = CmdInitCanon;
-            }
-            else if (strcmp (valiter->c_str(), "MessageType") == 0)
-            {
-              params_->cmd = CmdMessage;
-            }
-            else if (strcmp (valiter->c_str(), "MoveScrewType") == 0)
-            {
-              //! JAM:  No CRPI equivalent
-            }
-            else if (strcmp (valiter->c_str(), "MoveThroughToType") == 0)
-            {
-              params_->cmd = CmdMoveThroughTo;
-            }
-            else if (strcmp (valiter->c_str(), "MoveToType") == 0)
-            {
-              params_->cmd = CmdMoveTo;
-            }
-            else if (strcmp (valiter->c_str(), "RunProgramType") == 0)
-            {
-              //! JAM:  No CRPI equivalent
-              params_->cmd = CmdRunProgram;
-            }
-            else if (strcmp (valiter->c_str(), "SetAbsoluteAccelerationType") == 0)
-            {
-              params_->cmd = CmdSetAbsoluteAcceleration;
-            }
-            else if (strcmp (valiter->c_str(), "SetAbsoluteSpeedType") == 0)
-            {
-              params_->cmd = CmdSetAbsoluteSpeed;
-            }
-            else if (strcmp (valiter->c_str(), "SetAngleUnitsType") == 0)
-            {
-              params_->cmd = CmdSetAngleUnits;
-            }
-            else if (strcmp (valiter->c_str(), "SetEndEffectorParametersType") == 0)
-            {
-              params_->cmd = CmdSetParameter;
-            }
-            else if (strcmp (valiter->c_str(), "SetEndEffectorType") == 0)
-            {
-              params_->cmd = CmdSetTool;
-            }
-            else if (strcmp (valiter->c_str(), "SetEndPoseToleranceType") == 0)
-            {
-              params_->cmd = CmdSetEndPoseTolerance;
-            }
-            else if (strcmp (valiter->c_str(), "SetForceUnitsType") == 0)
-            {
-              //! JAM: No CRPI equivalent
-            }
-            else if (strcmp (valiter->c_str(), "SetIntermediatePoseToleranceType") == 0)
-            {
-              params_->cmd = CmdSetIntermediatePoseTolerance;
-            }
-            else if (strcmp (valiter->c_str(), "SetJointControlModesType") == 0)
-            {
-              //! JAM:  No CRPI equivalent
-            }
-            else if (strcmp (valiter->c_str(), "SetLengthUnitsType") == 0)
-            {
-              params_->cmd = CmdSetLengthUnits;
-            }
-            else if (strcmp (valiter->c_str(), "SetRelativeAccelerationType") == 0)
-            {
-              params_->cmd = CmdSetRelativeAcceleration;
-            }
-            else if (strcmp (valiter->c_str(), "SetTransSpeedRelativeType") == 0)
-            {
-              params_->cmd = CmdSetRelativeSpeed;
-            }
-            else if (strcmp (valiter->c_str(), "SetRobotParametersType") == 0)
-            {
-              params_->cmd = CmdSetParameter;
-            }
-            else if (strcmp (valiter->c_str(), "SetTorqueUnitsType") == 0)
-            {
-              //! JAM: No CRPI equivalent
-            }
-            else if (strcmp (valiter->c_str(), "StopMotionType") == 0)
-            {
-              params_->cmd = CmdStopMotion;
-            }
-          } //if (strcmp (nameiter->c_str(), "xsi:type") == 0)
-        } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
-      } //if (strcmp (tagName.c_str(), "CRCLCommand") == 0)
+          }
+        }
+        break;
 
       /*
         All other variables set using the interTagElement function
       */
-
-      if (strcmp (tagName.c_str(), "XAxis") == 0)
-      {
+      case TokXAxis:
         xaxisactive = true;
-      } //if (strcmp (tagName.c_str(), "XAxis") == 0)
-      if (strcmp (tagName.c_str(), "ZAxis") == 0)
-      {
+        break;
+      case TokZAxis:
         zaxisactive = true;
-      } //if (strcmp (tagName.c_str(), "ZAxis") == 0)
-
+        break;
+      default:
+        break;
+      }
     } // try
     catch (...)
     {
@@ -552,114 +123,45 @@ namespace Xml
   }
 
 
-  LIBRARY_API bool CrclXml::interTagElement (const string& tagName, 
-                                             const std::vector<std::string>& vals)
+  LIBRARY_API bool CrclXml::interTagElement (const xmlView& tagName, 
+                                             const xmlViewList& vals)
   {
     bool flag = true;
-    std::vector<std::string>::const_iterator valiter = vals.begin();
+    xmlViewList::const_iterator valiter = vals.begin();
+    const xmlName &tag = xmlLookup(tagName);
 
     try
     {
-      //! Robot pose:
-      if (strcmp (tagName.c_str(), "X") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          params_->pose->x = atof (valiter->c_str ());
-        }
-      }
-      if (strcmp (tagName.c_str(), "Y") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          params_->pose->y = atof (valiter->c_str ());
-        }
-      }
-      if (strcmp (tagName.c_str(), "Z") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          params_->pose->z = atof (valiter->c_str ());
-        }
-      }
-
-      //! Robot orientation
-      if (strcmp (tagName.c_str(), "I") == 0)
+      for (; valiter != vals.end(); ++valiter)
       {
-        for (; valiter != vals.end(); ++valiter)
+        switch (tag.token)
         {
+        case TokPoseField:
+          //! Robot pose:  <X>, <Y>, <Z>
+          xmlField(params_->pose, tag.field) = valiter->real();
+          break;
+        case TokVectorField:
+          //! Robot orientation:  <I>, <J>, <K> of <XAxis> or <ZAxis>
           if (xaxisactive)
           {
-            params_->xaxis.i = atof (valiter->c_str ());
+            xmlField(&params_->xaxis, tag.field) = valiter->real();
           }
           else if (zaxisactive)
           {
-            params_->zaxis.i = atof (valiter->c_str ());
+            xmlField(&params_->zaxis, tag.field) = valiter->real();
           }
-        }
-      }
-      if (strcmp (tagName.c_str(), "J") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          if (xaxisactive)
-          {
-            params_->xaxis.j = atof (valiter->c_str ());
-          }
-          else if (zaxisactive)
-          {
-            params_->zaxis.j = atof (valiter->c_str ());
-          }
-        }
-      }
-      if (strcmp (tagName.c_str(), "K") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          if (xaxisactive)
-          {
-            params_->xaxis.k = atof (valiter->c_str ());
-          }
-          else if (zaxisactive)
-          {
-            params_->zaxis.k = atof (valiter->c_str ());
-          }
-        }
-      }
-
-      //! NumPositions
-      if (strcmp (tagName.c_str(), "NumPositions") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          params_->numPositions = atof (valiter->c_str ());
-        }
-      }
-
-      //! CommandID
-      if (strcmp (tagName.c_str(), "CommandID") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          params_->commandID = atoi (valiter->c_str ());
-        }
-      }
-
-      //! Setting
-      if (strcmp (tagName.c_str(), "Setting") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          params_->setting = atof (valiter->c_str ());
-        }
-      }
-
-      //! MoveStraight
-      if (strcmp (tagName.c_str(), "MoveStraight") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          if (strcmp (valiter->c_str(), "true"))
+          break;
+        case TokNumPositions:
+          params_->numPositions = valiter->real();
+          break;
+        case TokCommandID:
+          params_->commandID = valiter->integer();
+          break;
+        case TokSetting:
+          params_->setting = valiter->real();
+          break;
+        case TokMoveStraight:
+          if (*valiter != "true")
           {
             params_->moveStraight = true;
           }
@@ -667,14 +169,12 @@ namespace Xml
           {
             params_->moveStraight = false;
           }
-        }
-      }
-
-      if (strcmp (tagName.c_str(), "Name") == 0)
-      {
-        for (; valiter != vals.end(); ++valiter)
-        {
-          params_->str = valiter->c_str();
+          break;
+        case TokName:
+          valiter->copy(params_->str);
+          break;
+        default:
+          break;
         }
       }
     } // try
@@ -687,16 +187,19 @@ namespace Xml
   }
 
 
-  LIBRARY_API bool CrclXml::endElement(const string& tagName)
+  LIBRARY_API bool CrclXml::endElement(const xmlView& tagName)
   {
-    if (strcmp (tagName.c_str(), "XAxis") == 0)
+    switch (xmlLookup(tagName).token)
     {
+    case TokXAxis:
       xaxisactive = false;
-    } //if (strcmp (tagName.c_str(), "XAxis") == 0)
-    if (strcmp (tagName.c_str(), "ZAxis") == 0)
-    {
+      break;
+    case TokZAxis:
       zaxisactive = false;
-    } //if (strcmp (tagName.c_str(), "ZAxis") == 0)
+      break;
+    default:
+      break;
+    }
 
     /*
     if (tagName == "RobData")
@@ -732,9 +235,12 @@ namespace Xml
     </Pose>
   </CRCLStatus>
   */
-  LIBRARY_API bool CrclXml::encode (char *line)
+  LIBRARY_API bool CrclXml::encode (std::string &line)
   {
+    XmlWriter out(line);
     std::string str;
+
+    out.clear();
     switch (params_->status)
     {
     case CANON_SUCCESS:
@@ -756,42 +262,19 @@ namespace Xml
 
     if (params_ != NULL)
     {
-      if (strcmp (params_->toolName.c_str(), "Nothing") == 0)
-      {
-        sprintf (line, "<?xml version=\"1.0\" encoding=\"UTF-8\"?><CRCLStatus xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xsi:noNamespaceSchemaLocation=\"../xmlSchemas/CRCLStatus.xsd\"><CommandStatus><CommandID>%d</CommandID><StatusID>%d</StatusID><CommandState>%s</CommandState></CommandStatus><Pose><Point><X>%f</X><Y>%f</Y><Z>%f</Z></Point><XAxis><I>%f</I><J>%f</J><K>%f</K></XAxis><ZAxis><I>%f</I><J>%f</J><K>%f</K></ZAxis></Pose></CRCLStatus>\0",
-                 params_->commandID,
-                 params_->counter,
-                 str.c_str(),
-                 params_->pose->x,
-                 params_->pose->y,
-                 params_->pose->z,
-                 params_->xaxis.i,
-                 params_->xaxis.j,
-                 params_->xaxis.k,
-                 params_->zaxis.i,
-                 params_->zaxis.j,
-                 params_->zaxis.k);
-      }
-      else
+      out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?><CRCLStatus xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xsi:noNamespaceSchemaLocation=\"../xmlSchemas/CRCLStatus.xsd\">";
+      out << "<CommandStatus><CommandID>" << params_->commandID << "</CommandID><StatusID>" << params_->counter
+          << "</StatusID><CommandState>" << str << "</CommandState></CommandStatus>";
+      if (strcmp (params_->toolName.c_str(), "Nothing") != 0)
       {
         //! Include gripper status if a tool has been defined using the couple command
-        sprintf (line, "<?xml version=\"1.0\" encoding=\"UTF-8\"?><CRCLStatus xmlns:xsi=\"http://www.w3.org/2001/XMLSchema-instance\" xsi:noNamespaceSchemaLocation=\"../xmlSchemas/CRCLStatus.xsd\"><CommandStatus><CommandID>%d</CommandID><StatusID>%d</StatusID><CommandState>%s</CommandState></CommandStatus><GripperStatus><GripperName>%s</GripperName><Separation>%f</Separation></GripperStatus><Pose><Point><X>%f</X><Y>%f</Y><Z>%f</Z></Point><XAxis><I>%f</I><J>%f</J><K>%f</K></XAxis><ZAxis><I>%f</I><J>%f</J><K>%f</K></ZAxis></Pose></CRCLStatus>\0",
-                 params_->commandID,
-                 params_->counter,      
-                 str.c_str(),
-                 params_->toolName.c_str(),
-                 params_->toolVal,
-                 params_->pose->x,
-                 params_->pose->y,
-                 params_->pose->z,
-                 params_->xaxis.i,
-                 params_->xaxis.j,
-                 params_->xaxis.k,
-                 params_->zaxis.i,
-                 params_->zaxis.j,
-                 params_->zaxis.k);
+        out << "<GripperStatus><GripperName>" << params_->toolName << "</GripperName><Separation>"
+            << params_->toolVal << "</Separation></GripperStatus>";
       }
-
+      out << "<Pose><Point><X>" << params_->pose->x << "</X><Y>" << params_->pose->y << "</Y><Z>"
+          << params_->pose->z << "</Z></Point><XAxis><I>" << params_->xaxis.i << "</I><J>" << params_->xaxis.j
+          << "</J><K>" << params_->xaxis.k << "</K></XAxis><ZAxis><I>" << params_->zaxis.i << "</I><J>"
+          << params_->zaxis.j << "</J><K>" << params_->zaxis.k << "</K></ZAxis></Pose></CRCLStatus>";
     } //if (params_ != NULL)
     return true;
   }
@@ -22,12 +22,17 @@
 #include <vector>
 #include <string>
 #include <time.h>
+#include <atomic>
+#include <mutex>
+#include <condition_variable>
+#include <chrono>
 #include "..\Math\MatrixMath.h"
 #include "..\Math\VectorMath.h"
 #include "..\..\portable.h"
 
 #ifndef WIN32
 #include <unistd.h>
+#include <sys/socket.h>
 #endif
 
 #ifdef WIN32
@@ -95,7 +100,8 @@ typedef enum
   CmdToSystem,
   CmdToWorld,
   CmdUpdateSystemTransform,
-  CmdUpdateWorldTransform
+  CmdUpdateWorldTransform,
+  CmdSubscribe                  //! Served by XmlServer, not by the robot
 } CanonCommand;
 
 typedef enum
@@ -657,17 +663,62 @@ struct keepalive
 };
 
 
-//! @brief Inner-tag parameter attributes for XML tags (ex <tag name="val">)
+//! @brief Single-writer state cache for feedback threads (sequence lock).  The writer never
+//!        blocks and readers never take a lock; a read that overlaps a write is retried.
 //!
-struct xmlAttributes
+//! @note T must be a plain structure (no pointers or containers), since a reader may copy it
+//!       while it is being written and then discard the copy.
+//!
+template <class T> class CrpiStateCache
 {
-  //! @brief The list of parameter names
+public:
+  //! @brief Default constructor
   //!
-  std::vector<std::string> name;
+  CrpiStateCache () :
+    seq_(0)
+  {
+  }
 
-  //! @brief The list of parameter values
+  //! @brief Publish a new value (feedback thread only)
+  //!
+  //! @param value The value to publish
   //!
-  std::vector<std::string> val;
+  void write (const T &value)
+  {
+    unsigned long seq = seq_.load(std::memory_order_relaxed);
+    seq_.store(seq + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+    data_ = value;
+    seq_.store(seq + 2, std::memory_order_release);
+  }
+
+  //! @brief Copy the most recently published value
+  //!
+  //! @param value The structure populated by this method
+  //!
+  //! @return The number of values published so far (0 if value was not populated)
+  //!
+  unsigned long read (T &value) const
+  {
+    unsigned long before, after;
+    do
+    {
+      before = seq_.load(std::memory_order_acquire);
+      value = data_;
+      std::atomic_thread_fence(std::memory_order_acquire);
+      after = seq_.load(std::memory_order_relaxed);
+    } while ((before & 1) != 0 || before != after);
+    return (before / 2);
+  }
+
+private:
+  //! @brief Write sequence number (odd while a write is in progress)
+  //!
+  std::atomic<unsigned long> seq_;
+
+  //! @brief The published value
+  //!
+  T data_;
 };
 
 
@@ -817,6 +868,68 @@ struct CrpiRobotParams
   //!
   bool use_serial;
 
+  //! @brief Whether or not to use the driver's binary command framing instead of text messages
+  //!
+  bool use_binary;
+
+  //! @brief Whether or not to use the Universal Robots RTDE interface for feedback and motion
+  //!
+  bool use_rtde;
+
+  //! @brief Port on which the RTDE server is listening
+  //!
+  int rtde_port;
+
+  //! @brief Requested RTDE output frequency in Hz (limited by the controller)
+  //!
+  double rtde_frequency;
+
+  //! @brief Rate in Hz at which drivers with a background status poll read the device (0 for the
+  //!        driver's default)
+  //!
+  double poll_rate;
+
+  //! @brief Whether or not to reach a hand server on the same computer through shared memory
+  //!        instead of loopback TCP
+  //!
+  bool use_shm;
+
+  //! @brief Shared memory key of the hand server (0 for the driver's default)
+  //!
+  int shm_key;
+
+  //! @brief Whether or not to run against the simulated controller (CrpiSim) instead of the robot
+  //!
+  bool use_sim;
+
+  //! @brief Simulated kinematic model:  articulated serial arm (true) or independent joints and
+  //!        Cartesian pose (false)
+  //!
+  bool sim_serial;
+
+  //! @brief Number of simulated axes
+  //!
+  int sim_axes;
+
+  //! @brief Link lengths of the simulated serial arm in mm (the first is the base height)
+  //!
+  double sim_links[CRPI_AXES_MAX];
+
+  //! @brief Simulated joint (degrees/s), Cartesian (mm/s), and rotational (degrees/s) speed limits
+  //!
+  double sim_joint_speed;
+  double sim_cart_speed;
+  double sim_rot_speed;
+
+  //! @brief Rate in Hz at which the simulated controller updates its feedback
+  //!
+  double sim_rate;
+
+  //! @brief Simulated latency of every call and the range of the uniform jitter added to it (ms)
+  //!
+  double sim_latency;
+  double sim_jitter;
+
   //! @brief Transformation to realign the robot's coordinate system to correct for mounting
   //!
   robotPose *mounting;
@@ -871,6 +984,26 @@ struct CrpiRobotParams
     serial_sbits = 0;
     serial_handshake[0] = '\0';
     use_serial = true;
+    use_binary = false;
+    use_rtde = false;
+    rtde_port = 30004;
+    rtde_frequency = 125.0;
+    poll_rate = 0.0;
+    use_shm = false;
+    shm_key = 0;
+    use_sim = false;
+    sim_serial = false;
+    sim_axes = 6;
+    for (int i = 0; i < CRPI_AXES_MAX; ++i)
+    {
+      sim_links[i] = 0.0;
+    }
+    sim_joint_speed = 180.0;
+    sim_cart_speed = 500.0;
+    sim_rot_speed = 180.0;
+    sim_rate = 125.0;
+    sim_latency = 0.0;
+    sim_jitter = 0.0;
   }
 
   //! @brief Assignment function
@@ -896,6 +1029,26 @@ struct CrpiRobotParams
       serial_sbits = source.serial_sbits;
       strcpy_s(serial_handshake, source.serial_handshake);
       use_serial = source.use_serial;
+      use_binary = source.use_binary;
+      use_rtde = source.use_rtde;
+      rtde_port = source.rtde_port;
+      rtde_frequency = source.rtde_frequency;
+      poll_rate = source.poll_rate;
+      use_shm = source.use_shm;
+      shm_key = source.shm_key;
+      use_sim = source.use_sim;
+      sim_serial = source.sim_serial;
+      sim_axes = source.sim_axes;
+      for (int i = 0; i < CRPI_AXES_MAX; ++i)
+      {
+        sim_links[i] = source.sim_links[i];
+      }
+      sim_joint_speed = source.sim_joint_speed;
+      sim_cart_speed = source.sim_cart_speed;
+      sim_rot_speed = source.sim_rot_speed;
+      sim_rate = source.sim_rate;
+      sim_latency = source.sim_latency;
+      sim_jitter = source.sim_jitter;
 
       tools.clear();
       coordSystNames.clear();
@@ -979,6 +1132,112 @@ inline const char* TimeStr ()
 };
 
 
+//! @brief Release a thread blocked reading from (or accepting on) a socket
+//!
+//! @param id The socket, which the blocked thread then reads as closed
+//!
+//! @note Closing a socket does not wake a thread blocked on it on every platform.  Release
+//!       the socket, join the thread, and only then close the socket.  On Windows a listening
+//!       socket cannot be shut down, so a thread blocked accepting on it is released by a
+//!       connection that is closed at once; the accept loop must check whether it is to stop
+//!       after every connection it accepts.
+//!
+inline void SocketRelease (ulapi_integer id)
+{
+#ifdef WIN32
+  struct sockaddr_in addr;
+  int size = sizeof(addr);
+  ulapi_integer wake;
+
+  //! SD_BOTH; shutdown and getsockname are declared by windows.h
+  if (shutdown ((SOCKET)id, 2) == 0)
+  {
+    return;
+  }
+
+  //! Not connected (WSAENOTCONN):  a listening socket, whose accept only a connection wakes
+  if (getsockname ((SOCKET)id, (struct sockaddr*)&addr, &size) == 0 && addr.sin_family == AF_INET)
+  {
+    wake = ulapi_socket_get_client_id (ntohs (addr.sin_port),
+                                       (addr.sin_addr.s_addr == htonl (INADDR_ANY) ? "127.0.0.1" : inet_ntoa (addr.sin_addr)));
+    if (wake >= 0)
+    {
+      ulapi_socket_close (wake);
+    }
+  }
+#else
+  shutdown ((int)id, SHUT_RDWR);
+#endif
+};
+
+
+//! @brief Counting semaphore for waking a thread that waits for work
+//!
+//! @note ulapi semaphores are named, system-wide objects; this one belongs to a single
+//!       process and may be embedded in each object that needs it.
+//!
+class crpi_semaphore
+{
+public:
+  //! @brief Default constructor
+  //!
+  crpi_semaphore () :
+    count_(0)
+  {
+  };
+
+  //! @brief Default destructor
+  //!
+  ~crpi_semaphore ()
+  {
+  };
+
+  //! @brief Increment the count, waking one waiting thread
+  //!
+  inline void give ()
+  {
+    std::lock_guard<std::mutex> guard(lock_);
+    ++count_;
+    signal_.notify_one();
+  };
+
+  //! @brief Wait until the count is positive, then decrement it
+  //!
+  inline void take ()
+  {
+    std::unique_lock<std::mutex> guard(lock_);
+    while (count_ == 0)
+    {
+      signal_.wait(guard);
+    }
+    --count_;
+  };
+
+  //! @brief Wait until the count is positive, then decrement it
+  //!
+  //! @param ms The longest time to wait in milliseconds
+  //!
+  //! @return True if the count was decremented, false if the wait timed out
+  //!
+  inline bool take (double ms)
+  {
+    std::unique_lock<std::mutex> guard(lock_);
+    if (!signal_.wait_for(guard, std::chrono::microseconds((long long)(ms * 1000.0)),
+                          [this] { return count_ > 0; }))
+    {
+      return false;
+    }
+    --count_;
+    return true;
+  };
+
+private:
+  std::mutex lock_;
+  std::condition_variable signal_;
+  int count_;
+}; // class crpi_semaphore
+
+
 //! @brief Timer class, includes stopwatch and alarm functionality
 //!
 class crpi_timer
@@ -992,6 +1251,10 @@ public:
 #ifdef WIN32
     highRes_ = (QueryPerformanceFrequency (&frequency_) ? true : false);
     timeBeginPeriod (1);
+#else
+    //! usleep is precise enough that waitUntil need not poll the clock
+    highRes_ = false;
+    start_ = 0.0;
 #endif
   };
 
@@ -1019,6 +1282,8 @@ public:
     {
       lRstart_ = (long)getCurrentTime ();
     }
+#else
+    start_ = ulapi_time ();
 #endif
     }
   };
@@ -1037,6 +1302,8 @@ public:
     {
       lRstart_ = (long)getCurrentTime ();
     }
+#else
+    start_ = ulapi_time ();
 #endif
   };
 
@@ -1066,6 +1333,9 @@ public:
       lRsample_ = (long)getCurrentTime ();
       return (lRsample_ - lRstart_);
     }
+#else
+    running_ = false;
+    return ((ulapi_time () - start_) * 1000.0);
 #endif    
   };
 
@@ -1095,6 +1365,8 @@ public:
       lRsample_ = (long)getCurrentTime ();
       return (lRsample_ - lRstart_);
     }
+#else
+    return ((ulapi_time () - start_) * 1000.0);
 #endif
   };
 
@@ -1148,6 +1420,10 @@ private:
   //!
   long lRsample_;
 
+  //! @brief Start time (s) where there is no high resolution counter
+  //!
+  double start_;
+
   //! @brief High resolution time sample difference variable
   //!
   LONGLONG timeDiff_;
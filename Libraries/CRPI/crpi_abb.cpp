@@ -13,29 +13,256 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "crpi_abb.h"
+#include "crpi_watchdog.h"
 #include "..\Math\MatrixMath.h"
 #include <fstream>
+#include <stdlib.h>
+#include <string.h>
 
 using namespace std;
 
 //#define ABB_NOISY
 
+//! State server stream settings:  receive buffer size (bytes), the bounds (ms) of the exponential
+//! reconnect backoff, and the age (s) after which cached feedback is no longer used
+#define ABB_STREAM_BUFFER 1024
+#define ABB_BACKOFF_MIN 100
+#define ABB_BACKOFF_MAX 5000
+#define ABB_STATE_STALE 0.5
+
 namespace crpi_robot
 {
-  void livemanABB (void *param)
+  //! @brief Keepalive heartbeat:  report the age of the newest feedback without touching the
+  //!        command socket, which may be held by a motion for as long as it runs
+  //!
+  bool heartbeatABB (void *param, double &feedbackTime)
+  {
+    abbObserver *obs = (abbObserver*)param;
+    abbState state;
+    bool healthy;
+
+    if (obs->cache.read(state) > 0)
+    {
+      for (int group = 0; group < ABB_STATE_GROUPS; ++group)
+      {
+        if (state.time[group] > feedbackTime)
+        {
+          feedbackTime = state.time[group];
+        }
+      }
+    }
+
+    ulapi_mutex_take(obs->lock);
+    if (obs->polled > feedbackTime)
+    {
+      feedbackTime = obs->polled;
+    }
+    //! Connected to the state server if one is configured, otherwise answering polls
+    healthy = (obs->params.obs_tcp_ip_port > 0 ? obs->client >= 0 : feedbackTime > 0.0);
+    ulapi_mutex_give(obs->lock);
+    return healthy;
+  }
+
+
+  LIBRARY_API void abbPackFrame (char *frame, int id, const double *values, int count)
+  {
+    unsigned int raw;
+    float val;
+    int i, j;
+
+    frame[0] = (char)(ABB_FRAME_SIZE & 0xFF);
+    frame[1] = (char)((ABB_FRAME_SIZE >> 8) & 0xFF);
+    frame[2] = (char)(id & 0xFF);
+    frame[3] = (char)((id >> 8) & 0xFF);
+
+    for (i = 0; i < ABB_FRAME_VALUES; ++i)
+    {
+      val = ((values != NULL && i < count) ? (float)values[i] : 0.0f);
+      memcpy(&raw, &val, sizeof(raw));
+      for (j = 0; j < 4; ++j)
+      {
+        frame[4 + (i * 4) + j] = (char)((raw >> (8 * j)) & 0xFF);
+      }
+    }
+  }
+
+
+  LIBRARY_API bool abbUnpackFrame (const char *frame, double *values)
+  {
+    const unsigned char *b = (const unsigned char*)frame;
+    unsigned int raw;
+    float val;
+    int i, j;
+
+    if ((b[0] | (b[1] << 8)) != ABB_FRAME_SIZE)
+    {
+      return false;
+    }
+
+    values[0] = (double)(b[2] | (b[3] << 8));
+    for (i = 0; i < ABB_FRAME_VALUES; ++i)
+    {
+      raw = 0;
+      for (j = 3; j >= 0; --j)
+      {
+        raw = (raw << 8) | b[4 + (i * 4) + j];
+      }
+      memcpy(&val, &raw, sizeof(val));
+      values[i + 1] = (double)val;
+    }
+    return true;
+  }
+
+
+  //! @brief Parse one state server message ("[id,v1,...,v7]") into 8 values
+  //!
+  //! @param mssg   The NUL-terminated message
+  //! @param values Array of 8 values populated by this function
+  //!
+  //! @return True if all 8 values were read, false otherwise
+  //!
+  bool parseStateMessage (const char *mssg, double *values)
   {
-    keepalive *ka = (keepalive*)param;
-    robotPose pose;
-    crpi_timer timer;
+    char *end;
+    int i;
 
-    while (ka->runThread)
+    while (*mssg == ' ' || *mssg == '[')
     {
-      ((CrpiAbb*)ka->rob)->GetRobotPose (&pose);
+      ++mssg;
+    }
+
+    for (i = 0; i < 8; ++i)
+    {
+      values[i] = strtod(mssg, &end);
+      if (end == mssg)
+      {
+        return false;
+      }
+      mssg = end;
+      while (*mssg == ' ' || *mssg == ',')
+      {
+        ++mssg;
+      }
+    }
+    return true;
+  }
+
+
+  //! @brief Consume the CRPI_StateServer push stream and publish it to the observer cache
+  //!
+  //! @note The state server sends pose, joints, torques, and digital inputs as four NUL-terminated
+  //!       messages per cycle.  Each message is published as soon as it is complete.
+  //!
+  void abbObserverThread (void *param)
+  {
+    abbObserver *obs = (abbObserver*)param;
+    ulapi_integer id;
+    char *buffer;
+    double values[8];
+    abbState state;
+    int backoff = ABB_BACKOFF_MIN;
+    int have = 0;
+    int start, get, i, group;
+
+    memset(&state, 0, sizeof(abbState));
+    buffer = new char[ABB_STREAM_BUFFER];
+
+    while (obs->runThread)
+    {
+      if (obs->client < 0)
+      {
+        if (obs->params.obs_tcp_ip_client)
+        {
+          //! CRPI_StateServer listens; connect to it
+          id = ulapi_socket_get_client_id(obs->params.obs_tcp_ip_port, obs->params.obs_tcp_ip_addr);
+        }
+        else
+        {
+          //! Wait for the state server to connect to us
+          if (obs->server < 0)
+          {
+            id = ulapi_socket_get_server_id(obs->params.obs_tcp_ip_port);
+            ulapi_mutex_take(obs->lock);
+            obs->server = id;
+            ulapi_mutex_give(obs->lock);
+          }
+          id = (obs->server < 0 || !obs->runThread ? -1 : ulapi_socket_get_connection_id(obs->server));
+        }
+
+        if (id < 0)
+        {
+          Sleep(backoff);
+          backoff = ((backoff * 2) > ABB_BACKOFF_MAX ? ABB_BACKOFF_MAX : (backoff * 2));
+          continue;
+        }
+        ulapi_socket_set_blocking(id);
+        ulapi_mutex_take(obs->lock);
+        obs->client = id;
+        ulapi_mutex_give(obs->lock);
+        backoff = ABB_BACKOFF_MIN;
+        have = 0;
+      }
+
+      get = (obs->runThread ? ulapi_socket_read(obs->client, buffer + have, ABB_STREAM_BUFFER - have) : 0);
+      if (get <= 0)
+      {
+        //! Connection closed or broken (or released to stop the thread)
+        ulapi_mutex_take(obs->lock);
+        ulapi_socket_close(obs->client);
+        obs->client = -1;
+        ulapi_mutex_give(obs->lock);
+        continue;
+      }
+      have += get;
+
+      //! Publish every complete message in the buffer
+      start = 0;
+      for (i = 0; i < have; ++i)
+      {
+        if (buffer[i] != '\0')
+        {
+          continue;
+        }
+
+        if (parseStateMessage(buffer + start, values))
+        {
+          group = (int)values[0] - 1;
+          if (group >= 0 && group < ABB_STATE_GROUPS)
+          {
+            memcpy(state.values[group], values, sizeof(values));
+            state.time[group] = ulapi_time();
+            obs->cache.write(state);
+          }
+        }
+        start = i + 1;
+      }
 
-      //! Don't slam your processor!  You don't need to poll at full speed.
-      timer.waitUntil(5000);
+      if (start == 0 && have == ABB_STREAM_BUFFER)
+      {
+        //! No terminator in a full buffer:  not a state server stream, drop it
+        have = 0;
+      }
+      else if (start > 0)
+      {
+        have -= start;
+        memmove(buffer, buffer + start, have);
+      }
+    }
+
+    ulapi_mutex_take(obs->lock);
+    if (obs->client >= 0)
+    {
+      ulapi_socket_close(obs->client);
+      obs->client = -1;
     }
-    return;
+    if (obs->server >= 0)
+    {
+      ulapi_socket_close(obs->server);
+      obs->server = -1;
+    }
+    obs->running = false;
+    ulapi_mutex_give(obs->lock);
+    delete [] buffer;
   }
 
 
@@ -46,27 +273,70 @@ namespace crpi_robot
     params_ = params;
     ka_.handle = ulapi_mutex_new(99);
 
-    //! Connect to ABB IRB 14000 server
-    server_ = ulapi_socket_get_client_id (params_.tcp_ip_port, params_.tcp_ip_addr);
-    ulapi_socket_set_blocking(server_);
-
-    task = ulapi_task_new();
-    ka_.rob = this;
-    ka_.runThread = true;
-
-    ulapi_task_start((ulapi_task_struct*)task, livemanABB, &ka_, ulapi_prio_lowest(), 0);
-
+    //! Set up before the keepalive thread starts polling
     feedback_ = new double[10];
     tempData_ = new vector<string>(10, " ");
 
     angleUnits_ = DEGREE;
     lengthUnits_ = MM;
     curTool_ = 1; //! Set default to parallel gripper
+    binary_ = params_.use_binary;
+
+    //! Connect to ABB IRB 14000 server
+    server_ = ulapi_socket_get_client_id (params_.tcp_ip_port, params_.tcp_ip_addr);
+    ulapi_socket_set_blocking(server_);
+
+    //! Feedback comes from the CRPI_StateServer push stream when an observer is configured
+    obsTask_ = NULL;
+    observer_.params = params_;
+    observer_.runThread = true;
+    observer_.running = false;
+    observer_.server = observer_.client = -1;
+    observer_.lock = ulapi_mutex_new(62);
+    observer_.polled = 0.0;
+    if (params_.obs_tcp_ip_port > 0)
+    {
+      observer_.running = true;
+      obsTask_ = ulapi_task_new();
+      ulapi_task_start((ulapi_task_struct*)obsTask_, abbObserverThread, &observer_, ulapi_prio_lowest(), 0);
+    }
+
+    watchId_ = CrpiWatchdog::instance().add("ABB", WATCHDOG_PERIOD, heartbeatABB, &observer_, 2.0 * WATCHDOG_PERIOD);
   }
 
 
   LIBRARY_API CrpiAbb::~CrpiAbb ()
   {
+    CrpiWatchdog::instance().remove(watchId_);
+    observer_.runThread = false;
+    if (obsTask_ != NULL)
+    {
+      //! Release the observer from a blocking accept or read until it notices that it is to stop
+      //! (it may be between opening a socket and blocking on it), then wait for it to exit
+      while (true)
+      {
+        ulapi_mutex_take(observer_.lock);
+        if (!observer_.running)
+        {
+          ulapi_mutex_give(observer_.lock);
+          break;
+        }
+        if (observer_.client >= 0)
+        {
+          SocketRelease(observer_.client);
+        }
+        if (observer_.server >= 0)
+        {
+          SocketRelease(observer_.server);
+        }
+        ulapi_mutex_give(observer_.lock);
+        Sleep(1);
+      }
+      ulapi_task_join((ulapi_task_struct*)obsTask_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)obsTask_);
+      obsTask_ = NULL;
+    }
+    ulapi_mutex_delete(observer_.lock);
     delete [] mssgBuffer_;
     delete [] feedback_;
     ulapi_socket_close(server_);
@@ -210,7 +480,7 @@ namespace crpi_robot
       }
       ulapi_mutex_give(ka_.handle);
 //      printf("%s\n", mssgBuffer_);
-      if (mssgBuffer_[1] == '1')
+      if (acknowledged ())
       {
         return CANON_SUCCESS;
       }
@@ -304,7 +574,7 @@ namespace crpi_robot
         return CANON_FAILURE;
       }
       ulapi_mutex_give(ka_.handle);
-      if (mssgBuffer_[1] == '1')
+      if (acknowledged ())
       {
         //printf("got message\n");
         return CANON_SUCCESS;
@@ -327,51 +597,23 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiAbb::GetRobotAxes (robotAxes *axes)
   {
-    //! Construct request for axis information
+    double values[8];
 
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback ('A'))
+    if (!fetch ('A', values))
     {
-      if (!send ())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      
-      //! Parse data
-      if (!parseFeedback (8))
-      {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
+      return CANON_FAILURE;
+    }
 
-      ulapi_mutex_give(ka_.handle);
-      try
-      {
-        for (int i = 0; i < 7; ++i)
-        {
-          axes->axis.at(i) = feedback_[i+1];
-        }
-      }
-      catch (...)
+    try
+    {
+      for (int i = 0; i < 7; ++i)
       {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
+        axes->axis.at(i) = values[i+1];
       }
-    } // if generateFeedback ('A')
-    else
+    }
+    catch (...)
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
+      //! probably an axis violation due to vector missmatch
       return CANON_FAILURE;
     }
     return CANON_SUCCESS;
@@ -387,55 +629,25 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiAbb::GetRobotIO (robotIO *io)
   {
-    //! Construct request for axis information
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback('S'))
+    double values[8];
+
+    if (!fetch ('S', values))
     {
-      if (!send())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get())
-      {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Parse data
-      if (!parseFeedback(8))
-      {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
+      return CANON_FAILURE;
+    }
 
-      try
-      {
-        io->dio[0] = (feedback_[1] > 0.5f);
-        io->dio[1] = (feedback_[2] > 0.5f);
-        io->dio[2] = (feedback_[3] > 0.5f);
-        io->dio[3] = (feedback_[4] > 0.5f);
-        io->dio[4] = (feedback_[5] > 0.5f);
-        io->dio[5] = (feedback_[6] > 0.5f);
-        io->dio[6] = (feedback_[7] > 0.5f);
-      }
-      catch (...)
+    try
+    {
+      for (int i = 0; i < 7; ++i)
       {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
+        io->dio[i] = (values[i+1] > 0.5f);
       }
     }
-    else
+    catch (...)
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
+      //! probably an axis violation due to vector missmatch
       return CANON_FAILURE;
     }
-
     return CANON_SUCCESS;
   }
 
@@ -443,89 +655,63 @@ namespace crpi_robot
   LIBRARY_API CanonReturn CrpiAbb::GetRobotPose (robotPose *pose)
   {
     double qx, qy, qz, qw;
-    //! Construct request for axis information
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback ('C'))
+    double values[8];
+
+    if (!fetch ('C', values))
     {
-      if (!send ())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
+      return CANON_FAILURE;
+    }
+
+    try
+    {
+      pose->x = values[1];
+      pose->y = values[2];
+      pose->z = values[3];
+      qw = values[4]; //qx
+      qx = values[5]; //qy
+      qy = values[6]; //qz
+      qz = values[7]; //qw
+
+      Math::matrix m1(3,3);
+      vector<double> q, e;
+      q.push_back(qw);
+      q.push_back(qx);
+      q.push_back(qy);
+      q.push_back(qz);
+
+      m1.rotQuaternionMatrixConvert(q);
+      m1.rotMatrixEulerConvert(e);
+
+      pose->xrot = e.at(0);
+      pose->yrot = e.at(1);
+      pose->zrot = e.at(2);
+
+      pose->status = 0;
+      pose->turns = 0;
+
+      if (lengthUnits_ == METER)
       {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
+        pose->x /= 1000.0f;
+        pose->y /= 1000.0f;
+        pose->z /= 1000.0f;
       }
-      //! Parse data
-      if (!parseFeedback (8))
+      else if (lengthUnits_ == INCH)
       {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
+        pose->x /= 25.4f;
+        pose->y /= 25.4f;
+        pose->z /= 25.4f;
       }
-      ulapi_mutex_give(ka_.handle);
-
-      try
-      {
-        pose->x = feedback_[1];
-        pose->y = feedback_[2];
-        pose->z = feedback_[3];
-        qw = feedback_[4]; //qx
-        qx = feedback_[5]; //qy
-        qy = feedback_[6]; //qz
-        qz = feedback_[7]; //qw
-
-        Math::matrix m1(3,3);
-        vector<double> q, e;
-        q.push_back(qw);
-        q.push_back(qx);
-        q.push_back(qy);
-        q.push_back(qz);
-
-        m1.rotQuaternionMatrixConvert(q);
-        m1.rotMatrixEulerConvert(e);
-
-        pose->xrot = e.at(0);
-        pose->yrot = e.at(1);
-        pose->zrot = e.at(2);
-
-        pose->status = 0;
-        pose->turns = 0;
-
-        if (lengthUnits_ == METER)
-        {
-          pose->x /= 1000.0f;
-          pose->y /= 1000.0f;
-          pose->z /= 1000.0f;
-        }
-        else if (lengthUnits_ == INCH)
-        {
-          pose->x /= 25.4f;
-          pose->y /= 25.4f;
-          pose->z /= 25.4f;
-        }
 
-        if (angleUnits_ == DEGREE)
-        {
-          pose->zrot *= (180.0f / 3.141592654f);
-          pose->yrot *= (180.0f / 3.141592654f);
-          pose->xrot *= (180.0f / 3.141592654f);
-        }
-      }
-      catch (...)
+      if (angleUnits_ == DEGREE)
       {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
+        pose->zrot *= (180.0f / 3.141592654f);
+        pose->yrot *= (180.0f / 3.141592654f);
+        pose->xrot *= (180.0f / 3.141592654f);
       }
     }
-    else
+    catch (...)
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
+      //! probably an axis violation due to vector missmatch
       return CANON_FAILURE;
     }
 
@@ -549,55 +735,27 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiAbb::GetRobotTorques (robotAxes *torques)
   {
-    //! Construct request for axis torque information
+    double values[8];
 
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback('T'))
+    if (!fetch ('T', values))
     {
-      if (!send())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get())
-      {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-
-      //! Parse data
-      if (!parseFeedback(8))
-      {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
+      return CANON_FAILURE;
+    }
 
-      ulapi_mutex_give(ka_.handle);
-      try
+    try
+    {
+      for (int i = 0; i < 7; ++i)
       {
-        for (int i = 0; i < 7; ++i)
+        torques->axis.at(i) = values[i + 1];
+        if (angleUnits_ == RADIAN)
         {
-          torques->axis.at(i) = feedback_[i + 1];
-          if (angleUnits_ == RADIAN)
-          {
-            torques->axis.at(i) *= (3.141592654f / 180.0f);
-          }
+          torques->axis.at(i) *= (3.141592654f / 180.0f);
         }
       }
-      catch (...)
-      {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
-      }
-    } // if generateFeedback ('A')
-    else
+    }
+    catch (...)
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
+      //! probably an axis violation due to vector missmatch
       return CANON_FAILURE;
     }
     return CANON_SUCCESS;
@@ -870,6 +1028,12 @@ namespace crpi_robot
     }
 
     cmdNum = ((moveType == 'P') ? 200 : 300) + ((posType == 'C') ? 0 : 10) + ((deltaType == 'A') ? 0 : 1);
+    if (binary_)
+    {
+      abbPackFrame(frame_, cmdNum, &input[0], (int)input.size());
+      return true;
+    }
+
     moveMe_ << "[" << cmdNum << ",";
 
     //! Loop through paramaters, completes 10 char string, and adds to command string
@@ -918,6 +1082,13 @@ namespace crpi_robot
 
     cmd = ((mode == 'B') ? 0 : ((mode == 'A') ? 10 : 20));
     //printf ("Tool: %d\n", cmd);
+    if (binary_)
+    {
+      double param = 1.0 - value;
+      abbPackFrame(frame_, cmd, &param, 1);
+      return true;
+    }
+
     moveMe_.str(string());
 
     moveMe_ << "[" << cmd << ",";
@@ -982,6 +1153,12 @@ namespace crpi_robot
       break;
     }
 
+    if (binary_)
+    {
+      abbPackFrame(frame_, cmd, NULL, 0);
+      return true;
+    }
+
     moveMe_.str(string());
     moveMe_ << "[" << cmd << ",0.0000000,0.0000000,0.0000000,0.0000000,0.0000000,0.0000000,0.0000000]\0";
     
@@ -1010,6 +1187,15 @@ namespace crpi_robot
       break;
     }
 
+    if (binary_)
+    {
+      double params[2];
+      params[0] = signum;
+      params[1] = val;
+      abbPackFrame(frame_, cmd, params, 2);
+      return true;
+    }
+
     moveMe_.str(string());
     moveMe_ << "[" << cmd << "," << signum << "," << val << ",0.0000000,0.0000000,0.0000000,0.0000000,0.0000000]\0";
 
@@ -1057,6 +1243,11 @@ namespace crpi_robot
       }
 
       cmd = 100 + ((paramType == 'S') ? 0 : 10);
+      if (binary_)
+      {
+        abbPackFrame(frame_, cmd, &input[0], 1);
+        break;
+      }
 
       moveMe_.str (string());
       moveMe_ << "[" << cmd << ",";
@@ -1094,13 +1285,22 @@ namespace crpi_robot
   LIBRARY_API bool CrpiAbb::send ()
   {
     int x;
-    
+
+    if (binary_)
+    {
+      //! Fixed-size frame built by the generate* methods
+      x = ulapi_socket_write(server_, frame_, ABB_FRAME_SIZE);
+      return (x == ABB_FRAME_SIZE);
+    }
+
+    //! Copy the formatted command once; str() returns a new string on every call
+    string mssg = moveMe_.str();
 #ifdef ABB_NOISY
     printf ("server_ = %d\n", server_);
-    printf ("Sending message %s\n", moveMe_.str().c_str());
+    printf ("Sending message %s\n", mssg.c_str());
 #endif
       //! Use TCP/IP
-      x = ulapi_socket_write(server_, moveMe_.str().c_str(), strlen(moveMe_.str().c_str())+1);
+      x = ulapi_socket_write(server_, mssg.c_str(), (int)mssg.length() + 1);
 #ifdef ABB_NOISY
       printf ("%i\n", x);
 #endif
@@ -1116,6 +1316,22 @@ namespace crpi_robot
       printf ("getting feedback...\n");
 #endif
 
+      if (binary_)
+      {
+        //! Replies are fixed-size frames; TCP may deliver one in pieces
+        int have = 0;
+        while (have < ABB_FRAME_SIZE)
+        {
+          x = ulapi_socket_read(server_, mssgBuffer_ + have, ABB_FRAME_SIZE - have);
+          if (x <= 0)
+          {
+            return false;
+          }
+          have += x;
+        }
+        return abbUnpackFrame(mssgBuffer_, feedback_);
+      }
+
       //! Use TCP/IP
       x = ulapi_socket_read(server_, mssgBuffer_, 8192);
 #ifdef ABB_NOISY
@@ -1127,42 +1343,99 @@ namespace crpi_robot
 
   LIBRARY_API bool CrpiAbb::parseFeedback (int num)
   {
-    bool newItem = false;
-    int index = -1, i;
+    const char *pos;
+    char *end;
+    int i;
 
-    for (i = 0; i < num; ++i)
+    if (binary_)
     {
-      tempData_->at(i) = "";
+      //! get() already decoded the frame into feedback_
+      return true;
     }
 
-    //! REQUEST_MSG_SIZE is very large, feedback from robot is limited to 80 characters
-    for (i = 1; i < 80; ++i)
+    //! Convert the "[v0,v1,...]" fields in place without intermediate strings
+    pos = mssgBuffer_ + 1;
+    for (i = 0; i < num; ++i)
     {
-      if (mssgBuffer_[i] == ',' || mssgBuffer_[i] == ']')
+      feedback_[i] = strtod(pos, &end);
+      if (end == pos)
       {
-        newItem = false;
+        return false;
+      }
+      pos = end;
+      if (*pos == ',')
+      {
+        ++pos;
       }
       else
       {
-        if (!newItem)
+        //! End of the message:  remaining fields are not present
+        for (++i; i < num; ++i)
         {
-          newItem = true;
-          index++;
-          if( index >= num )
-          {
-            break;
-//            return false;
-          }
+          feedback_[i] = 0.0f;
         }
-        tempData_->at(index).push_back (mssgBuffer_[i]);
-      } // if (mssgBuffer_[i] == ' ') ... else
-    } //for (int i = 0; i < 65; ++i)
-  
-    //! Convert strings to floats
-    for (i = 0; i < num; ++i)
+        break;
+      }
+    }
+    return true;
+  }
+
+
+  LIBRARY_API bool CrpiAbb::acknowledged ()
+  {
+    if (binary_)
+    {
+      return (feedback_[0] == 1.0f);
+    }
+    return (mssgBuffer_[1] == '1');
+  }
+
+
+  LIBRARY_API bool CrpiAbb::fetch (char retType, double *values)
+  {
+    abbState state;
+    int group;
+
+    switch (retType)
+    {
+    case 'C':
+      group = ABB_STATE_POSE;
+      break;
+    case 'A':
+      group = ABB_STATE_AXES;
+      break;
+    case 'T':
+      group = ABB_STATE_TORQUES;
+      break;
+    case 'S':
+      group = ABB_STATE_IO;
+      break;
+    default:
+      group = -1;
+      break;
+    }
+
+    //! Answer from the state server cache without touching the command socket
+    if (group >= 0 && obsTask_ != NULL && observer_.cache.read(state) > 0 &&
+        state.time[group] > 0.0 && (ulapi_time() - state.time[group]) < ABB_STATE_STALE)
     {
-      feedback_[i] = stod (tempData_->at(i));
+      memcpy(values, state.values[group], 8 * sizeof(double));
+      return true;
     }
+
+    //! No (recent) streamed feedback:  poll on the command socket
+    ulapi_mutex_take(ka_.handle);
+    if (!generateFeedback (retType) || !send () || !get () || !parseFeedback (8))
+    {
+      ulapi_mutex_give(ka_.handle);
+      return false;
+    }
+    memcpy(values, feedback_, 8 * sizeof(double));
+    ulapi_mutex_give(ka_.handle);
+
+    ulapi_mutex_take(observer_.lock);
+    observer_.polled = ulapi_time();
+    ulapi_mutex_give(observer_.lock);
     return true;
   }
 
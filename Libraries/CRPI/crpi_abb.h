@@ -24,8 +24,93 @@
 
 using namespace std;
 
+//! Feedback groups pushed by CRPI_StateServer, by message ID - 1
+#define ABB_STATE_POSE 0
+#define ABB_STATE_AXES 1
+#define ABB_STATE_TORQUES 2
+#define ABB_STATE_IO 3
+#define ABB_STATE_GROUPS 4
+
+//! Binary command framing (<Protocol Val="Binary"/>).  Every request and reply is one fixed
+//! 32-byte little-endian frame:
+//!   bytes 0-1:   uint16 frame length (32)
+//!   bytes 2-3:   uint16 command ID (requests) or status/message ID (replies)
+//!   bytes 4-31:  7 float32 values (RAPID num precision)
+#define ABB_FRAME_SIZE 32
+#define ABB_FRAME_VALUES 7
+
 namespace crpi_robot
 {
+  //! @brief Latest feedback received from CRPI_StateServer
+  //!
+  //! @note Plain data only so that it can be published through CrpiStateCache
+  //!
+  struct LIBRARY_API abbState
+  {
+    //! @brief Message values per feedback group, laid out as returned by the command socket
+    //!        ([0] is the message ID, [1..7] the values)
+    //!
+    double values[ABB_STATE_GROUPS][8];
+
+    //! @brief Time (in seconds, from ulapi_time) at which each group was last received (0 if never)
+    //!
+    double time[ABB_STATE_GROUPS];
+  };
+
+
+  //! @brief Encode one binary command frame
+  //!
+  //! @param frame  The ABB_FRAME_SIZE-byte frame populated by this function
+  //! @param id     The command ID (or reply status)
+  //! @param values The values to encode (up to ABB_FRAME_VALUES; the rest are zero)
+  //! @param count  The number of values
+  //!
+  LIBRARY_API void abbPackFrame (char *frame, int id, const double *values, int count);
+
+  //! @brief Decode one binary command frame
+  //!
+  //! @param frame  The ABB_FRAME_SIZE-byte frame
+  //! @param values Array of ABB_FRAME_VALUES + 1 values populated by this function ([0] is the ID)
+  //!
+  //! @return True if the frame length field is valid, false otherwise
+  //!
+  LIBRARY_API bool abbUnpackFrame (const char *frame, double *values);
+
+
+  //! @brief Shared data between CrpiAbb and its state server observer thread
+  //!
+  struct LIBRARY_API abbObserver
+  {
+    //! @brief Robot configuration parameters (observer address and port)
+    //!
+    CrpiRobotParams params;
+
+    //! @brief Terminator signal for the observer thread
+    //!
+    bool runThread;
+
+    //! @brief Whether the observer thread has yet to exit
+    //!
+    bool running;
+
+    //! @brief Sockets held by the observer thread (-1 if none), released to stop it while it
+    //!        is blocked on them, and the lock under which they are opened, closed, and released
+    //!
+    ulapi_integer server;
+    ulapi_integer client;
+    ulapi_mutex_struct *lock;
+
+    //! @brief Feedback published by the observer thread
+    //!
+    CrpiStateCache<abbState> cache;
+
+    //! @brief Time (from ulapi_time) of the last feedback polled on the command socket (0 if
+    //!        never), guarded by lock
+    //!
+    double polled;
+  };
+
+
   //! @ingroup Robot
   //!
   //! @brief CRPI interface for the ABB IRB 14000 robot
@@ -350,8 +435,16 @@ namespace crpi_robot
     CanonReturn StopMotion (int condition = 2);
 
   private:
-    void *task;
     keepalive ka_;
+
+    //! @brief Registration with the shared keepalive service
+    //!
+    int watchId_;
+
+    //! @brief State server observer thread and its feedback cache
+    //!
+    void *obsTask_;
+    abbObserver observer_;
     char IPAddr_[16];
     ulapi_integer server_;
     ulapi_integer client_;
@@ -373,6 +466,14 @@ namespace crpi_robot
     //!
     char *mssgBuffer_;
 
+    //! @brief Whether or not commands are sent as binary frames instead of text
+    //!
+    bool binary_;
+
+    //! @brief Outgoing binary frame (when binary_ is set)
+    //!
+    char frame_[ABB_FRAME_SIZE];
+
     //! @brief Returned data from the robot
     //!
     double *feedback_;
@@ -425,6 +526,20 @@ namespace crpi_robot
     //!
     bool parseFeedback (int num);
 
+    //! @brief Whether the robot acknowledged the last command as successful
+    //!
+    bool acknowledged ();
+
+    //! @brief Retrieve one feedback group, from the state server cache when it is fresh and by
+    //!        polling the command socket otherwise
+    //!
+    //! @param retType Specify the return value (see generateFeedback)
+    //! @param values  Array of 8 values populated by this method ([0] is the message ID)
+    //!
+    //! @return True if feedback was retrieved, false otherwise
+    //!
+    bool fetch (char retType, double *values);
+
     //! @brief Generate a parameter set request for the ABB
     //!
     //! @param paramType Specify the parameter to set, see notes for valid parameters
@@ -0,0 +1,379 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_abb_standin.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Loopback stand-in for the ABB IRB 14000 CRPI_Handler and CRPI_StateServer
+//  RAPID modules.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_abb_standin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//#define ABB_STANDIN_NOISY
+
+#define ABB_STANDIN_BUFFER 1024
+
+using namespace std;
+
+namespace crpi_robot
+{
+  void abbStandInThread (void *param)
+  {
+    ((AbbStandIn*)param)->serve();
+  }
+
+
+  void abbStandInStateThread (void *param)
+  {
+    ((AbbStandIn*)param)->stream();
+  }
+
+
+  LIBRARY_API AbbStandIn::AbbStandIn (int port, int statePort, double frequency) :
+    port_(port),
+    statePort_(statePort),
+    frequency_(frequency),
+    runThread_(true),
+    server_(-1),
+    client_(-1),
+    stateServer_(-1),
+    stateClient_(-1),
+    done_(0),
+    binary_(0)
+  {
+    int i;
+
+    memset(&state_, 0, sizeof(abbState));
+    for (i = 0; i < ABB_STATE_GROUPS; ++i)
+    {
+      state_.values[i][0] = i + 1;
+    }
+    //! Unit quaternion
+    state_.values[ABB_STATE_POSE][4] = 1.0f;
+
+    lock_ = ulapi_mutex_new(35);
+    server_ = ulapi_socket_get_server_id(port_);
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, abbStandInThread, this, ulapi_prio_lowest(), 0);
+
+    stateTask_ = NULL;
+    if (statePort_ > 0)
+    {
+      stateServer_ = ulapi_socket_get_server_id(statePort_);
+      stateTask_ = ulapi_task_new();
+      ulapi_task_start((ulapi_task_struct*)stateTask_, abbStandInStateThread, this, ulapi_prio_lowest(), 0);
+    }
+  }
+
+
+  LIBRARY_API AbbStandIn::~AbbStandIn ()
+  {
+    runThread_ = false;
+
+    //! Release the threads from their accepts and clients
+    if (server_ >= 0)
+    {
+      SocketRelease(server_);
+    }
+    if (stateServer_ >= 0)
+    {
+      SocketRelease(stateServer_);
+    }
+    ulapi_mutex_take(lock_);
+    if (client_ >= 0)
+    {
+      SocketRelease(client_);
+    }
+    if (stateClient_ >= 0)
+    {
+      SocketRelease(stateClient_);
+    }
+    ulapi_mutex_give(lock_);
+
+    ulapi_task_join((ulapi_task_struct*)task_, NULL);
+    ulapi_task_delete((ulapi_task_struct*)task_);
+    if (stateTask_ != NULL)
+    {
+      ulapi_task_join((ulapi_task_struct*)stateTask_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)stateTask_);
+    }
+
+    if (server_ >= 0)
+    {
+      ulapi_socket_close(server_);
+    }
+    if (stateServer_ >= 0)
+    {
+      ulapi_socket_close(stateServer_);
+    }
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API void AbbStandIn::setState (abbState &state)
+  {
+    ulapi_mutex_take(lock_);
+    state_ = state;
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API void AbbStandIn::getState (abbState &state)
+  {
+    ulapi_mutex_take(lock_);
+    state = state_;
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API unsigned long AbbStandIn::commandsDone ()
+  {
+    return done_;
+  }
+
+
+  LIBRARY_API unsigned long AbbStandIn::binaryFrames ()
+  {
+    return binary_;
+  }
+
+
+  LIBRARY_API void AbbStandIn::serve ()
+  {
+    ulapi_integer client;
+    char *buffer = new char[ABB_STANDIN_BUFFER];
+    char text[256];
+    double request[ABB_FRAME_VALUES + 1];
+    double reply[ABB_FRAME_VALUES + 1];
+    int have, get, used, i, len;
+    char *end;
+    const char *pos;
+
+    while (runThread_ && server_ >= 0)
+    {
+      client = ulapi_socket_get_connection_id(server_);
+      if (client < 0)
+      {
+        Sleep(100);
+        continue;
+      }
+      ulapi_socket_set_blocking(client);
+      ulapi_mutex_take(lock_);
+      client_ = client;
+      ulapi_mutex_give(lock_);
+      have = 0;
+
+      while (runThread_)
+      {
+        get = ulapi_socket_read(client, buffer + have, ABB_STANDIN_BUFFER - have);
+        if (get <= 0)
+        {
+          //! Client hung up
+          break;
+        }
+        have += get;
+
+        //! Answer every complete request in the framing it arrived in
+        while (have > 0)
+        {
+          used = 0;
+          if (buffer[0] == '[')
+          {
+            end = (char*)memchr(buffer, '\0', have);
+            if (end == NULL)
+            {
+              if (have == ABB_STANDIN_BUFFER)
+              {
+                //! Unterminated text:  drop it
+                have = 0;
+              }
+              break;
+            }
+            used = (int)(end - buffer) + 1;
+
+            pos = buffer + 1;
+            for (i = 0; i <= ABB_FRAME_VALUES; ++i)
+            {
+              request[i] = strtod(pos, &end);
+              pos = (*end == ',' ? end + 1 : end);
+            }
+            handle(request, reply);
+
+            len = sprintf(text, "[%g", reply[0]);
+            for (i = 1; i <= ABB_FRAME_VALUES; ++i)
+            {
+              len += sprintf(text + len, ",%g", reply[i]);
+            }
+            text[len++] = ']';
+            text[len++] = '\0';
+            if (ulapi_socket_write(client, text, len) != len)
+            {
+              have = -1;
+              break;
+            }
+          }
+          else
+          {
+            if (have < ABB_FRAME_SIZE)
+            {
+              break;
+            }
+            used = ABB_FRAME_SIZE;
+            if (!abbUnpackFrame(buffer, request))
+            {
+              //! Lost framing
+              have = -1;
+              break;
+            }
+            ++binary_;
+            handle(request, reply);
+
+            abbPackFrame(text, (int)reply[0], reply + 1, ABB_FRAME_VALUES);
+            if (ulapi_socket_write(client, text, ABB_FRAME_SIZE) != ABB_FRAME_SIZE)
+            {
+              have = -1;
+              break;
+            }
+          }
+
+          ++done_;
+          have -= used;
+          memmove(buffer, buffer + used, have);
+        }
+        if (have < 0)
+        {
+          break;
+        }
+      }
+
+      ulapi_mutex_take(lock_);
+      client_ = -1;
+      ulapi_mutex_give(lock_);
+      ulapi_socket_close(client);
+    }
+
+    delete [] buffer;
+  }
+
+
+  LIBRARY_API void AbbStandIn::stream ()
+  {
+    ulapi_integer client;
+    abbState state;
+    char text[ABB_STANDIN_BUFFER];
+    int group, i, len;
+    bool ok;
+
+    while (runThread_ && stateServer_ >= 0)
+    {
+      client = ulapi_socket_get_connection_id(stateServer_);
+      if (client < 0)
+      {
+        Sleep(100);
+        continue;
+      }
+
+      ulapi_mutex_take(lock_);
+      stateClient_ = client;
+      ulapi_mutex_give(lock_);
+
+      ok = true;
+      while (runThread_ && ok)
+      {
+        getState(state);
+
+        //! One NUL-terminated message per group and cycle, as CRPI_StateServer sends them
+        len = 0;
+        for (group = 0; group < ABB_STATE_GROUPS; ++group)
+        {
+          len += sprintf(text + len, "[%d", group + 1);
+          for (i = 1; i <= ABB_FRAME_VALUES; ++i)
+          {
+            len += sprintf(text + len, ",%g", state.values[group][i]);
+          }
+          text[len++] = ']';
+          text[len++] = '\0';
+        }
+        ok = (ulapi_socket_write(client, text, len) == len);
+        Sleep((int)(1000.0 / frequency_));
+      }
+
+      ulapi_mutex_take(lock_);
+      stateClient_ = -1;
+      ulapi_mutex_give(lock_);
+      ulapi_socket_close(client);
+    }
+  }
+
+
+  LIBRARY_API void AbbStandIn::handle (const double *request, double *reply)
+  {
+    int cmd = (int)request[0];
+    int group = -1;
+    int i;
+
+#ifdef ABB_STANDIN_NOISY
+    printf("AbbStandIn: command %d\n", cmd);
+#endif
+
+    ulapi_mutex_take(lock_);
+    if (cmd < 200)
+    {
+      //! Tool and parameter commands have no effect on the emulated state
+    }
+    else if (cmd < 210 || (cmd >= 300 && cmd < 400))
+    {
+      //! PTP and LIN Cartesian motion.  Like CRPI_Handler, relative moves are treated as absolute.
+      memcpy(&state_.values[ABB_STATE_POSE][1], request + 1, ABB_FRAME_VALUES * sizeof(double));
+      group = ABB_STATE_POSE;
+    }
+    else if (cmd < 220)
+    {
+      //! PTP joint motion
+      memcpy(&state_.values[ABB_STATE_AXES][1], request + 1, ABB_FRAME_VALUES * sizeof(double));
+      group = ABB_STATE_AXES;
+    }
+    else if (cmd >= 400 && cmd < 410)
+    {
+      //! Digital outputs are looped back to the digital inputs
+      i = (int)request[1];
+      if (i >= 0 && i < ABB_FRAME_VALUES)
+      {
+        state_.values[ABB_STATE_IO][i + 1] = request[2];
+      }
+    }
+    else if (cmd >= 500 && cmd < 600)
+    {
+      group = ABB_STATE_POSE;
+    }
+    else if (cmd >= 600 && cmd < 700)
+    {
+      group = ABB_STATE_AXES;
+    }
+    else if (cmd >= 800 && cmd < 900)
+    {
+      group = ABB_STATE_TORQUES;
+    }
+    else if (cmd >= 900 && cmd < 1000)
+    {
+      group = ABB_STATE_IO;
+    }
+
+    reply[0] = 1;
+    for (i = 1; i <= ABB_FRAME_VALUES; ++i)
+    {
+      reply[i] = (group < 0 ? 0.0f : state_.values[group][i]);
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+} // crpi_robot
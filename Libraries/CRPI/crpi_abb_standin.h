@@ -0,0 +1,101 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_abb_standin.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Loopback stand-in for the ABB IRB 14000 CRPI_Handler and CRPI_StateServer
+//  RAPID modules.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef ABB_IRB14000_STANDIN
+#define ABB_IRB14000_STANDIN
+
+#include "ulapi.h"
+#include "crpi_abb.h"
+
+#pragma warning (disable: 4251)
+
+namespace crpi_robot
+{
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Loopback server standing in for one arm of an IRC5 controller
+  //!
+  //! @note Serves one CrpiAbb client at a time on the command port, answering text or binary
+  //!       frames in the framing of each request like CRPI_Handler_*.MOD does.  Motions jump
+  //!       straight to their targets.  If a state port is given, the state is also pushed in the
+  //!       CRPI_StateServer_*.mod format to one observer at a time.
+  //!
+  class LIBRARY_API AbbStandIn
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    //! @param port      The command port to listen on
+    //! @param statePort The state server port to listen on (0 for none)
+    //! @param frequency The state server update rate (Hz)
+    //!
+    AbbStandIn (int port, int statePort = 0, double frequency = 100.0);
+
+    //! @brief Default destructor
+    //!
+    ~AbbStandIn ();
+
+    //! @brief Replace the state reported to clients
+    //!
+    void setState (abbState &state);
+
+    //! @brief Copy the state currently reported to clients
+    //!
+    void getState (abbState &state);
+
+    //! @brief Number of commands answered since construction
+    //!
+    unsigned long commandsDone ();
+
+    //! @brief Number of binary frames received since construction
+    //!
+    unsigned long binaryFrames ();
+
+    //! @brief Serve command clients (thread body)
+    //!
+    void serve ();
+
+    //! @brief Push the state to observers (thread body)
+    //!
+    void stream ();
+
+    int port_;
+    int statePort_;
+    double frequency_;
+    bool runThread_;
+
+  private:
+    //! @brief Apply one command and fill in the reply
+    //!
+    //! @param request The command ID followed by seven parameters
+    //! @param reply   The status (1) followed by seven values
+    //!
+    void handle (const double *request, double *reply);
+
+    ulapi_mutex_struct *lock_;
+    void *task_;
+    void *stateTask_;
+    ulapi_integer server_;
+    ulapi_integer client_;
+    ulapi_integer stateServer_;
+    ulapi_integer stateClient_;
+    abbState state_;
+    unsigned long done_;
+    unsigned long binary_;
+  }; // AbbStandIn
+
+} // crpi_robot
+
+#endif
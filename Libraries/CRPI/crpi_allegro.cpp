@@ -24,8 +24,25 @@ using namespace std;
 namespace crpi_robot
 {
 
-  LIBRARY_API CrpiAllegro::CrpiAllegro (CrpiRobotParams &params)
+  LIBRARY_API CrpiAllegro::CrpiAllegro (CrpiRobotParams &params) :
+    link_(NULL),
+    server_config(-1),
+    server_params(-1),
+    server_feedback(-1)
   {
+    if (params.use_shm)
+    {
+      link_ = new HandShmLink();
+      if (link_->open((params.shm_key > 0) ? params.shm_key : HAND_SHM_KEY_ALLEGRO, false))
+      {
+        cout << "shared memory connection success" << endl;
+        return;
+      }
+      cout << "no shared memory connection, using TCP" << endl;
+      delete link_;
+      link_ = NULL;
+    }
+
     server_config = ulapi_socket_get_client_id (6008, "127.0.0.1");
 
     server_params = ulapi_socket_get_client_id (6009, "127.0.0.1");
@@ -62,6 +79,26 @@ namespace crpi_robot
 
   LIBRARY_API CrpiAllegro::~CrpiAllegro ()
   {
+    if (link_ != NULL)
+    {
+      delete link_;
+      link_ = NULL;
+    }
+  }
+
+
+  LIBRARY_API void CrpiAllegro::sendBuffer (int channel, int delay)
+  {
+    if (link_ != NULL)
+    {
+      //! The hand server is woken as soon as the message is queued, so no delay is needed
+      link_->send(channel, outbuffer);
+      return;
+    }
+
+    send = ulapi_socket_write((channel == HAND_CHANNEL_PARAMS) ? server_params : server_config,
+                              outbuffer, sizeof(outbuffer));
+    Sleep(delay);
   }
 
   LIBRARY_API CanonReturn CrpiAllegro::SetTool (double percent)
@@ -133,8 +170,7 @@ namespace crpi_robot
       sstream.str(std::string());
     }
 
-    send = ulapi_socket_write(server_config, outbuffer, sizeof(outbuffer));
-    Sleep(3);
+    sendBuffer(HAND_CHANNEL_CONFIG, 3);
 
     strcpy(outbuffer,"");
     
@@ -180,6 +216,22 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiAllegro::GetRobotAxes (robotAxes *axes)
   {
+    handFeedback fb;
+
+    if (link_ != NULL)
+    {
+      //! Read the most recent joint angles published by the hand server without a round trip
+      if (link_->feedback(fb) == 0)
+      {
+        return CANON_FAILURE;
+      }
+      for (int ii = 0; ii < HAND_SHM_JOINTS; ++ii)
+      {
+        axes->axis.at(ii) = fb.joints[ii];
+      }
+      return CANON_SUCCESS;
+    }
+
     strcpy(outbuffer,"");
     strcpy(outbuffer,"joint_angles");
 
@@ -219,6 +271,21 @@ namespace crpi_robot
  
   LIBRARY_API CanonReturn CrpiAllegro::GetRobotForces (robotPose *forces)
   {
+    handFeedback fb;
+
+    if (link_ != NULL)
+    {
+      if (link_->feedback(fb) == 0)
+      {
+        return CANON_FAILURE;
+      }
+      forces->x = fb.force[0];
+      forces->y = fb.force[1];
+      forces->z = fb.force[2];
+      //no torques yet
+      forces->xrot = forces->yrot = forces->zrot = 0;
+      return CANON_SUCCESS;
+    }
 
     strcpy(outbuffer,"");
     strcpy(outbuffer,"cart_force");
@@ -262,6 +329,22 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiAllegro::GetRobotPose (robotPose *pose)
   {
+    handFeedback fb;
+
+    if (link_ != NULL)
+    {
+      if (link_->feedback(fb) == 0)
+      {
+        return CANON_FAILURE;
+      }
+      pose->x = fb.pose[0];
+      pose->y = fb.pose[1];
+      pose->z = fb.pose[2];
+      pose->xrot = fb.pose[3];
+      pose->yrot = fb.pose[4];
+      pose->zrot = fb.pose[5];
+      return CANON_SUCCESS;
+    }
     strcpy(outbuffer,"");
     strcpy(outbuffer,"cart_pose");
 
@@ -362,8 +445,7 @@ namespace crpi_robot
     strcat(outbuffer, " ");
     sstream.str(std::string());
 
-    send = ulapi_socket_write(server_config, outbuffer, sizeof(outbuffer));
-    Sleep(10);
+    sendBuffer(HAND_CHANNEL_CONFIG, 10);
 
     strcpy(outbuffer,"");
     
@@ -391,8 +473,7 @@ namespace crpi_robot
       sstream.str(std::string());
     }
 
-    send = ulapi_socket_write(server_config, outbuffer, sizeof(outbuffer));
-    Sleep(10);
+    sendBuffer(HAND_CHANNEL_CONFIG, 10);
 
     strcpy(outbuffer,"");
     
@@ -413,15 +494,13 @@ namespace crpi_robot
 
     strcpy(outbuffer,"");
     strcat(outbuffer, "Speed");
-    send = ulapi_socket_write(server_params, outbuffer, sizeof(outbuffer));
-    Sleep(10);
+    sendBuffer(HAND_CHANNEL_PARAMS, 10);
     strcpy(outbuffer,"");
   
     sstream << speed;
     SpeedAsString = sstream.str();
     strcat(outbuffer, SpeedAsString.c_str());
-    send = ulapi_socket_write(server_params, outbuffer, sizeof(outbuffer));
-    Sleep(10);
+    sendBuffer(HAND_CHANNEL_PARAMS, 10);
     strcpy(outbuffer,"");
 
     return CANON_SUCCESS;
@@ -480,8 +559,7 @@ namespace crpi_robot
     if (strcmp(paramName,"Control")==0 || strcmp(paramName,"Plan")==0)
     {
       strcat(outbuffer, temp_char);
-      send = ulapi_socket_write(server_config, outbuffer, sizeof(outbuffer));
-      Sleep(10);
+      sendBuffer(HAND_CHANNEL_CONFIG, 10);
     }
 
     //parameters for various other behaviors:
@@ -490,33 +568,28 @@ namespace crpi_robot
     else if  (strcmp(paramName,"touch_stop")==0)
     {
       strcat(outbuffer, "touch_stop");
-      send = ulapi_socket_write(server_params, outbuffer, sizeof(outbuffer));
-      Sleep(10);
+      sendBuffer(HAND_CHANNEL_PARAMS, 10);
       strcpy(outbuffer,"");
 
       strcat(outbuffer, temp_char);
-      send = ulapi_socket_write(server_params, outbuffer, sizeof(outbuffer));
-      Sleep(10);
+      sendBuffer(HAND_CHANNEL_PARAMS, 10);
     }
 
     else if  (strcmp(paramName,"gravity_vector")==0)
     {
       strcat(outbuffer, "gravity_vector");
-      send = ulapi_socket_write(server_params, outbuffer, sizeof(outbuffer));
-      Sleep(10);
+      sendBuffer(HAND_CHANNEL_PARAMS, 10);
       strcpy(outbuffer,"");
 
       strcat(outbuffer, temp_char);
-      send = ulapi_socket_write(server_params, outbuffer, sizeof(outbuffer));
-      Sleep(10);
+      sendBuffer(HAND_CHANNEL_PARAMS, 10);
     }
 
     else if  (strcmp(paramName,"tare_nano17")==0)
     {
       cout << "TARING SENSORS" << endl;
       strcat(outbuffer, "tare_nano17");
-      send = ulapi_socket_write(server_params, outbuffer, sizeof(outbuffer));
-      Sleep(10);
+      sendBuffer(HAND_CHANNEL_PARAMS, 10);
     }
 
     /*
@@ -19,6 +19,7 @@
 
 #include "ulapi.h"
 #include "crpi.h"
+#include "crpi_hand_shm.h"
 
 
 namespace crpi_robot
@@ -350,6 +351,17 @@ namespace crpi_robot
 
   private:
 
+    //! @brief Send the contents of outbuffer to the hand server
+    //!
+    //! @param channel HAND_CHANNEL_CONFIG or HAND_CHANNEL_PARAMS
+    //! @param delay   Time (ms) the TCP transport waits after writing the message
+    //!
+    void sendBuffer (int channel, int delay);
+
+    //! @brief Shared-memory link to the hand server (NULL when using TCP)
+    //!
+    HandShmLink *link_;
+
     ulapi_integer server_config, server_params, server_feedback;
 
     void *task;
@@ -0,0 +1,212 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_batch.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Batches of CRPI or CRCL XML commands.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "crpi_batch.h"
+#include "crpi_sax.h"
+#include "crpi_xml_names.h"
+#include "crpi_xml_writer.h"
+
+using namespace std;
+using namespace Xml;
+
+namespace crpi_robot
+{
+  //! @brief Finds the extent of every child of a <CRPIBatch> or <CRCLBatch> root element
+  //!
+  class XmlBatchSplitter : public XmlHandler
+  {
+  public:
+    const char *begin;
+    const char *end;
+    int depth;
+    int root;
+    bool stopOnFailure;
+    vector<string> *commands;
+    int count;
+
+    //! @brief The current child:  its name, its '<', and the end of its start tag's attributes
+    //!
+    const char *name;
+    const char *start;
+    const char *tail;
+
+    XmlBatchSplitter (const string &text, vector<string> *list)
+    {
+      begin = text.data();
+      end = begin + text.length();
+      depth = 0;
+      root = TokUnknown;
+      stopOnFailure = true;
+      commands = list;
+      count = 0;
+      name = start = tail = NULL;
+    }
+
+    bool startElement (const xmlView& tagName, const xmlAttributes& attr)
+    {
+      if (depth == 0)
+      {
+        //! Anything other than a batch is left for the command parsers
+        root = xmlLookup(tagName).token;
+        if (root != TokCRPIBatch && root != TokCRCLBatch)
+        {
+          return false;
+        }
+        for (int i = 0; i < attr.name.count; ++i)
+        {
+          if (xmlLookup(attr.name.item[i]).token == TokStopOnFailure)
+          {
+            stopOnFailure = (attr.val.item[i] != "false");
+          }
+        }
+      }
+      else if (depth == 1)
+      {
+        name = tagName.ptr;
+        for (start = name; start > begin && *start != '<'; --start)
+        {
+        }
+        tail = name + tagName.len;
+        if (attr.val.count > 0)
+        {
+          //! Past the closing quote of the last attribute
+          tail = attr.val.item[attr.val.count - 1].ptr + attr.val.item[attr.val.count - 1].len + 1;
+        }
+      }
+      ++depth;
+      return true;
+    }
+
+    bool interTagElement (const xmlView& tagName, const xmlViewList& vals)
+    {
+      return true;
+    }
+
+    bool endElement (const xmlView& tagName)
+    {
+      const char *close;
+
+      --depth;
+      if (depth == 1)
+      {
+        //! A self-closing child reports its start tag's name; otherwise this is its closing tag
+        close = (tagName.ptr == name ? tail : tagName.ptr + tagName.len);
+        close = (const char*)memchr(close, '>', end - close);
+        if (close == NULL)
+        {
+          return false;
+        }
+        if (count == (int)commands->size())
+        {
+          commands->push_back(string());
+        }
+        (*commands)[count++].assign(start, close + 1 - start);
+      }
+      return true;
+    }
+  };
+
+
+  LIBRARY_API CrpiBatch::CrpiBatch ()
+  {
+    count_ = executed_ = 0;
+    crcl_ = failed_ = false;
+    stopOnFailure_ = true;
+  }
+
+
+  LIBRARY_API CrpiBatch::~CrpiBatch ()
+  {
+  }
+
+
+  LIBRARY_API bool CrpiBatch::parse (const string &text)
+  {
+    XmlBatchSplitter splitter(text, &commands_);
+    bool batch;
+
+    batch = saxParse(text.data(), text.length(), splitter);
+    count_ = (batch ? splitter.count : 0);
+    crcl_ = (splitter.root == TokCRCLBatch);
+    stopOnFailure_ = splitter.stopOnFailure;
+    executed_ = 0;
+    failed_ = false;
+    statuses_.clear();
+    return batch;
+  }
+
+
+  LIBRARY_API bool CrpiBatch::crcl () const
+  {
+    return crcl_;
+  }
+
+
+  LIBRARY_API int CrpiBatch::size () const
+  {
+    return count_;
+  }
+
+
+  LIBRARY_API string &CrpiBatch::command (int index)
+  {
+    return commands_.at(index);
+  }
+
+
+  LIBRARY_API void CrpiBatch::add (CanonReturn status, const string &response)
+  {
+    size_t from = 0;
+
+    //! Each status is nested in the batch status, so it loses its XML declaration
+    if (response.compare(0, 2, "<?") == 0)
+    {
+      from = response.find("?>");
+      from = (from == string::npos ? 0 : from + 2);
+    }
+    statuses_.append(response, from, string::npos);
+    ++executed_;
+    failed_ = failed_ || (status != CANON_SUCCESS);
+  }
+
+
+  LIBRARY_API bool CrpiBatch::stopped () const
+  {
+    return failed_ && stopOnFailure_;
+  }
+
+
+  LIBRARY_API bool CrpiBatch::failed () const
+  {
+    return failed_;
+  }
+
+
+  LIBRARY_API void CrpiBatch::respond (string &response, unsigned int statusID)
+  {
+    XmlWriter out(response);
+    const char *root = (crcl_ ? "CRCLBatchStatus" : "CRPIBatchStatus");
+
+    out.clear();
+    if (crcl_)
+    {
+      out << "<?xml version=\"1.0\" encoding=\"UTF-8\"?>";
+    }
+    out << '<' << root << "><StatusID>" << statusID << "</StatusID><CommandState>"
+        << ((failed_ || executed_ < count_ || count_ == 0) ? "Error" : "Done") << "</CommandState><Executed>"
+        << executed_ << "</Executed><Count>" << count_ << "</Count>" << statuses_ << "</" << root << '>';
+  }
+
+} // crpi_robot
@@ -0,0 +1,124 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_batch.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Batches of CRPI or CRCL XML commands sent, executed, and answered as a
+//  single message.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_BATCH_H
+#define CRPI_BATCH_H
+
+#include <string>
+#include <vector>
+#include "crpi.h"
+
+#pragma warning (disable: 4251)
+
+//! A batch wraps any number of commands in one envelope, executed in order:
+//!
+//!   <CRPIBatch StopOnFailure="true">
+//!     <CRPICommand type="SetRelativeSpeed"><Real Value="0.5"/></CRPICommand>
+//!     <CRPICommand type="MoveTo"><Pose X="300" Y="-300" Z="200" XRot="180" YRot="0" ZRot="0"/></CRPICommand>
+//!   </CRPIBatch>
+//!
+//! or, for CRCL, <CRCLBatch> around <CRCLCommandInstance> elements.  Unless StopOnFailure is
+//! "false", the commands after the first that does not succeed are not executed.  The single
+//! response holds the status of every command executed, in order:
+//!
+//!   <CRPIBatchStatus><StatusID>..</StatusID><CommandState>Done|Error</CommandState>
+//!     <Executed>..</Executed><Count>..</Count><CRPIStatus>..</CRPIStatus>...</CRPIBatchStatus>
+//!
+//! (<CRCLBatchStatus> of <CRCLStatus> elements for CRCL).  The batch is Done only if every
+//! command was executed and succeeded; its StatusID is that of its last command.
+
+namespace crpi_robot
+{
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Splits a batch into its commands and aggregates their responses
+  //!
+  //! @note Reuse one CrpiBatch per connection to keep its buffers from one batch to the next.
+  //!
+  class LIBRARY_API CrpiBatch
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    CrpiBatch ();
+
+    //! @brief Default destructor
+    //!
+    ~CrpiBatch ();
+
+    //! @brief Split a batch into its commands, forgetting the previous batch
+    //!
+    //! @param text The message received
+    //!
+    //! @return True if the message is a well-formed batch, false otherwise (only the root
+    //!         element is read if it is not a batch)
+    //!
+    bool parse (const std::string &text);
+
+    //! @brief Whether the batch holds CRCL commands rather than CRPI commands
+    //!
+    bool crcl () const;
+
+    //! @brief Number of commands in the batch
+    //!
+    int size () const;
+
+    //! @brief A command of the batch
+    //!
+    //! @param index Position of the command in the batch (0 to size() - 1)
+    //!
+    std::string &command (int index);
+
+    //! @brief Record the response to the next command executed
+    //!
+    //! @param status   The result of the command
+    //! @param response Its CRPI (or CRCL) XML status message
+    //!
+    void add (CanonReturn status, const std::string &response);
+
+    //! @brief Whether the remaining commands should not be executed
+    //!
+    bool stopped () const;
+
+    //! @brief Whether any command executed did not succeed
+    //!
+    bool failed () const;
+
+    //! @brief Encode the response to the batch
+    //!
+    //! @param response Replaced with the batch status message
+    //! @param statusID Message counter of the last command
+    //!
+    void respond (std::string &response, unsigned int statusID);
+
+  private:
+    //! @brief Commands of the batch (the first count_; the rest keep their buffers for reuse)
+    //!
+    std::vector<std::string> commands_;
+    int count_;
+
+    bool crcl_;
+    bool stopOnFailure_;
+
+    //! @brief Responses added so far
+    //!
+    int executed_;
+    bool failed_;
+    std::string statuses_;
+  }; // CrpiBatch
+
+} // crpi_robot
+
+#endif
@@ -0,0 +1,404 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_binary.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Compact binary encoding of the CRPI command set.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include "crpi_binary.h"
+
+using namespace std;
+
+//! Every field flag defined by this version of the protocol
+#define CRPI_BIN_ALL 0x0FFF
+
+namespace Xml
+{
+  //! @brief Append a value in host (little-endian) order
+  //!
+  template <class V> static inline void binPut (string &msg, V value)
+  {
+    msg.append((const char*)&value, sizeof(V));
+  }
+
+
+  //! @brief Append the six members of a pose
+  //!
+  static inline void binPutPose (string &msg, const robotPose *pose)
+  {
+    double vals[6] = {pose->x, pose->y, pose->z, pose->xrot, pose->yrot, pose->zrot};
+    msg.append((const char*)vals, sizeof(vals));
+  }
+
+
+  //! @brief Append a count and that many axis values
+  //!
+  static inline void binPutAxes (string &msg, const robotAxes *axes)
+  {
+    unsigned char count = (unsigned char)(axes->axes < (int)axes->axis.size() ? axes->axes : axes->axis.size());
+    binPut(msg, count);
+    if (count > 0)
+    {
+      msg.append((const char*)&axes->axis[0], count * sizeof(double));
+    }
+  }
+
+
+  //! @brief Reads values from a message, noting when it runs past the end
+  //!
+  struct binReader
+  {
+    const char *pos;
+    const char *end;
+    bool ok;
+
+    binReader (const string &msg)
+    {
+      pos = msg.data();
+      end = pos + msg.length();
+      ok = true;
+    }
+
+    bool get (void *data, size_t length)
+    {
+      if (!ok || (size_t)(end - pos) < length)
+      {
+        ok = false;
+        return false;
+      }
+      memcpy(data, pos, length);
+      pos += length;
+      return true;
+    }
+
+    template <class V> V get ()
+    {
+      V value = V();
+      get(&value, sizeof(V));
+      return value;
+    }
+
+    void getPose (robotPose *pose)
+    {
+      double vals[6];
+      if (get(vals, sizeof(vals)))
+      {
+        pose->x = vals[0];
+        pose->y = vals[1];
+        pose->z = vals[2];
+        pose->xrot = vals[3];
+        pose->yrot = vals[4];
+        pose->zrot = vals[5];
+      }
+    }
+
+    void getAxes (robotAxes *axes)
+    {
+      unsigned char count = get<unsigned char>();
+      if ((size_t)count > axes->axis.size())
+      {
+        axes->axis.resize(count);
+      }
+      if (count > 0)
+      {
+        get(&axes->axis[0], count * sizeof(double));
+      }
+      axes->axes = count;
+    }
+  };
+
+
+  //! @brief The fields a command carries
+  //!
+  static int binCommandFields (int cmd)
+  {
+    switch (cmd)
+    {
+    case CmdCouple:
+    case CmdMessage:
+    case CmdSaveConfig:
+    case CmdSetAngleUnits:
+    case CmdSetLengthUnits:
+      return CRPI_BIN_STRING;
+    case CmdMoveAttractor:
+    case CmdMoveStraightTo:
+    case CmdMoveThroughTo:
+    case CmdMoveTo:
+      return CRPI_BIN_POSE;
+    case CmdMoveToAxisTarget:
+      return CRPI_BIN_AXES;
+    case CmdSetAbsoluteAcceleration:
+    case CmdSetAbsoluteSpeed:
+    case CmdSetRelativeAcceleration:
+    case CmdSetRelativeSpeed:
+    case CmdSetTool:
+      return CRPI_BIN_REAL;
+    case CmdSetRobotDO:
+      return CRPI_BIN_INTEGER | CRPI_BIN_BOOLEAN;
+    case CmdSubscribe:
+      return CRPI_BIN_STRING | CRPI_BIN_REAL | CRPI_BIN_INTEGER;
+    default:
+      return 0;
+    }
+  }
+
+
+  //! @brief The fields a response to a command carries
+  //!
+  static int binResponseFields (int cmd)
+  {
+    switch (cmd)
+    {
+    case CmdGetRobotAxes:
+      return CRPI_BIN_STATUS | CRPI_BIN_AXES;
+    case CmdGetRobotForces:
+      return CRPI_BIN_STATUS | CRPI_BIN_FORCES;
+    case CmdGetRobotIO:
+      return CRPI_BIN_STATUS | CRPI_BIN_IO;
+    case CmdGetRobotPose:
+      return CRPI_BIN_STATUS | CRPI_BIN_POSE;
+    case CmdGetRobotSpeed:
+      return CRPI_BIN_STATUS | CRPI_BIN_SPEED;
+    case CmdGetRobotTorques:
+      return CRPI_BIN_STATUS | CRPI_BIN_TORQUES;
+    default:
+      return CRPI_BIN_STATUS;
+    }
+  }
+
+
+  LIBRARY_API CrpiBinary::CrpiBinary (CrpiXmlParams *params) :
+    params_(params)
+  {
+  }
+
+
+  LIBRARY_API CrpiBinary::~CrpiBinary ()
+  {
+  }
+
+
+  LIBRARY_API int CrpiBinary::command (const string &msg)
+  {
+    unsigned short cmd;
+
+    if (msg.length() < 4)
+    {
+      return -1;
+    }
+    memcpy(&cmd, msg.data(), sizeof(cmd));
+    return cmd;
+  }
+
+
+  LIBRARY_API bool CrpiBinary::parse (const string &msg)
+  {
+    binReader in(msg);
+    unsigned short cmd, fields, length;
+    unsigned char i;
+
+    cmd = in.get<unsigned short>();
+    fields = in.get<unsigned short>();
+    if (!in.ok || (fields & ~CRPI_BIN_ALL) != 0)
+    {
+      return false;
+    }
+    params_->cmd = (CanonCommand)cmd;
+
+    if (fields & CRPI_BIN_STATUS)
+    {
+      params_->status = (CanonReturn)in.get<unsigned char>();
+      params_->counter = in.get<unsigned int>();
+    }
+    if (fields & CRPI_BIN_STRING)
+    {
+      length = in.get<unsigned short>();
+      if (in.ok && (size_t)(in.end - in.pos) >= length)
+      {
+        params_->str.assign(in.pos, length);
+        in.pos += length;
+      }
+      else
+      {
+        in.ok = false;
+      }
+    }
+    if (fields & CRPI_BIN_INTEGER)
+    {
+      params_->integer = in.get<int>();
+    }
+    if (fields & CRPI_BIN_BOOLEAN)
+    {
+      params_->boolean = (in.get<unsigned char>() != 0);
+    }
+    if (fields & CRPI_BIN_REAL)
+    {
+      //! SetAbsoluteSpeed and SetAbsoluteAcceleration take their value from numPositions
+      params_->real = params_->numPositions = in.get<double>();
+    }
+    if (fields & CRPI_BIN_POSE)
+    {
+      in.getPose(params_->pose);
+    }
+    if (fields & CRPI_BIN_AXES)
+    {
+      in.getAxes(params_->axes);
+    }
+    if (fields & CRPI_BIN_FORCES)
+    {
+      in.getPose(params_->forces);
+    }
+    if (fields & CRPI_BIN_TORQUES)
+    {
+      in.getAxes(params_->torques);
+    }
+    if (fields & CRPI_BIN_IO)
+    {
+      params_->io->ndio = in.get<unsigned char>();
+      params_->io->naio = in.get<unsigned char>();
+      if (params_->io->ndio > CRPI_IO_MAX || params_->io->naio > CRPI_IO_MAX)
+      {
+        return false;
+      }
+      for (i = 0; i < params_->io->ndio; ++i)
+      {
+        params_->io->dio[i] = (in.get<unsigned char>() != 0);
+      }
+      for (i = 0; i < params_->io->naio; ++i)
+      {
+        params_->io->aio[i] = in.get<double>();
+      }
+    }
+    if (fields & CRPI_BIN_SPEED)
+    {
+      in.getPose(params_->speed);
+    }
+    if (fields & CRPI_BIN_TIME)
+    {
+      in.get<double>();
+    }
+
+    return in.ok;
+  }
+
+
+  LIBRARY_API bool CrpiBinary::encode (string &msg)
+  {
+    if (params_ == NULL)
+    {
+      return false;
+    }
+    put(params_->cmd, binResponseFields(params_->cmd), 0.0, msg);
+    return true;
+  }
+
+
+  LIBRARY_API bool CrpiBinary::encodeCommand (string &msg)
+  {
+    if (params_ == NULL)
+    {
+      return false;
+    }
+    put(params_->cmd, binCommandFields(params_->cmd), 0.0, msg);
+    return true;
+  }
+
+
+  LIBRARY_API bool CrpiBinary::encodeState (int channels, double time, string &msg)
+  {
+    int fields = CRPI_BIN_STATUS | CRPI_BIN_TIME;
+
+    if (params_ == NULL)
+    {
+      return false;
+    }
+    fields |= ((channels & CRPI_CHANNEL_POSE) ? CRPI_BIN_POSE : 0);
+    fields |= ((channels & CRPI_CHANNEL_AXES) ? CRPI_BIN_AXES : 0);
+    fields |= ((channels & CRPI_CHANNEL_FORCES) ? CRPI_BIN_FORCES : 0);
+    fields |= ((channels & CRPI_CHANNEL_IO) ? CRPI_BIN_IO : 0);
+    fields |= ((channels & CRPI_CHANNEL_SPEED) ? CRPI_BIN_SPEED : 0);
+    put(CmdSubscribe, fields, time, msg);
+    return true;
+  }
+
+
+  void CrpiBinary::put (int cmd, int fields, double time, string &msg)
+  {
+    unsigned short length;
+    int i;
+
+    msg.clear();
+    binPut(msg, (unsigned short)cmd);
+    binPut(msg, (unsigned short)fields);
+
+    if (fields & CRPI_BIN_STATUS)
+    {
+      binPut(msg, (unsigned char)params_->status);
+      binPut(msg, (unsigned int)params_->counter);
+    }
+    if (fields & CRPI_BIN_STRING)
+    {
+      length = (unsigned short)(params_->str.length() < 0xFFFF ? params_->str.length() : 0xFFFF);
+      binPut(msg, length);
+      msg.append(params_->str.data(), length);
+    }
+    if (fields & CRPI_BIN_INTEGER)
+    {
+      binPut(msg, (int)params_->integer);
+    }
+    if (fields & CRPI_BIN_BOOLEAN)
+    {
+      binPut(msg, (unsigned char)(params_->boolean ? 1 : 0));
+    }
+    if (fields & CRPI_BIN_REAL)
+    {
+      binPut(msg, params_->real);
+    }
+    if (fields & CRPI_BIN_POSE)
+    {
+      binPutPose(msg, params_->pose);
+    }
+    if (fields & CRPI_BIN_AXES)
+    {
+      binPutAxes(msg, params_->axes);
+    }
+    if (fields & CRPI_BIN_FORCES)
+    {
+      binPutPose(msg, params_->forces);
+    }
+    if (fields & CRPI_BIN_TORQUES)
+    {
+      binPutAxes(msg, params_->torques);
+    }
+    if (fields & CRPI_BIN_IO)
+    {
+      binPut(msg, (unsigned char)params_->io->ndio);
+      binPut(msg, (unsigned char)params_->io->naio);
+      for (i = 0; i < params_->io->ndio; ++i)
+      {
+        binPut(msg, (unsigned char)(params_->io->dio[i] ? 1 : 0));
+      }
+      for (i = 0; i < params_->io->naio; ++i)
+      {
+        binPut(msg, params_->io->aio[i]);
+      }
+    }
+    if (fields & CRPI_BIN_SPEED)
+    {
+      binPutPose(msg, params_->speed);
+    }
+    if (fields & CRPI_BIN_TIME)
+    {
+      binPut(msg, time);
+    }
+  }
+
+} // Xml namespace
@@ -0,0 +1,121 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_binary.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Compact binary encoding of the CRPI command set, an alternative to CRPI
+//  XML for remote clients.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_BINARY_H
+#define CRPI_BINARY_H
+
+#include <string>
+#include "crpi.h"
+#include "crpi_xml.h"
+
+//! Every message (command, response, or state frame) is a 4-byte header followed by the fields
+//! it carries, in the order of the flags below:
+//!
+//!   uint16 command    CanonCommand (CmdSubscribe for state frames)
+//!   uint16 fields     Which of the following are present
+//!
+//! Multi-byte values are little-endian; doubles are IEEE 754.  Over XMLInterface, the client
+//! selects the binary protocol with the handshake byte XML_STREAM_BINARY, and every message is
+//! preceded by its 4-byte, big-endian length (see XmlStream).
+#define CRPI_BIN_STATUS 0x0001      //! uint8 CanonReturn, uint32 message counter (responses)
+#define CRPI_BIN_STRING 0x0002      //! uint16 length, then that many characters
+#define CRPI_BIN_INTEGER 0x0004     //! int32
+#define CRPI_BIN_BOOLEAN 0x0008     //! uint8 (0 or 1)
+#define CRPI_BIN_REAL 0x0010        //! double
+#define CRPI_BIN_POSE 0x0020        //! 6 doubles:  X, Y, Z, XRot, YRot, ZRot
+#define CRPI_BIN_AXES 0x0040        //! uint8 count, then count doubles
+#define CRPI_BIN_FORCES 0x0080      //! 6 doubles, as CRPI_BIN_POSE
+#define CRPI_BIN_TORQUES 0x0100     //! uint8 count, then count doubles
+#define CRPI_BIN_IO 0x0200          //! uint8 digital count, uint8 analog count, a uint8 per
+                                    //! digital value, then a double per analog value
+#define CRPI_BIN_SPEED 0x0400       //! 6 doubles, as CRPI_BIN_POSE
+#define CRPI_BIN_TIME 0x0800        //! double:  time the state was sampled (state frames)
+
+namespace Xml
+{
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Binary counterpart of CrpiXml, sharing its parameter structure
+  //!
+  //! @note Commands carry the fields their CRPI XML form carries (MoveTo a pose, Couple a
+  //!       string, SetRobotDO an integer and a boolean, ...).  Responses carry the status and
+  //!       counter, plus the state a Get* query asked for.
+  //!
+  class LIBRARY_API CrpiBinary
+  {
+  public:
+    //! @brief Constructor
+    //!
+    //! @param params The parameters populated by parse and read by the encoders
+    //!
+    CrpiBinary (CrpiXmlParams *params);
+
+    //! @brief Default destructor
+    //!
+    ~CrpiBinary ();
+
+    //! @brief Decode a message into the parameters
+    //!
+    //! @param msg The message (without its length prefix)
+    //!
+    //! @return True if the message was well formed, false otherwise
+    //!
+    bool parse (const std::string &msg);
+
+    //! @brief Encode a response to the command in the parameters
+    //!
+    //! @param msg Populated with the response
+    //!
+    //! @return True if encoding was successful, false otherwise
+    //!
+    bool encode (std::string &msg);
+
+    //! @brief Encode the command in the parameters (for clients)
+    //!
+    //! @param msg Populated with the command
+    //!
+    //! @return True if encoding was successful, false otherwise
+    //!
+    bool encodeCommand (std::string &msg);
+
+    //! @brief Encode a state frame for subscribers
+    //!
+    //! @param channels The state to include (CRPI_CHANNEL_POSE | CRPI_CHANNEL_AXES | ...)
+    //! @param time     Time (from ulapi_time) at which the state was sampled
+    //! @param msg      Populated with the state frame
+    //!
+    //! @return True if encoding was successful, false otherwise
+    //!
+    bool encodeState (int channels, double time, std::string &msg);
+
+    //! @brief The command of a message, without decoding it
+    //!
+    //! @param msg The message
+    //!
+    //! @return The CanonCommand, or -1 if the message is too short
+    //!
+    static int command (const std::string &msg);
+
+  private:
+    //! @brief Append the header and the given fields from the parameters
+    //!
+    void put (int cmd, int fields, double time, std::string &msg);
+
+    CrpiXmlParams *params_;
+  }; // CrpiBinary
+
+} // Xml namespace
+
+#endif
@@ -0,0 +1,213 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_command.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Per-request contexts for remote CRPI commands.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_command.h"
+
+using namespace std;
+using namespace Xml;
+
+namespace crpi_robot
+{
+  LIBRARY_API CrpiCommand::CrpiCommand () :
+    crcl_(false)
+  {
+    request_ = new CrpiXmlParams();
+    requestXml_ = new CrpiXml(request_);
+    requestBin_ = new CrpiBinary(request_);
+    requestCrcl_ = new CrclXml(request_);
+    response_ = new CrpiXmlParams();
+    responseXml_ = new CrpiXml(response_);
+    responseBin_ = new CrpiBinary(response_);
+    responseCrcl_ = new CrclXml(response_);
+  }
+
+
+  LIBRARY_API CrpiCommand::~CrpiCommand ()
+  {
+    delete requestXml_;
+    delete requestBin_;
+    delete requestCrcl_;
+    delete request_;
+    delete responseXml_;
+    delete responseBin_;
+    delete responseCrcl_;
+    delete response_;
+  }
+
+
+  LIBRARY_API bool CrpiCommand::parse (const string &command, bool binary)
+  {
+    //! Commands only carry the values they use; clear those of the previous command
+    request_->cmd = (CanonCommand)-1;
+    request_->str.clear();
+    request_->integer = 0;
+    request_->real = request_->numPositions = 0.0;
+    request_->boolean = false;
+    crcl_ = false;
+
+    if (binary)
+    {
+      return requestBin_->parse(command);
+    }
+    return requestXml_->parse(command);
+  }
+
+
+  LIBRARY_API bool CrpiCommand::parseCrcl (const string &command)
+  {
+    bool parsed;
+
+    //! Clear the values CRCL commands carry as well as those of CRPI commands
+    request_->cmd = (CanonCommand)-1;
+    request_->str.clear();
+    request_->integer = request_->commandID = 0;
+    request_->real = request_->numPositions = request_->setting = 0.0;
+    request_->boolean = request_->moveStraight = false;
+    request_->xaxis.i = request_->xaxis.j = request_->xaxis.k = 0.0;
+    request_->zaxis.i = request_->zaxis.j = request_->zaxis.k = 0.0;
+    crcl_ = true;
+
+    parsed = requestCrcl_->parse(command);
+
+    //! Carry the CRCL values where CrpiParamsHandler expects them, as CrclXmlHandler does
+    switch (request_->cmd)
+    {
+    case CmdMoveTo:
+      if (request_->moveStraight)
+      {
+        request_->cmd = CmdMoveStraightTo;
+      }
+      break;
+    case CmdSetRelativeAcceleration:
+    case CmdSetRelativeSpeed:
+      request_->real = request_->numPositions;
+      break;
+    case CmdSetTool:
+      request_->real = request_->setting;
+      break;
+    default:
+      break;
+    }
+    return parsed;
+  }
+
+
+  LIBRARY_API bool CrpiCommand::crcl () const
+  {
+    return crcl_;
+  }
+
+
+  LIBRARY_API void CrpiCommand::orient (bool degrees)
+  {
+    Math::matrix rot(4, 4);
+    Math::pose rpy;
+    const orientVect &x = request_->xaxis;
+    const orientVect &z = request_->zaxis;
+
+    //! The Y axis completes the right-handed frame
+    rot.at(0, 0) = x.i;
+    rot.at(1, 0) = x.j;
+    rot.at(2, 0) = x.k;
+    rot.at(0, 1) = (z.j * x.k) - (z.k * x.j);
+    rot.at(1, 1) = (z.k * x.i) - (z.i * x.k);
+    rot.at(2, 1) = (z.i * x.j) - (z.j * x.i);
+    rot.at(0, 2) = z.i;
+    rot.at(1, 2) = z.j;
+    rot.at(2, 2) = z.k;
+    rot.at(3, 3) = 1.0;
+
+    if (rot.matrixRPYConvert(rpy, degrees))
+    {
+      request_->pose->xrot = rpy.xr;
+      request_->pose->yrot = rpy.yr;
+      request_->pose->zrot = rpy.zr;
+    }
+  }
+
+
+  LIBRARY_API bool CrpiCommand::respond (string &response, bool binary)
+  {
+    if (crcl_)
+    {
+      return responseCrcl_->encode(response);
+    }
+    if (binary)
+    {
+      return responseBin_->encode(response);
+    }
+    return responseXml_->encode(response);
+  }
+
+
+  LIBRARY_API const CrpiXmlParams &CrpiCommand::request () const
+  {
+    return *request_;
+  }
+
+
+  LIBRARY_API CrpiXmlParams &CrpiCommand::response ()
+  {
+    return *response_;
+  }
+
+
+  LIBRARY_API CrpiCommandPool::CrpiCommandPool ()
+  {
+    counter_ = 0;
+    lock_ = ulapi_mutex_new(59);
+  }
+
+
+  LIBRARY_API CrpiCommandPool::~CrpiCommandPool ()
+  {
+    vector<CrpiCommand*>::iterator iter;
+
+    for (iter = free_.begin(); iter != free_.end(); ++iter)
+    {
+      delete *iter;
+    }
+    free_.clear();
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API CrpiCommand *CrpiCommandPool::take ()
+  {
+    CrpiCommand *command;
+
+    ulapi_mutex_take(lock_);
+    if (free_.empty())
+    {
+      command = new CrpiCommand();
+    }
+    else
+    {
+      command = free_.back();
+      free_.pop_back();
+    }
+    command->response().counter = ++counter_;
+    ulapi_mutex_give(lock_);
+    return command;
+  }
+
+
+  LIBRARY_API void CrpiCommandPool::give (CrpiCommand *command)
+  {
+    ulapi_mutex_take(lock_);
+    free_.push_back(command);
+    ulapi_mutex_give(lock_);
+  }
+
+} // crpi_robot
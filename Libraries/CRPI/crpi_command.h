@@ -0,0 +1,155 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_command.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Per-request contexts for remote CRPI commands, so that commands from
+//  several clients may be handled by one robot at the same time.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_COMMAND_H
+#define CRPI_COMMAND_H
+
+#include <string>
+#include <vector>
+#include "crpi.h"
+#include "crpi_xml.h"
+#include "crpi_binary.h"
+
+#pragma warning (disable: 4251)
+
+namespace crpi_robot
+{
+  //! @ingroup crpi_robot
+  //!
+  //! @brief One remote command:  the request parsed from the client, and the response to it
+  //!
+  //! @note The request is written only by parse (and orient); executing the command (see
+  //!       CrpiRobot::CrpiCommandHandler) reads it and writes only the response.  Unlike the
+  //!       CrpiXmlHandler/CrpiXmlResponse pair, which share one CrpiXmlParams per robot, any
+  //!       number of commands may therefore be in flight at once, ex. queries answered while a
+  //!       motion command executes.
+  //!
+  class LIBRARY_API CrpiCommand
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    CrpiCommand ();
+
+    //! @brief Default destructor
+    //!
+    ~CrpiCommand ();
+
+    //! @brief Parse a command into the request, replacing the previous one
+    //!
+    //! @param command The CRPI XML command, or binary command (see CrpiBinary)
+    //! @param binary  Whether the command is binary
+    //!
+    //! @return True if the command was well formed, false otherwise
+    //!
+    bool parse (const std::string &command, bool binary);
+
+    //! @brief Parse a CRCL command instance into the request, replacing the previous one
+    //!
+    //! @param command The CRCL XML command
+    //!
+    //! @return True if the command was well formed, false otherwise
+    //!
+    //! @note The request is given its CRPI meaning (ex. a straight MoveTo is MoveStraightTo),
+    //!       and the response is encoded as a CRCL status.  The orientation of the pose is
+    //!       set by orient() once the robot's angle units are known.
+    //!
+    bool parseCrcl (const std::string &command);
+
+    //! @brief Whether the request is a CRCL command
+    //!
+    bool crcl () const;
+
+    //! @brief Set the orientation of a CRCL request from its X and Z axes
+    //!
+    //! @param degrees Whether the robot's angle units are degrees (true) or radians (false)
+    //!
+    void orient (bool degrees);
+
+    //! @brief Encode the response
+    //!
+    //! @param response Replaced with the CRPI XML or binary response
+    //! @param binary   Whether to encode the response in binary
+    //!
+    //! @return True if encoding was successful, false otherwise
+    //!
+    bool respond (std::string &response, bool binary);
+
+    //! @brief The parsed command
+    //!
+    const Xml::CrpiXmlParams &request () const;
+
+    //! @brief The status of the command and the state it read
+    //!
+    Xml::CrpiXmlParams &response ();
+
+  private:
+    Xml::CrpiXmlParams *request_;
+    Xml::CrpiXml *requestXml_;
+    Xml::CrpiBinary *requestBin_;
+    Xml::CrclXml *requestCrcl_;
+
+    Xml::CrpiXmlParams *response_;
+    Xml::CrpiXml *responseXml_;
+    Xml::CrpiBinary *responseBin_;
+    Xml::CrclXml *responseCrcl_;
+
+    //! @brief Whether the request is a CRCL command
+    //!
+    bool crcl_;
+  }; // CrpiCommand
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Reusable command contexts for one connection
+  //!
+  //! @note Contexts are created as needed and kept when returned, so a connection stops
+  //!       allocating once it has as many commands in flight as it will ever have.  Each
+  //!       context taken is given the connection's next message counter (StatusID), so
+  //!       responses are numbered in the order their commands arrived.
+  //!
+  class LIBRARY_API CrpiCommandPool
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    CrpiCommandPool ();
+
+    //! @brief Default destructor; every context must have been returned
+    //!
+    ~CrpiCommandPool ();
+
+    //! @brief Take a context for the next command
+    //!
+    //! @return The context, numbered with the next message counter
+    //!
+    CrpiCommand *take ();
+
+    //! @brief Return a context taken from this pool
+    //!
+    //! @param command The context, no longer in use
+    //!
+    void give (CrpiCommand *command);
+
+  private:
+    std::vector<CrpiCommand*> free_;
+    unsigned int counter_;
+    ulapi_mutex_struct *lock_;
+  }; // CrpiCommandPool
+
+} // crpi_robot
+
+#endif
@@ -0,0 +1,593 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_composite.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Composite robot made of an arm and a hand, with overlapped command
+//  execution.  Generalizes CrpiDemoHack.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_COMPOSITE_H
+#define CRPI_COMPOSITE_H
+
+#include "crpi.h"
+#include "ulapi.h"
+#include <string.h>
+
+#pragma warning (disable: 4251)
+
+using namespace std;
+
+//! Device masks for CrpiComposite::Overlap() and CrpiComposite::Sync()
+#define COMPOSITE_ARM 1
+#define COMPOSITE_HAND 2
+#define COMPOSITE_BOTH 3
+
+namespace crpi_robot
+{
+  //! @brief Commands that may run in the background on a composite device
+  //!
+  enum CompositeOp
+  {
+    COMPOSITE_MOVE_TO = 0,
+    COMPOSITE_MOVE_STRAIGHT_TO,
+    COMPOSITE_MOVE_TO_AXIS_TARGET,
+    COMPOSITE_MOVE_ATTRACTOR,
+    COMPOSITE_SET_TOOL,
+    COMPOSITE_SET_PARAMETER
+  };
+
+
+  //! @brief Combine the results of two commands (REJECT over FAILURE over SUCCESS)
+  //!
+  inline CanonReturn compositeResult (CanonReturn a, CanonReturn b)
+  {
+    if (a == CANON_REJECT || b == CANON_REJECT)
+    {
+      return CANON_REJECT;
+    }
+    else if (a == CANON_FAILURE || b == CANON_FAILURE)
+    {
+      return CANON_FAILURE;
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  //! @brief Worker thread that runs one device's background commands in order
+  //!
+  //! @note One command is in flight at a time; posting a second command waits for the first.
+  //!       The worker and the callers waiting on it block on a condition variable.
+  //!
+  template <class T> class CrpiCompositeLane
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    //! @param device The device commanded by this lane (not owned)
+    //!
+    CrpiCompositeLane (T *device) :
+      device_(device),
+      runThread_(true),
+      state_(0),
+      result_(CANON_SUCCESS)
+    {
+      task_ = ulapi_task_new();
+      ulapi_task_start((ulapi_task_struct*)task_, run, this, ulapi_prio_lowest(), 0);
+    }
+
+    //! @brief Default destructor
+    //!
+    ~CrpiCompositeLane ()
+    {
+      {
+        std::unique_lock<std::mutex> guard(lock_);
+        while (state_ != 0)
+        {
+          signal_.wait(guard);
+        }
+        runThread_ = false;
+      }
+      signal_.notify_all();
+      ulapi_task_join((ulapi_task_struct*)task_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)task_);
+    }
+
+    //! @brief Queue a command, waiting for the previous one to finish
+    //!
+    void post (CompositeOp op, robotPose *pose, robotAxes *axes, double value, const char *name, void *param)
+    {
+      std::unique_lock<std::mutex> guard(lock_);
+      while (state_ != 0)
+      {
+        signal_.wait(guard);
+      }
+      op_ = op;
+      if (pose != NULL)
+      {
+        pose_ = *pose;
+      }
+      if (axes != NULL)
+      {
+        axes_ = *axes;
+      }
+      value_ = value;
+      if (name != NULL)
+      {
+        strncpy(name_, name, sizeof(name_) - 1);
+        name_[sizeof(name_) - 1] = '\0';
+      }
+      param_ = param;
+      state_ = 1;
+      guard.unlock();
+      signal_.notify_all();
+    }
+
+    //! @brief Wait for the command in flight, if any
+    //!
+    void wait ()
+    {
+      std::unique_lock<std::mutex> guard(lock_);
+      while (state_ != 0)
+      {
+        signal_.wait(guard);
+      }
+    }
+
+    //! @brief Wait for the command in flight and collect the results since the last sync
+    //!
+    CanonReturn sync ()
+    {
+      CanonReturn val;
+      std::unique_lock<std::mutex> guard(lock_);
+
+      while (state_ != 0)
+      {
+        signal_.wait(guard);
+      }
+      val = result_;
+      result_ = CANON_SUCCESS;
+      return val;
+    }
+
+    //! @brief Whether or not a command is in flight
+    //!
+    bool busy ()
+    {
+      std::lock_guard<std::mutex> guard(lock_);
+      return (state_ != 0);
+    }
+
+    //! @brief Thread body
+    //!
+    static void run (void *param)
+    {
+      CrpiCompositeLane<T> *lane = (CrpiCompositeLane<T>*)param;
+      CanonReturn val;
+      std::unique_lock<std::mutex> guard(lane->lock_);
+
+      while (true)
+      {
+        while (lane->runThread_ && lane->state_ != 1)
+        {
+          lane->signal_.wait(guard);
+        }
+        if (!lane->runThread_)
+        {
+          break;
+        }
+        lane->state_ = 2;
+        guard.unlock();
+        val = lane->execute();
+        guard.lock();
+        lane->result_ = compositeResult(lane->result_, val);
+        lane->state_ = 0;
+        lane->signal_.notify_all();
+      }
+    }
+
+  private:
+    //! @brief Run the queued command on the device
+    //!
+    CanonReturn execute ()
+    {
+      switch (op_)
+      {
+      case COMPOSITE_MOVE_TO:
+        return device_->MoveTo(pose_);
+      case COMPOSITE_MOVE_STRAIGHT_TO:
+        return device_->MoveStraightTo(pose_);
+      case COMPOSITE_MOVE_TO_AXIS_TARGET:
+        return device_->MoveToAxisTarget(axes_);
+      case COMPOSITE_MOVE_ATTRACTOR:
+        return device_->MoveAttractor(pose_);
+      case COMPOSITE_SET_TOOL:
+        return device_->SetTool(value_);
+      case COMPOSITE_SET_PARAMETER:
+        return device_->SetParameter(name_, param_);
+      default:
+        return CANON_REJECT;
+      }
+    }
+
+    T *device_;
+    void *task_;
+    bool runThread_;
+
+    //! @brief 0 = idle, 1 = command queued, 2 = command running
+    //!
+    int state_;
+    CanonReturn result_;
+
+    //! @brief Protects runThread_, state_, result_, and the queued command; signaled whenever
+    //!        a command is queued or finishes, and on shutdown
+    //!
+    std::mutex lock_;
+    std::condition_variable signal_;
+
+    CompositeOp op_;
+    robotPose pose_;
+    robotAxes axes_;
+    double value_;
+    char name_[64];
+    void *param_;
+  }; // CrpiCompositeLane
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief A robot arm and a hand driven as one CRPI robot
+  //!
+  //! @note Motion, feedback, unit, and I/O commands go to the arm; SetTool and SetParameter go to
+  //!       the hand (prefix the parameter name with "ARM:" or "HAND:" to choose); Couple, Message,
+  //!       and StopMotion go to both.
+  //!
+  //!       By default every command returns when it is done.  Devices selected with Overlap()
+  //!       instead run MoveTo, MoveStraightTo, MoveToAxisTarget, MoveAttractor, SetTool, and
+  //!       SetParameter in the background and return CANON_RUNNING, so a gripper can pre-shape
+  //!       while the arm approaches.  Sync() is the synchronization point: it waits for the
+  //!       selected devices and returns the combined result of their background commands.  Other
+  //!       commands for a device wait for its background command first; StopMotion and the arm's
+  //!       Get* queries, which drivers answer alongside motion, do not wait.
+  //!
+  //!       Through CrpiRobot, use SetParameter("COMPOSITE_OVERLAP", int *mask) and
+  //!       SetParameter("COMPOSITE_SYNC", int *mask).  Parameter values passed to a background
+  //!       SetParameter must remain valid until the next Sync().
+  //!
+  template <class Arm, class Hand> class CrpiComposite
+  {
+  public:
+    //! @brief Constructor for use with CrpiRobot (both devices are configured from params)
+    //!
+    //! @param params Configuration parameters for the arm and the hand
+    //!
+    CrpiComposite (CrpiRobotParams &params) :
+      overlap_(0)
+    {
+      arm_ = new Arm(params);
+      hand_ = new Hand(params);
+      armLane_ = new CrpiCompositeLane<Arm>(arm_);
+      handLane_ = new CrpiCompositeLane<Hand>(hand_);
+    }
+
+    //! @brief Constructor for separately configured devices
+    //!
+    //! @param armParams  Configuration parameters for the arm
+    //! @param handParams Configuration parameters for the hand
+    //!
+    CrpiComposite (CrpiRobotParams &armParams, CrpiRobotParams &handParams) :
+      overlap_(0)
+    {
+      arm_ = new Arm(armParams);
+      hand_ = new Hand(handParams);
+      armLane_ = new CrpiCompositeLane<Arm>(arm_);
+      handLane_ = new CrpiCompositeLane<Hand>(hand_);
+    }
+
+    //! @brief Default destructor
+    //!
+    ~CrpiComposite ()
+    {
+      delete armLane_;
+      delete handLane_;
+      delete hand_;
+      delete arm_;
+    }
+
+    //! @brief Select the devices whose commands run in the background
+    //!
+    //! @param mask Any combination of COMPOSITE_ARM and COMPOSITE_HAND (0 for none)
+    //!
+    void Overlap (int mask)
+    {
+      overlap_ = mask;
+    }
+
+    //! @brief Wait for background commands to finish
+    //!
+    //! @param mask The devices to wait for
+    //!
+    //! @return The combined result of the background commands issued since the last Sync()
+    //!
+    CanonReturn Sync (int mask = COMPOSITE_BOTH)
+    {
+      CanonReturn val = CANON_SUCCESS;
+
+      if ((mask & COMPOSITE_ARM) != 0)
+      {
+        val = compositeResult(val, armLane_->sync());
+      }
+      if ((mask & COMPOSITE_HAND) != 0)
+      {
+        val = compositeResult(val, handLane_->sync());
+      }
+      return val;
+    }
+
+    //! @brief Direct access to the arm (commands bypass the background lane)
+    //!
+    Arm *arm ()
+    {
+      return arm_;
+    }
+
+    //! @brief Direct access to the hand (commands bypass the background lane)
+    //!
+    Hand *hand ()
+    {
+      return hand_;
+    }
+
+    CanonReturn ApplyCartesianForceTorque (robotPose &robotForceTorque, vector<bool> activeAxes, vector<bool> manipulator)
+    {
+      armLane_->wait();
+      return arm_->ApplyCartesianForceTorque(robotForceTorque, activeAxes, manipulator);
+    }
+
+    CanonReturn ApplyJointTorque (robotAxes &robotJointTorque)
+    {
+      armLane_->wait();
+      return arm_->ApplyJointTorque(robotJointTorque);
+    }
+
+    CanonReturn Couple (const char *targetID)
+    {
+      armLane_->wait();
+      handLane_->wait();
+      return compositeResult(hand_->Couple(targetID), arm_->Couple(targetID));
+    }
+
+    CanonReturn Message (const char *message)
+    {
+      armLane_->wait();
+      handLane_->wait();
+      return compositeResult(arm_->Message(message), hand_->Message(message));
+    }
+
+    CanonReturn MoveStraightTo (robotPose &pose)
+    {
+      if ((overlap_ & COMPOSITE_ARM) != 0)
+      {
+        armLane_->post(COMPOSITE_MOVE_STRAIGHT_TO, &pose, NULL, 0.0, NULL, NULL);
+        return CANON_RUNNING;
+      }
+      armLane_->wait();
+      return arm_->MoveStraightTo(pose);
+    }
+
+    CanonReturn MoveThroughTo (robotPose *poses, int numPoses, robotPose *accelerations = NULL,
+                               robotPose *speeds = NULL, robotPose *tolerances = NULL)
+    {
+      armLane_->wait();
+      return arm_->MoveThroughTo(poses, numPoses, accelerations, speeds, tolerances);
+    }
+
+    CanonReturn MoveTo (robotPose &pose)
+    {
+      if ((overlap_ & COMPOSITE_ARM) != 0)
+      {
+        armLane_->post(COMPOSITE_MOVE_TO, &pose, NULL, 0.0, NULL, NULL);
+        return CANON_RUNNING;
+      }
+      armLane_->wait();
+      return arm_->MoveTo(pose);
+    }
+
+    CanonReturn GetRobotAxes (robotAxes *axes)
+    {
+      return arm_->GetRobotAxes(axes);
+    }
+
+    CanonReturn GetRobotForces (robotPose *forces)
+    {
+      return arm_->GetRobotForces(forces);
+    }
+
+    CanonReturn GetRobotIO (robotIO *io)
+    {
+      return arm_->GetRobotIO(io);
+    }
+
+    CanonReturn GetRobotPose (robotPose *pose)
+    {
+      return arm_->GetRobotPose(pose);
+    }
+
+    CanonReturn GetRobotSpeed (robotPose *speed)
+    {
+      return arm_->GetRobotSpeed(speed);
+    }
+
+    CanonReturn GetRobotSpeed (robotAxes *speed)
+    {
+      return arm_->GetRobotSpeed(speed);
+    }
+
+    CanonReturn GetRobotTorques (robotAxes *torques)
+    {
+      return arm_->GetRobotTorques(torques);
+    }
+
+    CanonReturn MoveAttractor (robotPose &pose)
+    {
+      if ((overlap_ & COMPOSITE_ARM) != 0)
+      {
+        armLane_->post(COMPOSITE_MOVE_ATTRACTOR, &pose, NULL, 0.0, NULL, NULL);
+        return CANON_RUNNING;
+      }
+      armLane_->wait();
+      return arm_->MoveAttractor(pose);
+    }
+
+    CanonReturn MoveToAxisTarget (robotAxes &axes)
+    {
+      if ((overlap_ & COMPOSITE_ARM) != 0)
+      {
+        armLane_->post(COMPOSITE_MOVE_TO_AXIS_TARGET, NULL, &axes, 0.0, NULL, NULL);
+        return CANON_RUNNING;
+      }
+      armLane_->wait();
+      return arm_->MoveToAxisTarget(axes);
+    }
+
+    CanonReturn SetAbsoluteAcceleration (double acceleration)
+    {
+      armLane_->wait();
+      return arm_->SetAbsoluteAcceleration(acceleration);
+    }
+
+    CanonReturn SetAbsoluteSpeed (double speed)
+    {
+      armLane_->wait();
+      return arm_->SetAbsoluteSpeed(speed);
+    }
+
+    CanonReturn SetAngleUnits (const char *unitName)
+    {
+      armLane_->wait();
+      return arm_->SetAngleUnits(unitName);
+    }
+
+    CanonReturn SetAxialSpeeds (double *speeds)
+    {
+      armLane_->wait();
+      return arm_->SetAxialSpeeds(speeds);
+    }
+
+    CanonReturn SetAxialUnits (const char **unitNames)
+    {
+      armLane_->wait();
+      return arm_->SetAxialUnits(unitNames);
+    }
+
+    CanonReturn SetEndPoseTolerance (robotPose &tolerance)
+    {
+      armLane_->wait();
+      return arm_->SetEndPoseTolerance(tolerance);
+    }
+
+    CanonReturn SetIntermediatePoseTolerance (robotPose *tolerances)
+    {
+      armLane_->wait();
+      return arm_->SetIntermediatePoseTolerance(tolerances);
+    }
+
+    CanonReturn SetLengthUnits (const char *unitName)
+    {
+      armLane_->wait();
+      return arm_->SetLengthUnits(unitName);
+    }
+
+    CanonReturn SetParameter (const char *paramName, void *paramVal)
+    {
+      if (strcmp(paramName, "COMPOSITE_OVERLAP") == 0)
+      {
+        Overlap(*((int*)paramVal));
+        return CANON_SUCCESS;
+      }
+      else if (strcmp(paramName, "COMPOSITE_SYNC") == 0)
+      {
+        return Sync(*((int*)paramVal));
+      }
+      else if (strncmp(paramName, "ARM:", 4) == 0)
+      {
+        if ((overlap_ & COMPOSITE_ARM) != 0)
+        {
+          armLane_->post(COMPOSITE_SET_PARAMETER, NULL, NULL, 0.0, paramName + 4, paramVal);
+          return CANON_RUNNING;
+        }
+        armLane_->wait();
+        return arm_->SetParameter(paramName + 4, paramVal);
+      }
+
+      if (strncmp(paramName, "HAND:", 5) == 0)
+      {
+        paramName += 5;
+      }
+      if ((overlap_ & COMPOSITE_HAND) != 0)
+      {
+        handLane_->post(COMPOSITE_SET_PARAMETER, NULL, NULL, 0.0, paramName, paramVal);
+        return CANON_RUNNING;
+      }
+      handLane_->wait();
+      return hand_->SetParameter(paramName, paramVal);
+    }
+
+    CanonReturn SetRelativeAcceleration (double percent)
+    {
+      armLane_->wait();
+      return arm_->SetRelativeAcceleration(percent);
+    }
+
+    CanonReturn SetRelativeSpeed (double percent)
+    {
+      armLane_->wait();
+      return arm_->SetRelativeSpeed(percent);
+    }
+
+    CanonReturn SetRobotIO (robotIO &io)
+    {
+      armLane_->wait();
+      return arm_->SetRobotIO(io);
+    }
+
+    CanonReturn SetRobotDO (int dig_out, bool val)
+    {
+      armLane_->wait();
+      return arm_->SetRobotDO(dig_out, val);
+    }
+
+    CanonReturn SetTool (double percent)
+    {
+      if ((overlap_ & COMPOSITE_HAND) != 0)
+      {
+        handLane_->post(COMPOSITE_SET_TOOL, NULL, NULL, percent, NULL, NULL);
+        return CANON_RUNNING;
+      }
+      handLane_->wait();
+      return hand_->SetTool(percent);
+    }
+
+    CanonReturn StopMotion (int condition = 2)
+    {
+      //! Does not wait for background commands, which the stop is meant to interrupt
+      return compositeResult(arm_->StopMotion(condition), hand_->StopMotion(condition));
+    }
+
+  private:
+    Arm *arm_;
+    Hand *hand_;
+    CrpiCompositeLane<Arm> *armLane_;
+    CrpiCompositeLane<Hand> *handLane_;
+    int overlap_;
+  }; // CrpiComposite
+
+} // crpi_robot
+
+#endif
@@ -0,0 +1,289 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_hand_shm.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Shared-memory link between CRPI hand drivers and hand servers running on
+//  the same computer.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_hand_shm.h"
+#include <string.h>
+#include <new>
+
+using namespace std;
+
+namespace crpi_robot
+{
+  //! @brief Append one message to a ring
+  //!
+  //! @return False if the ring is full
+  //!
+  static bool ringPush (handShmRing *ring, int channel, const char *message)
+  {
+    unsigned int head = ring->head.load(std::memory_order_relaxed);
+    unsigned int tail = ring->tail.load(std::memory_order_acquire);
+    handShmMessage *slot;
+    size_t length;
+
+    if (head - tail >= HAND_SHM_SLOTS)
+    {
+      return false;
+    }
+
+    slot = &ring->slots[head % HAND_SHM_SLOTS];
+    length = strlen(message);
+    if (length >= HAND_SHM_MESSAGE)
+    {
+      length = HAND_SHM_MESSAGE - 1;
+    }
+    slot->channel = (unsigned int)channel;
+    slot->length = (unsigned int)length;
+    memcpy(slot->data, message, length);
+    slot->data[length] = '\0';
+
+    ring->head.store(head + 1, std::memory_order_release);
+    return true;
+  }
+
+
+  //! @brief Remove the oldest message from a ring
+  //!
+  //! @return False if the ring is empty
+  //!
+  static bool ringPop (handShmRing *ring, int &channel, char *message, int size)
+  {
+    unsigned int tail = ring->tail.load(std::memory_order_relaxed);
+    unsigned int head = ring->head.load(std::memory_order_acquire);
+    handShmMessage *slot;
+    unsigned int length;
+
+    if (tail == head)
+    {
+      return false;
+    }
+
+    slot = &ring->slots[tail % HAND_SHM_SLOTS];
+    length = slot->length;
+    if (length >= (unsigned int)size)
+    {
+      length = size - 1;
+    }
+    channel = (int)slot->channel;
+    memcpy(message, slot->data, length);
+    message[length] = '\0';
+
+    ring->tail.store(tail + 1, std::memory_order_release);
+    return true;
+  }
+
+
+  LIBRARY_API HandShmLink::HandShmLink () :
+    shm_(NULL),
+    sendSem_(NULL),
+    recvSem_(NULL),
+    segment_(NULL),
+    out_(NULL),
+    in_(NULL),
+    server_(false)
+  {
+    sendLock_ = ulapi_mutex_new(41);
+    recvLock_ = ulapi_mutex_new(43);
+  }
+
+
+  LIBRARY_API HandShmLink::~HandShmLink ()
+  {
+    close();
+    ulapi_mutex_delete(sendLock_);
+    ulapi_mutex_delete(recvLock_);
+  }
+
+
+  LIBRARY_API bool HandShmLink::open (int key, bool server, double timeout)
+  {
+    handShmSegment *segment;
+    double start;
+
+    close();
+
+    shm_ = ulapi_shm_new(key, sizeof(handShmSegment));
+    if (shm_ == NULL)
+    {
+      return false;
+    }
+    segment = (handShmSegment*)ulapi_shm_addr(shm_);
+    server_ = server;
+
+    if (server)
+    {
+      //! Start from empty rings and no feedback; clients wait for the magic number
+      segment->magic.store(0, std::memory_order_relaxed);
+      memset((void*)&segment->commands, 0, sizeof(handShmRing));
+      memset((void*)&segment->replies, 0, sizeof(handShmRing));
+      new (&segment->feedback) CrpiStateCache<handFeedback>();
+      segment->version = HAND_SHM_VERSION;
+      segment->magic.store(HAND_SHM_MAGIC, std::memory_order_release);
+    }
+    else
+    {
+      start = ulapi_time();
+      while (segment->magic.load(std::memory_order_acquire) != HAND_SHM_MAGIC ||
+             segment->version != HAND_SHM_VERSION)
+      {
+        if ((ulapi_time() - start) > timeout)
+        {
+          ulapi_shm_delete(shm_);
+          shm_ = NULL;
+          return false;
+        }
+        Sleep(1);
+      }
+    }
+
+    //! Semaphore "key" wakes the server when a command is queued, "key + 1" wakes the driver
+    //! when a reply is queued
+    sendSem_ = ulapi_sem_new(server ? key + 1 : key);
+    recvSem_ = ulapi_sem_new(server ? key : key + 1);
+    out_ = server ? &segment->replies : &segment->commands;
+    in_ = server ? &segment->commands : &segment->replies;
+    segment_ = segment;
+    return true;
+  }
+
+
+  LIBRARY_API void HandShmLink::close ()
+  {
+    if (segment_ != NULL && server_)
+    {
+      segment_->magic.store(0, std::memory_order_release);
+    }
+    segment_ = NULL;
+    out_ = in_ = NULL;
+
+    //! SysV semaphores are removed for every process at once, so only the server deletes them on
+    //! POSIX systems.  Win32 semaphore handles are per process and are always closed.
+#if !defined(_MSC_VER)
+    if (server_)
+#endif
+    {
+      if (sendSem_ != NULL)
+      {
+        ulapi_sem_delete(sendSem_);
+      }
+      if (recvSem_ != NULL)
+      {
+        ulapi_sem_delete(recvSem_);
+      }
+    }
+    sendSem_ = recvSem_ = NULL;
+    if (shm_ != NULL)
+    {
+      ulapi_shm_delete(shm_);
+      shm_ = NULL;
+    }
+  }
+
+
+  LIBRARY_API bool HandShmLink::connected ()
+  {
+    return (segment_ != NULL && segment_->magic.load(std::memory_order_acquire) == HAND_SHM_MAGIC);
+  }
+
+
+  LIBRARY_API bool HandShmLink::send (int channel, const char *message)
+  {
+    double start = ulapi_time();
+    bool ok;
+
+    if (!connected())
+    {
+      return false;
+    }
+
+    ulapi_mutex_take(sendLock_);
+    while (!(ok = ringPush(out_, channel, message)))
+    {
+      //! The other side has fallen behind by a full ring; give it a moment to catch up
+      if ((ulapi_time() - start) > HAND_SHM_TIMEOUT || !connected())
+      {
+        break;
+      }
+      Sleep(1);
+    }
+    ulapi_mutex_give(sendLock_);
+
+    if (ok)
+    {
+      ulapi_sem_give(sendSem_);
+    }
+    return ok;
+  }
+
+
+  LIBRARY_API bool HandShmLink::receive (int &channel, char *message, int size, double timeout)
+  {
+    double start = ulapi_time();
+    bool ok;
+
+    if (segment_ == NULL || size < 1)
+    {
+      return false;
+    }
+
+    ulapi_mutex_take(recvLock_);
+    while (!(ok = ringPop(in_, channel, message, size)))
+    {
+      if (timeout < 0.0)
+      {
+        //! The semaphore may already have been given for a message taken above, so an empty
+        //! ring after waking is reported rather than waited on again
+        ulapi_sem_take(recvSem_);
+        ok = ringPop(in_, channel, message, size);
+        break;
+      }
+      if ((ulapi_time() - start) > timeout)
+      {
+        break;
+      }
+      Sleep(1);
+    }
+    ulapi_mutex_give(recvLock_);
+    return ok;
+  }
+
+
+  LIBRARY_API void HandShmLink::wake ()
+  {
+    if (recvSem_ != NULL)
+    {
+      ulapi_sem_give(recvSem_);
+    }
+  }
+
+
+  LIBRARY_API void HandShmLink::publish (const handFeedback &feedback)
+  {
+    if (segment_ != NULL && server_)
+    {
+      segment_->feedback.write(feedback);
+    }
+  }
+
+
+  LIBRARY_API unsigned long HandShmLink::feedback (handFeedback &feedback)
+  {
+    if (segment_ == NULL)
+    {
+      return 0;
+    }
+    return segment_->feedback.read(feedback);
+  }
+
+} // crpi_robot
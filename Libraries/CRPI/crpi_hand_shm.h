@@ -0,0 +1,179 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_hand_shm.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Shared-memory link between CRPI hand drivers and hand servers running on
+//  the same computer.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_HAND_SHM_H
+#define CRPI_HAND_SHM_H
+
+#include "crpi.h"
+#include "ulapi.h"
+
+#pragma warning (disable: 4251)
+
+#define HAND_SHM_MAGIC 0x43525048   //! 'CRPH', set by the server once the segment is ready
+#define HAND_SHM_VERSION 1
+#define HAND_SHM_SLOTS 64           //! Messages that may be queued in each direction
+#define HAND_SHM_MESSAGE 256        //! Largest message (bytes, including the terminating NUL)
+#define HAND_SHM_JOINTS 16          //! Joint values in the feedback block
+#define HAND_SHM_TIMEOUT 1.0        //! Default wait for the server or for free ring space (s)
+
+//! Default keys.  A link uses its key and the key above it, so keys must be at least 2 apart.
+#define HAND_SHM_KEY_ALLEGRO 6008   //! Allegro hand (6008 and 6009)
+#define HAND_SHM_KEY_SDH 6010       //! Schunk SDH (6010 and 6011)
+
+//! Message channels.  These replace the separate loopback sockets used by the TCP transport.
+#define HAND_CHANNEL_CONFIG 0       //! Controller and planner selection, set points
+#define HAND_CHANNEL_PARAMS 1       //! Controller parameters
+
+namespace crpi_robot
+{
+  //! @brief Feedback published by the hand server
+  //!
+  struct LIBRARY_API handFeedback
+  {
+    //! @brief Joint positions in the server's native units
+    //!
+    double joints[HAND_SHM_JOINTS];
+
+    //! @brief Cartesian pose and force (X, Y, Z, XR, YR, ZR)
+    //!
+    double pose[6], force[6];
+  };
+
+  //! @brief One queued message
+  //!
+  struct handShmMessage
+  {
+    unsigned int channel;
+    unsigned int length;
+    char data[HAND_SHM_MESSAGE];
+  };
+
+  //! @brief Single-producer, single-consumer message ring
+  //!
+  //! @note head is only written by the producer and tail only by the consumer, so neither side
+  //!       takes a lock.  They are kept on separate cache lines.
+  //!
+  struct handShmRing
+  {
+    std::atomic<unsigned int> head;
+    char padHead[64 - sizeof(std::atomic<unsigned int>)];
+    std::atomic<unsigned int> tail;
+    char padTail[64 - sizeof(std::atomic<unsigned int>)];
+    handShmMessage slots[HAND_SHM_SLOTS];
+  };
+
+  //! @brief Layout of the shared segment
+  //!
+  struct handShmSegment
+  {
+    std::atomic<unsigned int> magic;
+    unsigned int version;
+    handShmRing commands;
+    handShmRing replies;
+    CrpiStateCache<handFeedback> feedback;
+  };
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Shared-memory transport for hand drivers and hand servers on the same computer
+  //!
+  //! @note Commands travel from driver to server and replies from server to driver through
+  //!       lock-free rings; joint, pose, and force feedback is a seqlock block that the driver
+  //!       reads without a round trip.  A semaphore per direction wakes a blocked receiver.
+  //!       One driver process and one server process may share a key.
+  //!
+  class LIBRARY_API HandShmLink
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    HandShmLink ();
+
+    //! @brief Default destructor
+    //!
+    ~HandShmLink ();
+
+    //! @brief Attach to the shared segment
+    //!
+    //! @param key     Shared memory key; key and key + 1 are also used for the semaphores, so
+    //!                the keys of two links must differ by at least 2
+    //! @param server  True for the hand server, which initializes the segment, false for a driver
+    //! @param timeout How long a driver waits for the server to initialize the segment (s)
+    //!
+    //! @return True if the link is ready, false otherwise (a driver should fall back to TCP)
+    //!
+    bool open (int key, bool server, double timeout = HAND_SHM_TIMEOUT);
+
+    //! @brief Detach from the shared segment
+    //!
+    void close ();
+
+    //! @brief Whether or not the link is open and the server is present
+    //!
+    bool connected ();
+
+    //! @brief Queue a message for the other side (commands from a driver, replies from a server)
+    //!
+    //! @param channel The message channel (HAND_CHANNEL_*)
+    //! @param message NUL-terminated message text
+    //!
+    //! @return True if the message was queued, false if the link is closed or the ring stayed
+    //!         full for HAND_SHM_TIMEOUT seconds
+    //!
+    bool send (int channel, const char *message);
+
+    //! @brief Take the next message from the other side
+    //!
+    //! @param channel Set to the message channel
+    //! @param message Buffer populated with the NUL-terminated message text
+    //! @param size    Size of the message buffer
+    //! @param timeout How long to wait (s); a negative value blocks until the other side queues a
+    //!                message or wake() is called
+    //!
+    //! @return True if a message was received, false otherwise (a blocking receive may also
+    //!         return false after a wake-up with nothing queued)
+    //!
+    bool receive (int &channel, char *message, int size, double timeout);
+
+    //! @brief Release a receiver blocked in receive() (used when shutting a server down)
+    //!
+    void wake ();
+
+    //! @brief Publish new feedback (server only)
+    //!
+    void publish (const handFeedback &feedback);
+
+    //! @brief Copy the most recent feedback
+    //!
+    //! @return The number of feedback blocks published so far (0 if none)
+    //!
+    unsigned long feedback (handFeedback &feedback);
+
+  private:
+    void *shm_;
+    void *sendSem_;
+    void *recvSem_;
+    handShmSegment *segment_;
+    handShmRing *out_;
+    handShmRing *in_;
+    bool server_;
+    ulapi_mutex_struct *sendLock_;
+    ulapi_mutex_struct *recvLock_;
+  }; // HandShmLink
+
+} // crpi_robot
+
+#endif
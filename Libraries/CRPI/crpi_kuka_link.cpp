@@ -0,0 +1,329 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_kuka_link.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Framed serial and TCP transport between CrpiKukaLWR and the KRL command
+//  interpreter.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_kuka_link.h"
+#include <string.h>
+
+using namespace std;
+
+namespace crpi_robot
+{
+  void kukaReceiveThread (void *param)
+  {
+    ((KukaLink*)param)->receive();
+  }
+
+
+  LIBRARY_API KukaLink::KukaLink () :
+    runThread_(false),
+    receiving_(false),
+    socket_(-1),
+    serial_(NULL),
+    task_(NULL),
+    nextSeq_(0),
+    answerSeq_(0)
+  {
+    memset(slots_, 0, sizeof(slots_));
+    lock_ = ulapi_mutex_new(49);
+  }
+
+
+  LIBRARY_API KukaLink::~KukaLink ()
+  {
+    close();
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API bool KukaLink::attach (ulapi_integer socket)
+  {
+    close();
+
+    if (socket < 0)
+    {
+      return false;
+    }
+    socket_ = socket;
+    ulapi_socket_set_blocking(socket_);
+
+    runThread_ = receiving_ = true;
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, kukaReceiveThread, this, ulapi_prio_lowest(), 0);
+    return true;
+  }
+
+
+  LIBRARY_API bool KukaLink::openSerial (const char *port, int baud)
+  {
+    close();
+
+    if ((serial_ = ulapi_serial_new()) == NULL)
+    {
+      return false;
+    }
+    if (ulapi_serial_open(port, serial_) != ULAPI_OK ||
+        ulapi_serial_baud(serial_, baud) != ULAPI_OK ||
+        ulapi_serial_set_nonblocking(serial_) != ULAPI_OK)
+    {
+      ulapi_serial_delete(serial_);
+      serial_ = NULL;
+      return false;
+    }
+
+    runThread_ = receiving_ = true;
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, kukaReceiveThread, this, ulapi_prio_lowest(), 0);
+    return true;
+  }
+
+
+  LIBRARY_API void KukaLink::close ()
+  {
+    runThread_ = false;
+    if (socket_ >= 0)
+    {
+      //! Releases the receive thread from its blocking read
+      ulapi_socket_close(socket_);
+      socket_ = -1;
+    }
+
+    //! The serial receive thread polls, so let it finish before the port is closed
+    for (int i = 0; i < 1000 && receiving_; ++i)
+    {
+      Sleep(1);
+    }
+
+    if (serial_ != NULL)
+    {
+      ulapi_serial_close(serial_);
+      ulapi_serial_delete(serial_);
+      serial_ = NULL;
+    }
+
+    ulapi_mutex_take(lock_);
+    memset(slots_, 0, sizeof(slots_));
+    answerSeq_ = nextSeq_;
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API bool KukaLink::connected ()
+  {
+    return runThread_ && (socket_ >= 0 || serial_ != NULL);
+  }
+
+
+  LIBRARY_API int KukaLink::request (const char *frame, int length)
+  {
+    unsigned int seq;
+    kukaTransaction *slot;
+    bool ok;
+
+    if (!connected())
+    {
+      return -1;
+    }
+
+    ulapi_mutex_take(lock_);
+    seq = nextSeq_;
+    slot = &slots_[seq % KUKA_PENDING];
+    if ((seq - answerSeq_) >= KUKA_PENDING || slot->state != 0)
+    {
+      //! Too many requests in flight
+      ulapi_mutex_give(lock_);
+      return -1;
+    }
+
+    slot->state = 1;
+    slot->seq = seq & 0x7FFFFFFF;
+    slot->sent = ulapi_time();
+    slot->size = 0;
+    slot->reply[0] = '\0';
+
+    //! Send under the lock so that requests are not interleaved and are queued in the order in
+    //! which the controller will answer them
+    if (serial_ != NULL)
+    {
+      ok = (ulapi_serial_write(serial_, frame, length) == length);
+    }
+    else
+    {
+      ok = (ulapi_socket_write(socket_, frame, length) == length);
+    }
+
+    if (ok)
+    {
+      nextSeq_ = seq + 1;
+    }
+    else
+    {
+      slot->state = 0;
+    }
+    ulapi_mutex_give(lock_);
+
+    //! Sequence numbers are returned as non-negative integers
+    return ok ? (int)(seq & 0x7FFFFFFF) : -1;
+  }
+
+
+  LIBRARY_API bool KukaLink::wait (int seq, double timeout, char *reply)
+  {
+    double start = ulapi_time();
+    kukaTransaction *slot;
+
+    if (seq < 0)
+    {
+      return false;
+    }
+    slot = &slots_[(unsigned int)seq % KUKA_PENDING];
+
+    while (true)
+    {
+      ulapi_mutex_take(lock_);
+      if (slot->state == 2 && slot->seq == (unsigned int)seq)
+      {
+        if (reply != NULL)
+        {
+          memcpy(reply, slot->reply, slot->size + 1);
+        }
+        slot->state = 0;
+        ulapi_mutex_give(lock_);
+        return true;
+      }
+      if (slot->state != 1 || slot->seq != (unsigned int)seq)
+      {
+        //! Unknown or reclaimed request
+        ulapi_mutex_give(lock_);
+        return false;
+      }
+      if ((ulapi_time() - start) > timeout || !runThread_)
+      {
+        //! Keep the slot in line until its reply arrives so that the reply is not handed to a
+        //! later request
+        slot->state = 3;
+        ulapi_mutex_give(lock_);
+        return false;
+      }
+      ulapi_mutex_give(lock_);
+      Sleep(1);
+    }
+  }
+
+
+  LIBRARY_API int KukaLink::pending ()
+  {
+    int count;
+
+    ulapi_mutex_take(lock_);
+    count = (int)(nextSeq_ - answerSeq_);
+    ulapi_mutex_give(lock_);
+    return count;
+  }
+
+
+  LIBRARY_API void KukaLink::receive ()
+  {
+    char *buffer = new char[KUKA_FRAME + 1];
+    int have = 0;
+    int get, start, i;
+
+    while (runThread_)
+    {
+      if (serial_ != NULL)
+      {
+        get = ulapi_serial_read(serial_, buffer + have, KUKA_FRAME - have);
+        if (get <= 0)
+        {
+          //! Nothing available yet
+          Sleep(1);
+          continue;
+        }
+      }
+      else
+      {
+        get = ulapi_socket_read(socket_, buffer + have, KUKA_FRAME - have);
+        if (get <= 0)
+        {
+          //! Connection closed or broken
+          break;
+        }
+      }
+      have += get;
+
+      //! Deliver every complete reply; empty lines (ex. the LF of a CR LF pair) are skipped
+      start = 0;
+      for (i = 0; i < have; ++i)
+      {
+        if (buffer[i] != '\0' && buffer[i] != '\r' && buffer[i] != '\n')
+        {
+          continue;
+        }
+        if (i > start)
+        {
+          buffer[i] = '\0';
+          deliver(buffer + start, i - start);
+        }
+        start = i + 1;
+      }
+
+      if (start == 0 && have == KUKA_FRAME)
+      {
+        //! No terminator in a full buffer:  framing was lost, drop it and resynchronize on the
+        //! next terminator
+        have = 0;
+      }
+      else if (start > 0)
+      {
+        have -= start;
+        memmove(buffer, buffer + start, have);
+      }
+    }
+
+    runThread_ = false;
+    delete [] buffer;
+    receiving_ = false;
+  }
+
+
+  LIBRARY_API void KukaLink::deliver (const char *reply, int size)
+  {
+    kukaTransaction *slot;
+
+    ulapi_mutex_take(lock_);
+    if (answerSeq_ == nextSeq_)
+    {
+      //! Nothing outstanding:  unsolicited or belongs to a request already given up on
+      ulapi_mutex_give(lock_);
+      return;
+    }
+
+    slot = &slots_[answerSeq_ % KUKA_PENDING];
+    ++answerSeq_;
+    if (slot->state == 1)
+    {
+      memcpy(slot->reply, reply, size);
+      slot->reply[size] = '\0';
+      slot->size = size;
+      slot->state = 2;
+    }
+    else
+    {
+      //! The waiter timed out; drop the late reply
+      slot->state = 0;
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+} // crpi_robot
@@ -0,0 +1,143 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_kuka_link.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Framed serial and TCP transport between CrpiKukaLWR and the KRL command
+//  interpreter.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef KUKA_LINK_H
+#define KUKA_LINK_H
+
+#include "crpi.h"
+#include "ulapi.h"
+
+#pragma warning (disable: 4251)
+
+//! Requests are NUL-terminated strings (serial text or CRPIData XML).  The KRL interpreter
+//! handles them in order and answers each with one line of text terminated by a NUL, carriage
+//! return, or newline, so replies are matched to requests by their order.
+#define KUKA_FRAME 1024             //! Longest reply, including the terminator
+#define KUKA_PENDING 16             //! Requests that may be in flight at once
+#define KUKA_TIMEOUT 1.0            //! Default wait for the reply to a setting or query (s)
+#define KUKA_MOTION_TIMEOUT 60.0    //! Default wait for the reply to a motion or tool command (s)
+
+namespace crpi_robot
+{
+  //! @brief One request awaiting its reply
+  //!
+  struct LIBRARY_API kukaTransaction
+  {
+    //! @brief Slot state (0 = free, 1 = awaiting reply, 2 = reply received, 3 = abandoned by a
+    //!        waiter that timed out; the reply is still expected and is dropped)
+    //!
+    int state;
+
+    //! @brief Sequence number of the request
+    //!
+    unsigned int seq;
+
+    //! @brief Time (from ulapi_time) at which the request was sent
+    //!
+    double sent;
+
+    //! @brief Reply text (NUL-terminated) and its length
+    //!
+    char reply[KUKA_FRAME];
+    int size;
+  };
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Pipelined request/reply transport to the KRL interpreter over serial or TCP
+  //!
+  //! @note Requests may be issued from any thread without waiting for earlier replies; a
+  //!       background thread reads replies and hands each to the oldest outstanding request.
+  //!       A request whose waiter times out keeps its place so that its late reply cannot be
+  //!       taken for the reply to a later request.  It is freed only when that reply arrives
+  //!       (however late, ex. behind a long motion) or the connection is closed.
+  //!
+  class LIBRARY_API KukaLink
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    KukaLink ();
+
+    //! @brief Default destructor
+    //!
+    ~KukaLink ();
+
+    //! @brief Use an open TCP connection to the controller (closed by the link)
+    //!
+    bool attach (ulapi_integer socket);
+
+    //! @brief Open a serial port to the controller
+    //!
+    //! @param port The serial port name (ex. "COM7" or "/dev/ttyS0")
+    //! @param baud The baud rate
+    //!
+    bool openSerial (const char *port, int baud);
+
+    //! @brief Stop the receive thread and close the connection
+    //!
+    void close ();
+
+    //! @brief Whether or not the controller is reachable
+    //!
+    bool connected ();
+
+    //! @brief Send a request without waiting for its reply
+    //!
+    //! @param frame  The request
+    //! @param length The number of bytes to send (including the NUL terminator)
+    //!
+    //! @return The sequence number of the request, or -1 if it could not be sent
+    //!
+    int request (const char *frame, int length);
+
+    //! @brief Wait for the reply to a request
+    //!
+    //! @param seq     Sequence number returned by request()
+    //! @param timeout How long to wait (s)
+    //! @param reply   Buffer of at least KUKA_FRAME bytes populated with the reply (may be NULL)
+    //!
+    //! @return True if the reply arrived in time, false otherwise
+    //!
+    bool wait (int seq, double timeout, char *reply = NULL);
+
+    //! @brief Number of requests sent but not yet answered
+    //!
+    int pending ();
+
+    //! @brief Read replies and match them to requests (thread body)
+    //!
+    void receive ();
+
+  private:
+    //! @brief Hand one reply to the oldest outstanding request
+    //!
+    void deliver (const char *reply, int size);
+
+    bool runThread_;
+    bool receiving_;
+    ulapi_integer socket_;
+    void *serial_;
+    void *task_;
+    ulapi_mutex_struct *lock_;
+    unsigned int nextSeq_;
+    unsigned int answerSeq_;
+    kukaTransaction slots_[KUKA_PENDING];
+  }; // KukaLink
+
+} // crpi_robot
+
+#endif
@@ -5,6 +5,7 @@
 //  Workfile:        crpi_kuka_lwr.cpp
 //  Revision:        1.0 - 13 March, 2014
 //                   1.1 - 16 June, 2014   Updated to use ulapi serial drivers
+//                   1.2 - 18 October, 2026 Pipelined requests through KukaLink
 //  Author:          J. Marvel
 //
 //  Description
@@ -14,179 +15,255 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "crpi_kuka_lwr.h"
+#include "crpi_watchdog.h"
 #include <fstream>
 
 using namespace std;
 
-//#define STATIC_ //! Uncomment this line if you want to hard code the serial port (debugging purposes only)
-
 //#define LWR_NOISY
 
+//! Observer stream settings:  receive buffer size (bytes), the bounds (ms) of the exponential
+//! reconnect backoff, and the age (s) after which cached feedback is no longer used
+#define KUKA_STREAM_BUFFER 1024
+#define KUKA_BACKOFF_MIN 100
+#define KUKA_BACKOFF_MAX 5000
+#define KUKA_STATE_STALE 0.5
+
 namespace crpi_robot
 {
-  void livemanLWR (void *param)
+  //! @brief Keepalive heartbeat:  report the age of the newest feedback without touching the
+  //!        KRL channel, which may be held by a motion for as long as it runs
+  //!
+  bool heartbeatLWR (void *param, double &feedbackTime)
   {
-    keepalive *ka = (keepalive*)param;
-    robotPose pose;
-    crpi_timer timer;
+    kukaObserver *obs = (kukaObserver*)param;
+    kukaState state;
+    bool healthy;
+
+    if (obs->cache.read(state) > 0)
+    {
+      for (int group = 0; group < KUKA_STATE_GROUPS; ++group)
+      {
+        if (state.time[group] > feedbackTime)
+        {
+          feedbackTime = state.time[group];
+        }
+      }
+    }
 
-    while (ka->runThread)
+    ulapi_mutex_take(obs->lock);
+    if (obs->polled > feedbackTime)
     {
-      ((CrpiKukaLWR*)ka->rob)->GetRobotPose (&pose);
-      //! Don't slam your processor!  You don't need to poll at full speed.
-      timer.waitUntil(5000);
+      feedbackTime = obs->polled;
     }
-    return;
+    //! Connected to the observer stream if one is configured, otherwise answering polls
+    healthy = (obs->params.obs_tcp_ip_port > 0 ? obs->client >= 0 : feedbackTime > 0.0);
+    ulapi_mutex_give(obs->lock);
+    return healthy;
   }
 
-  void observerLWR(void *param)
+  //! @brief Parse one observer message ("<type> v1 v2 ...") into its feedback group and values
+  //!
+  //! @param mssg   The NUL-terminated message
+  //! @param values Array of KUKA_STATE_VALUES values populated by this function (unused values
+  //!               are set to zero)
+  //!
+  //! @return The feedback group (KUKA_STATE_*), or -1 if the message is not recognized
+  //!
+  int parseObserverMessage (const char *mssg, double *values)
   {
-    /*
-      Connect to observer 
-      Create broadcast server
-      Loop
-        Read values from observer
-        Broadcast values
-    
-    */
+    char *end;
+    int group, i;
 
+    while (*mssg == ' ')
+    {
+      ++mssg;
+    }
 
-    /*
-      //! Run as client
-    //cout << "Connect to which address (xxx.xxx.xxx.xxx)? : ";
-    //cin >> inbuffer;
+    switch (*mssg)
+    {
+    case 'C':
+      group = KUKA_STATE_POSE;
+      break;
+    case 'A':
+      group = KUKA_STATE_AXES;
+      break;
+    case 'F':
+      group = KUKA_STATE_FORCES;
+      break;
+    case 'T':
+      group = KUKA_STATE_TORQUES;
+      break;
+    case 'S':
+      group = KUKA_STATE_IO;
+      break;
+    default:
+      return -1;
+    }
 
-//    server = ulapi_socket_get_client_id (6009, inbuffer);
-    //server = ulapi_socket_get_client_id (1025, inbuffer);
-    server = ulapi_socket_get_client_id(1025, "169.254.152.3");
-    if (server < 0)
+    //! Skip the rest of the type token (the command channel pads it to three characters)
+    while (*mssg != '\0' && *mssg != ' ')
     {
-      cout << "could not connect" << endl;
-      return;
+      ++mssg;
     }
-    else
+
+    for (i = 0; i < KUKA_STATE_VALUES; ++i)
+    {
+      values[i] = strtod(mssg, &end);
+      if (end == mssg)
+      {
+        break;
+      }
+      mssg = end;
+    }
+    if (i == 0)
     {
-      cout << "connected..." << endl;
-      cout << ulapi_socket_set_blocking(server) << endl;
-      cout << server << endl;
+      return -1;
     }
-    
-    //! ABB Test
-    timer timmytime;
+    for (; i < KUKA_STATE_VALUES; ++i)
+    {
+      values[i] = 0.0f;
+    }
+    return group;
+  }
+
 
-    int counter = 0;
-    char buffer[63];
-    while (true)
+  //! @brief Consume the KRL observer stream and publish it to the observer cache
+  //!
+  //! @note The observer sends one message per feedback group, in the same space-delimited form
+  //!       returned by the command channel and prefixed with the request letter ('C', 'A', 'F',
+  //!       'T', or 'S').  Messages are terminated by a newline, carriage return, or NUL, and each
+  //!       is published as soon as it is complete.
+  //!
+  void observerLWR (void *param)
+  {
+    kukaObserver *obs = (kukaObserver*)param;
+    ulapi_integer id;
+    char *buffer;
+    double values[KUKA_STATE_VALUES];
+    kukaState state;
+    int backoff = KUKA_BACKOFF_MIN;
+    int have = 0;
+    int start, get, i, group;
+
+    memset(&state, 0, sizeof(kukaState));
+    buffer = new char[KUKA_STREAM_BUFFER + 1];
+
+    while (obs->runThread)
     {
-      int jj;
-      //      ulapi_socket_write(server, "1", 1);
-      for ( jj = 0; jj < 62; ++jj)
+      if (obs->client < 0)
       {
-      
-        get = ulapi_socket_read(server, inbuffer, REQUEST_MSG_SIZE);
-        buffer[jj] = inbuffer[0];
+        if (obs->params.obs_tcp_ip_client)
+        {
+          //! The observer listens; connect to it
+          id = ulapi_socket_get_client_id(obs->params.obs_tcp_ip_port, obs->params.obs_tcp_ip_addr);
+        }
+        else
+        {
+          //! Wait for the observer to connect to us
+          if (obs->server < 0)
+          {
+            id = ulapi_socket_get_server_id(obs->params.obs_tcp_ip_port);
+            ulapi_mutex_take(obs->lock);
+            obs->server = id;
+            ulapi_mutex_give(obs->lock);
+          }
+          id = (obs->server < 0 || !obs->runThread ? -1 : ulapi_socket_get_connection_id(obs->server));
+        }
+
+        if (id < 0)
+        {
+          Sleep(backoff);
+          backoff = ((backoff * 2) > KUKA_BACKOFF_MAX ? KUKA_BACKOFF_MAX : (backoff * 2));
+          continue;
+        }
+        ulapi_socket_set_blocking(id);
+        ulapi_mutex_take(obs->lock);
+        obs->client = id;
+        ulapi_mutex_give(obs->lock);
+        backoff = KUKA_BACKOFF_MIN;
+        have = 0;
       }
 
+      get = (obs->runThread ? ulapi_socket_read(obs->client, buffer + have, KUKA_STREAM_BUFFER - have) : 0);
+      if (get <= 0)
+      {
+        //! Connection closed or broken
+        ulapi_mutex_take(obs->lock);
+        ulapi_socket_close(obs->client);
+        obs->client = -1;
+        ulapi_mutex_give(obs->lock);
+        continue;
+      }
+      have += get;
 
-      //inbuffer[get] = '\0';
-      buffer[jj] = '\0';
-      //if (get > 2)
+      //! Publish every complete message in the buffer
+      start = 0;
+      for (i = 0; i < have; ++i)
       {
-        cout << buffer << endl;
-      }  
-    
-    */
+        if (buffer[i] != '\n' && buffer[i] != '\r' && buffer[i] != '\0')
+        {
+          continue;
+        }
 
-    keepalive *ka = (keepalive*)param;
-    robotPose pose;
-    crpi_timer timer;
+        buffer[i] = '\0';
+        if ((group = parseObserverMessage(buffer + start, values)) >= 0)
+        {
+          memcpy(state.values[group], values, sizeof(values));
+          state.time[group] = ulapi_time();
+          obs->cache.write(state);
+        }
+        start = i + 1;
+      }
+
+      if (start == 0 && have == KUKA_STREAM_BUFFER)
+      {
+        //! No terminator in a full buffer:  not an observer stream, drop it
+        have = 0;
+      }
+      else if (start > 0)
+      {
+        have -= start;
+        memmove(buffer, buffer + start, have);
+      }
+    }
 
-    while (ka->runThread)
+    ulapi_mutex_take(obs->lock);
+    if (obs->client >= 0)
     {
-      ((CrpiKukaLWR*)ka->rob)->GetRobotPose(&pose);
-      //! Don't slam your processor!  You don't need to poll at full speed.
-      timer.waitUntil(5000);
+      ulapi_socket_close(obs->client);
+      obs->client = -1;
     }
-    return;
+    if (obs->server >= 0)
+    {
+      ulapi_socket_close(obs->server);
+      obs->server = -1;
+    }
+    obs->running = false;
+    ulapi_mutex_give(obs->lock);
+    delete [] buffer;
   }
 
 
   LIBRARY_API CrpiKukaLWR::CrpiKukaLWR (CrpiRobotParams &params)
   {
-    mssgBuffer_ = new char[8192];
+    obsTask_ = NULL;
 
-#ifndef OLDSERIAL
     if (ULAPI_OK != ulapi_init())
     {
 #ifdef LWR_NOISY
       printf("ulapi_init error\n");
 #endif
     }
-#endif
-
-#ifndef STATIC_
 
     params_ = params;
     ka_.handle = ulapi_mutex_new(99);
 
     if (params_.use_serial)
     {
-#ifdef OLDSERIAL
-      serial_ = new serial();
-#else
-      if (NULL == (serialID_ = ulapi_serial_new()))
-      {
-#ifdef LWR_NOISY
-        printf ("\nCannot create serial object\n");
-#endif
-      }
-#endif
-
-#ifdef LWR_NOISY
-        printf ("%s : ", COMChannel_);
-#endif
-
-#ifdef OLDSERIAL
-      serialData_.setChannel (params_.serial_port);
-#else
-      if (ulapi_serial_open(COMChannel_, serialID_) == ULAPI_OK)
-      {
-#ifdef LWR_NOISY
-        printf ("Opened COM channel\n");
-#endif
-      }
-      else
-      {
-#ifdef LWR_NOISY
-        printf ("Could not open COM channel\n");
-#endif
-      }
-#endif
-
-#ifdef OLDSERIAL
-      serialData_.setBaud (params_.serial_rate);
-#else
-      if (ulapi_serial_baud(serialID_, val) == ULAPI_OK)
-      {
-#ifdef LWR_NOISY
-        printf ("Set BAUD rate successful\n");
-#endif
-      }
-      else
-      {
-#ifdef LWR_NOISY
-        printf ("Could not set BAUD rate\n");
-#endif
-      }
-#endif
-
-#ifdef OLDSERIAL
-      serialData_.setParity(params_.serial_parity_even);
-      serialData_.setStopBits(params_.serial_sbits);
-#endif
-
-#ifdef OLDSERIAL
-      if (serial_->attach(serialData_))
+      //! Parity and stop bits are left at the port defaults, which the ulapi serial driver does not
+      //! expose
+      if (link_.openSerial(params_.serial_port, params_.serial_rate))
       {
 #ifdef LWR_NOISY
         printf ("serial connection to arm successful\n");
@@ -198,23 +275,6 @@ namespace crpi_robot
         printf ("serial connection to arm failed\n");
 #endif
       }
-#else
-      if (ulapi_serial_set_nonblocking(serialID_) == ULAPI_OK) //set_nonblocking
-      {
-#ifdef LWR_NOISY
-        printf ("Set serial port blocking okay\n");
-#endif
-      }
-      else
-      {
-#ifdef LWR_NOISY
-        printf ("Could not set serial port blocking\n");
-#endif
-      }
-      val = ulapi_serial_write(serialID_,
-                                "TBx 1.00000000 0.00000000 0.00000000 0.00000000 0.00000000",
-                                strlen("TBx 1.00000000 0.00000000 0.00000000 0.00000000 0.00000000"));
-#endif        
     } // if (params_.use_serial)
     else
     {
@@ -224,49 +284,71 @@ namespace crpi_robot
       printf ("Waiting for connection...\n");
       server_ = ulapi_socket_get_server_id(params_.tcp_ip_port);
       client_ = ulapi_socket_get_connection_id(server_);
-      ulapi_socket_set_blocking(client_);
-
-      task = ulapi_task_new();
-      ka_.rob = this;
-      ka_.runThread = true;
-
-      ulapi_task_start((ulapi_task_struct*)task, livemanLWR, &ka_, ulapi_prio_lowest(), 0);
+      link_.attach(client_);
     }
-#else
-    bool test;
-    test = serialData_.setBaud (57600);
-    test &= serialData_.setChannel (1);
-    serialUsed_ = true;
-#endif
-
-    feedback_ = new double[10];
-    tempData_ = new vector<string>(10, " ");
+    //! Feedback comes from the observer stream when an observer is configured, so that state
+    //! queries do not wait behind motion commands on the KRL channel
+    observer_.params = params_;
+    observer_.runThread = true;
+    observer_.running = false;
+    observer_.server = observer_.client = -1;
+    observer_.lock = ulapi_mutex_new(61);
+    observer_.polled = 0.0;
+    if (params_.obs_tcp_ip_port > 0)
+    {
+      observer_.running = true;
+      obsTask_ = ulapi_task_new();
+      ulapi_task_start((ulapi_task_struct*)obsTask_, observerLWR, &observer_, ulapi_prio_lowest(), 0);
+    }
+    watchId_ = CrpiWatchdog::instance().add("KUKA LWR", WATCHDOG_PERIOD, heartbeatLWR, &observer_, 2.0 * WATCHDOG_PERIOD);
 
     angleUnits_ = DEGREE;
     lengthUnits_ = MM;
   }
 
 
+
   LIBRARY_API CrpiKukaLWR::~CrpiKukaLWR ()
   {
-    delete [] mssgBuffer_;
-    delete [] feedback_;
-    if (params_.use_serial)
+    CrpiWatchdog::instance().remove(watchId_);
+    observer_.runThread = false;
+    if (obsTask_ != NULL)
     {
-#ifdef OLDSERIAL
-      serial_->closeConnection(serialData_);
-#else
-      ulapi_serial_close(serialID_);
-      ulapi_serial_delete(serialID_);
-#endif
+      //! Release the observer from a blocking accept or read until it notices that it is to stop
+      //! (it may be between opening a socket and blocking on it), then wait for it to exit
+      while (true)
+      {
+        ulapi_mutex_take(observer_.lock);
+        if (!observer_.running)
+        {
+          ulapi_mutex_give(observer_.lock);
+          break;
+        }
+        if (observer_.client >= 0)
+        {
+          SocketRelease(observer_.client);
+        }
+        if (observer_.server >= 0)
+        {
+          SocketRelease(observer_.server);
+        }
+        ulapi_mutex_give(observer_.lock);
+        Sleep(1);
+      }
+      ulapi_task_join((ulapi_task_struct*)obsTask_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)obsTask_);
+      obsTask_ = NULL;
     }
-    else
+    ulapi_mutex_delete(observer_.lock);
+    link_.close();
+    if (!params_.use_serial)
     {
       ulapi_socket_close(server_);
     }
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::ApplyCartesianForceTorque (robotPose &robotForceTorque, vector<bool> activeAxes, vector<bool> manipulator)
   {
     //! TODO
@@ -283,42 +365,24 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiKukaLWR::SetTool (double percent)
   {
+    char reply[KUKA_FRAME];
+    int seq;
+
     ulapi_mutex_take(ka_.handle);
-    if (generateTool ('B', percent))
-    {
-      //! Send message to robot
-      if (!send ())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        //! error getting
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
-      if (mssgBuffer_[0] == '1')
-      {
-        return CANON_SUCCESS;
-      }
-      else
-      {
-        return CANON_FAILURE;
-      }
-    }
-    else
+    seq = (generateTool ('B', percent) ? send () : -1);
+    ulapi_mutex_give(ka_.handle);
+
+    //! Wait for the response from the robot outside of the lock so that other requests may be
+    //! sent in the meantime
+    if (!get (seq, KUKA_MOTION_TIMEOUT, reply))
     {
-      //! Error generating tool actuation message
-      ulapi_mutex_give(ka_.handle);
       return CANON_FAILURE;
     }
+    return (reply[0] == '1' ? CANON_SUCCESS : CANON_FAILURE);
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::Couple (const char *targetID)
   {
     std::vector<CrpiToolDef>::const_iterator itr;
@@ -334,41 +398,23 @@ namespace crpi_robot
       return CANON_FAILURE;
     }
 
+    char reply[KUKA_FRAME];
+    int seq;
+
     ulapi_mutex_take(ka_.handle);
-    if (generateTool('D', itr->toolID))
-    {
-      //! Send message to robot
-      if (!send ())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
-    }
-    else
-    {
-      ulapi_mutex_give(ka_.handle);
-      return CANON_FAILURE;
-    }
+    seq = (generateTool ('D', itr->toolID) ? send () : -1);
+    ulapi_mutex_give(ka_.handle);
 
-    if (mssgBuffer_[0] == '1')
-    {
-      return CANON_SUCCESS;
-    }
-    else
+    //! Wait for response from robot
+    if (!get (seq, KUKA_MOTION_TIMEOUT, reply))
     {
       return CANON_FAILURE;
     }
+    return (reply[0] == '1' ? CANON_SUCCESS : CANON_FAILURE);
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::Message (const char *message)
   {
     //! The KR C2 controller cannot display a message on the teach pendant, it seems
@@ -391,43 +437,24 @@ namespace crpi_robot
     target.push_back (0.0);
     target.push_back (0.0);
 
-    ulapi_mutex_take(ka_.handle);
     //! LIN, Cartesian, Absolute
-    if (generateMove ('L', 'C', 'A', target))
-    {
-      //! Send message to robot
-      if (!send ())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
+    char reply[KUKA_FRAME];
+    int seq;
 
-      if (mssgBuffer_[0] == '1')
-      {
-        return CANON_SUCCESS;
-      }
-      else
-      {
-        return CANON_FAILURE;
-      }
-    }
-    else
+    ulapi_mutex_take(ka_.handle);
+    seq = (generateMove ('L', 'C', 'A', target) ? send () : -1);
+    ulapi_mutex_give(ka_.handle);
+
+    //! Wait for response from robot
+    if (!get (seq, KUKA_MOTION_TIMEOUT, reply))
     {
-      //! Error generating motion message
-      ulapi_mutex_give(ka_.handle);
       return CANON_FAILURE;
     }
+    return (reply[0] == '1' ? CANON_SUCCESS : CANON_FAILURE);
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::MoveThroughTo (robotPose *poses,
                                                    int numPoses,
                                                    robotPose *accelerations,
@@ -468,197 +495,89 @@ namespace crpi_robot
     target.push_back (0.0);
 
     //! PTP, Cartesian, Absolute
-    //if (generateMove ('P', 'C', 'R', target)) //! JAM:  for initial testing purposes only
+    char reply[KUKA_FRAME];
+    int seq;
+
     ulapi_mutex_take(ka_.handle);
-    if (generateMove ('P', 'C', 'A', target))
-    {
-      //! Send message to robot
-      if (!send())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
-      if (mssgBuffer_[0] == '1')
-      {
-        return CANON_SUCCESS;
-      }
-      else
-      {
-        return CANON_FAILURE;
-      }
-    }
-    else
+    seq = (generateMove ('P', 'C', 'A', target) ? send () : -1);
+    ulapi_mutex_give(ka_.handle);
+
+    //! Wait for response from robot
+    if (!get (seq, KUKA_MOTION_TIMEOUT, reply))
     {
-      //! Error generating motion message
-      ulapi_mutex_give(ka_.handle);
       return CANON_FAILURE;
     }
+    return (reply[0] == '1' ? CANON_SUCCESS : CANON_FAILURE);
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::GetRobotAxes (robotAxes *axes)
   {
-    //! Construct request for axis information
+    double values[KUKA_STATE_VALUES];
 
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback ('A'))
+    if (!fetch ('A', 7, values))
     {
-      if (!send ())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      
-      //! Parse data
-      if (!parseFeedback (7))
-      {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
+      return CANON_FAILURE;
+    }
 
-      ulapi_mutex_give(ka_.handle);
-      try
-      {
-        for (int i = 0; i < axes->axes; ++i)
-        {
-          axes->axis.at(i) = feedback_[i];
-        }
-      }
-      catch (...)
+    try
+    {
+      for (int i = 0; i < axes->axes; ++i)
       {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
+        axes->axis.at(i) = values[i];
       }
-    } // if generateFeedback ('A')
-    else
+    }
+    catch (...)
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
+      //! probably an axis violation due to vector missmatch
       return CANON_FAILURE;
     }
     return CANON_SUCCESS;
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::GetRobotForces (robotPose *forces)
   {
-    //! Construct request for axis information
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback('F'))
-    {
-      if (!send())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get())
-      {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Parse data
-      if (!parseFeedback(6))
-      {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
+    double values[KUKA_STATE_VALUES];
 
-      try
-      {
-        forces->x = feedback_[0];
-        forces->y = feedback_[1];
-        forces->z = feedback_[2];
-        forces->zrot = feedback_[3];
-        forces->yrot = feedback_[4];
-        forces->xrot = feedback_[5];
-      }
-      catch (...)
-      {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
-      }
-    }
-    else
+    if (!fetch ('F', 6, values))
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
       return CANON_FAILURE;
     }
 
+    forces->x = values[0];
+    forces->y = values[1];
+    forces->z = values[2];
+    forces->zrot = values[3];
+    forces->yrot = values[4];
+    forces->xrot = values[5];
+
     return CANON_SUCCESS;
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::GetRobotIO (robotIO *io)
   {
-    //! Construct request for axis information
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback('S'))
+    double values[KUKA_STATE_VALUES];
+
+    if (!fetch ('S', 8, values))
     {
-      if (!send())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get())
-      {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Parse data
-      if (!parseFeedback(8))
-      {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
+      return CANON_FAILURE;
+    }
 
-      try
-      {
-        io->dio[0] = (feedback_[1] > 0.5f);
-        io->dio[1] = (feedback_[2] > 0.5f);
-        io->dio[2] = (feedback_[3] > 0.5f);
-        io->dio[3] = (feedback_[4] > 0.5f);
-        io->dio[4] = (feedback_[5] > 0.5f);
-        io->dio[5] = (feedback_[6] > 0.5f);
-        io->dio[6] = (feedback_[7] > 0.5f);
-      }
-      catch (...)
+    try
+    {
+      for (int i = 0; i < 7; ++i)
       {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
+        io->dio[i] = (values[i + 1] > 0.5f);
       }
     }
-    else
+    catch (...)
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
+      //! probably an axis violation due to vector missmatch
       return CANON_FAILURE;
     }
 
@@ -666,82 +585,50 @@ namespace crpi_robot
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::GetRobotPose (robotPose *pose)
   {
-    //! Construct request for axis information
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback ('C'))
+    double values[KUKA_STATE_VALUES];
+
+    if (!fetch ('C', 8, values))
     {
-      if (!send ())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Parse data
-      if (!parseFeedback (8))
-      {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
+      return CANON_FAILURE;
+    }
 
-      try
-      {
-        pose->x = feedback_[0];
-        pose->y = feedback_[1];
-        pose->z = feedback_[2];
-        pose->zrot = feedback_[3];
-        pose->yrot = feedback_[4];
-        pose->xrot = feedback_[5];
-        pose->status = (int)feedback_[6];
-        pose->turns = (int)feedback_[7];
-
-        if (lengthUnits_ == METER)
-        {
-          pose->x /= 1000.0f;
-          pose->y /= 1000.0f;
-          pose->z /= 1000.0f;
-        }
-        else if (lengthUnits_ == INCH)
-        {
-          pose->x /= 25.4f;
-          pose->y /= 25.4f;
-          pose->z /= 25.4f;
-        }
+    pose->x = values[0];
+    pose->y = values[1];
+    pose->z = values[2];
+    pose->zrot = values[3];
+    pose->yrot = values[4];
+    pose->xrot = values[5];
+    pose->status = (int)values[6];
+    pose->turns = (int)values[7];
 
-        if (angleUnits_ == RADIAN)
-        {
-          pose->zrot *= (3.141592654f / 180.0f);
-          pose->yrot *= (3.141592654f / 180.0f);
-          pose->xrot *= (3.141592654f / 180.0f);
-        }
-      }
-      catch (...)
-      {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
-      }
+    if (lengthUnits_ == METER)
+    {
+      pose->x /= 1000.0f;
+      pose->y /= 1000.0f;
+      pose->z /= 1000.0f;
     }
-    else
+    else if (lengthUnits_ == INCH)
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
-      return CANON_FAILURE;
+      pose->x /= 25.4f;
+      pose->y /= 25.4f;
+      pose->z /= 25.4f;
+    }
+
+    if (angleUnits_ == RADIAN)
+    {
+      pose->zrot *= (3.141592654f / 180.0f);
+      pose->yrot *= (3.141592654f / 180.0f);
+      pose->xrot *= (3.141592654f / 180.0f);
     }
 
     return CANON_SUCCESS;
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::GetRobotSpeed (robotPose *speed)
   {
     //! TODO
@@ -758,60 +645,34 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiKukaLWR::GetRobotTorques (robotAxes *torques)
   {
-    //! Construct request for axis information
-    ulapi_mutex_take(ka_.handle);
-    if (generateFeedback('T'))
+    double values[KUKA_STATE_VALUES];
+
+    if (!fetch ('T', 6, values))
     {
-      if (!send())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get())
-      {
-        //! error receiving
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Parse data
-      if (!parseFeedback(6))
-      {
-        //! Error parsing data
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
+      return CANON_FAILURE;
+    }
+
+    try
+    {
+      torques->axis.at(0) = values[0];
+      torques->axis.at(1) = values[1];
+      torques->axis.at(2) = 0.0f;
+      torques->axis.at(3) = values[2];
+      torques->axis.at(4) = values[3];
+      torques->axis.at(5) = values[4];
+      torques->axis.at(6) = values[5];
 
-      try
+      if (angleUnits_ == RADIAN)
       {
-        torques->axis.at(0) = feedback_[0];
-        torques->axis.at(1) = feedback_[1];
-        torques->axis.at(2) = 0.0f;
-        torques->axis.at(3) = feedback_[2];
-        torques->axis.at(4) = feedback_[3];
-        torques->axis.at(5) = feedback_[4];
-        torques->axis.at(6) = feedback_[5];
-
-        if (angleUnits_ == RADIAN)
+        for (int i = 0; i < 7; ++i)
         {
-          for (int i = 0; i < 7; ++i)
-          {
-            torques->axis.at(i) *= (3.141592654f / 180.0f);
-          }
+          torques->axis.at(i) *= (3.141592654f / 180.0f);
         }
       }
-      catch (...)
-      {
-        //! probably an axis violation due to vector missmatch
-        return CANON_FAILURE;
-      }
     }
-    else
+    catch (...)
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
+      //! probably an axis violation due to vector missmatch
       return CANON_FAILURE;
     }
 
@@ -819,6 +680,7 @@ namespace crpi_robot
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::MoveAttractor (robotPose &pose)
   {
     //! Construct message
@@ -834,44 +696,23 @@ namespace crpi_robot
     target.push_back (0.0);
     target.push_back (0.0);
 
+    char reply[KUKA_FRAME];
+    int seq;
+
     ulapi_mutex_take(ka_.handle);
-    if (generateMove ('L', 'F', 'A', target))
-    {
-      //! Send message to robot
-      if (!send ())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
+    seq = (generateMove ('L', 'F', 'A', target) ? send () : -1);
+    ulapi_mutex_give(ka_.handle);
 
-      if (mssgBuffer_[0] == '1')
-      {
-        return CANON_SUCCESS;
-      }
-      else
-      {
-        return CANON_FAILURE;
-      }
-    }
-    else
+    //! Wait for response from robot
+    if (!get (seq, KUKA_MOTION_TIMEOUT, reply))
     {
-      //! Error generating motion message
-      ulapi_mutex_give(ka_.handle);
       return CANON_FAILURE;
     }
-
-    return CANON_SUCCESS;
+    return (reply[0] == '1' ? CANON_SUCCESS : CANON_FAILURE);
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::MoveToAxisTarget (robotAxes &axes)
   {
     //! Construct message
@@ -882,35 +723,23 @@ namespace crpi_robot
     }
 
     //! PTP, Angular, Absolute
+    char reply[KUKA_FRAME];
+    int seq;
+
     ulapi_mutex_take(ka_.handle);
-    if (generateMove ('P', 'A', 'A', target))
-    {
-      //! Send message to robot
-      if (!send())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get ())
-      {
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
-    }
-    else
+    seq = (generateMove ('P', 'A', 'A', target) ? send () : -1);
+    ulapi_mutex_give(ka_.handle);
+
+    //! Wait for response from robot
+    if (!get (seq, KUKA_MOTION_TIMEOUT, reply))
     {
-      //! Error generating motion message
-      ulapi_mutex_give(ka_.handle);
       return CANON_FAILURE;
     }
-
     return CANON_SUCCESS;
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::SetAbsoluteAcceleration (double tolerance)
   {
     //! Not yet implemented
@@ -937,7 +766,7 @@ namespace crpi_robot
     }
     else
     {
-      CANON_FAILURE;
+      return CANON_FAILURE;
     }
 
     //! Not yet implemented
@@ -988,7 +817,7 @@ namespace crpi_robot
     }
     else
     {
-      CANON_FAILURE;
+      return CANON_FAILURE;
     }
     return CANON_REJECT;
   }
@@ -1030,34 +859,23 @@ namespace crpi_robot
   LIBRARY_API CanonReturn CrpiKukaLWR::SetRobotDO (int dig_out, bool val)
   {
     //! Construct digital signal output command
+    char reply[KUKA_FRAME];
+    int seq;
+
     ulapi_mutex_take(ka_.handle);
-    if (generateIO('D', dig_out, val))
-    {
-      //! Send message to robot
-      if (!send())
-      {
-        //! error sending
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      //! Wait for response from robot
-      if (!get())
-      {
-        ulapi_mutex_give(ka_.handle);
-        return CANON_FAILURE;
-      }
-      ulapi_mutex_give(ka_.handle);
-    }
-    else
+    seq = (generateIO('D', dig_out, val) ? send () : -1);
+    ulapi_mutex_give(ka_.handle);
+
+    //! Wait for response from robot
+    if (!get (seq, KUKA_TIMEOUT, reply))
     {
-      //! Error generating feedback request message
-      ulapi_mutex_give(ka_.handle);
       return CANON_FAILURE;
     }
     return CANON_SUCCESS;
   }
 
 
+
   LIBRARY_API CanonReturn CrpiKukaLWR::StopMotion (int condition)
   {
     //! Not yet implemented
@@ -1069,8 +887,7 @@ namespace crpi_robot
   {
     bool state = true;
     size_t found;
-    int extension = 0,
-        currLength = 0,
+    int currLength = 0,
         i = 0,
         j = 0;
 
@@ -1380,120 +1197,100 @@ namespace crpi_robot
   }
 
   
-  LIBRARY_API bool CrpiKukaLWR::send ()
+  LIBRARY_API int CrpiKukaLWR::send ()
   {
-    int x;
-    
-#ifdef LWR_NOISY
-    printf ("Sending message %s\n", moveMe_.str().c_str());
-    printf ("fflushhhhhh...\n");
-#endif
-    //fflush(NULL);
-#ifdef LWR_NOISY
-    printf ("flushed\n");
-#endif
-    if (params_.use_serial)
-    {
-      //! Use Serial
-#ifdef OLDSERIAL
-#ifdef LWR_NOISY
-    printf ("Sending...\n");
-#endif
-      serial_->sendData(moveMe_.str().c_str(), serialData_);
-#ifdef LWR_NOISY
-    printf ("Sent!\n");
-#endif
-#else
-      x = ulapi_serial_write(serialID_, moveMe_.str().c_str(), strlen(moveMe_.str().c_str())+1);
-#ifdef LWR_NOISY
-      printf ("%i\n", x);
-#endif
-#endif
-      return true;
-    }
-    else
-    {
-      //! Use TCP/IP
-      x = ulapi_socket_write(client_, moveMe_.str().c_str(), strlen(moveMe_.str().c_str())+1);
+    string mssg = moveMe_.str();
+
 #ifdef LWR_NOISY
-      printf ("%i\n", x);
+    printf ("Sending message %s\n", mssg.c_str());
 #endif
-      return true;
-    }
+    //! The NUL terminator is sent as well; the KRL interpreter uses it to delimit requests
+    return link_.request(mssg.c_str(), (int)strlen(mssg.c_str()) + 1);
   }
 
 
-  LIBRARY_API bool CrpiKukaLWR::get ()
+
+  LIBRARY_API bool CrpiKukaLWR::get (int seq, double timeout, char *reply)
   {
-    int x = 0;
+    bool ok = link_.wait(seq, timeout, reply);
 
 #ifdef LWR_NOISY
-      printf ("getting feedback...\n");
+    printf ("%s read\n", ok ? reply : "(no response)");
 #endif
+    return ok;
+  }
 
-    if (params_.use_serial)
-    {
-      //! Use serial
-#ifdef OLDSERIAL
-      serial_->getData (mssgBuffer_, serialData_, 285);
-#else
-      x = ulapi_serial_read(serialID_, mssgBuffer_, 8192);
-#endif
-#ifdef LWR_NOISY
-      printf ("%d %s read\n", x, mssgBuffer_);
-#endif
-      return true;
-    }
-    else
+
+
+  LIBRARY_API bool CrpiKukaLWR::parseFeedback (const char *reply, int num, double *values)
+  {
+    const char *ptr = reply;
+    char *end;
+
+    //! Values are space delimited
+    for (int i = 0; i < num; ++i)
     {
-      //! Use TCP/IP
-      x = ulapi_socket_read(client_, mssgBuffer_, 8192);
-#ifdef LWR_NOISY
-      printf ("%d %s read\n", x, mssgBuffer_);
-#endif
-      return true;
+      values[i] = strtod(ptr, &end);
+      if (end == ptr)
+      {
+        //! Fewer values than expected
+        return false;
+      }
+      ptr = end;
     }
+    return true;
   }
 
 
-  LIBRARY_API bool CrpiKukaLWR::parseFeedback (int num)
+
+  LIBRARY_API bool CrpiKukaLWR::fetch (char retType, int num, double *values)
   {
-    bool newItem = false;
-    int index = -1, i;
+    kukaState state;
+    char reply[KUKA_FRAME];
+    int group, seq;
 
-    for (i = 0; i < num; ++i)
+    switch (retType)
     {
-      tempData_->at(i) = "";
+    case 'C':
+      group = KUKA_STATE_POSE;
+      break;
+    case 'A':
+      group = KUKA_STATE_AXES;
+      break;
+    case 'F':
+      group = KUKA_STATE_FORCES;
+      break;
+    case 'T':
+      group = KUKA_STATE_TORQUES;
+      break;
+    case 'S':
+      group = KUKA_STATE_IO;
+      break;
+    default:
+      return false;
     }
 
-    //! REQUEST_MSG_SIZE is very large, feedback from robot is limited to 80 characters
-    for (i = 0; i < 80; ++i)
+    //! Answer from the observer cache without touching the command channel
+    if (obsTask_ != NULL && observer_.cache.read(state) > 0 &&
+        state.time[group] > 0.0 && (ulapi_time() - state.time[group]) < KUKA_STATE_STALE)
     {
-      if (mssgBuffer_[i] == ' ')
-      {
-        newItem = false;
-      }
-      else
-      {
-        if (!newItem)
-        {
-          newItem = true;
-          index++;
-          if( index >= num )
-          {
-            break;
-//            return false;
-          }
-        }
-        tempData_->at(index).push_back (mssgBuffer_[i]);
-      } // if (mssgBuffer_[i] == ' ') ... else
-    } //for (int i = 0; i < 65; ++i)
-  
-    //! Convert strings to floats
-    for (i = 0; i < num; ++i)
+      memcpy(values, state.values[group], num * sizeof(double));
+      return true;
+    }
+
+    //! No (recent) streamed feedback:  poll on the command channel
+    ulapi_mutex_take(ka_.handle);
+    seq = (generateFeedback (retType) ? send () : -1);
+    ulapi_mutex_give(ka_.handle);
+
+    if (!get (seq, KUKA_TIMEOUT, reply) || !parseFeedback (reply, num, values))
     {
-      feedback_[i] = stod (tempData_->at(i));
+      return false;
     }
+
+    ulapi_mutex_take(observer_.lock);
+    observer_.polled = ulapi_time();
+    ulapi_mutex_give(observer_.lock);
     return true;
   }
 
@@ -15,16 +15,9 @@
 #ifndef KUKA_LWR_H
 #define KUKA_LWR_H
 
-#define OLDSERIAL
-
-#ifdef OLDSERIAL
-#include "..\Serial\serial.h"
-using namespace Network;
-#else
 #include "ulapi.h"
-#endif
-
 #include "crpi.h"
+#include "crpi_kuka_link.h"
 
 #pragma warning (disable: 4251)
 
@@ -33,8 +26,65 @@ using namespace Network;
 
 using namespace std;
 
+//! Feedback groups streamed by the observer, by request letter (see generateFeedback)
+#define KUKA_STATE_POSE 0           //! 'C':  X Y Z A B C status turns
+#define KUKA_STATE_AXES 1           //! 'A':  A1 A2 E1 A3 A4 A5 A6
+#define KUKA_STATE_FORCES 2         //! 'F':  X Y Z A B C
+#define KUKA_STATE_TORQUES 3        //! 'T':  A1 A2 A3 A4 A5 A6
+#define KUKA_STATE_IO 4             //! 'S':  timestamp DI1..DI7
+#define KUKA_STATE_GROUPS 5
+#define KUKA_STATE_VALUES 10
+
 namespace crpi_robot
 {
+  //! @brief Latest feedback received from the LWR observer stream
+  //!
+  //! @note Plain data only so that it can be published through CrpiStateCache
+  //!
+  struct LIBRARY_API kukaState
+  {
+    //! @brief Values per feedback group, laid out as returned by the command channel
+    //!
+    double values[KUKA_STATE_GROUPS][KUKA_STATE_VALUES];
+
+    //! @brief Time (in seconds, from ulapi_time) at which each group was last received (0 if never)
+    //!
+    double time[KUKA_STATE_GROUPS];
+  };
+
+
+  //! @brief Shared data between CrpiKukaLWR and its observer thread
+  //!
+  struct LIBRARY_API kukaObserver
+  {
+    //! @brief Robot configuration parameters (observer address and port)
+    //!
+    CrpiRobotParams params;
+
+    //! @brief Terminator signal for the observer thread
+    //!
+    bool runThread;
+
+    //! @brief Whether the observer thread has yet to exit
+    //!
+    bool running;
+
+    //! @brief Sockets held by the observer thread (-1 if none), released to stop it while it
+    //!        is blocked on them, and the lock under which they are opened, closed, and released
+    //!
+    ulapi_integer server;
+    ulapi_integer client;
+    ulapi_mutex_struct *lock;
+
+    //! @brief Feedback published by the observer thread
+    //!
+    CrpiStateCache<kukaState> cache;
+
+    //! @brief Time (from ulapi_time) of the last feedback polled on the KRL channel (0 if
+    //!        never), guarded by lock
+    //!
+    double polled;
+  };
 
 
   //! @ingroup Robot
@@ -361,19 +411,20 @@ namespace crpi_robot
     CanonReturn StopMotion (int condition = 2);
 
   private:
-    //! @brief Whether or not we are using socket communications for message passing with the robot
-    //!
-    //bool serialUsed_;
-    char COMChannel_[5];
-#ifdef OLDSERIAL
-    serialStruct serialData_;
-    serial *serial_;
-#else
-    void *serialID_;
-#endif
-
-    void *task;
+    //! @brief Framed serial or TCP connection to the KRL interpreter
+    //!
+    KukaLink link_;
+
     keepalive ka_;
+
+    //! @brief Registration with the shared keepalive service
+    //!
+    int watchId_;
+
+    //! @brief Observer thread and its feedback cache
+    //!
+    void *obsTask_;
+    kukaObserver observer_;
     char IPAddr_[16];
     ulapi_integer server_;
     ulapi_integer client_;
@@ -390,14 +441,6 @@ namespace crpi_robot
     //!
     stringstream tempString_;
 
-    //! @brief Message buffer for serial and socket communications
-    //!
-    char *mssgBuffer_;
-
-    //! @brief Returned data from the robot
-    //!
-    double *feedback_;
-
     CanonAngleUnit angleUnits_;
     CanonLengthUnit lengthUnits_;
     CanonAngleUnit axialUnits_[7];
@@ -405,8 +448,6 @@ namespace crpi_robot
     double defaultSpeed_;
     double axial;
 
-    vector<string> *tempData_;
-
     //! @brief Generate a motion command for the Kuka LWR
     //!
     //! @param moveType  Specify the movement type, either PTP ('P'), LIN ('L'), or force control ('F')
@@ -440,11 +481,24 @@ namespace crpi_robot
 
     //! @brief Convert the received response string from the robot to a vector of floating point numbers
     //!
-    //! @param num The number of arguments to parse from the character string sent by the robot
+    //! @param reply  The response received from the robot
+    //! @param num    The number of arguments to parse from the character string sent by the robot
+    //! @param values Array of num values populated by this method
     //!
     //! @return True if parsing action was successful, false otherwise
     //!
-    bool parseFeedback (int num);
+    bool parseFeedback (const char *reply, int num, double *values);
+
+    //! @brief Retrieve one feedback group, from the observer cache when it is fresh and by
+    //!        polling the command channel otherwise
+    //!
+    //! @param retType Specify the return value (see generateFeedback)
+    //! @param num     The number of values to retrieve
+    //! @param values  Array of num values populated by this method
+    //!
+    //! @return True if feedback was retrieved, false otherwise
+    //!
+    bool fetch (char retType, int num, double *values);
 
     //! @brief Generate a tool activation request for the KUKA LWR
     //!
@@ -469,13 +523,22 @@ namespace crpi_robot
     //!
     bool generateParameter (char paramType, char subtype, vector<double> &input);
 
-    //! @brief Send content of moveMe_ to robot using whatever communication protocol is defined.  
+    //! @brief Send content of moveMe_ to robot without waiting for the response (ka_.handle must be
+    //!        held, since moveMe_ is shared)
+    //!
+    //! @return The sequence number of the request, or -1 if it could not be sent
     //!
-    bool send ();
+    int send ();
 
-    //! @brief Store data from robot in mssgBuffer_ using whatever communication protocol is defined
+    //! @brief Wait for the response to a request sent by send() (ka_.handle need not be held)
+    //!
+    //! @param seq     The sequence number returned by send()
+    //! @param timeout How long to wait (s)
+    //! @param reply   Buffer of KUKA_FRAME bytes populated with the response
+    //!
+    //! @return True if the response arrived in time, false otherwise
     //!
-    bool get ();
+    bool get (int seq, double timeout, char *reply);
   }; // CrpiKukaLWR
 
 } // namespace crpi_robot
@@ -0,0 +1,586 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_program.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Compiler and binary cache for collaborative robot programs.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <string.h>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include "crpi_program.h"
+
+using namespace std;
+using namespace Xml;
+
+//! Cache file signature, and the version of the layout that follows it
+#define CRPI_PLAN_MAGIC "CRPIPLAN"
+#define CRPI_PLAN_VERSION 1
+
+namespace crpi_robot
+{
+  //! @brief Append a value in host (little-endian) order
+  //!
+  template <class V> static inline void planPut (string &data, V value)
+  {
+    data.append((const char*)&value, sizeof(V));
+  }
+
+
+  //! @brief Append a length-prefixed string
+  //!
+  static inline void planPutString (string &data, const string &str)
+  {
+    planPut(data, (unsigned int)str.length());
+    data.append(str);
+  }
+
+
+  //! @brief Reads values from a cached plan, noting when it runs past the end
+  //!
+  struct planReader
+  {
+    const char *pos;
+    const char *end;
+    bool ok;
+
+    planReader (const string &data)
+    {
+      pos = data.data();
+      end = pos + data.length();
+      ok = true;
+    }
+
+    bool get (void *data, size_t length)
+    {
+      if (!ok || (size_t)(end - pos) < length)
+      {
+        ok = false;
+        return false;
+      }
+      memcpy(data, pos, length);
+      pos += length;
+      return true;
+    }
+
+    template <class V> V get ()
+    {
+      V value = V();
+      get(&value, sizeof(V));
+      return value;
+    }
+
+    void getString (string &str)
+    {
+      unsigned int length = get<unsigned int>();
+      if (!ok || (size_t)(end - pos) < length)
+      {
+        ok = false;
+        return;
+      }
+      str.assign(pos, length);
+      pos += length;
+    }
+
+    //! @brief Read a count of at most the bytes remaining, each item taking at least size bytes
+    //!
+    unsigned int getCount (size_t size)
+    {
+      unsigned int count = get<unsigned int>();
+      if (ok && count > (size_t)(end - pos) / size)
+      {
+        ok = false;
+      }
+      return (ok ? count : 0);
+    }
+  };
+
+
+  //! @brief Split a dependency list (separated by commas or white space) into its process IDs
+  //!
+  static void splitIDs (const string &list, vector<string> &ids)
+  {
+    size_t from = 0, to;
+    const char *separators = ", \t\r\n";
+
+    while ((from = list.find_first_not_of(separators, from)) != string::npos)
+    {
+      to = list.find_first_of(separators, from);
+      ids.push_back(list.substr(from, to == string::npos ? string::npos : to - from));
+      from = to;
+    }
+  }
+
+
+  LIBRARY_API CrpiPlan::CrpiPlan ()
+  {
+    key_ = 0;
+  }
+
+
+  LIBRARY_API CrpiPlan::~CrpiPlan ()
+  {
+  }
+
+
+  LIBRARY_API unsigned long long CrpiPlan::hash (const string &xml)
+  {
+    unsigned long long val = 14695981039346656037ULL;
+    string::const_iterator iter;
+
+    for (iter = xml.begin(); iter != xml.end(); ++iter)
+    {
+      val ^= (unsigned char)*iter;
+      val *= 1099511628211ULL;
+    }
+    return val;
+  }
+
+
+  LIBRARY_API void CrpiPlan::clear ()
+  {
+    key_ = 0;
+    frames_.clear();
+    agentIDs_.clear();
+    robots_.clear();
+    componentIDs_.clear();
+    components_.clear();
+    processIDs_.clear();
+    code_.clear();
+  }
+
+
+  LIBRARY_API bool CrpiPlan::compile (const CrpiXmlProgramParams &program)
+  {
+    map<string, int> components, agents, processes;
+    map<string, int>::const_iterator found;
+    vector<vector<int> > dependents(program.Processes.size());
+    vector<int> waiting(program.Processes.size(), 0), order;
+    vector<string> ids;
+    vector<string>::const_iterator iditer;
+    vector<CrpiProcessStep>::const_iterator siter;
+    CrpiPlanComponent comp;
+    CrpiPlanInstruction ins;
+    int i, j, last, agent;
+
+    clear();
+
+    //! Every location is defined in the program's reference frame
+    frames_.push_back(program.RefFrame == "World" ? string() : program.RefFrame);
+
+    for (i = 0; i < (int)program.Components.size(); ++i)
+    {
+      components[program.Components[i].ID] = i;
+      componentIDs_.push_back(program.Components[i].ID);
+      comp.location = program.Components[i].Location;
+      comp.frame = 0;
+      comp.located = (program.Components[i].Type == CompPart);
+      components_.push_back(comp);
+    }
+
+    for (i = 0; i < (int)program.Agents.size(); ++i)
+    {
+      agents[program.Agents[i].ID] = i;
+      agentIDs_.push_back(program.Agents[i].ID);
+      robots_.push_back(program.Agents[i].Type == AgentRobot ? 1 : 0);
+    }
+
+    for (i = 0; i < (int)program.Processes.size(); ++i)
+    {
+      processes[program.Processes[i].ID] = i;
+    }
+
+    //! Order the processes so that each follows those it depends on, otherwise keeping the
+    //! order in which they are defined
+    for (i = 0; i < (int)program.Processes.size(); ++i)
+    {
+      ids.clear();
+      for (iditer = program.Processes[i].Dependencies.begin();
+           iditer != program.Processes[i].Dependencies.end();
+           ++iditer)
+      {
+        splitIDs(*iditer, ids);
+      }
+      for (iditer = ids.begin(); iditer != ids.end(); ++iditer)
+      {
+        if (*iditer == "none")
+        {
+          continue;
+        }
+        if ((found = processes.find(*iditer)) == processes.end())
+        {
+          clear();
+          return false;
+        }
+        dependents[found->second].push_back(i);
+        ++waiting[i];
+      }
+    }
+
+    while (order.size() < program.Processes.size())
+    {
+      for (i = 0; i < (int)program.Processes.size() && waiting[i] != 0; ++i)
+      {
+      }
+      if (i == (int)program.Processes.size())
+      {
+        //! The remaining processes depend on each other
+        clear();
+        return false;
+      }
+      waiting[i] = -1;
+      order.push_back(i);
+      for (j = 0; j < (int)dependents[i].size(); ++j)
+      {
+        --waiting[dependents[i][j]];
+      }
+    }
+
+    for (j = 0; j < (int)order.size(); ++j)
+    {
+      const CrpiProcess &proc = program.Processes[order[j]];
+
+      if ((found = agents.find(proc.Agent)) == agents.end())
+      {
+        clear();
+        return false;
+      }
+      agent = found->second;
+      processIDs_.push_back(proc.ID);
+
+      last = -1;
+      for (siter = proc.Steps.begin(); siter != proc.Steps.end(); ++siter)
+      {
+        ins.op = (int)siter->Type;
+        ins.agent = agent;
+        ins.process = j;
+        ins.component = -1;
+        if (!siter->ComponentID.empty())
+        {
+          if ((found = components.find(siter->ComponentID)) == components.end())
+          {
+            clear();
+            return false;
+          }
+          ins.component = last = found->second;
+        }
+        else if (ins.op == PlanMove || ins.op == PlanInsert)
+        {
+          ins.component = last;
+        }
+
+        if ((ins.op == PlanMove || ins.op == PlanInsert) &&
+            (ins.component < 0 || !components_[ins.component].located))
+        {
+          clear();
+          return false;
+        }
+        code_.push_back(ins);
+      }
+    }
+
+    return true;
+  }
+
+
+  LIBRARY_API bool CrpiPlan::build (const string &xml, const char *cachePath)
+  {
+    CrpiXmlProgramParams program;
+    CrpiProgramXml parser(&program);
+    unsigned long long key = hash(xml);
+
+    if (cachePath != NULL && load(cachePath, key))
+    {
+      return true;
+    }
+
+    if (!parser.parse(xml) || !compile(program))
+    {
+      return false;
+    }
+    key_ = key;
+
+    //! A cache that cannot be written only costs the next load a compile
+    if (cachePath != NULL)
+    {
+      save(cachePath);
+    }
+    return true;
+  }
+
+
+  LIBRARY_API void CrpiPlan::encode (string &data) const
+  {
+    int i;
+
+    data.clear();
+    data.append(CRPI_PLAN_MAGIC, strlen(CRPI_PLAN_MAGIC));
+    planPut(data, (unsigned int)CRPI_PLAN_VERSION);
+    planPut(data, key_);
+
+    planPut(data, (unsigned int)frames_.size());
+    for (i = 0; i < (int)frames_.size(); ++i)
+    {
+      planPutString(data, frames_[i]);
+    }
+
+    planPut(data, (unsigned int)agentIDs_.size());
+    for (i = 0; i < (int)agentIDs_.size(); ++i)
+    {
+      planPutString(data, agentIDs_[i]);
+      planPut(data, robots_[i]);
+    }
+
+    planPut(data, (unsigned int)components_.size());
+    for (i = 0; i < (int)components_.size(); ++i)
+    {
+      const robotPose &loc = components_[i].location;
+      double vals[6] = {loc.x, loc.y, loc.z, loc.xrot, loc.yrot, loc.zrot};
+
+      planPutString(data, componentIDs_[i]);
+      data.append((const char*)vals, sizeof(vals));
+      planPut(data, components_[i].frame);
+      planPut(data, (char)(components_[i].located ? 1 : 0));
+    }
+
+    planPut(data, (unsigned int)processIDs_.size());
+    for (i = 0; i < (int)processIDs_.size(); ++i)
+    {
+      planPutString(data, processIDs_[i]);
+    }
+
+    planPut(data, (unsigned int)code_.size());
+    if (!code_.empty())
+    {
+      data.append((const char*)&code_[0], code_.size() * sizeof(CrpiPlanInstruction));
+    }
+  }
+
+
+  LIBRARY_API bool CrpiPlan::decode (const string &data)
+  {
+    planReader in(data);
+    CrpiPlan plan;
+    char magic[sizeof(CRPI_PLAN_MAGIC) - 1];
+    double vals[6];
+    unsigned int count, i;
+
+    if (!in.get(magic, sizeof(magic)) || memcmp(magic, CRPI_PLAN_MAGIC, sizeof(magic)) != 0 ||
+        in.get<unsigned int>() != CRPI_PLAN_VERSION)
+    {
+      return false;
+    }
+    plan.key_ = in.get<unsigned long long>();
+
+    count = in.getCount(sizeof(unsigned int));
+    plan.frames_.resize(count);
+    for (i = 0; i < count; ++i)
+    {
+      in.getString(plan.frames_[i]);
+    }
+
+    count = in.getCount(sizeof(unsigned int) + 1);
+    plan.agentIDs_.resize(count);
+    plan.robots_.resize(count);
+    for (i = 0; i < count; ++i)
+    {
+      in.getString(plan.agentIDs_[i]);
+      plan.robots_[i] = in.get<char>();
+    }
+
+    count = in.getCount(sizeof(unsigned int) + sizeof(vals) + sizeof(int) + 1);
+    plan.componentIDs_.resize(count);
+    plan.components_.resize(count);
+    for (i = 0; i < count; ++i)
+    {
+      CrpiPlanComponent &comp = plan.components_[i];
+
+      in.getString(plan.componentIDs_[i]);
+      in.get(vals, sizeof(vals));
+      comp.location.x = vals[0];
+      comp.location.y = vals[1];
+      comp.location.z = vals[2];
+      comp.location.xrot = vals[3];
+      comp.location.yrot = vals[4];
+      comp.location.zrot = vals[5];
+      comp.frame = in.get<int>();
+      comp.located = (in.get<char>() != 0);
+      if (comp.frame < 0 || comp.frame >= (int)plan.frames_.size())
+      {
+        return false;
+      }
+    }
+
+    count = in.getCount(sizeof(unsigned int));
+    plan.processIDs_.resize(count);
+    for (i = 0; i < count; ++i)
+    {
+      in.getString(plan.processIDs_[i]);
+    }
+
+    count = in.getCount(sizeof(CrpiPlanInstruction));
+    plan.code_.resize(count);
+    if (count > 0)
+    {
+      in.get(&plan.code_[0], count * sizeof(CrpiPlanInstruction));
+    }
+
+    if (!in.ok || in.pos != in.end)
+    {
+      return false;
+    }
+
+    //! The interpreter indexes by these without checking them again
+    for (i = 0; i < count; ++i)
+    {
+      const CrpiPlanInstruction &ins = plan.code_[i];
+      if (ins.op < PlanLocate || ins.op > PlanInsert ||
+          ins.agent < 0 || ins.agent >= (int)plan.agentIDs_.size() ||
+          ins.process < 0 || ins.process >= (int)plan.processIDs_.size() ||
+          ins.component < -1 || ins.component >= (int)plan.components_.size() ||
+          ((ins.op == PlanMove || ins.op == PlanInsert) &&
+           (ins.component < 0 || !plan.components_[ins.component].located)))
+      {
+        return false;
+      }
+    }
+
+    key_ = plan.key_;
+    frames_.swap(plan.frames_);
+    agentIDs_.swap(plan.agentIDs_);
+    robots_.swap(plan.robots_);
+    componentIDs_.swap(plan.componentIDs_);
+    components_.swap(plan.components_);
+    processIDs_.swap(plan.processIDs_);
+    code_.swap(plan.code_);
+    return true;
+  }
+
+
+  LIBRARY_API bool CrpiPlan::save (const char *path) const
+  {
+    string data;
+
+    encode(data);
+    ofstream out(path, ios::out | ios::binary | ios::trunc);
+    if (!out)
+    {
+      return false;
+    }
+    out.write(data.data(), data.length());
+    return out.good();
+  }
+
+
+  LIBRARY_API bool CrpiPlan::load (const char *path, unsigned long long key)
+  {
+    string data;
+    char header[sizeof(CRPI_PLAN_MAGIC) - 1 + sizeof(unsigned int) + sizeof(unsigned long long)];
+    unsigned long long cached;
+
+    ifstream in(path, ios::in | ios::binary);
+    if (!in)
+    {
+      return false;
+    }
+
+    //! Only the header is read from the plan of another program
+    if (!in.read(header, sizeof(header)))
+    {
+      return false;
+    }
+    memcpy(&cached, header + sizeof(header) - sizeof(cached), sizeof(cached));
+    if (cached != key)
+    {
+      return false;
+    }
+
+    data.assign(header, sizeof(header));
+    data.append(istreambuf_iterator<char>(in), istreambuf_iterator<char>());
+    return decode(data);
+  }
+
+
+  LIBRARY_API unsigned long long CrpiPlan::key () const
+  {
+    return key_;
+  }
+
+
+  LIBRARY_API int CrpiPlan::size () const
+  {
+    return (int)code_.size();
+  }
+
+
+  LIBRARY_API const CrpiPlanInstruction &CrpiPlan::instruction (int index) const
+  {
+    return code_[index];
+  }
+
+
+  LIBRARY_API int CrpiPlan::agents () const
+  {
+    return (int)agentIDs_.size();
+  }
+
+
+  LIBRARY_API int CrpiPlan::agent (const char *id) const
+  {
+    int i;
+
+    for (i = 0; i < (int)agentIDs_.size(); ++i)
+    {
+      if (strcmp(agentIDs_[i].c_str(), id) == 0)
+      {
+        return i;
+      }
+    }
+    return -1;
+  }
+
+
+  LIBRARY_API bool CrpiPlan::robot (int agent) const
+  {
+    return robots_.at(agent) != 0;
+  }
+
+
+  LIBRARY_API const CrpiPlanComponent &CrpiPlan::component (int index) const
+  {
+    return components_.at(index);
+  }
+
+
+  LIBRARY_API int CrpiPlan::components () const
+  {
+    return (int)components_.size();
+  }
+
+
+  LIBRARY_API const string &CrpiPlan::componentID (int index) const
+  {
+    return componentIDs_.at(index);
+  }
+
+
+  LIBRARY_API const string &CrpiPlan::processID (int index) const
+  {
+    return processIDs_.at(index);
+  }
+
+
+  LIBRARY_API const string &CrpiPlan::frame (int index) const
+  {
+    return frames_.at(index);
+  }
+
+} // crpi_robot
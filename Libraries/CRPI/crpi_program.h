@@ -0,0 +1,385 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_program.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Collaborative robot programs (see CrpiProgramXml) compiled into flat,
+//  cacheable execution plans, and an interpreter that runs a plan on
+//  CrpiRobot instances.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_PROGRAM_H
+#define CRPI_PROGRAM_H
+
+#include <string>
+#include <vector>
+#include "crpi.h"
+#include "crpi_robot.h"
+
+#pragma warning (disable: 4251)
+
+//! A plan is the program with every name resolved:  components, agents, processes, and
+//! coordinate frames are referenced by index, processes are ordered so that each follows the
+//! processes it depends on, and every step is one instruction naming the agent that performs
+//! it and the component it acts on.  Plans are cached on disk, keyed by a hash of the program
+//! XML, so that a program that has not changed is loaded without being parsed or compiled.
+
+namespace crpi_robot
+{
+  //! @brief Plan instruction codes (the same values as Xml::StepType)
+  //!
+  enum CrpiPlanOp
+  {
+    PlanLocate = 0,
+    PlanMove,
+    PlanOpen,
+    PlanClose,
+    PlanInsert
+  };
+
+
+  //! @brief One step of a compiled program
+  //!
+  struct CrpiPlanInstruction
+  {
+    //! @brief What to do (CrpiPlanOp)
+    //!
+    int op;
+
+    //! @brief Index of the agent performing the step
+    //!
+    int agent;
+
+    //! @brief Index of the component acted on, or -1 for none
+    //!
+    int component;
+
+    //! @brief Index of the process to which the step belongs
+    //!
+    int process;
+  };
+
+
+  //! @brief A component of a compiled program
+  //!
+  struct CrpiPlanComponent
+  {
+    //! @brief Location of the component in its coordinate frame
+    //!
+    robotPose location;
+
+    //! @brief Index of the coordinate frame in which the location is defined
+    //!
+    int frame;
+
+    //! @brief Whether the component has a location (parts do; fixtures do not)
+    //!
+    bool located;
+  };
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Compiler and binary cache for collaborative robot programs
+  //!
+  class LIBRARY_API CrpiPlan
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    CrpiPlan ();
+
+    //! @brief Default destructor
+    //!
+    ~CrpiPlan ();
+
+    //! @brief Hash of a program's XML, used as the key of its cached plan
+    //!
+    //! @param xml The program XML
+    //!
+    //! @return 64-bit FNV-1a hash of the XML text
+    //!
+    static unsigned long long hash (const std::string &xml);
+
+    //! @brief Compile a parsed program, replacing the current plan
+    //!
+    //! @param program The program (see CrpiProgramXml)
+    //!
+    //! @return True if the program compiled, false if it refers to an undefined component,
+    //!         agent, or process, if its dependencies are circular, or if a motion step has no
+    //!         located component to move to
+    //!
+    //! @note A Move or Insert step that names no component moves to the last component named
+    //!       by the steps before it in the same process
+    //!
+    bool compile (const Xml::CrpiXmlProgramParams &program);
+
+    //! @brief Load the plan of a program, compiling it only if the cache does not hold it
+    //!
+    //! @param xml       The program XML
+    //! @param cachePath The plan cache file (NULL for none); rewritten if it holds another plan
+    //!
+    //! @return True if the plan was loaded or compiled, false otherwise
+    //!
+    bool build (const std::string &xml, const char *cachePath);
+
+    //! @brief Write the plan to a binary cache file
+    //!
+    //! @param path The destination file
+    //!
+    //! @return True if the file was written, false otherwise
+    //!
+    bool save (const char *path) const;
+
+    //! @brief Read a plan from a binary cache file
+    //!
+    //! @param path The cache file
+    //! @param key  The hash of the program XML expected
+    //!
+    //! @return True if the file holds the plan of that program, false otherwise (the current
+    //!         plan is then unchanged)
+    //!
+    bool load (const char *path, unsigned long long key);
+
+    //! @brief Hash of the program XML the plan was built from (0 if compiled without XML)
+    //!
+    unsigned long long key () const;
+
+    //! @brief Number of instructions
+    //!
+    int size () const;
+
+    //! @brief An instruction of the plan, in execution order
+    //!
+    const CrpiPlanInstruction &instruction (int index) const;
+
+    //! @brief Number of agents
+    //!
+    int agents () const;
+
+    //! @brief Find an agent by its ID
+    //!
+    //! @return Index of the agent, or -1 if the program does not define it
+    //!
+    int agent (const char *id) const;
+
+    //! @brief Whether an agent is a robot (rather than an operator)
+    //!
+    bool robot (int agent) const;
+
+    //! @brief A component of the plan
+    //!
+    const CrpiPlanComponent &component (int index) const;
+
+    //! @brief Number of components
+    //!
+    int components () const;
+
+    //! @brief ID of a component, process, or coordinate frame (empty for the world frame)
+    //!
+    const std::string &componentID (int index) const;
+    const std::string &processID (int index) const;
+    const std::string &frame (int index) const;
+
+  private:
+    //! @brief Serialize the plan to, or restore it from, its binary cache form
+    //!
+    void encode (std::string &data) const;
+    bool decode (const std::string &data);
+
+    void clear ();
+
+    unsigned long long key_;
+    std::vector<std::string> frames_;
+    std::vector<std::string> agentIDs_;
+    std::vector<char> robots_;
+    std::vector<std::string> componentIDs_;
+    std::vector<CrpiPlanComponent> components_;
+    std::vector<std::string> processIDs_;
+    std::vector<CrpiPlanInstruction> code_;
+  }; // CrpiPlan
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Runs a plan on the robots that are its agents
+  //!
+  //! @note Each robot is bound once, when the locations of the plan's components are projected
+  //!       into its base frame; running the plan then makes only the motion and tool calls.
+  //!       Steps of operator agents with no robot bound are skipped, as the operator performs
+  //!       them.  Locate steps make no call.  Open and Close set the tool to 0 and 1.
+  //!
+  template <class T> class CrpiPlanRunner
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    //! @param plan The plan to run (not owned; must outlive the runner)
+    //!
+    CrpiPlanRunner (const CrpiPlan &plan) :
+      plan_(plan),
+      robots_(plan.agents(), (CrpiRobot<T>*)NULL),
+      targets_(plan.agents()),
+      pc_(0)
+    {
+    }
+
+    //! @brief Default destructor
+    //!
+    ~CrpiPlanRunner ()
+    {
+    }
+
+    //! @brief Assign a robot to an agent of the plan
+    //!
+    //! @param agentID The agent's ID in the program
+    //! @param robot   The robot (not owned)
+    //!
+    //! @return SUCCESS if the robot is bound, REJECT if the program does not define the agent,
+    //!         and FAILURE if a component's coordinate frame is not one of the robot's
+    //!
+    CanonReturn bind (const char *agentID, CrpiRobot<T> *robot)
+    {
+      int agent = plan_.agent(agentID), i;
+      robotPose location;
+      CanonReturn val;
+
+      if (agent < 0 || robot == NULL)
+      {
+        return CANON_REJECT;
+      }
+
+      targets_[agent].resize(plan_.components());
+      for (i = 0; i < plan_.components(); ++i)
+      {
+        const CrpiPlanComponent &comp = plan_.component(i);
+        if (!comp.located)
+        {
+          continue;
+        }
+        location = comp.location;
+        if (plan_.frame(comp.frame).empty())
+        {
+          val = robot->FromWorld(&location, &targets_[agent][i]);
+        }
+        else
+        {
+          val = robot->FromSystem(plan_.frame(comp.frame).c_str(), &location, &targets_[agent][i]);
+        }
+        if (val != CANON_SUCCESS)
+        {
+          return CANON_FAILURE;
+        }
+      }
+      robots_[agent] = robot;
+      return CANON_SUCCESS;
+    }
+
+    //! @brief Run the plan from the current instruction to the end
+    //!
+    //! @return SUCCESS if every remaining instruction succeeded, otherwise the result of the
+    //!         instruction that did not (which remains the current instruction, so that the
+    //!         plan may be resumed)
+    //!
+    CanonReturn run ()
+    {
+      CanonReturn val = CANON_SUCCESS;
+
+      while (pc_ < plan_.size() && (val = step()) == CANON_SUCCESS)
+      {
+      }
+      return val;
+    }
+
+    //! @brief Execute the current instruction, advancing to the next if it succeeds
+    //!
+    //! @return SUCCESS if the instruction succeeded or was skipped, REJECT if the plan is
+    //!         complete or the instruction's agent is a robot that has not been bound, and
+    //!         FAILURE if the instruction failed
+    //!
+    CanonReturn step ()
+    {
+      CrpiRobot<T> *robot;
+      CanonReturn val = CANON_SUCCESS;
+
+      if (pc_ >= plan_.size())
+      {
+        return CANON_REJECT;
+      }
+
+      const CrpiPlanInstruction &ins = plan_.instruction(pc_);
+      robot = robots_[ins.agent];
+      if (robot == NULL)
+      {
+        if (plan_.robot(ins.agent))
+        {
+          return CANON_REJECT;
+        }
+      }
+      else
+      {
+        switch (ins.op)
+        {
+        case PlanMove:
+          val = robot->MoveTo(targets_[ins.agent][ins.component]);
+          break;
+        case PlanInsert:
+          val = robot->MoveStraightTo(targets_[ins.agent][ins.component]);
+          break;
+        case PlanOpen:
+          val = robot->SetTool(0.0);
+          break;
+        case PlanClose:
+          val = robot->SetTool(1.0);
+          break;
+        default:
+          break;
+        }
+      }
+
+      if (val == CANON_SUCCESS)
+      {
+        ++pc_;
+      }
+      return val;
+    }
+
+    //! @brief Index of the current instruction (size() of the plan once it is complete)
+    //!
+    int position () const
+    {
+      return pc_;
+    }
+
+    //! @brief Restart the plan from its first instruction
+    //!
+    void reset ()
+    {
+      pc_ = 0;
+    }
+
+  private:
+    const CrpiPlan &plan_;
+
+    //! @brief Robot bound to each agent (NULL if none)
+    //!
+    std::vector<CrpiRobot<T>*> robots_;
+
+    //! @brief Location of each component in the base frame of each bound robot
+    //!
+    std::vector<std::vector<robotPose> > targets_;
+
+    //! @brief Index of the current instruction
+    //!
+    int pc_;
+  }; // CrpiPlanRunner
+
+} // crpi_robot
+
+#endif
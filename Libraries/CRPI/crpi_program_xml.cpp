@@ -0,0 +1,390 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       XML
+//  Workfile:        crpi_program_xml.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  XML parser class definition file for collaborative robot programs.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_xml.h"
+#include <iostream>
+
+using namespace std;
+
+namespace Xml
+{
+  //! @brief Escape a string for use as an attribute value or text
+  //!
+  static string escape (const string &str)
+  {
+    string out;
+    string::const_iterator iter;
+
+    for (iter = str.begin(); iter != str.end(); ++iter)
+    {
+      switch (*iter)
+      {
+      case '<':
+        out += "&lt;";
+        break;
+      case '>':
+        out += "&gt;";
+        break;
+      case '&':
+        out += "&amp;";
+        break;
+      case '\"':
+        out += "&quot;";
+        break;
+      default:
+        out += *iter;
+      }
+    }
+    return out;
+  }
+
+
+  //! @brief Derive the type of a process step from its description
+  //!
+  static StepType stepType (const string &description)
+  {
+    if (description.find("Locate") != string::npos)
+    {
+      return StepLocate;
+    }
+    if (description.find("Open") != string::npos || description.find("Release") != string::npos)
+    {
+      return StepOpen;
+    }
+    if (description.find("Close") != string::npos || description.find("Grasp") != string::npos)
+    {
+      return StepClose;
+    }
+    if (description.find("Insert") != string::npos)
+    {
+      return StepInsert;
+    }
+    return StepMove;
+  }
+
+
+  LIBRARY_API CrpiProgramXml::CrpiProgramXml (CrpiXmlProgramParams *params) :
+    params_(params),
+    componentactive(false),
+    locationactive(false),
+    processactive(false)
+  {
+  }
+
+
+  LIBRARY_API CrpiProgramXml::~CrpiProgramXml ()
+  {
+    params_ = NULL;
+  }
+
+
+  LIBRARY_API bool CrpiProgramXml::parse (const string &line)
+  {
+    return saxParse(line.data(), line.length(), *this);
+  }
+
+
+  LIBRARY_API bool CrpiProgramXml::startElement (const xmlView& tagName,
+                                                 const xmlAttributes& attr)
+  {
+    xmlViewList::const_iterator nameiter = attr.name.begin();
+    xmlViewList::const_iterator valiter = attr.val.begin();
+
+    if (params_ == NULL)
+    {
+      return false;
+    }
+
+    try
+    {
+      if (tagName == "Program")
+      {
+        params_->Components.clear();
+        params_->Agents.clear();
+        params_->Processes.clear();
+        for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "ID")
+          {
+            valiter->copy(params_->ID);
+          }
+          else if (*nameiter == "Name")
+          {
+            valiter->copy(params_->Name);
+          }
+          else if (*nameiter == "RefFrame")
+          {
+            valiter->copy(params_->RefFrame);
+          }
+        }
+      }
+      else if (tagName == "Part" || tagName == "Fixture")
+      {
+        CrpiXmlComponent comp;
+        comp.Type = (tagName == "Part" ? CompPart : CompFixture);
+        for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "ID")
+          {
+            valiter->copy(comp.ID);
+          }
+          else if (*nameiter == "Name")
+          {
+            valiter->copy(comp.Name);
+          }
+        }
+        params_->Components.push_back(comp);
+        componentactive = true;
+      }
+      else if (tagName == "Location")
+      {
+        locationactive = componentactive;
+      }
+      else if (tagName == "Robot" || tagName == "Operator")
+      {
+        CrpiXmlAgent agent;
+        agent.Type = (tagName == "Robot" ? AgentRobot : AgentOperator);
+        for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "ID")
+          {
+            valiter->copy(agent.ID);
+          }
+          else if (*nameiter == "Name")
+          {
+            valiter->copy(agent.Name);
+          }
+        }
+        params_->Agents.push_back(agent);
+      }
+      else if (tagName == "Process")
+      {
+        CrpiProcess proc;
+        for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "ID")
+          {
+            valiter->copy(proc.ID);
+          }
+          else if (*nameiter == "Name")
+          {
+            valiter->copy(proc.Name);
+          }
+        }
+        params_->Processes.push_back(proc);
+        processactive = true;
+      }
+      else if (tagName == "Step" && processactive)
+      {
+        CrpiProcessStep step;
+        for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "ID")
+          {
+            valiter->copy(step.ID);
+          }
+          else if (*nameiter == "Name")
+          {
+            valiter->copy(step.Description);
+          }
+          else if (*nameiter == "Component")
+          {
+            valiter->copy(step.ComponentID);
+          }
+        }
+        step.Type = stepType(step.Description);
+        params_->Processes.back().Steps.push_back(step);
+      }
+    } // try
+    catch (...)
+    {
+      return false;
+    }
+
+    return true;
+  }
+
+
+  LIBRARY_API bool CrpiProgramXml::interTagElement (const xmlView& tagName,
+                                                    const xmlViewList& vals)
+  {
+    xmlViewList::const_iterator valiter = vals.begin();
+
+    if (params_ == NULL || valiter == vals.end())
+    {
+      return params_ != NULL;
+    }
+
+    try
+    {
+      if (locationactive)
+      {
+        robotPose &loc = params_->Components.back().Location;
+        if (tagName == "X")
+        {
+          loc.x = valiter->real();
+        }
+        else if (tagName == "Y")
+        {
+          loc.y = valiter->real();
+        }
+        else if (tagName == "Z")
+        {
+          loc.z = valiter->real();
+        }
+        else if (tagName == "RX")
+        {
+          loc.xrot = valiter->real();
+        }
+        else if (tagName == "RY")
+        {
+          loc.yrot = valiter->real();
+        }
+        else if (tagName == "RZ")
+        {
+          loc.zrot = valiter->real();
+        }
+      }
+      else if (componentactive && tagName == "File")
+      {
+        valiter->copy(params_->Components.back().File);
+      }
+      else if (processactive)
+      {
+        CrpiProcess &proc = params_->Processes.back();
+        if (tagName == "Dependency")
+        {
+          //! "none" marks a process that can start immediately
+          for (; valiter != vals.end(); ++valiter)
+          {
+            if (*valiter != "none")
+            {
+              proc.Dependencies.push_back(valiter->str());
+            }
+          }
+        }
+        else if (tagName == "Agent")
+        {
+          valiter->copy(proc.Agent);
+        }
+        else if (tagName == "PrevProcess" || tagName == "PrevTask")
+        {
+          valiter->copy(proc.PrevProcess);
+        }
+      }
+    } // try
+    catch (...)
+    {
+      return false;
+    }
+
+    return true;
+  }
+
+
+  LIBRARY_API bool CrpiProgramXml::endElement (const xmlView& tagName)
+  {
+    if (tagName == "Part" || tagName == "Fixture")
+    {
+      componentactive = locationactive = false;
+    }
+    else if (tagName == "Location")
+    {
+      locationactive = false;
+    }
+    else if (tagName == "Process")
+    {
+      processactive = false;
+    }
+    return true;
+  }
+
+
+  LIBRARY_API bool CrpiProgramXml::encode (std::string &line)
+  {
+    vector<CrpiXmlComponent>::const_iterator citer;
+    vector<CrpiXmlAgent>::const_iterator aiter;
+    vector<CrpiProcess>::const_iterator piter;
+    vector<CrpiProcessStep>::const_iterator siter;
+    vector<string>::const_iterator diter;
+    XmlWriter out(line);
+
+    out.clear();
+    if (params_ == NULL)
+    {
+      return false;
+    }
+
+    out << "<Program ID=\"" << escape(params_->ID) << "\" Name=\"" << escape(params_->Name)
+        << "\" RefFrame=\"" << escape(params_->RefFrame) << "\">";
+
+    out << "<Components>";
+    for (citer = params_->Components.begin(); citer != params_->Components.end(); ++citer)
+    {
+      if (citer->Type == CompFixture)
+      {
+        out << "<Fixture ID=\"" << escape(citer->ID) << "\" Name=\"" << escape(citer->Name) << "\"/>";
+        continue;
+      }
+      out << "<Part ID=\"" << escape(citer->ID) << "\" Name=\"" << escape(citer->Name) << "\">";
+      out << "<Location><X>" << citer->Location.x << "</X><Y>" << citer->Location.y << "</Y><Z>"
+          << citer->Location.z << "</Z><RX>" << citer->Location.xrot << "</RX><RY>" << citer->Location.yrot
+          << "</RY><RZ>" << citer->Location.zrot << "</RZ></Location>";
+      out << "<File>" << escape(citer->File) << "</File></Part>";
+    }
+    out << "</Components>";
+
+    out << "<Agents>";
+    for (aiter = params_->Agents.begin(); aiter != params_->Agents.end(); ++aiter)
+    {
+      out << (aiter->Type == AgentOperator ? "<Operator" : "<Robot") << " ID=\"" << escape(aiter->ID)
+          << "\" Name=\"" << escape(aiter->Name) << "\"/>";
+    }
+    out << "</Agents>";
+
+    //! Processes are kept flat; they are written as a single task
+    out << "<Task><Subtask>";
+    for (piter = params_->Processes.begin(); piter != params_->Processes.end(); ++piter)
+    {
+      out << "<Process ID=\"" << escape(piter->ID) << "\" Name=\"" << escape(piter->Name) << "\">";
+      out << "<Dependency>";
+      if (piter->Dependencies.empty())
+      {
+        out << "none";
+      }
+      for (diter = piter->Dependencies.begin(); diter != piter->Dependencies.end(); ++diter)
+      {
+        out << (diter == piter->Dependencies.begin() ? "" : ",") << escape(*diter);
+      }
+      out << "</Dependency>";
+      out << "<Agent>" << escape(piter->Agent) << "</Agent>";
+      out << "<PrevProcess>" << escape(piter->PrevProcess) << "</PrevProcess>";
+      for (siter = piter->Steps.begin(); siter != piter->Steps.end(); ++siter)
+      {
+        out << "<Step ID=\"" << escape(siter->ID) << "\" Name=\"" << escape(siter->Description) << "\"";
+        if (!siter->ComponentID.empty())
+        {
+          out << " Component=\"" << escape(siter->ComponentID) << "\"";
+        }
+        out << "/>";
+      }
+      out << "</Process>";
+    }
+    out << "</Subtask></Task>";
+    out << "</Program>";
+
+    return true;
+  }
+
+} // Xml namespace
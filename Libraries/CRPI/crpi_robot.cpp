@@ -27,9 +27,15 @@ using namespace std;
 #include "crpi_robot_xml.h"
 #include "crpi_allegro.h"
 #include "crpi_abb.h"
+#include "crpi_composite.h"
+#include "crpi_sim.h"
 
 //#define NOISY
 
+//! Send a call to the simulated controller when the configuration selects one, and to the robot
+//! otherwise
+#define ROBOT_CALL(call) (sim_ != NULL ? sim_->call : robInterface_->call)
+
 //! Explicit instantiations
 template class LIBRARY_API crpi_robot::CrpiRobot<crpi_robot::CrpiSchunkSDH>;
 template class LIBRARY_API crpi_robot::CrpiRobot<crpi_robot::CrpiRobotiq>;
@@ -37,6 +43,8 @@ template class LIBRARY_API crpi_robot::CrpiRobot<crpi_robot::CrpiKukaLWR>;
 template class LIBRARY_API crpi_robot::CrpiRobot<crpi_robot::CrpiUniversal>;
 template class LIBRARY_API crpi_robot::CrpiRobot<crpi_robot::CrpiAllegro>;
 template class LIBRARY_API crpi_robot::CrpiRobot<crpi_robot::CrpiAbb>;
+template class LIBRARY_API crpi_robot::CrpiRobot<crpi_robot::CrpiSim>;
+template class LIBRARY_API crpi_robot::CrpiRobot<crpi_robot::CrpiComposite<crpi_robot::CrpiKukaLWR, crpi_robot::CrpiRobotiq> >;
 
 
 namespace crpi_robot
@@ -45,6 +53,8 @@ namespace crpi_robot
   {
     robotparams_ = new CrpiRobotParams();
     bypass_ = bypass;
+    robInterface_ = NULL;
+    sim_ = NULL;
 
     char line[1024];
     ifstream inputs(initPath);
@@ -77,16 +87,22 @@ namespace crpi_robot
       //! Update to matrix representation
       Math::pose ptemp = robotparams_->toWorld->pose();
       state = robotparams_->toWorldMatrix->RPYMatrixConvert(ptemp, true);
-      char lineout[4096];
+      string lineout;
       ofstream out(initPath);
       robXML.encode(lineout);
       out << lineout;
     }
 
-    robInterface_ = (bypass_ ? NULL : new T(*robotparams_));
+    if (!bypass_ && robotparams_->use_sim)
+    {
+      sim_ = new CrpiSim(*robotparams_);
+    }
+    robInterface_ = ((bypass_ || sim_ != NULL) ? NULL : new T(*robotparams_));
     crpiparams_ = new CrpiXmlParams();
     crclxml_ = new CrclXml(crpiparams_);
     crpixml_ = new CrpiXml(crpiparams_);
+    crpibin_ = new CrpiBinary(crpiparams_);
+    crpibatch_ = new CrpiBatch();
     rotMatrix_ = new matrix(3, 3);
     crpiparams_->toolName = "Nothing";
     crpiparams_->toolVal = 0.0f;
@@ -94,6 +110,7 @@ namespace crpi_robot
     v2_ = new vector3D;
     v3_ = new vector3D;
     crpiparams_->status = CANON_REJECT;
+    paramsLock_ = ulapi_mutex_new(60);
   }
 
 
@@ -102,7 +119,9 @@ namespace crpi_robot
     if (!bypass_)
     {
       delete robInterface_;
+      delete sim_;
     }
+    ulapi_mutex_delete(paramsLock_);
   }
 
 
@@ -115,8 +134,10 @@ namespace crpi_robot
 
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
+    ulapi_mutex_take(paramsLock_);
     crpiparams_->toolVal = percent;
-    val = robInterface_->SetTool (percent);
+    ulapi_mutex_give(paramsLock_);
+    val = ROBOT_CALL(SetTool (percent));
     crpiparams_->status = val;
     return val;
   }
@@ -130,7 +151,7 @@ namespace crpi_robot
 
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->ApplyCartesianForceTorque (robotForceTorque, activeAxes, manipulator);
+    val = ROBOT_CALL(ApplyCartesianForceTorque (robotForceTorque, activeAxes, manipulator));
     crpiparams_->status = val;
     return val;
   }
@@ -151,8 +172,10 @@ namespace crpi_robot
 
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
+    ulapi_mutex_take(paramsLock_);
     crpiparams_->toolName = targetID;
-    val = robInterface_->Couple(targetID);
+    ulapi_mutex_give(paramsLock_);
+    val = ROBOT_CALL(Couple (targetID));
     crpiparams_->status = val;
     return val;
   }
@@ -164,14 +187,18 @@ namespace crpi_robot
     {
       robotAxes temp;
       *axes = temp;
+      ulapi_mutex_take(paramsLock_);
       *crpiparams_->axes = temp;
+      ulapi_mutex_give(paramsLock_);
       return CANON_SUCCESS;
     }
 
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->GetRobotAxes (axes);
+    val = ROBOT_CALL(GetRobotAxes (axes));
+    ulapi_mutex_take(paramsLock_);
     *crpiparams_->axes = *axes;
+    ulapi_mutex_give(paramsLock_);
     crpiparams_->status = val;
     return val;
   }
@@ -183,14 +210,18 @@ namespace crpi_robot
     {
       robotPose temp;
       *forces = temp;
+      ulapi_mutex_take(paramsLock_);
       *crpiparams_->forces = temp;
+      ulapi_mutex_give(paramsLock_);
       return CANON_SUCCESS;
     }
 
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->GetRobotForces (forces);
+    val = ROBOT_CALL(GetRobotForces (forces));
+    ulapi_mutex_take(paramsLock_);
     *crpiparams_->forces = *forces;
+    ulapi_mutex_give(paramsLock_);
     return val;
   }
 
@@ -201,14 +232,18 @@ namespace crpi_robot
     {
       robotIO temp;
       *io = temp;
+      ulapi_mutex_take(paramsLock_);
       *crpiparams_->io = temp;
+      ulapi_mutex_give(paramsLock_);
       return CANON_SUCCESS;
     }
 
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->GetRobotIO (io);
+    val = ROBOT_CALL(GetRobotIO (io));
+    ulapi_mutex_take(paramsLock_);
     *crpiparams_->io = *io;
+    ulapi_mutex_give(paramsLock_);
     crpiparams_->status = val;
     return val;
   }
@@ -220,16 +255,19 @@ namespace crpi_robot
     {
       robotPose temp;
       *pose = temp;
+      ulapi_mutex_take(paramsLock_);
       *crpiparams_->pose = temp;
+      ulapi_mutex_give(paramsLock_);
       return CANON_SUCCESS;
     }
 
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
     //cout << "robot: get pose" << endl;
-    val = robInterface_->GetRobotPose (pose);
+    val = ROBOT_CALL(GetRobotPose (pose));
     //cout << "robot: do math" << endl;
     Math::pose ptemp = pose->pose();
+    ulapi_mutex_take(paramsLock_);
     rotMatrix_->RPYMatrixConvert (ptemp, (angleUnits_ == DEGREE));
     crpiparams_->xaxis.i = rotMatrix_->at (0, 0);
     crpiparams_->xaxis.j = rotMatrix_->at (1, 0);
@@ -240,6 +278,7 @@ namespace crpi_robot
     crpiparams_->zaxis.k = rotMatrix_->at (2, 2);
     crpiparams_->status = val;
     *crpiparams_->pose = ptemp;
+    ulapi_mutex_give(paramsLock_);
     return val;
   }
 
@@ -255,7 +294,7 @@ namespace crpi_robot
 
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->GetRobotSpeed (speed);
+    val = ROBOT_CALL(GetRobotSpeed (speed));
     crpiparams_->status = val;
     return val;
   }
@@ -271,7 +310,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->GetRobotSpeed (speed);
+    val = ROBOT_CALL(GetRobotSpeed (speed));
     crpiparams_->status = val;
     return val;
   }
@@ -283,13 +322,17 @@ namespace crpi_robot
     {
       robotAxes temp;
       *torques = temp;
+      ulapi_mutex_take(paramsLock_);
       *crpiparams_->torques = temp;
+      ulapi_mutex_give(paramsLock_);
       return CANON_SUCCESS;
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->GetRobotTorques (torques);
+    val = ROBOT_CALL(GetRobotTorques (torques));
+    ulapi_mutex_take(paramsLock_);
     *crpiparams_->torques = *torques;
+    ulapi_mutex_give(paramsLock_);
     crpiparams_->status = val;
     return val;
   }
@@ -303,7 +346,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->Message (message);
+    val = ROBOT_CALL(Message (message));
     crpiparams_->status = val;
     return val;
   }
@@ -317,7 +360,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->MoveStraightTo (pose);
+    val = ROBOT_CALL(MoveStraightTo (pose));
     crpiparams_->status = val;
     return val;
   }
@@ -335,7 +378,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->MoveThroughTo (poses, numPoses, accelerations, speeds, tolerances);
+    val = ROBOT_CALL(MoveThroughTo (poses, numPoses, accelerations, speeds, tolerances));
     crpiparams_->status = val;
     return val;
   }
@@ -349,7 +392,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->MoveTo (pose);
+    val = ROBOT_CALL(MoveTo (pose));
     crpiparams_->status = val;
     return val;
   }
@@ -363,7 +406,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->MoveAttractor (pose);
+    val = ROBOT_CALL(MoveAttractor (pose));
     crpiparams_->status = val;
     return val;
   }
@@ -377,7 +420,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->MoveToAxisTarget (axes);
+    val = ROBOT_CALL(MoveToAxisTarget (axes));
     crpiparams_->status = val;
     return val;
   }
@@ -391,7 +434,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetAbsoluteAcceleration (tolerance);
+    val = ROBOT_CALL(SetAbsoluteAcceleration (tolerance));
     crpiparams_->status = val;
     return val;
   }
@@ -405,7 +448,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetAbsoluteSpeed (speed);
+    val = ROBOT_CALL(SetAbsoluteSpeed (speed));
     crpiparams_->status = val;
     return val;
   }
@@ -433,7 +476,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetAngleUnits (unitName);
+    val = ROBOT_CALL(SetAngleUnits (unitName));
     crpiparams_->status = val;
 
     return val;
@@ -448,7 +491,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetAxialSpeeds (speeds);
+    val = ROBOT_CALL(SetAxialSpeeds (speeds));
     crpiparams_->status = val;
     return val;
   }
@@ -462,7 +505,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetAxialUnits (unitNames);
+    val = ROBOT_CALL(SetAxialUnits (unitNames));
     crpiparams_->status = val;
     return val;
   }
@@ -476,7 +519,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetEndPoseTolerance (tolerance);
+    val = ROBOT_CALL(SetEndPoseTolerance (tolerance));
     crpiparams_->status = val;
     return val;
   }
@@ -490,7 +533,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetIntermediatePoseTolerance (tolerances);
+    val = ROBOT_CALL(SetIntermediatePoseTolerance (tolerances));
     crpiparams_->status = val;
     return val;
   }
@@ -504,7 +547,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetLengthUnits (unitName);
+    val = ROBOT_CALL(SetLengthUnits (unitName));
     crpiparams_->status = val;
 
     if (strcmp(unitName, "meter") == 0)
@@ -535,7 +578,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetParameter (paramName, paramVal);
+    val = ROBOT_CALL(SetParameter (paramName, paramVal));
     crpiparams_->status = val;
     return val;
   }
@@ -549,7 +592,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetRelativeAcceleration (percent);
+    val = ROBOT_CALL(SetRelativeAcceleration (percent));
     crpiparams_->status = val;
     return val;
   }
@@ -563,7 +606,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetRelativeSpeed (percent);
+    val = ROBOT_CALL(SetRelativeSpeed (percent));
     crpiparams_->status = val;
     return val;
   }
@@ -577,7 +620,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->SetRobotIO (io);
+    val = ROBOT_CALL(SetRobotIO (io));
     crpiparams_->status = val;
     return val;
   }
@@ -591,7 +634,7 @@ namespace crpi_robot
     }
     CanonReturn retval;
     crpiparams_->status = CANON_RUNNING;
-    retval = robInterface_->SetRobotDO (dig_out, val);
+    retval = ROBOT_CALL(SetRobotDO (dig_out, val));
     crpiparams_->status = retval;
     return retval;
   }
@@ -605,7 +648,7 @@ namespace crpi_robot
     }
     CanonReturn val;
     crpiparams_->status = CANON_RUNNING;
-    val = robInterface_->StopMotion (condition);
+    val = ROBOT_CALL(StopMotion (condition));
     crpiparams_->status = val;
     return val;
   }
@@ -616,6 +659,7 @@ namespace crpi_robot
     crclxml_->parse(str); //! Populate the params_ structure based on the XML string
 
     //! Get the CRPI 6DOF pose from the 2-vector representation CRCL uses
+    ulapi_mutex_take(paramsLock_);
     v1_->i = crpiparams_->xaxis.i;
     v1_->j = crpiparams_->xaxis.j;
     v1_->k = crpiparams_->xaxis.k;
@@ -641,6 +685,7 @@ namespace crpi_robot
     Math::pose ptemp;
     rotMatrix_->matrixRPYConvert (ptemp, (angleUnits_ == DEGREE));
     *crpiparams_->pose = ptemp;
+    ulapi_mutex_give(paramsLock_);
 
     switch (crpiparams_->cmd)
     {
@@ -744,7 +789,7 @@ namespace crpi_robot
   }
 
 
-  template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrclXmlResponse (char *str)
+  template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrclXmlResponse (std::string &str)
   {
     crpiparams_->counter += 1;
     crclxml_->encode(str);
@@ -754,8 +799,93 @@ namespace crpi_robot
   template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrpiXmlHandler (std::string& str)
   {
     crpixml_->parse(str); //! Populate the params_ structure based on the XML string
+    return CrpiParamsHandler(*crpiparams_, *crpiparams_);
+  }
 
-    switch (crpiparams_->cmd)
+
+  template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrpiBinaryHandler (std::string& str)
+  {
+    if (!crpibin_->parse(str))
+    {
+      return CANON_REJECT;
+    }
+    return CrpiParamsHandler(*crpiparams_, *crpiparams_);
+  }
+
+
+  template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrpiBinaryResponse (std::string& str)
+  {
+    crpiparams_->counter += 1;
+    if (crpibin_->encode(str))
+    {
+      return CANON_SUCCESS;
+    }
+    return CANON_FAILURE;
+  }
+
+
+  template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrpiCommandHandler (CrpiCommand &command)
+  {
+    const CrpiXmlParams &request = command.request();
+    CrpiXmlParams &response = command.response();
+
+    if (command.crcl())
+    {
+      //! CRCL gives the orientation as two axes, and its status echoes them with the command ID
+      command.orient(angleUnits_ == DEGREE);
+      response.commandID = request.commandID;
+      response.xaxis = request.xaxis;
+      response.zaxis = request.zaxis;
+    }
+
+    //! Commands report their target, as in CrpiXmlResponse; queries replace it with what they read
+    response.cmd = request.cmd;
+    *response.pose = *request.pose;
+    *response.axes = *request.axes;
+    response.status = CrpiParamsHandler(request, response);
+
+    //! The coupled tool is the robot's, not the command's
+    ulapi_mutex_take(paramsLock_);
+    response.toolName = crpiparams_->toolName;
+    response.toolVal = crpiparams_->toolVal;
+    ulapi_mutex_give(paramsLock_);
+    return response.status;
+  }
+
+
+  template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrpiBatchHandler (std::string& str, std::string& response)
+  {
+    CanonReturn val;
+    int i;
+
+    if (!crpibatch_->parse(str))
+    {
+      return CANON_REJECT;
+    }
+
+    for (i = 0; i < crpibatch_->size() && !crpibatch_->stopped(); ++i)
+    {
+      if (crpibatch_->crcl())
+      {
+        val = CrclXmlHandler(crpibatch_->command(i));
+        CrclXmlResponse(batchResponse_);
+      }
+      else
+      {
+        val = CrpiXmlHandler(crpibatch_->command(i));
+        CrpiXmlResponse(batchResponse_);
+      }
+      crpibatch_->add(val, batchResponse_);
+    }
+
+    crpibatch_->respond(response, crpiparams_->counter);
+    return (crpibatch_->failed() || crpibatch_->size() == 0 ? CANON_FAILURE : CANON_SUCCESS);
+  }
+
+
+  template <class T> CanonReturn CrpiRobot<T>::CrpiParamsHandler (const CrpiXmlParams &request, CrpiXmlParams &response)
+  {
+    switch (request.cmd)
     {
     case CmdApplyCartesianForceTorque:
       //! TODO
@@ -764,7 +894,7 @@ namespace crpi_robot
       //! TODO
       break;
     case CmdCouple:
-      return Couple(crpiparams_->str.c_str());
+      return Couple(request.str.c_str());
       break;
     case CmdToWorldMatrix:
       break;
@@ -775,52 +905,52 @@ namespace crpi_robot
     case CmdFromWorld:
       break;
     case CmdGetRobotAxes:
-      return GetRobotAxes(crpiparams_->axes);
+      return GetRobotAxes(response.axes);
       break;
     case CmdGetRobotForces:
-      return GetRobotForces(crpiparams_->forces);
+      return GetRobotForces(response.forces);
       break;
     case CmdGetRobotIO:
-      return GetRobotIO(crpiparams_->io);
+      return GetRobotIO(response.io);
       break;
     case CmdGetRobotPose:
-      return GetRobotPose(crpiparams_->pose);
+      return GetRobotPose(response.pose);
       break;
     case CmdGetRobotSpeed:
       //!TODO
       break;
     case CmdGetRobotTorques:
-      return GetRobotTorques(crpiparams_->torques);
+      return GetRobotTorques(response.torques);
       break;
     case CmdMessage:
-      return Message(crpiparams_->str.c_str());
+      return Message(request.str.c_str());
       break;
     case CmdMoveAttractor:
-      return MoveAttractor(*crpiparams_->pose);
+      return MoveAttractor(*request.pose);
       break;
     case CmdMoveStraightTo:
-      return MoveStraightTo(*crpiparams_->pose);
+      return MoveStraightTo(*request.pose);
       break;
     case CmdMoveThroughTo:
       //! TODO
       break;
     case CmdMoveTo:
-      return MoveTo(*crpiparams_->pose);
+      return MoveTo(*request.pose);
       break;
     case CmdMoveToAxisTarget:
-      return MoveToAxisTarget(*crpiparams_->axes);
+      return MoveToAxisTarget(*request.axes);
       break;
     case CmdSaveConfig:
-      return SaveConfig(crpiparams_->str.c_str());
+      return SaveConfig(request.str.c_str());
       break;
     case CmdSetAbsoluteAcceleration:
-      return SetAbsoluteAcceleration(crpiparams_->numPositions);
+      return SetAbsoluteAcceleration(request.numPositions);
       break;
     case CmdSetAbsoluteSpeed:
-      return SetAbsoluteSpeed(crpiparams_->numPositions);
+      return SetAbsoluteSpeed(request.numPositions);
       break;
     case CmdSetAngleUnits:
-      return SetAngleUnits(crpiparams_->str.c_str());
+      return SetAngleUnits(request.str.c_str());
       break;
     case CmdSetAxialSpeeds:
       //!TODO
@@ -833,25 +963,25 @@ namespace crpi_robot
     case CmdSetIntermediatePoseTolerance:
       break;
     case CmdSetLengthUnits:
-      return SetLengthUnits(crpiparams_->str.c_str());
+      return SetLengthUnits(request.str.c_str());
       break;
     case CmdSetParameter:
       //SetParameter (params_->str.c_str(), *(params_->numPositions));
       break;
     case CmdSetRelativeAcceleration:
-      return SetRelativeAcceleration(crpiparams_->real);
+      return SetRelativeAcceleration(request.real);
       break;
     case CmdSetRelativeSpeed:
-      return SetRelativeSpeed(crpiparams_->real);
+      return SetRelativeSpeed(request.real);
       break;
     case CmdSetRobotDO:
-      return SetRobotDO(crpiparams_->integer, crpiparams_->boolean);
+      return SetRobotDO(request.integer, request.boolean);
       break;
     case CmdSetRobotIO:
       //! TODO
       break;
     case CmdSetTool:
-      return SetTool(crpiparams_->real);
+      return SetTool(request.real);
       break;
     case CmdStopMotion:
       break;
@@ -871,7 +1001,7 @@ namespace crpi_robot
   }
 
 
-  template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrpiXmlResponse (char *str)
+  template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::CrpiXmlResponse (std::string &str)
   {
     crpiparams_->counter += 1;
     if (crpixml_->encode(str))
@@ -1234,7 +1364,7 @@ namespace crpi_robot
 
   template <class T> LIBRARY_API CanonReturn CrpiRobot<T>::SaveConfig (const char *file)
   {
-    char line[4096];
+    string line;
     CrpiRobotXml robXML(robotparams_);
     robXML.encode(line);
     ofstream out(file);
@@ -22,6 +22,9 @@
 
 #include "crpi.h"
 #include "crpi_xml.h"
+#include "crpi_binary.h"
+#include "crpi_command.h"
+#include "crpi_batch.h"
 #include "crpi_robot_xml.h"
 #include "vector.h"
 
@@ -31,6 +34,7 @@ using namespace Math;
 
 namespace crpi_robot
 {
+  class CrpiSim;
 
   //! @ingroup Robot
   //!
@@ -46,6 +50,9 @@ namespace crpi_robot
     //! @param bypass   Whether or not to bypass the actual robot (i.e., to access certain functions
     //!                 actually being connected to a robot)
     //!
+    //! @note If the initialization file has a <Simulation> tag, commands are sent to a simulated
+    //!       controller (CrpiSim) instead of the robot
+    //!
     CrpiRobot (const char *initPath, bool bypass = false);
 
     //! @brief Default destructor
@@ -374,12 +381,13 @@ namespace crpi_robot
 
     //! @brief Generate a status message for a CRCL client
     //!
-    //! @param str Response CRCL XML message to be sent to the CRCL client
+    //! @param str Replaced with the response CRCL XML message to be sent to the CRCL client; reuse
+    //!            the same string for every response to avoid reallocating it
     //!
     //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
     //!         not accepted, and FAILURE if the command is accepted but not executed successfully
     //!
-    CanonReturn CrclXmlResponse (char *str);
+    CanonReturn CrclXmlResponse (std::string &str);
 
     //! @brief Convert CRPI XML to CRPI function calls
     //!
@@ -392,12 +400,55 @@ namespace crpi_robot
 
     //! @brief Generate a status message for a CRPI XML client
     //!
-    //! @param str Response CRPI XML message to be sent to the client
+    //! @param str Replaced with the response CRPI XML message to be sent to the client; reuse the
+    //!            same string for every response to avoid reallocating it
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn CrpiXmlResponse (std::string &str);
+
+    //! @brief Convert a binary CRPI command (see CrpiBinary) to CRPI function calls
+    //!
+    //! @param str Binary command to be interpreted as a function call
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn CrpiBinaryHandler (std::string &str);
+
+    //! @brief Generate a binary status message for a client
+    //!
+    //! @param str Binary response to be sent to the client
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn CrpiBinaryResponse (std::string &str);
+
+    //! @brief Execute a command parsed into its own context (see CrpiCommand)
+    //!
+    //! @param command The command; its request is read, and its response populated with the
+    //!                status and with the state a Get* query reads
     //!
     //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
     //!         not accepted, and FAILURE if the command is accepted but not executed successfully
     //!
-    CanonReturn CrpiXmlResponse (char *str);
+    //! @note Unlike CrpiXmlHandler, this does not use the robot's shared CrpiXmlParams, so
+    //!       commands in separate contexts may be executed from separate threads
+    //!
+    CanonReturn CrpiCommandHandler (CrpiCommand &command);
+
+    //! @brief Execute a batch of CRPI or CRCL XML commands (see CrpiBatch) and generate the single
+    //!        status message for it
+    //!
+    //! @param str      The <CRPIBatch> or <CRCLBatch> message
+    //! @param response Replaced with the batch status message to be sent to the client
+    //!
+    //! @return SUCCESS if every command is executed successfully, REJECT if the message is not a
+    //!         batch, and FAILURE if any command is not executed successfully
+    //!
+    CanonReturn CrpiBatchHandler (std::string &str, std::string &response);
 
     //! @brief Populates a reference to a matrix object with the transformation matrix from robot to world
     //!
@@ -515,14 +566,34 @@ namespace crpi_robot
     CanonReturn SaveConfig (const char *file);
 
   private:
+    //! @brief Make the CRPI function call described by a parsed command
+    //!
+    //! @param request  The command
+    //! @param response Populated with the state a Get* query reads (may be the request, as it is
+    //!                 for the crpiparams_ shared by CrpiXmlHandler and CrpiBinaryHandler)
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn CrpiParamsHandler (const CrpiXmlParams &request, CrpiXmlParams &response);
+
     //! @brief Interface object for the different supported robots
     //!
     T *robInterface_;
 
+    //! @brief Simulated controller used in place of robInterface_ (NULL when driving the robot)
+    //!
+    CrpiSim *sim_;
+
     //! @brief CRPI function parameters for interpretation of XML-based commands
     //!
     CrpiXmlParams *crpiparams_;
 
+    //! @brief Guards the state that other threads' commands copy into crpiparams_ (and
+    //!        rotMatrix_, used to convert it)
+    //!
+    ulapi_mutex_struct *paramsLock_;
+
     //! @brief Settings for connecting to and communicating with a remote robot
     //!
     CrpiRobotParams *robotparams_;
@@ -535,6 +606,15 @@ namespace crpi_robot
     //!
     CrpiXml *crpixml_;
 
+    //! @brief Handler for interpreting binary CRPI commands as C++ function calls
+    //!
+    CrpiBinary *crpibin_;
+
+    //! @brief Command batch being executed, and the response to its current command
+    //!
+    CrpiBatch *crpibatch_;
+    std::string batchResponse_;
+
     //! @brief Variables used (and abused) throughout the CrpiRobot class for rotation representation
     //!        conversions.  Added here for memory efficiency.
     matrix *rotMatrix_;
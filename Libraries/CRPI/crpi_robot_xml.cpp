@@ -35,335 +35,9 @@ namespace Xml
   }
 
 
-  LIBRARY_API bool CrpiRobotXml::characters(const vector<string>& ch)
-  {
-    vector<string>::const_iterator chIter = ch.begin();
-
-    for (; chIter != ch.end(); ++chIter)
-    {
-    }
-
-    return true;
-  }
-
-
   LIBRARY_API bool CrpiRobotXml::parse (const string &line)
   {
-    static char buff[1024];
-    bool readTags = false;
-    bool state = true;
-    bool error = false;
-
-    xmlAttributes attr;
-    vector<string> chars;
-
-    int marker = 0;
-    int openTags = 0;
-    bool tagActive = false;
-    bool start = false;
-    bool single = false;
-    bool validXML = false;
-
-    int strLength = line.length();
-    int count;
-    string temp;
-    string name;
-    string attrname;
-    string attrval;
-    try
-    {
-      //! JAM:  TODO, STRIP OFF WHITE SPACE:  Carriage returns, tabs, etc.
-
-      while (marker < strLength && !error && line[marker] != '\0')
-      {
-        if (line[marker] == '<')
-        {
-          //! ***** Handle tags *****
-          tagActive = true;
-          for (int i = 0; i < 20; i++)
-          {
-            buff[i] = ' ';
-          }
-
-          name = "";
-          ++marker;
-
-          //! Skip white space
-          while (line[marker] == ' ' || line[marker] == '\t' || line[marker] == '?')
-          {
-            ++marker;
-            if (marker >= (strLength - 1))
-            {
-              break;
-            }
-          }
-
-          if (marker >= (strLength - 1))
-          {
-            //! Ill-formed XML string (end encountered before closing tags
-            error = true;
-            break;
-          }
-
-          if (line[marker] == '/')
-          {
-            start = false;
-            marker++;
-          }
-          else
-          {
-            start = true;
-          }
-
-          int count = 0;
-          while (line[marker] != ' ' && line[marker] != '\t' &&
-                 line[marker] != '/' && line[marker] != '>' &&
-                 line[marker] != '?' && marker <= (strLength - 1))
-          {
-            buff[count] = line[marker];
-            count++;
-            marker++;
-            if (marker >= (strLength - 1))
-            {
-              break;
-            }
-          }
-          if (marker > (strLength - 1))
-          {
-            //! Ill-formed XML string (end encountered before closing tags
-            error = true;
-            break;
-          }
-
-          buff[count] = '\0';
-          name = buff;
-          name = name.substr(0, count);
-
-          if (start)
-          {
-            //! Look for attributes of opening tags
-            while (line[marker] != '/' && line[marker] != '>' &&
-                   line[marker] != '?' && marker <= (strLength -1))
-            {
-              if (line[marker] != ' ' && line[marker] != '\t' &&
-                  line[marker] != '?' && line[marker] != '\n')
-              {
-                //! Non-white-space character & non-terminating element
-                //! Ergo, an attribute
-                count = 0;
-
-                //! grab the attribute name
-                while (line[marker] != '=' && line[marker] != ' ' && line[marker] != '?')
-                {
-                  buff[count++] = line[marker++];
-                  if (marker >= strLength - 1)
-                  {
-                    break;
-                  }
-                }
-                if (marker >= strLength - 1)
-                {
-                  break;
-                }
-                buff[count] = '\0';
-                attrname = buff;
-                attrname = attrname.substr(0, count);
-                attr.name.push_back(attrname);
-
-                //! grab the attribute value
-                while (line[marker] != '\"')
-                {
-                  marker++;
-                  if (marker >= strLength - 1)
-                  {
-                    break;
-                  }
-                }
-                marker++;
-                if (marker >= strLength - 1)
-                {
-                  break;
-                }
-
-                count = 0;
-                while (line[marker] != '\"')
-                {
-                  buff[count++] = line[marker++];
-                  if (marker >= strLength - 1)
-                  {
-                    break;
-                  }
-                }
-                buff[count] = '\0';
-                attrval = buff;
-                attrval = attrval.substr(0, count);
-                attr.val.push_back(attrval);
-              } // if (line[marker] != ' ' && line[marker] != '\t' && line[marker] != '\n' && line[marker] != '?')
-              marker++;
-              if (marker > strLength - 1)
-              {
-                break;
-              }
-            } // while (line[marker] != '/' && line[marker] != '>' && line[marker] != '?')
-
-            if (marker > (strLength - 1))
-            {
-              //! Ill-formed XML string (end encountered before closing tags
-              error = true;
-              break;
-            } // if (marker > (strLength - 1))
-
-            //! Test for single-tag XML lines (ex. <tag/>
-            if (line[marker] == '/')
-            {
-              single = true;
-            }
-            while (line[marker] != '>')
-            {
-              marker++;
-              if (marker >= strLength - 1)
-              {
-                break;
-              }
-            } // while (line[marker] != '>')
-          } // if (start)
-
-          if (error)
-          {
-            break;
-          }
-
-          //! Pass tag information for data structure assignment
-          if (start)
-          {
-            if (state && startElement (name, attr))
-            {
-              state = true;
-              attr.name.clear();
-              attr.val.clear();
-            }
-            else
-            {
-              state = false;
-            }
-
-            validXML = false;
-            openTags++;
-            readTags = true;
-            if (single)
-            {
-              tagActive = false;
-              validXML = true;
-              if (state && endElement (name))
-              {
-                state = true;
-              }
-              else
-              {
-                state = false;
-              }
-              openTags--;
-              start = false;
-            }
-          } // if (start)
-          else
-          {
-            tagActive = false;
-            validXML = true;
-            if (state && endElement (name))
-            {
-              state = true;
-            }
-            else
-            {
-              state = false;
-            }
-            openTags--;
-          } // if (start) ... else
-        } // if (line[marker] == '<')
-        else if (tagActive)
-        {
-          //! ***** Handle text between tags *****
-          while(start)
-          {
-            if (marker > strLength || line[marker] == '<')
-            {
-              marker--;
-              break;
-            }
-
-            //! Skip white space
-            while (line[marker] == ' ' || line[marker] == '\t' ||
-                   line[marker] == '\n' || line[marker] == ',' ||
-                   line[marker] == '?')
-            {
-              marker++;
-              if (marker >= strLength)
-              {
-                break;
-              }
-            }
-
-            if (marker > strLength || line[marker] == '<')
-            {
-              marker--;
-              break;
-            }
-
-            count = 0;
-            while (line[marker] != ',' && line[marker] != '<')
-            {
-              buff[count++] = line[marker++];
-              if (marker >= strLength - 1)
-              {
-                break;
-              }
-            }
-            if (marker >= (strLength - 1))
-            {
-              //! Ill-formed XML string (end encountered before closing tags
-              error = true;
-              break;
-            }
-            if (count > 0)
-            {
-              temp = buff;
-              temp = temp.substr (0, count);
-              chars.push_back (temp);
-            }
-          } // while(start)
-          if (start)
-          {
-            if (state && interTagElement (name, chars))
-            {
-              state = true;
-            }
-            else
-            {
-              state = false;
-            }
-            chars.clear ();
-          }
-          start = false;
-        } // else if (tagActive)
-
-        ++marker;
-        if (openTags < 1 && readTags)
-        {
-//          break;
-        }
-      } // while (marker < strLength && marker < 1024)
-    } // try
-    catch (...)
-    {
-      return false;
-    }
-
-    if (error)
-    {
-      //! Exiting with errors
-    }
-    return state;
+    return saxParse(line.data(), line.length(), *this);
   }
 
   /*
@@ -371,7 +45,12 @@ namespace Xml
     <TCP_IP Address="127.0.0.1" Port="6007" Client="false"/>
     <Serial Port="COM7" Rate="57600" Parity="Even" SBits="1" Handshake="None"/>
     <ComType Val="Serial"/>
+    <Protocol Val="Binary"/>
     <Observer Address="169.254.152.3" Port="1025" Client="true"/>
+    <RTDE Port="30004" Frequency="500"/>
+    <Polling Rate="50"/>
+    <SharedMemory Key="6008"/>
+    <Simulation Model="Serial" Axes="6" Links="400,25,455,35,420,80" JointSpeed="180" CartSpeed="500" RotSpeed="180" Rate="125" Latency="2" Jitter="1"/>
     <Mounting X="0.0" Y="0.0" Z="0.0" XR="0.0" YR="0.0" ZR="0.0"/>
     <ToWorld X="2335.14" Y="471.0" Z="661.0" XR="0.0" YR="0.0" ZR="90.0" M00="0.0" M01="0.0" M02="0.0" M03="0.0" M10="0.0" M11="0.0" M12="0.0" M13="0.0" M20="0.0" M21="0.0" M22="0.0" M23="0.0" M30="0.0" M31="0.0" M32="0.0" M33="0.0"/>
     <CoordSystem Name="Table1" X="2335.14" Y="471.0" Z="661.0" XR="0.0" YR="0.0" ZR="90.0" M00="0.0" M01="0.0" M02="0.0" M03="0.0" M10="0.0" M11="0.0" M12="0.0" M13="0.0" M20="0.0" M21="0.0" M22="0.0" M23="0.0" M30="0.0" M31="0.0" M32="0.0" M33="0.0"/>
@@ -384,252 +63,382 @@ namespace Xml
   </Robot>
   */
 
-  LIBRARY_API bool CrpiRobotXml::startElement (const string& tagName, 
+  LIBRARY_API bool CrpiRobotXml::startElement (const xmlView& tagName, 
                                                const xmlAttributes& attr)
   {
-    std::vector<std::string>::const_iterator nameiter = attr.name.begin();
-    std::vector<std::string>::const_iterator valiter = attr.val.begin();
+    xmlViewList::const_iterator nameiter = attr.name.begin();
+    xmlViewList::const_iterator valiter = attr.val.begin();
     bool flag = true;
 
     try
     {
-      if (strcmp (tagName.c_str(), "Robot") == 0)
+      if (tagName == "Robot")
       {
-      } // if (strcmp (tagName.c_str(), "Robot") == 0)
-      else if (strcmp (tagName.c_str(), "TCP_IP") == 0)
+      } // if (tagName == "Robot")
+      else if (tagName == "TCP_IP")
       {
         //! <TCP_IP Address="127.0.0.1" Port="6007" Client="false"/>
         for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp (nameiter->c_str(), "Address") == 0)
+          if (*nameiter == "Address")
           {
-            sprintf(params_->tcp_ip_addr, valiter->c_str());
+            valiter->copy(params_->tcp_ip_addr, sizeof(params_->tcp_ip_addr));
           }
-          else if (strcmp (nameiter->c_str(), "Port") == 0)
+          else if (*nameiter == "Port")
           {
-            params_->tcp_ip_port = atoi (valiter->c_str ());
+            params_->tcp_ip_port = valiter->integer();
           }
-          else if (strcmp (nameiter->c_str(), "Client") == 0)
+          else if (*nameiter == "Client")
           {
-            params_->tcp_ip_client = (strcmp (valiter->c_str(), "true") == 0);
+            params_->tcp_ip_client = (*valiter == "true");
           }
           else
           {
             //! Unknown tag
           }
         } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
-      } //... else if (strcmp (tagName.c_str(), "TCP_IP") == 0)
-      else if (strcmp(tagName.c_str(), "Observer") == 0)
+      } //... else if (tagName == "TCP_IP")
+      else if (tagName == "Observer")
       {
-        //! <TCP_IP Address="127.0.0.1" Port="6007" Client="false"/>
+        //! <Observer Address="169.254.152.80" Port="2025" Client="true"/>
+        //!   Client="true":  connect to the robot's state server; "false":  listen for it
         for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp(nameiter->c_str(), "Address") == 0)
+          if (*nameiter == "Address")
           {
-            sprintf(params_->obs_tcp_ip_addr, valiter->c_str());
+            valiter->copy(params_->obs_tcp_ip_addr, sizeof(params_->obs_tcp_ip_addr));
           }
-          else if (strcmp(nameiter->c_str(), "Port") == 0)
+          else if (*nameiter == "Port")
           {
-            params_->obs_tcp_ip_port = atoi(valiter->c_str());
+            params_->obs_tcp_ip_port = valiter->integer();
           }
-          else if (strcmp(nameiter->c_str(), "Client") == 0)
+          else if (*nameiter == "Client")
           {
-            params_->obs_tcp_ip_client = (strcmp(valiter->c_str(), "true") == 0);
+            params_->obs_tcp_ip_client = (*valiter == "true");
           }
           else
           {
             //! Unknown tag
           }
         } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
-      } //... else if (strcmp (tagName.c_str(), "Observer") == 0)
-      else if (strcmp (tagName.c_str(), "Serial") == 0)
+      } //... else if (tagName == "Observer")
+      else if (tagName == "Serial")
       {
         //! <Serial Port="COM7" Rate="57600" Parity="Even" SBits="1" Handshake="None"/>
         for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp (nameiter->c_str(), "Port") == 0)
+          if (*nameiter == "Port")
           {
-            sprintf(params_->serial_port, valiter->c_str());
+            valiter->copy(params_->serial_port, sizeof(params_->serial_port));
           }
-          else if (strcmp (nameiter->c_str(), "Rate") == 0)
+          else if (*nameiter == "Rate")
           {
-            params_->serial_rate = atoi (valiter->c_str ());
+            params_->serial_rate = valiter->integer();
           }
-          else if (strcmp (nameiter->c_str(), "Parity") == 0)
+          else if (*nameiter == "Parity")
           {
-            params_->serial_parity_even = (strcmp (valiter->c_str(), "Even") == 0);
+            params_->serial_parity_even = (*valiter == "Even");
           }
-          else if (strcmp (nameiter->c_str(), "SBits") == 0)
+          else if (*nameiter == "SBits")
           {
-            params_->serial_sbits = atoi (valiter->c_str());
+            params_->serial_sbits = valiter->integer();
           }
-          else if (strcmp (nameiter->c_str(), "Handshake") == 0)
+          else if (*nameiter == "Handshake")
           {
-            sprintf (params_->serial_handshake, valiter->c_str());
+            valiter->copy(params_->serial_handshake, sizeof(params_->serial_handshake));
           }
           else
           {
             //! Unknown tag
           }
         } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
-      } //else if (strcmp (tagName.c_str(), "Serial") == 0)
-      else if (strcmp (tagName.c_str(), "ComType") == 0)
+      } //else if (tagName == "Serial")
+      else if (tagName == "ComType")
       {
         //! <ComType Val="Serial"/>
         for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp (nameiter->c_str(), "Val") == 0)
+          if (*nameiter == "Val")
+          {
+            params_->use_serial = (*valiter == "Serial");
+          }
+          else
+          {
+            //! Unknown tag
+          }
+        } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+      } //else if (tagName == "ComType")
+      else if (tagName == "Protocol")
+      {
+        //! <Protocol Val="Binary"/>
+        for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "Val")
+          {
+            params_->use_binary = (*valiter == "Binary");
+          }
+          else
+          {
+            //! Unknown tag
+          }
+        } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+      } //else if (tagName == "Protocol")
+      else if (tagName == "RTDE")
+      {
+        //! <RTDE Port="30004" Frequency="500"/>
+        params_->use_rtde = true;
+        for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "Port")
+          {
+            params_->rtde_port = valiter->integer();
+          }
+          else if (*nameiter == "Frequency")
+          {
+            params_->rtde_frequency = valiter->real();
+          }
+          else
+          {
+            //! Unknown tag
+          }
+        } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+      } //else if (tagName == "RTDE")
+      else if (tagName == "Polling")
+      {
+        //! <Polling Rate="50"/>
+        for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "Rate")
+          {
+            params_->poll_rate = valiter->real();
+          }
+          else
+          {
+            //! Unknown tag
+          }
+        } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+      } //else if (tagName == "Polling")
+      else if (tagName == "SharedMemory")
+      {
+        //! <SharedMemory Key="6008"/>
+        params_->use_shm = true;
+        for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "Key")
           {
-            params_->use_serial = (strcmp (valiter->c_str(), "Serial") == 0);
+            params_->shm_key = valiter->integer();
           }
           else
           {
             //! Unknown tag
           }
         } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
-      } //else if (strcmp (tagName.c_str(), "ComType") == 0)
-      else if (strcmp (tagName.c_str(), "Mounting") == 0)
+      } //else if (tagName == "SharedMemory")
+      else if (tagName == "Simulation")
+      {
+        //! <Simulation Model="Serial" Axes="6" Links="400,25,455,35,420,80" JointSpeed="180"
+        //!             CartSpeed="500" RotSpeed="180" Rate="125" Latency="2" Jitter="1"/>
+        params_->use_sim = true;
+        for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
+        {
+          if (*nameiter == "Model")
+          {
+            params_->sim_serial = (*valiter == "Serial");
+          }
+          else if (*nameiter == "Axes")
+          {
+            params_->sim_axes = valiter->integer();
+          }
+          else if (*nameiter == "Links")
+          {
+            char links[256];
+            const char *link = links;
+            valiter->copy(links, sizeof(links));
+            for (int i = 0; i < CRPI_AXES_MAX && *link != '\0'; ++i)
+            {
+              params_->sim_links[i] = atof (link);
+              while (*link != '\0' && *link != ',')
+              {
+                ++link;
+              }
+              if (*link == ',')
+              {
+                ++link;
+              }
+            }
+          }
+          else if (*nameiter == "JointSpeed")
+          {
+            params_->sim_joint_speed = valiter->real();
+          }
+          else if (*nameiter == "CartSpeed")
+          {
+            params_->sim_cart_speed = valiter->real();
+          }
+          else if (*nameiter == "RotSpeed")
+          {
+            params_->sim_rot_speed = valiter->real();
+          }
+          else if (*nameiter == "Rate")
+          {
+            params_->sim_rate = valiter->real();
+          }
+          else if (*nameiter == "Latency")
+          {
+            params_->sim_latency = valiter->real();
+          }
+          else if (*nameiter == "Jitter")
+          {
+            params_->sim_jitter = valiter->real();
+          }
+          else
+          {
+            //! Unknown tag
+          }
+        } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
+      } //else if (tagName == "Simulation")
+      else if (tagName == "Mounting")
       {
         //! <Mounting X="0.0" Y="0.0" Z="0.0" XR="0.0" YR="0.0" ZR="0.0"/>
         for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp (nameiter->c_str(), "X") == 0)
+          if (*nameiter == "X")
           {
-            params_->mounting->x = atof(valiter->c_str());
+            params_->mounting->x = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "Y") == 0)
+          else if (*nameiter == "Y")
           {
-            params_->mounting->y = atof(valiter->c_str());
+            params_->mounting->y = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "Z") == 0)
+          else if (*nameiter == "Z")
           {
-            params_->mounting->z = atof(valiter->c_str());
+            params_->mounting->z = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "XR") == 0)
+          else if (*nameiter == "XR")
           {
-            params_->mounting->xrot = atof(valiter->c_str());
+            params_->mounting->xrot = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "YR") == 0)
+          else if (*nameiter == "YR")
           {
-            params_->mounting->yrot = atof(valiter->c_str());
+            params_->mounting->yrot = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "ZR") == 0)
+          else if (*nameiter == "ZR")
           {
-            params_->mounting->zrot = atof(valiter->c_str());
+            params_->mounting->zrot = valiter->real();
           }
           else
           {
             //! Unknown tag
           }
         } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
-      } //else if (strcmp (tagName.c_str(), "Mounting") == 0)
-      else if (strcmp (tagName.c_str(), "ToWorld") == 0)
+      } //else if (tagName == "Mounting")
+      else if (tagName == "ToWorld")
       {
         // <ToWorld X = "2335.14" Y = "471.0" Z = "661.0" XR = "0.0" YR = "0.0" ZR = "90.0" M00 = "0.0" M01 = "0.0" M02 = "0.0" M03 = "0.0" M10 = "0.0" M11 = "0.0" M12 = "0.0" M13 = "0.0" M20 = "0.0" M21 = "0.0" M22 = "0.0" M23 = "0.0" M30 = "0.0" M31 = "0.0" M32 = "0.0" M33 = "0.0" / >
         for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp (nameiter->c_str(), "X") == 0)
+          if (*nameiter == "X")
           {
-            params_->toWorld->x = atof(valiter->c_str());
+            params_->toWorld->x = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "Y") == 0)
+          else if (*nameiter == "Y")
           {
-            params_->toWorld->y = atof(valiter->c_str());
+            params_->toWorld->y = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "Z") == 0)
+          else if (*nameiter == "Z")
           {
-            params_->toWorld->z = atof(valiter->c_str());
+            params_->toWorld->z = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "XR") == 0)
+          else if (*nameiter == "XR")
           {
-            params_->toWorld->xrot = atof(valiter->c_str());
+            params_->toWorld->xrot = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "YR") == 0)
+          else if (*nameiter == "YR")
           {
-            params_->toWorld->yrot = atof(valiter->c_str());
+            params_->toWorld->yrot = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "ZR") == 0)
+          else if (*nameiter == "ZR")
           {
-            params_->toWorld->zrot = atof(valiter->c_str());
+            params_->toWorld->zrot = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "M00") == 0)
+          else if (*nameiter == "M00")
           {
-            params_->toWorldMatrix->at(0, 0) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(0, 0) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M01") == 0)
+          else if (*nameiter == "M01")
           {
-            params_->toWorldMatrix->at(0, 1) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(0, 1) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M02") == 0)
+          else if (*nameiter == "M02")
           {
-            params_->toWorldMatrix->at(0, 2) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(0, 2) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M03") == 0)
+          else if (*nameiter == "M03")
           {
-            params_->toWorldMatrix->at(0, 3) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(0, 3) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M10") == 0)
+          else if (*nameiter == "M10")
           {
-            params_->toWorldMatrix->at(1, 0) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(1, 0) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M11") == 0)
+          else if (*nameiter == "M11")
           {
-            params_->toWorldMatrix->at(1, 1) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(1, 1) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M12") == 0)
+          else if (*nameiter == "M12")
           {
-            params_->toWorldMatrix->at(1, 2) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(1, 2) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M13") == 0)
+          else if (*nameiter == "M13")
           {
-            params_->toWorldMatrix->at(1, 3) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(1, 3) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M20") == 0)
+          else if (*nameiter == "M20")
           {
-            params_->toWorldMatrix->at(2, 0) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(2, 0) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M21") == 0)
+          else if (*nameiter == "M21")
           {
-            params_->toWorldMatrix->at(2, 1) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(2, 1) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M22") == 0)
+          else if (*nameiter == "M22")
           {
-            params_->toWorldMatrix->at(2, 2) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(2, 2) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M23") == 0)
+          else if (*nameiter == "M23")
           {
-            params_->toWorldMatrix->at(2, 3) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(2, 3) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M30") == 0)
+          else if (*nameiter == "M30")
           {
-            params_->toWorldMatrix->at(3, 0) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(3, 0) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M31") == 0)
+          else if (*nameiter == "M31")
           {
-            params_->toWorldMatrix->at(3, 1) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(3, 1) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M32") == 0)
+          else if (*nameiter == "M32")
           {
-            params_->toWorldMatrix->at(3, 2) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(3, 2) = valiter->real();
             params_->usedMatrix = true;
           }
-          else if (strcmp (nameiter->c_str(), "M33") == 0)
+          else if (*nameiter == "M33")
           {
-            params_->toWorldMatrix->at(3, 3) = atof(valiter->c_str());
+            params_->toWorldMatrix->at(3, 3) = valiter->real();
             params_->usedMatrix = true;
           }
           else
@@ -637,8 +446,8 @@ namespace Xml
             //! Unknown tag
           }
         } //for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
-      } //else if (strcmp (tagName.c_str(), "ToWorld") == 0)
-      else if (strcmp(tagName.c_str(), "CoordSystem") == 0)
+      } //else if (tagName == "ToWorld")
+      else if (tagName == "CoordSystem")
       {
         // <CoordSystem Name = "Table1" X = "2335.14" Y = "471.0" Z = "661.0" XR = "0.0" YR = "0.0" ZR = "90.0" M00 = "0.0" M01 = "0.0" M02 = "0.0" M03 = "0.0" M10 = "0.0" M11 = "0.0" M12 = "0.0" M13 = "0.0" M20 = "0.0" M21 = "0.0" M22 = "0.0" M23 = "0.0" M30 = "0.0" M31 = "0.0" M32 = "0.0" M33 = "0.0" / >
         Math::matrix *mtemp;
@@ -648,112 +457,112 @@ namespace Xml
         bool usedmatrix = false;
         for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp(nameiter->c_str(), "Name") == 0)
+          if (*nameiter == "Name")
           {
-            stemp = valiter->c_str();
+            valiter->copy(stemp);
           }
-          if (strcmp(nameiter->c_str(), "X") == 0)
+          if (*nameiter == "X")
           {
-            ptemp.x = atof(valiter->c_str());
+            ptemp.x = valiter->real();
           }
-          else if (strcmp(nameiter->c_str(), "Y") == 0)
+          else if (*nameiter == "Y")
           {
-            ptemp.y = atof(valiter->c_str());
+            ptemp.y = valiter->real();
           }
-          else if (strcmp(nameiter->c_str(), "Z") == 0)
+          else if (*nameiter == "Z")
           {
-            ptemp.z = atof(valiter->c_str());
+            ptemp.z = valiter->real();
           }
-          else if (strcmp(nameiter->c_str(), "XR") == 0)
+          else if (*nameiter == "XR")
           {
-            ptemp.xr = atof(valiter->c_str());
+            ptemp.xr = valiter->real();
           }
-          else if (strcmp(nameiter->c_str(), "YR") == 0)
+          else if (*nameiter == "YR")
           {
-            ptemp.yr = atof(valiter->c_str());
+            ptemp.yr = valiter->real();
           }
-          else if (strcmp(nameiter->c_str(), "ZR") == 0)
+          else if (*nameiter == "ZR")
           {
-            ptemp.zr = atof(valiter->c_str());
+            ptemp.zr = valiter->real();
           }
-          else if (strcmp(nameiter->c_str(), "M00") == 0)
+          else if (*nameiter == "M00")
           {
-            mtemp->at(0, 0) = atof(valiter->c_str());
+            mtemp->at(0, 0) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M01") == 0)
+          else if (*nameiter == "M01")
           {
-            mtemp->at(0, 1) = atof(valiter->c_str());
+            mtemp->at(0, 1) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M02") == 0)
+          else if (*nameiter == "M02")
           {
-            mtemp->at(0, 2) = atof(valiter->c_str());
+            mtemp->at(0, 2) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M03") == 0)
+          else if (*nameiter == "M03")
           {
-            mtemp->at(0, 3) = atof(valiter->c_str());
+            mtemp->at(0, 3) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M10") == 0)
+          else if (*nameiter == "M10")
           {
-            mtemp->at(1, 0) = atof(valiter->c_str());
+            mtemp->at(1, 0) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M11") == 0)
+          else if (*nameiter == "M11")
           {
-            mtemp->at(1, 1) = atof(valiter->c_str());
+            mtemp->at(1, 1) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M12") == 0)
+          else if (*nameiter == "M12")
           {
-            mtemp->at(1, 2) = atof(valiter->c_str());
+            mtemp->at(1, 2) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M13") == 0)
+          else if (*nameiter == "M13")
           {
-            mtemp->at(1, 3) = atof(valiter->c_str());
+            mtemp->at(1, 3) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M20") == 0)
+          else if (*nameiter == "M20")
           {
-            mtemp->at(2, 0) = atof(valiter->c_str());
+            mtemp->at(2, 0) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M21") == 0)
+          else if (*nameiter == "M21")
           {
-            mtemp->at(2, 1) = atof(valiter->c_str());
+            mtemp->at(2, 1) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M22") == 0)
+          else if (*nameiter == "M22")
           {
-            mtemp->at(2, 2) = atof(valiter->c_str());
+            mtemp->at(2, 2) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M23") == 0)
+          else if (*nameiter == "M23")
           {
-            mtemp->at(2, 3) = atof(valiter->c_str());
+            mtemp->at(2, 3) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M30") == 0)
+          else if (*nameiter == "M30")
           {
-            mtemp->at(3, 0) = atof(valiter->c_str());
+            mtemp->at(3, 0) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M31") == 0)
+          else if (*nameiter == "M31")
           {
-            mtemp->at(3, 1) = atof(valiter->c_str());
+            mtemp->at(3, 1) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M32") == 0)
+          else if (*nameiter == "M32")
           {
-            mtemp->at(3, 2) = atof(valiter->c_str());
+            mtemp->at(3, 2) = valiter->real();
             usedmatrix = true;
           }
-          else if (strcmp(nameiter->c_str(), "M33") == 0)
+          else if (*nameiter == "M33")
           {
-            mtemp->at(3, 3) = atof(valiter->c_str());
+            mtemp->at(3, 3) = valiter->real();
             usedmatrix = true;
           }
           else
@@ -772,66 +581,66 @@ namespace Xml
         params_->toCoordSystMatrices.push_back(mtemp);
         params_->toCoordSystPoses.push_back(rptemp);
         params_->coordSystNames.push_back(stemp);
-      } //else if (strcmp (tagName.c_str(), "CoordSystem") == 0)
-      else if (strcmp (tagName.c_str(), "Tool") == 0)
+      } //else if (tagName == "CoordSystem")
+      else if (tagName == "Tool")
       {
         //<Tool ID="7" Name="gripper_gear" X="0.0" Y="0.0" Z="0.0" XR="0.0" YR="0.0" ZR="0.0" MX="0.0" MY="0.0" MZ="0.0"/>
         for (nameiter = attr.name.begin(), valiter = attr.val.begin(); nameiter != attr.name.end(); ++nameiter, ++valiter)
         {
-          if (strcmp (nameiter->c_str(), "ID") == 0)
+          if (*nameiter == "ID")
           {
-            toolTmp->toolID = atoi(valiter->c_str());
+            toolTmp->toolID = valiter->integer();
           }
-          else if (strcmp (nameiter->c_str(), "Name") == 0)
+          else if (*nameiter == "Name")
           {
-            toolTmp->toolName = valiter->c_str();
+            valiter->copy(toolTmp->toolName);
           }
-          else if (strcmp (nameiter->c_str(), "X") == 0)
+          else if (*nameiter == "X")
           {
-            toolTmp->TCP.x = atof(valiter->c_str());
+            toolTmp->TCP.x = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "Y") == 0)
+          else if (*nameiter == "Y")
           {
-            toolTmp->TCP.y = atof(valiter->c_str());
+            toolTmp->TCP.y = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "Z") == 0)
+          else if (*nameiter == "Z")
           {
-            toolTmp->TCP.z = atof(valiter->c_str());
+            toolTmp->TCP.z = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "Mass") == 0)
+          else if (*nameiter == "Mass")
           {
-            toolTmp->mass = atof(valiter->c_str());
+            toolTmp->mass = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "XR") == 0)
+          else if (*nameiter == "XR")
           {
-            toolTmp->TCP.xrot = atof(valiter->c_str());
+            toolTmp->TCP.xrot = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "YR") == 0)
+          else if (*nameiter == "YR")
           {
-            toolTmp->TCP.yrot = atof(valiter->c_str());
+            toolTmp->TCP.yrot = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "ZR") == 0)
+          else if (*nameiter == "ZR")
           {
-            toolTmp->TCP.zrot = atof(valiter->c_str());
+            toolTmp->TCP.zrot = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "MX") == 0)
+          else if (*nameiter == "MX")
           {
-            toolTmp->centerMass.x = atof(valiter->c_str());
+            toolTmp->centerMass.x = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "MY") == 0)
+          else if (*nameiter == "MY")
           {
-            toolTmp->centerMass.y = atof(valiter->c_str());
+            toolTmp->centerMass.y = valiter->real();
           }
-          else if (strcmp (nameiter->c_str(), "MZ") == 0)
+          else if (*nameiter == "MZ")
           {
-            toolTmp->centerMass.z = atof(valiter->c_str());
+            toolTmp->centerMass.z = valiter->real();
           }
           else
           {
             //! Unknown tag
           }
         } // for (; nameiter != attr.name.end(); ++nameiter, ++valiter)
-      } //else if (strcmp (tagName.c_str(), "Tool") == 0)
+      } //else if (tagName == "Tool")
       else
       {
         //! Unknown tag
@@ -846,115 +655,114 @@ namespace Xml
   }
 
 
-  LIBRARY_API bool CrpiRobotXml::interTagElement (const string& tagName, 
-                                                  const std::vector<std::string>& vals)
+  LIBRARY_API bool CrpiRobotXml::interTagElement (const xmlView& tagName, 
+                                                  const xmlViewList& vals)
   {
     bool flag = true;
-    std::vector<std::string>::const_iterator valiter = vals.begin();
 
     try
     {
 /*
       //! Robot pose:
-      if (strcmp (tagName.c_str(), "X") == 0)
+      if (tagName == "X")
       {
         for (; valiter != vals.end(); ++valiter)
         {
-          params_->pose->x = atof (valiter->c_str ());
+          params_->pose->x = valiter->real();
         }
       }
-      if (strcmp (tagName.c_str(), "Y") == 0)
+      if (tagName == "Y")
       {
         for (; valiter != vals.end(); ++valiter)
         {
-          params_->pose->y = atof (valiter->c_str ());
+          params_->pose->y = valiter->real();
         }
       }
-      if (strcmp (tagName.c_str(), "Z") == 0)
+      if (tagName == "Z")
       {
         for (; valiter != vals.end(); ++valiter)
         {
-          params_->pose->z = atof (valiter->c_str ());
+          params_->pose->z = valiter->real();
         }
       }
 
       //! Robot orientation
-      if (strcmp (tagName.c_str(), "I") == 0)
+      if (tagName == "I")
       {
         for (; valiter != vals.end(); ++valiter)
         {
           if (xaxisactive)
           {
-            params_->xaxis.i = atof (valiter->c_str ());
+            params_->xaxis.i = valiter->real();
           }
           else if (zaxisactive)
           {
-            params_->zaxis.i = atof (valiter->c_str ());
+            params_->zaxis.i = valiter->real();
           }
         }
       }
-      if (strcmp (tagName.c_str(), "J") == 0)
+      if (tagName == "J")
       {
         for (; valiter != vals.end(); ++valiter)
         {
           if (xaxisactive)
           {
-            params_->xaxis.j = atof (valiter->c_str ());
+            params_->xaxis.j = valiter->real();
           }
           else if (zaxisactive)
           {
-            params_->zaxis.j = atof (valiter->c_str ());
+            params_->zaxis.j = valiter->real();
           }
         }
       }
-      if (strcmp (tagName.c_str(), "K") == 0)
+      if (tagName == "K")
       {
         for (; valiter != vals.end(); ++valiter)
         {
           if (xaxisactive)
           {
-            params_->xaxis.k = atof (valiter->c_str ());
+            params_->xaxis.k = valiter->real();
           }
           else if (zaxisactive)
           {
-            params_->zaxis.k = atof (valiter->c_str ());
+            params_->zaxis.k = valiter->real();
           }
         }
       }
 
       //! NumPositions
-      if (strcmp (tagName.c_str(), "NumPositions") == 0)
+      if (tagName == "NumPositions")
       {
         for (; valiter != vals.end(); ++valiter)
         {
-          params_->numPositions = atof (valiter->c_str ());
+          params_->numPositions = valiter->real();
         }
       }
 
       //! CommandID
-      if (strcmp (tagName.c_str(), "CommandID") == 0)
+      if (tagName == "CommandID")
       {
         for (; valiter != vals.end(); ++valiter)
         {
-          params_->commandID = atoi (valiter->c_str ());
+          params_->commandID = valiter->integer();
         }
       }
 
       //! Setting
-      if (strcmp (tagName.c_str(), "Setting") == 0)
+      if (tagName == "Setting")
       {
         for (; valiter != vals.end(); ++valiter)
         {
-          params_->setting = atof (valiter->c_str ());
+          params_->setting = valiter->real();
         }
       }
 
       //! MoveStraight
-      if (strcmp (tagName.c_str(), "MoveStraight") == 0)
+      if (tagName == "MoveStraight")
       {
         for (; valiter != vals.end(); ++valiter)
         {
-          if (strcmp (valiter->c_str(), "true"))
+          if (*valiter != "true")
           {
             params_->moveStraight = true;
           }
@@ -965,11 +773,11 @@ namespace Xml
         }
       }
 
-      if (strcmp (tagName.c_str(), "Name") == 0)
+      if (tagName == "Name")
       {
         for (; valiter != vals.end(); ++valiter)
         {
-          params_->str = valiter->c_str();
+          valiter->copy(params_->str);
         }
       }
 */
@@ -983,17 +791,17 @@ namespace Xml
   }
 
 
-  LIBRARY_API bool CrpiRobotXml::endElement(const string& tagName)
+  LIBRARY_API bool CrpiRobotXml::endElement(const xmlView& tagName)
   {
 /*
-    if (strcmp (tagName.c_str(), "XAxis") == 0)
+    if (tagName == "XAxis")
     {
       xaxisactive = false;
-    } //if (strcmp (tagName.c_str(), "XAxis") == 0)
-    if (strcmp (tagName.c_str(), "ZAxis") == 0)
+    } //if (tagName == "XAxis")
+    if (tagName == "ZAxis")
     {
       zaxisactive = false;
-    } //if (strcmp (tagName.c_str(), "ZAxis") == 0)
+    } //if (tagName == "ZAxis")
 */
     /*
     if (tagName == "RobData")
@@ -1005,7 +813,7 @@ namespace Xml
       return false;
     }
     */
-    if (strcmp(tagName.c_str(), "Tool") == 0)
+    if (tagName == "Tool")
     {
       params_->tools.push_back(*toolTmp);
     }
@@ -1029,32 +837,72 @@ namespace Xml
     <Tool ID="5" Name="robotiq" X="0.0" Y="0.0" Z="260.0" XR="0.0" YR="0.0" ZR="0.0" Mass="2.7" MX="0.0" MY="0.0" MZ="125.0"/>
   </ROBOT>
   */
-  LIBRARY_API bool CrpiRobotXml::encode (char *line)
+  LIBRARY_API bool CrpiRobotXml::encode (std::string &line)
   {
-    std::stringstream strm;
+    XmlWriter out(line);
     vector<CrpiToolDef>::iterator titer;
     vector<string>::iterator niter;
     vector<Math::matrix*>::iterator miter;
     vector<robotPose>::iterator piter;
 
+    out.clear();
     if (params_ != NULL)
     {
-      strm << "<ROBOT>\n <TCP_IP Address=\"" << params_->tcp_ip_addr << "\" Port=\"" << params_->tcp_ip_port
-           << "\" Client=\"" << (params_->tcp_ip_client ? "true" : "false") << "\"/>\n  <ComType Val=\""
-           << (params_->use_serial ? "SERIAL" : "TCP_IP") << "\"/>\n  <Mounting X=\"" << params_->mounting->x
-           << "\" Y=\"" << params_->mounting->y << "\" Z=\"" << params_->mounting->z << "\" XR=\""
-           << params_->mounting->xrot << "\" YR=\"" << params_->mounting->yrot << "\" ZR=\"" << params_->mounting->zrot
-           << "\"/>\n  <ToWorld X=\"" << params_->toWorld->x << "\" Y=\"" << params_->toWorld->y << "\" Z=\""
-           << params_->toWorld->z << "\" XR=\"" << params_->toWorld->xrot << "\" YR=\"" << params_->toWorld->yrot
-           << "\" ZR=\"" << params_->toWorld->zrot << "\" M00=\"" << params_->toWorldMatrix->at(0, 0) << "\" M01=\""
-           << params_->toWorldMatrix->at(0, 1) << "\" M02=\"" << params_->toWorldMatrix->at(0, 2) << "\" M03=\""
-           << params_->toWorldMatrix->at(0, 3) << "\" M10=\"" << params_->toWorldMatrix->at(1, 0) << "\" M11=\""
-           << params_->toWorldMatrix->at(1, 1) << "\" M12=\"" << params_->toWorldMatrix->at(1, 2) << "\" M13=\""
-           << params_->toWorldMatrix->at(1, 3) << "\" M20=\"" << params_->toWorldMatrix->at(2, 0) << "\" M21=\""
-           << params_->toWorldMatrix->at(2, 1) << "\" M22=\"" << params_->toWorldMatrix->at(2, 2) << "\" M23=\""
-           << params_->toWorldMatrix->at(2, 3) << "\" M30=\"" << params_->toWorldMatrix->at(3, 0) << "\" M31=\""
-           << params_->toWorldMatrix->at(3, 1) << "\" M32=\"" << params_->toWorldMatrix->at(3, 2) << "\" M33=\""
-           << params_->toWorldMatrix->at(3, 3) << "\"/>\n";
+      out << "<ROBOT>\n <TCP_IP Address=\"" << params_->tcp_ip_addr << "\" Port=\"" << params_->tcp_ip_port
+          << "\" Client=\"" << (params_->tcp_ip_client ? "true" : "false") << "\"/>\n  <ComType Val=\""
+          << (params_->use_serial ? "SERIAL" : "TCP_IP") << "\"/>\n  <Mounting X=\"" << params_->mounting->x
+          << "\" Y=\"" << params_->mounting->y << "\" Z=\"" << params_->mounting->z << "\" XR=\""
+          << params_->mounting->xrot << "\" YR=\"" << params_->mounting->yrot << "\" ZR=\"" << params_->mounting->zrot
+          << "\"/>\n  <ToWorld X=\"" << params_->toWorld->x << "\" Y=\"" << params_->toWorld->y << "\" Z=\""
+          << params_->toWorld->z << "\" XR=\"" << params_->toWorld->xrot << "\" YR=\"" << params_->toWorld->yrot
+          << "\" ZR=\"" << params_->toWorld->zrot << "\" M00=\"" << params_->toWorldMatrix->at(0, 0) << "\" M01=\""
+          << params_->toWorldMatrix->at(0, 1) << "\" M02=\"" << params_->toWorldMatrix->at(0, 2) << "\" M03=\""
+          << params_->toWorldMatrix->at(0, 3) << "\" M10=\"" << params_->toWorldMatrix->at(1, 0) << "\" M11=\""
+          << params_->toWorldMatrix->at(1, 1) << "\" M12=\"" << params_->toWorldMatrix->at(1, 2) << "\" M13=\""
+          << params_->toWorldMatrix->at(1, 3) << "\" M20=\"" << params_->toWorldMatrix->at(2, 0) << "\" M21=\""
+          << params_->toWorldMatrix->at(2, 1) << "\" M22=\"" << params_->toWorldMatrix->at(2, 2) << "\" M23=\""
+          << params_->toWorldMatrix->at(2, 3) << "\" M30=\"" << params_->toWorldMatrix->at(3, 0) << "\" M31=\""
+          << params_->toWorldMatrix->at(3, 1) << "\" M32=\"" << params_->toWorldMatrix->at(3, 2) << "\" M33=\""
+          << params_->toWorldMatrix->at(3, 3) << "\"/>\n";
+
+      if (params_->use_binary)
+      {
+        out << "  <Protocol Val=\"Binary\"/>\n";
+      }
+
+      if (params_->obs_tcp_ip_port > 0)
+      {
+        out << "  <Observer Address=\"" << params_->obs_tcp_ip_addr << "\" Port=\"" << params_->obs_tcp_ip_port
+            << "\" Client=\"" << (params_->obs_tcp_ip_client ? "true" : "false") << "\"/>\n";
+      }
+
+      if (params_->use_rtde)
+      {
+        out << "  <RTDE Port=\"" << params_->rtde_port << "\" Frequency=\"" << params_->rtde_frequency << "\"/>\n";
+      }
+
+      if (params_->poll_rate > 0.0)
+      {
+        out << "  <Polling Rate=\"" << params_->poll_rate << "\"/>\n";
+      }
+
+      if (params_->use_shm)
+      {
+        out << "  <SharedMemory Key=\"" << params_->shm_key << "\"/>\n";
+      }
+
+      if (params_->use_sim)
+      {
+        out << "  <Simulation Model=\"" << (params_->sim_serial ? "Serial" : "Cartesian") << "\" Axes=\""
+            << params_->sim_axes << "\" Links=\"";
+        for (int i = 0; i < params_->sim_axes && i < CRPI_AXES_MAX; ++i)
+        {
+          out << (i > 0 ? "," : "") << params_->sim_links[i];
+        }
+        out << "\" JointSpeed=\"" << params_->sim_joint_speed << "\" CartSpeed=\"" << params_->sim_cart_speed
+            << "\" RotSpeed=\"" << params_->sim_rot_speed << "\" Rate=\"" << params_->sim_rate
+            << "\" Latency=\"" << params_->sim_latency << "\" Jitter=\"" << params_->sim_jitter << "\"/>\n";
+      }
            
       //! Encode coordinate system transformations
       niter = params_->coordSystNames.begin();
@@ -1062,30 +910,28 @@ namespace Xml
       piter = params_->toCoordSystPoses.begin();
       for (; niter != params_->coordSystNames.end(); ++niter, ++miter, ++piter)
       {
-        strm << "<CoordSystem Name=\"" << niter->c_str() << "\" X=\"" << (*piter).x << "\" Y=\"" 
-             << (*piter).y << "\" Z=\"" << (*piter).z << "\" XR=\"" << (*piter).xrot << "\" YR=\""
-             << (*piter).yrot << "\" ZR=\"" << (*piter).zrot << "\" M00=\"" << (*miter)->at(0, 0) 
-             << "\" M01=\"" << (*miter)->at(0, 1) << "\" M02=\"" << (*miter)->at(0, 2) << "\" M03=\""
-             << (*miter)->at(0, 3) << "\" M10=\"" << (*miter)->at(1, 0) << "\" M11=\""
-             << (*miter)->at(1, 1) << "\" M12=\"" << (*miter)->at(1, 2) << "\" M13=\""
-             << (*miter)->at(1, 3) << "\" M20=\"" << (*miter)->at(2, 0) << "\" M21=\""
-             << (*miter)->at(2, 1) << "\" M22=\"" << (*miter)->at(2, 2) << "\" M23=\""
-             << (*miter)->at(2, 3) << "\" M30=\"" << (*miter)->at(3, 0) << "\" M31=\""
-             << (*miter)->at(3, 1) << "\" M32=\"" << (*miter)->at(3, 2) << "\" M33=\""
-             << (*miter)->at(3, 3) << "\"/>\n";
+        out << "<CoordSystem Name=\"" << niter->c_str() << "\" X=\"" << (*piter).x << "\" Y=\"" 
+            << (*piter).y << "\" Z=\"" << (*piter).z << "\" XR=\"" << (*piter).xrot << "\" YR=\""
+            << (*piter).yrot << "\" ZR=\"" << (*piter).zrot << "\" M00=\"" << (*miter)->at(0, 0) 
+            << "\" M01=\"" << (*miter)->at(0, 1) << "\" M02=\"" << (*miter)->at(0, 2) << "\" M03=\""
+            << (*miter)->at(0, 3) << "\" M10=\"" << (*miter)->at(1, 0) << "\" M11=\""
+            << (*miter)->at(1, 1) << "\" M12=\"" << (*miter)->at(1, 2) << "\" M13=\""
+            << (*miter)->at(1, 3) << "\" M20=\"" << (*miter)->at(2, 0) << "\" M21=\""
+            << (*miter)->at(2, 1) << "\" M22=\"" << (*miter)->at(2, 2) << "\" M23=\""
+            << (*miter)->at(2, 3) << "\" M30=\"" << (*miter)->at(3, 0) << "\" M31=\""
+            << (*miter)->at(3, 1) << "\" M32=\"" << (*miter)->at(3, 2) << "\" M33=\""
+            << (*miter)->at(3, 3) << "\"/>\n";
       }
 
       for (titer = params_->tools.begin(); titer != params_->tools.end(); ++titer)
       {
-        strm << "  <Tool ID=\"" << titer->toolID << "\" Name=\"" << titer->toolName.c_str() << "\" X=\""
-             << titer->TCP.x << "\" Y=\"" << titer->TCP.y << "\" Z=\"" << titer->TCP.z << "\" XR=\""
-             << titer->TCP.xrot << "\" YR=\"" << titer->TCP.yrot << "\" ZR=\"" << titer->TCP.zrot << "\" Mass=\""
-             << titer->mass << "\" MX=\"" << titer->centerMass.x << "\" MY=\"" << titer->centerMass.y << "\" MZ=\""
-             << titer->centerMass.z << "\"/>\n";
+        out << "  <Tool ID=\"" << titer->toolID << "\" Name=\"" << titer->toolName.c_str() << "\" X=\""
+            << titer->TCP.x << "\" Y=\"" << titer->TCP.y << "\" Z=\"" << titer->TCP.z << "\" XR=\""
+            << titer->TCP.xrot << "\" YR=\"" << titer->TCP.yrot << "\" ZR=\"" << titer->TCP.zrot << "\" Mass=\""
+            << titer->mass << "\" MX=\"" << titer->centerMass.x << "\" MY=\"" << titer->centerMass.y << "\" MZ=\""
+            << titer->centerMass.z << "\"/>\n";
       }           
-      strm << "</ROBOT>\n";
-
-      sprintf(line, "%s", strm.str().c_str());
+      out << "</ROBOT>\n";
     } //if (params_ != NULL)
     return true;
   }
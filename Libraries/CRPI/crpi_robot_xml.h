@@ -19,6 +19,8 @@
 #include <vector>
 #include <string>
 #include "crpi.h"
+#include "crpi_sax.h"
+#include "crpi_xml_writer.h"
 
 namespace Xml
 {
@@ -26,7 +28,7 @@ namespace Xml
   //!
   //! @brief XML parsing class based on the SAX structure
   //!
-  class LIBRARY_API CrpiRobotXml
+  class LIBRARY_API CrpiRobotXml : private XmlHandler
   {
   public:
 
@@ -52,25 +54,17 @@ namespace Xml
 
     //! @brief Encode an XML string from an input schema
     //!
-    //! @param line The output XML string
+    //! @param line Replaced with the XML string (see XmlWriter)
     //!
     //! @return True if encoding was successful, false otherwise
     //!
-    bool encode (char* line);
+    bool encode (std::string &line);
 
   private:
 
     CrpiRobotParams *params_;
     CrpiToolDef *toolTmp;
 
-    //! @brief Parse the text between the tag pair
-    //!
-    //! @param ch The string of character located between the tag pair
-    //!
-    //! @return True if parsing is successful
-    //!
-    bool characters (const std::vector<std::string>& ch);
-
     //! @brief Parse the first tag of a tag pair
     //!
     //! @param tagName The tag label
@@ -78,18 +72,18 @@ namespace Xml
     //!
     //! @return True if parsing is successful
     //!
-    bool startElement (const std::string& tagName, 
+    bool startElement (const xmlView& tagName, 
                        const xmlAttributes& attr);
 
-    //! @brief Parse the first tag of a tag pair
+    //! @brief Parse the text between the tag pair
     //!
     //! @param tagName The tag label
-    //! @param attr    String of additional attributes located within the tag
+    //! @param vals    The comma-separated text items
     //!
     //! @return True if parsing is successful
     //!
-    bool interTagElement (const std::string& tagName, 
-                          const std::vector<std::string>& attr);
+    bool interTagElement (const xmlView& tagName, 
+                          const xmlViewList& vals);
 
     //! @brief Parse the second tag of a tag pair
     //!
@@ -97,7 +91,7 @@ namespace Xml
     //!
     //! @return True if parsing is successful
     //!
-    bool endElement (const std::string& tagName);
+    bool endElement (const xmlView& tagName);
 
   }; // CrpiRobotXml
 } // Xml namespace
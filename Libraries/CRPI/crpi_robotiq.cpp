@@ -13,6 +13,7 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "crpi_robotiq.h"
+#include "crpi_watchdog.h"
 #include <iostream>
 
 //#define NOISY
@@ -21,20 +22,19 @@ using namespace std;
 
 namespace crpi_robot
 {
-  void livemanRobotiq (void *param)
+  //! @brief Keepalive heartbeat:  report the age of the newest status from the background poll
+  //!        without waiting behind a command for the gripper lock
+  //!
+  bool heartbeatRobotiq (void *param, double &feedbackTime)
   {
-    keepalive *ka = (keepalive*)param;
-    int val;
-    crpi_timer timer;
+    RobotiqModbus *modbus = (RobotiqModbus*)param;
+    robotiqStatus status;
 
-    while (ka->runThread)
+    if (modbus->status(status) > 0)
     {
-      ((CrpiRobotiq*)ka->rob)->SetParameter("STATUS", &val);
-
-      //! Don't slam your processor!  You don't need to poll at full speed.
-      timer.waitUntil(5000);
+      feedbackTime = status.received;
     }
-    return;
+    return modbus->connected();
   }
 
   LIBRARY_API CrpiRobotiq::CrpiRobotiq (CrpiRobotParams &params)
@@ -63,25 +63,17 @@ namespace crpi_robot
     commandRegister_[11] = 0x0F; 
     commandRegister_[12] = 0x1E;  // Consisting of 30 bytes of data
 
-    statusRegister_[0] = 0x00; // 
-    statusRegister_[1] = 0x01;
-    statusRegister_[2] = 0x00; // 
-    statusRegister_[3] = 0x00;
-    statusRegister_[4] = 0x00;  //  
-    statusRegister_[5] = 0x06;
-    statusRegister_[6] = 0x02;  // 
-    statusRegister_[7] = 0x04;  // 
-    statusRegister_[8] = 0x00;  // 
-    statusRegister_[9] = 0x00;
-    statusRegister_[10] = 0x00;  // 
-    statusRegister_[11] = 0x0F; 
-
-    //! Establish socket connection
-    //clientID_ = ulapi_socket_get_client_id (502, "129.6.35.31"); //"169.254.152.31");
-    clientID_ = ulapi_socket_get_client_id (params_->tcp_ip_port, params_->tcp_ip_addr);
+    //! Nothing is known about the gripper until the first status read arrives
+    robotiqStatus status;
+    memset(&status, 0, sizeof(robotiqStatus));
+    applyStatus(status);
+
+    //! Establish socket connection; status registers are then polled in the background
+    modbus_ = new RobotiqModbus();
+    modbus_->connect(params_->tcp_ip_addr, params_->tcp_ip_port, params_->poll_rate);
 
 #ifdef NOISY
-    if (clientID_ < 0)
+    if (!modbus_->connected())
     {
       cout << "no connection" << endl;
     }
@@ -103,17 +95,15 @@ namespace crpi_robot
     
     grasped_ = false;
 
-    task = ulapi_task_new();
     ka_.handle = ulapi_mutex_new(99);
-    ka_.rob = this;
-    ka_.runThread = true;
-
-    ulapi_task_start((ulapi_task_struct*)task, livemanRobotiq, &ka_, ulapi_prio_lowest(), 0);
+    watchId_ = CrpiWatchdog::instance().add("Robotiq", WATCHDOG_PERIOD, heartbeatRobotiq, modbus_, 2.0 * WATCHDOG_PERIOD);
   }
 
   LIBRARY_API CrpiRobotiq::~CrpiRobotiq ()
   {
-    ka_.runThread = false;
+    CrpiWatchdog::instance().remove(watchId_);
+    modbus_->disconnect();
+    delete modbus_;
   }
 
   LIBRARY_API CanonReturn CrpiRobotiq::ApplyCartesianForceTorque (robotPose &robotForceTorque, vector<bool> activeAxes, vector<bool> manipulator)
@@ -543,6 +533,11 @@ namespace crpi_robot
     {
       getStatusRegisters ();
     }
+    else if (strcmp (paramName, "GRASP_MONITOR") == 0)
+    {
+      //! Hand out the grasp monitor to callers that only hold a CrpiRobot<CrpiRobotiq>
+      *((RobotiqGraspMonitor**)paramVal) = &modbus_->monitor();
+    }
     else
     {
       return CANON_FAILURE;
@@ -554,6 +549,12 @@ namespace crpi_robot
   }
 
 
+  LIBRARY_API RobotiqGraspMonitor *CrpiRobotiq::GraspMonitor ()
+  {
+    return &modbus_->monitor();
+  }
+
+
   LIBRARY_API CanonReturn CrpiRobotiq::SetRelativeAcceleration (double percent)
   {
     return CANON_SUCCESS;
@@ -585,124 +586,79 @@ namespace crpi_robot
     return CANON_SUCCESS;
   }
   
-  LIBRARY_API void CrpiRobotiq::sendCommand()
+  LIBRARY_API void CrpiRobotiq::sendCommand(bool motion)
   {
-    int sent = ulapi_socket_write (clientID_, commandRegister_, 43);
-    int get;
-
-    get = ulapi_socket_read(clientID_, inbuffer, 8192);
-    for (int x = 0; x < get; ++x)
+    //! Reconnect if the connection was lost since the last command
+    if (!modbus_->connected())
     {
-      ackCommand_[x] = (int)inbuffer[x];
-      ackCommand_[x] = (ackCommand_[x] < 0)?(ackCommand_[x]+256):(ackCommand_[x]);
+      modbus_->connect(params_->tcp_ip_addr, params_->tcp_ip_port, params_->poll_rate);
     }
 
+    //! The 15 registers follow the 13-byte request header kept in commandRegister_
+    if (!modbus_->writeRegisters(commandRegister_ + 13, 15))
+    {
+#ifdef NOISY
+      cout << "command not acknowledged" << endl;
+#endif
+    }
+    else if (motion)
+    {
+      //! Status reads sent from now on reflect the new goal
+      modbus_->monitor().markMotion(ulapi_time());
+    }
 
     getStatusRegisters ();
   }
 
   LIBRARY_API void CrpiRobotiq::getStatusRegisters()
   {
-    crpi_timer timer;
-    timer.waitUntil(200);
-    int sent = ulapi_socket_write(clientID_, statusRegister_, 12), get;
+    robotiqStatus status;
+    double since = ulapi_time();
 
-    get = ulapi_socket_read (clientID_, inbuffer, 8192);
+    //! Ask for a read now rather than waiting for the next periodic poll so that callers are
+    //! bound by the gripper's response time
+    modbus_->pollNow();
+    if (modbus_->statusSince(since, status))
     {
-    for (int i = 0; i < get; ++i)
-    {
-      ackStatus_[i] = (int)inbuffer[i];
-      ackStatus_[i] = (ackStatus_[i] < 0)?(ackStatus_[i]+256):(ackStatus_[i]);
+      applyStatus(status);
     }
+  }
 
-    bitset<8> gripper_status(ackStatus_[9]);
-
-    //extract Initialization Status
-    if(gripper_status.test(0)) gACT = true;
-    else gACT = false;
-
-    //extract gripper mode 0:Basic 1:Pinch 2:Wide 3:Scissor
-    if(!gripper_status.test(1) && !gripper_status.test(2)) gMOD = 0;
-    else if (!gripper_status.test(1) && gripper_status.test(2)) gMOD = 1;
-    else if (gripper_status.test(1) && !gripper_status.test(2)) gMOD = 2;
-    else gMOD = 3;
-
-    //extract Stop/GoTo status
-    if(gripper_status.test(3)) gGTO = 1;
-    else gGTO = 0;
-
-    //extract setup status
-    if(!gripper_status.test(4) && !gripper_status.test(5)) gIMC = 0;
-    else if(gripper_status.test(4) && !gripper_status.test(5)) gIMC = 1;
-    else if(!gripper_status.test(4) && gripper_status.test(5)) gIMC = 2;
-    else  gIMC = 3;
-
-    //extract motion status
-    if(!gripper_status.test(6) && !gripper_status.test(7)) gSTA = 0;
-    else if(gripper_status.test(6) && !gripper_status.test(7)) gSTA = 1;
-    else if(!gripper_status.test(6) && gripper_status.test(7)) gSTA = 2;
-    else  gSTA = 3;
-
-    bitset<8> object_status(ackStatus_[10]);
-
-    //extract FingerA status
-    if(!object_status.test(0) && !object_status.test(1)) gDTA = 0;
-    else if(object_status.test(0) && !object_status.test(1)) gDTA = 1;
-    else if(!object_status.test(0) && object_status.test(1)) gDTA = 2;
-    else  gDTA = 3;
-
-    //extract FingerB status
-    if(!object_status.test(2) && !object_status.test(3)) gDTB = 0;
-    else if(object_status.test(2) && !object_status.test(3)) gDTB = 1;
-    else if(!object_status.test(2) && object_status.test(3)) gDTB = 2;
-    else  gDTB = 3;
-
-    //extract FingerC status
-    if(!object_status.test(4) && !object_status.test(5)) gDTC = 0;
-    else if(object_status.test(4) && !object_status.test(5)) gDTC = 1;
-    else if(!object_status.test(4) && object_status.test(5)) gDTC = 2;
-    else  gDTC = 3;
-
-    //extract Scissor status
-    if(!object_status.test(6) && !object_status.test(7)) gDTS = 0;
-    else if(object_status.test(6) && !object_status.test(7)) gDTS = 1;
-    else if(!object_status.test(6) && object_status.test(7)) gDTS = 2;
-    else  gDTS = 3;
-
-    //cout << gDTA << " " << gDTB << " " << gDTC  << endl;
-
-    if (gDTA == 1 && gDTB == 1 && gDTC == 1) graspedOnClose_ = true;
-    else graspedOnClose_ = false;
-
-    if (gDTA == 2 && gDTB == 2 && gDTC == 2) graspedOnOpen_ = true;
-    else graspedOnOpen_ = false;
-
-    if (gDTA == 3 && gDTB == 3 && gDTC == 3) allFingersAtPos_ = true;
-    else allFingersAtPos_ = false;
-
-    //extract Fault Status
-    gFLT = ackStatus_[11];
-
-    //extract FingerA Stats
-    ReqEcho_PosFingerA = ackStatus_[12];
-    PosFingerA = ackStatus_[13];
-    CurFingerA = ackStatus_[14];
-
-    //extract FingerB Stats
-    ReqEcho_PosFingerB = ackStatus_[15];
-    PosFingerB = ackStatus_[16];
-    CurFingerB = ackStatus_[17];
-
-    //extract FingerC Stats
-    ReqEcho_PosFingerC = ackStatus_[18];
-    PosFingerC = ackStatus_[19];
-    CurFingerC = ackStatus_[20];
-
-    //extract Scissor Stats
-    ReqEcho_PosScissor = ackStatus_[21];
-    PosScissor = ackStatus_[22];
-    CurScissor = ackStatus_[23];
-    }
+
+  LIBRARY_API void CrpiRobotiq::applyStatus (robotiqStatus &status)
+  {
+    gACT = status.gACT;
+    gMOD = status.gMOD;
+    gGTO = status.gGTO;
+    gIMC = status.gIMC;
+    gSTA = status.gSTA;
+
+    gDTA = status.gDT[0];
+    gDTB = status.gDT[1];
+    gDTC = status.gDT[2];
+    gDTS = status.gDT[3];
+
+    graspedOnClose_ = status.graspedOnClose;
+    graspedOnOpen_ = status.graspedOnOpen;
+    allFingersAtPos_ = status.allFingersAtPos;
+
+    gFLT = status.gFLT;
+
+    ReqEcho_PosFingerA = status.reqEcho[0];
+    PosFingerA = status.pos[0];
+    CurFingerA = status.cur[0];
+
+    ReqEcho_PosFingerB = status.reqEcho[1];
+    PosFingerB = status.pos[1];
+    CurFingerB = status.cur[1];
+
+    ReqEcho_PosFingerC = status.reqEcho[2];
+    PosFingerC = status.pos[2];
+    CurFingerC = status.cur[2];
+
+    ReqEcho_PosScissor = status.reqEcho[3];
+    PosScissor = status.pos[3];
+    CurScissor = status.cur[3];
   }
 
 
@@ -766,7 +722,7 @@ namespace crpi_robot
         action_request->set(3,value);
         request = (unsigned char)action_request->to_ulong();
           commandRegister_[13]=request;
-        sendCommand();
+        sendCommand(value);
       break;
 
       case AUTO_RELEASE: //set rSTR 0:NORMAL or 1:AUTO RELEASE
@@ -818,36 +774,23 @@ namespace crpi_robot
 
       //writeStatus();
 
+      double since = ulapi_time();
       setHandParam (3,1); //GoTo
       sendCommand();
 
-      clock_t startTime = clock();
-      clock_t currentTime;
-      double time;
-
-      while (true)
+      //! Continue as soon as the grasp monitor sees the gripper stop
+      robotiqStatus current;
+      if (modbus_->monitor().waitFor(ROBOTIQ_GRIPPER, ROBOTIQ_STOPPED_MASK, since, 5.0))
       {
-        getStatusRegisters();
+        modbus_->status(current);
+        applyStatus(current);
         if (gDTA == 3 && gDTB == 3 && gDTC == 3)
         {
           status = 3;
-          getStatusRegisters();
-          //writeStatus();
-          break;
         }
         else if (gDTA == 2 && gDTB == 2 && gDTC == 2)
         {
           status = 2;
-          getStatusRegisters();
-          break;
-        }
-        currentTime = clock();
-        time = (currentTime-startTime)/(double) CLOCKS_PER_SEC;
-        
-        if (time > 5) 
-        {
-          status = 0;
-          break;
         }
       }
       //cout << "save: " << PrevFingerA << " " << PrevFingerB << " " << PrevFingerC << endl;
@@ -867,12 +810,15 @@ namespace crpi_robot
       PrevFingerC = ReqEcho_PosFingerC;
       PrevScissor = ReqEcho_PosScissor;
 
+      double since = ulapi_time();
       setHandParam (3,1);
       sendCommand();
 
-      while (gDTA != 3 && gDTB != 3 && gDTC != 3)
+      robotiqStatus current;
+      if (modbus_->monitor().waitFor(ROBOTIQ_GRIPPER, ROBOTIQ_STOPPED_MASK, since, 5.0))
       {
-        getStatusRegisters();
+        modbus_->status(current);
+        applyStatus(current);
       }
       //getStatusRegisters();
       //writeStatus();
@@ -16,6 +16,7 @@
 #define crpi_robotIQ_H
 
 #include "crpi.h"
+#include "crpi_robotiq_modbus.h"
 #include <bitset>
 
 #include "ulapi.h"
@@ -359,14 +360,22 @@ namespace crpi_robot
     //!
     CanonReturn StopMotion (int condition = 2);
 
+    //! @brief Object contact and motion completion events of the gripper
+    //!
+    //! @return The grasp monitor fed by the background status poll
+    //!
+    //! @note Also available through SetParameter("GRASP_MONITOR", RobotiqGraspMonitor**).
+    //!
+    RobotiqGraspMonitor *GraspMonitor ();
+
   private:
     CrpiRobotParams *params_;
-    ulapi_integer clientID_;
+
+    //! @brief Modbus-TCP connection to the gripper with its background status poll
+    //!
+    RobotiqModbus *modbus_;
 
     char commandRegister_[43];
-    int ackCommand_[12];
-    char statusRegister_[12];
-    int ackStatus_[128];
 
     int  ReqEcho_PosFingerA, ReqEcho_PosFingerB, ReqEcho_PosFingerC, ReqEcho_PosScissor, gripperMode;
     int PosFingerA, PosFingerB, PosFingerC, PosScissor;
@@ -380,15 +389,24 @@ namespace crpi_robot
   
     bool graspedOnClose_, graspedOnOpen_, allFingersAtPos_;
 
-    char inbuffer[8192];
     int option;
 
     void setHandParam (int param, int val);
 
-    void sendCommand ();
+    //! @brief Write the command registers
+    //!
+    //! @param motion Whether the command starts a motion (rGTO set) for the grasp monitor
+    //!
+    void sendCommand (bool motion = false);
 
+    //! @brief Refresh the gripper state from a status read sent after this call
+    //!
     void getStatusRegisters();
 
+    //! @brief Copy decoded status registers into the gripper state members
+    //!
+    void applyStatus (robotiqStatus &status);
+
     int setGrip(int param);
 
     void setPositionFingerA(int);
@@ -418,8 +436,11 @@ namespace crpi_robot
     void writeStatus ();
 
     bool grasped_;
-    void *task;
     keepalive ka_;
+
+    //! @brief Registration with the shared keepalive service
+    //!
+    int watchId_;
     unsigned long threadID_;
 
     //! @brief The name of the gripper configuration
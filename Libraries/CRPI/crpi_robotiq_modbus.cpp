@@ -0,0 +1,688 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_robotiq_modbus.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Asynchronous Modbus-TCP client with a background status poll for the
+//  Robotiq 3-finger gripper.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_robotiq_modbus.h"
+#include <iostream>
+#include <string.h>
+
+//#define MODBUS_NOISY
+
+using namespace std;
+
+namespace crpi_robot
+{
+  LIBRARY_API void robotiqDecodeStatus (const unsigned char *data, robotiqStatus &status)
+  {
+    int i;
+
+    //! Gripper status byte
+    status.gACT = (data[0] & 0x01);
+    //! Mode 0:Basic 1:Pinch 2:Wide 3:Scissor, with bit 1 as the high bit as written by setHandParam
+    status.gMOD = (((data[0] >> 1) & 0x01) << 1) | ((data[0] >> 2) & 0x01);
+    status.gGTO = ((data[0] >> 3) & 0x01);
+    status.gIMC = ((data[0] >> 4) & 0x03);
+    status.gSTA = ((data[0] >> 6) & 0x03);
+
+    //! Object status byte:  two bits per finger
+    for (i = 0; i < 4; ++i)
+    {
+      status.gDT[i] = ((data[1] >> (2 * i)) & 0x03);
+    }
+
+    status.gFLT = data[2];
+
+    //! Requested position echo, position, and current for fingers A, B, C, and the scissor
+    for (i = 0; i < 4; ++i)
+    {
+      status.reqEcho[i] = data[3 + (3 * i)];
+      status.pos[i] = data[4 + (3 * i)];
+      status.cur[i] = data[5 + (3 * i)];
+    }
+
+    status.graspedOnClose = (status.gDT[0] == 1 && status.gDT[1] == 1 && status.gDT[2] == 1);
+    status.graspedOnOpen = (status.gDT[0] == 2 && status.gDT[1] == 2 && status.gDT[2] == 2);
+    status.allFingersAtPos = (status.gDT[0] == 3 && status.gDT[1] == 3 && status.gDT[2] == 3);
+  }
+
+
+  LIBRARY_API RobotiqGraspMonitor::RobotiqGraspMonitor () :
+    primed_(false),
+    marked_(0.0),
+    seq_(0)
+  {
+    int i;
+
+    for (i = 0; i < ROBOTIQ_CHANNELS; ++i)
+    {
+      states_[i] = -1;
+      start_[i] = -1.0;
+    }
+    for (i = 0; i < ROBOTIQ_CALLBACKS; ++i)
+    {
+      callbacks_[i] = NULL;
+      callbackData_[i] = NULL;
+    }
+    memset(events_, 0, sizeof(events_));
+    lock_ = ulapi_mutex_new(39);
+  }
+
+
+  LIBRARY_API RobotiqGraspMonitor::~RobotiqGraspMonitor ()
+  {
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API void RobotiqGraspMonitor::update (const robotiqStatus &status)
+  {
+    robotiqGraspEvent raised[ROBOTIQ_CHANNELS];
+    robotiqGraspCallback callbacks[ROBOTIQ_CALLBACKS];
+    void *data[ROBOTIQ_CALLBACKS];
+    int now[ROBOTIQ_CHANNELS];
+    int count = 0;
+    int i, j;
+
+    for (i = 0; i < 4; ++i)
+    {
+      now[i] = status.gDT[i];
+    }
+    now[ROBOTIQ_GRIPPER] = status.gSTA;
+
+    ulapi_mutex_take(lock_);
+    if (status.requested < marked_)
+    {
+      //! Read before the last motion command took effect
+      ulapi_mutex_give(lock_);
+      return;
+    }
+
+    for (i = 0; i < ROBOTIQ_CHANNELS; ++i)
+    {
+      if (primed_ && now[i] != states_[i])
+      {
+        robotiqGraspEvent &event = events_[seq_ % ROBOTIQ_EVENTS];
+        event.channel = i;
+        event.from = states_[i];
+        event.to = now[i];
+        event.requested = status.requested;
+        event.received = status.received;
+        event.elapsed = ((now[i] != 0 && start_[i] >= 0.0) ? (status.received - start_[i]) : -1.0);
+        event.seq = ++seq_;
+        raised[count++] = event;
+      }
+
+      //! Both object status 0 and motion status 0 mean "moving"
+      if (now[i] == 0 && (states_[i] != 0 || start_[i] < 0.0))
+      {
+        start_[i] = status.requested;
+      }
+      else if (now[i] != 0)
+      {
+        start_[i] = -1.0;
+      }
+      states_[i] = now[i];
+    }
+    primed_ = true;
+
+    memcpy(callbacks, callbacks_, sizeof(callbacks));
+    memcpy(data, callbackData_, sizeof(data));
+    ulapi_mutex_give(lock_);
+
+    //! Callbacks run without the lock so they may call back into the monitor
+    for (i = 0; i < count; ++i)
+    {
+      for (j = 0; j < ROBOTIQ_CALLBACKS; ++j)
+      {
+        if (callbacks[j] != NULL)
+        {
+          callbacks[j](raised[i], data[j]);
+        }
+      }
+    }
+  }
+
+
+  LIBRARY_API void RobotiqGraspMonitor::markMotion (double when)
+  {
+    int i;
+
+    ulapi_mutex_take(lock_);
+    marked_ = when;
+    for (i = 0; i < ROBOTIQ_CHANNELS; ++i)
+    {
+      if (primed_)
+      {
+        states_[i] = 0;
+      }
+      start_[i] = when;
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API int RobotiqGraspMonitor::addCallback (robotiqGraspCallback callback, void *data)
+  {
+    int i;
+
+    ulapi_mutex_take(lock_);
+    for (i = 0; i < ROBOTIQ_CALLBACKS; ++i)
+    {
+      if (callbacks_[i] == NULL)
+      {
+        callbacks_[i] = callback;
+        callbackData_[i] = data;
+        ulapi_mutex_give(lock_);
+        return i;
+      }
+    }
+    ulapi_mutex_give(lock_);
+    return -1;
+  }
+
+
+  LIBRARY_API void RobotiqGraspMonitor::removeCallback (int id)
+  {
+    if (id < 0 || id >= ROBOTIQ_CALLBACKS)
+    {
+      return;
+    }
+    ulapi_mutex_take(lock_);
+    callbacks_[id] = NULL;
+    callbackData_[id] = NULL;
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API bool RobotiqGraspMonitor::waitFor (int channel, int mask, double since, double timeout, robotiqGraspEvent *event)
+  {
+    double start = ulapi_time();
+    unsigned long seq, first;
+    robotiqGraspEvent *e;
+
+    while (true)
+    {
+      ulapi_mutex_take(lock_);
+      first = ((seq_ > ROBOTIQ_EVENTS) ? (seq_ - ROBOTIQ_EVENTS) : 0);
+      for (seq = first; seq < seq_; ++seq)
+      {
+        e = &events_[seq % ROBOTIQ_EVENTS];
+        if (e->channel == channel && e->requested >= since && ((mask >> e->to) & 1) != 0)
+        {
+          if (event != NULL)
+          {
+            *event = *e;
+          }
+          ulapi_mutex_give(lock_);
+          return true;
+        }
+      }
+      ulapi_mutex_give(lock_);
+
+      if ((ulapi_time() - start) > timeout)
+      {
+        return false;
+      }
+      Sleep(1);
+    }
+  }
+
+
+  LIBRARY_API int RobotiqGraspMonitor::state (int channel)
+  {
+    int val;
+
+    if (channel < 0 || channel >= ROBOTIQ_CHANNELS)
+    {
+      return -1;
+    }
+    ulapi_mutex_take(lock_);
+    val = (primed_ ? states_[channel] : -1);
+    ulapi_mutex_give(lock_);
+    return val;
+  }
+
+
+  void robotiqReceiveThread (void *param)
+  {
+    ((RobotiqModbus*)param)->receive();
+  }
+
+
+  void robotiqPollThread (void *param)
+  {
+    ((RobotiqModbus*)param)->poll();
+  }
+
+
+  LIBRARY_API RobotiqModbus::RobotiqModbus () :
+    runThread_(false),
+    socket_(-1),
+    recvTask_(NULL),
+    pollTask_(NULL),
+    unit_(2),
+    period_(1.0 / ROBOTIQ_POLL_RATE),
+    nextTid_(1)
+  {
+    memset(slots_, 0, sizeof(slots_));
+    lock_ = ulapi_mutex_new(37);
+  }
+
+
+  LIBRARY_API RobotiqModbus::~RobotiqModbus ()
+  {
+    disconnect();
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API bool RobotiqModbus::connect (const char *addr, int port, double rate, int unit)
+  {
+    disconnect();
+
+    socket_ = ulapi_socket_get_client_id(port, addr);
+    if (socket_ < 0)
+    {
+      return false;
+    }
+    ulapi_socket_set_blocking(socket_);
+
+    unit_ = unit;
+    period_ = 1.0 / ((rate > 0.0) ? rate : ROBOTIQ_POLL_RATE);
+    memset(slots_, 0, sizeof(slots_));
+
+    runThread_ = true;
+    recvTask_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)recvTask_, robotiqReceiveThread, this, ulapi_prio_lowest(), 0);
+    pollTask_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)pollTask_, robotiqPollThread, this, ulapi_prio_lowest(), 0);
+    return true;
+  }
+
+
+  LIBRARY_API void RobotiqModbus::disconnect ()
+  {
+    ulapi_mutex_take(lock_);
+    runThread_ = false;
+    if (socket_ >= 0)
+    {
+      //! Releases the receive thread from its blocking read
+      SocketRelease(socket_);
+    }
+    ulapi_mutex_give(lock_);
+
+    //! Both threads must be gone before the socket is closed or new threads are started
+    if (recvTask_ != NULL)
+    {
+      ulapi_task_join((ulapi_task_struct*)recvTask_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)recvTask_);
+      recvTask_ = NULL;
+    }
+    if (pollTask_ != NULL)
+    {
+      ulapi_task_join((ulapi_task_struct*)pollTask_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)pollTask_);
+      pollTask_ = NULL;
+    }
+
+    ulapi_mutex_take(lock_);
+    if (socket_ >= 0)
+    {
+      ulapi_socket_close(socket_);
+      socket_ = -1;
+    }
+    memset(slots_, 0, sizeof(slots_));
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API bool RobotiqModbus::connected ()
+  {
+    return (socket_ >= 0);
+  }
+
+
+  LIBRARY_API int RobotiqModbus::submit (const char *pdu, int size)
+  {
+    return send(pdu, size, false);
+  }
+
+
+  LIBRARY_API bool RobotiqModbus::wait (int tid, double timeout, char *reply, int *size)
+  {
+    double start = ulapi_time();
+    bool ok = false;
+    int i;
+
+    if (tid < 0)
+    {
+      return false;
+    }
+
+    while (true)
+    {
+      ulapi_mutex_take(lock_);
+      for (i = 0; i < ROBOTIQ_PENDING; ++i)
+      {
+        if (slots_[i].state != 0 && !slots_[i].poll && slots_[i].tid == (unsigned short)tid)
+        {
+          break;
+        }
+      }
+      if (i == ROBOTIQ_PENDING)
+      {
+        //! Unknown or reclaimed transaction
+        ulapi_mutex_give(lock_);
+        return false;
+      }
+      if (slots_[i].state == 2)
+      {
+        if (reply != NULL)
+        {
+          memcpy(reply, slots_[i].reply, slots_[i].size);
+        }
+        if (size != NULL)
+        {
+          *size = slots_[i].size;
+        }
+        //! Exception replies set the high bit of the function code
+        ok = ((slots_[i].reply[ROBOTIQ_MBAP_SIZE] & 0x80) == 0);
+        slots_[i].state = 0;
+        ulapi_mutex_give(lock_);
+        return ok;
+      }
+      if ((ulapi_time() - start) > timeout || socket_ < 0)
+      {
+        slots_[i].state = 0;
+        ulapi_mutex_give(lock_);
+        return false;
+      }
+      ulapi_mutex_give(lock_);
+      Sleep(1);
+    }
+  }
+
+
+  LIBRARY_API RobotiqGraspMonitor &RobotiqModbus::monitor ()
+  {
+    return monitor_;
+  }
+
+
+  LIBRARY_API bool RobotiqModbus::writeRegisters (const char *data, int count, double timeout)
+  {
+    char pdu[ROBOTIQ_FRAME];
+
+    if (count < 1 || (6 + (2 * count) + ROBOTIQ_MBAP_SIZE) > ROBOTIQ_FRAME)
+    {
+      return false;
+    }
+
+    //! Function code 16 (Preset Multiple Registers) starting at address 0
+    pdu[0] = 0x10;
+    pdu[1] = 0x00;
+    pdu[2] = 0x00;
+    pdu[3] = (char)((count >> 8) & 0xFF);
+    pdu[4] = (char)(count & 0xFF);
+    pdu[5] = (char)(2 * count);
+    memcpy(pdu + 6, data, 2 * count);
+
+    return wait(submit(pdu, 6 + (2 * count)), timeout);
+  }
+
+
+  LIBRARY_API bool RobotiqModbus::pollNow ()
+  {
+    char pdu[5];
+
+    //! Function code 4 (Read Input Registers) starting at address 0
+    pdu[0] = 0x04;
+    pdu[1] = 0x00;
+    pdu[2] = 0x00;
+    pdu[3] = 0x00;
+    pdu[4] = ROBOTIQ_STATUS_REGISTERS;
+
+    return (send(pdu, 5, true) >= 0);
+  }
+
+
+  LIBRARY_API unsigned long RobotiqModbus::status (robotiqStatus &status) const
+  {
+    return cache_.read(status);
+  }
+
+
+  LIBRARY_API bool RobotiqModbus::statusSince (double since, robotiqStatus &status, double timeout)
+  {
+    double start = ulapi_time();
+
+    while (true)
+    {
+      if (cache_.read(status) > 0 && status.requested >= since)
+      {
+        return true;
+      }
+      if ((ulapi_time() - start) > timeout || socket_ < 0)
+      {
+        return false;
+      }
+      Sleep(1);
+    }
+  }
+
+
+  LIBRARY_API void RobotiqModbus::receive ()
+  {
+    char *buffer = new char[2 * ROBOTIQ_FRAME];
+    int have = 0;
+    int get, length;
+
+    while (runThread_)
+    {
+      get = ulapi_socket_read(socket_, buffer + have, (2 * ROBOTIQ_FRAME) - have);
+      if (get <= 0)
+      {
+        //! Connection closed or broken
+        break;
+      }
+      have += get;
+
+      //! Deliver every complete ADU; the MBAP length counts the unit ID and the PDU
+      while (have >= ROBOTIQ_MBAP_SIZE)
+      {
+        length = 6 + ((((unsigned char)buffer[4]) << 8) | (unsigned char)buffer[5]);
+        if (length <= ROBOTIQ_MBAP_SIZE || length > ROBOTIQ_FRAME)
+        {
+          //! Lost framing
+          have = -1;
+          break;
+        }
+        if (have < length)
+        {
+          break;
+        }
+        deliver(buffer, length);
+        have -= length;
+        memmove(buffer, buffer + length, have);
+      }
+      if (have < 0)
+      {
+        break;
+      }
+    }
+
+    ulapi_mutex_take(lock_);
+    if (runThread_)
+    {
+      //! Lost rather than disconnected:  close the connection and fail every waiting transaction
+      //! so that connected() reports the loss and the next command reconnects
+#ifdef MODBUS_NOISY
+      cout << "Robotiq Modbus connection lost" << endl;
+#endif
+      runThread_ = false;
+      ulapi_socket_close(socket_);
+      socket_ = -1;
+      memset(slots_, 0, sizeof(slots_));
+    }
+    ulapi_mutex_give(lock_);
+    delete [] buffer;
+  }
+
+
+  LIBRARY_API void RobotiqModbus::poll ()
+  {
+    crpi_timer timer;
+    bool outstanding;
+    double now;
+    int i;
+
+    while (runThread_)
+    {
+      //! Keep at most one periodic read in flight so a slow gripper is not flooded
+      outstanding = false;
+      now = ulapi_time();
+      ulapi_mutex_take(lock_);
+      for (i = 0; i < ROBOTIQ_PENDING; ++i)
+      {
+        if (slots_[i].state == 1 && slots_[i].poll && (now - slots_[i].sent) < ROBOTIQ_TIMEOUT)
+        {
+          outstanding = true;
+          break;
+        }
+      }
+      ulapi_mutex_give(lock_);
+
+      if (!outstanding)
+      {
+        pollNow();
+      }
+      timer.waitUntil(period_ * 1000.0);
+    }
+  }
+
+
+  LIBRARY_API int RobotiqModbus::send (const char *pdu, int size, bool poll)
+  {
+    char adu[ROBOTIQ_FRAME];
+    int i, slot = -1;
+    int tid;
+
+    if (size < 1 || (size + ROBOTIQ_MBAP_SIZE) > ROBOTIQ_FRAME)
+    {
+      return -1;
+    }
+
+    ulapi_mutex_take(lock_);
+    if (socket_ < 0 || !runThread_)
+    {
+      ulapi_mutex_give(lock_);
+      return -1;
+    }
+
+    //! Take a free slot, or reclaim the oldest one whose reply never came or was never collected
+    for (i = 0; i < ROBOTIQ_PENDING; ++i)
+    {
+      if (slots_[i].state == 0)
+      {
+        slot = i;
+        break;
+      }
+      if (slot < 0 || slots_[i].sent < slots_[slot].sent)
+      {
+        slot = i;
+      }
+    }
+
+    tid = nextTid_++;
+    adu[0] = (char)((tid >> 8) & 0xFF);
+    adu[1] = (char)(tid & 0xFF);
+    adu[2] = 0x00; //! Protocol ID
+    adu[3] = 0x00;
+    adu[4] = (char)(((size + 1) >> 8) & 0xFF);
+    adu[5] = (char)((size + 1) & 0xFF);
+    adu[6] = (char)unit_;
+    memcpy(adu + ROBOTIQ_MBAP_SIZE, pdu, size);
+
+    slots_[slot].state = 1;
+    slots_[slot].poll = poll;
+    slots_[slot].tid = (unsigned short)tid;
+    slots_[slot].sent = ulapi_time();
+    slots_[slot].size = 0;
+
+    if (ulapi_socket_write(socket_, adu, size + ROBOTIQ_MBAP_SIZE) != (size + ROBOTIQ_MBAP_SIZE))
+    {
+      slots_[slot].state = 0;
+      tid = -1;
+    }
+    ulapi_mutex_give(lock_);
+
+    return tid;
+  }
+
+
+  LIBRARY_API void RobotiqModbus::deliver (const char *adu, int size)
+  {
+    const unsigned char *b = (const unsigned char*)adu;
+    unsigned short tid = (unsigned short)((b[0] << 8) | b[1]);
+    robotiqStatus status;
+    bool decoded = false;
+    int i;
+
+    ulapi_mutex_take(lock_);
+    for (i = 0; i < ROBOTIQ_PENDING; ++i)
+    {
+      if (slots_[i].state == 1 && slots_[i].tid == tid)
+      {
+        break;
+      }
+    }
+    if (i == ROBOTIQ_PENDING)
+    {
+      //! Reply to a reclaimed transaction
+      ulapi_mutex_give(lock_);
+      return;
+    }
+
+    if (slots_[i].poll)
+    {
+      //! Decode the status once here; readers only copy it from the cache
+      if (b[ROBOTIQ_MBAP_SIZE] == 0x04 && size >= (ROBOTIQ_MBAP_SIZE + 2 + (2 * ROBOTIQ_STATUS_REGISTERS)))
+      {
+        robotiqDecodeStatus(b + ROBOTIQ_MBAP_SIZE + 2, status);
+        status.requested = slots_[i].sent;
+        status.received = ulapi_time();
+        cache_.write(status);
+        decoded = true;
+      }
+      slots_[i].state = 0;
+    }
+    else
+    {
+      memcpy(slots_[i].reply, adu, size);
+      slots_[i].size = size;
+      slots_[i].state = 2;
+    }
+    ulapi_mutex_give(lock_);
+
+    if (decoded)
+    {
+      monitor_.update(status);
+    }
+
+#ifdef MODBUS_NOISY
+    cout << "Robotiq reply " << tid << " (" << size << " bytes)" << endl;
+#endif
+  }
+
+} // namespace crpi_robot
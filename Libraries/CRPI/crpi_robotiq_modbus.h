@@ -0,0 +1,351 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_robotiq_modbus.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Asynchronous Modbus-TCP client with a background status poll for the
+//  Robotiq 3-finger gripper.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef crpi_robotIQ_MODBUS_H
+#define crpi_robotIQ_MODBUS_H
+
+#include "crpi.h"
+#include "ulapi.h"
+
+#pragma warning (disable: 4251)
+
+//! Modbus-TCP framing
+#define ROBOTIQ_MBAP_SIZE 7         //! Transaction ID, protocol ID, length, unit ID
+#define ROBOTIQ_FRAME 260           //! Largest Modbus-TCP ADU
+#define ROBOTIQ_PENDING 16          //! Transactions that may be in flight at once
+#define ROBOTIQ_STATUS_REGISTERS 15 //! Input registers read by each status poll
+#define ROBOTIQ_POLL_RATE 50.0      //! Default status poll rate (Hz)
+#define ROBOTIQ_TIMEOUT 1.0         //! Default transaction timeout (s)
+
+//! Grasp monitor channels:  the object status of each finger (gDTA..gDTS) and the motion status
+//! (gSTA) of the whole gripper
+#define ROBOTIQ_FINGER_A 0
+#define ROBOTIQ_FINGER_B 1
+#define ROBOTIQ_FINGER_C 2
+#define ROBOTIQ_SCISSOR 3
+#define ROBOTIQ_GRIPPER 4
+#define ROBOTIQ_CHANNELS 5
+#define ROBOTIQ_EVENTS 64           //! Transitions kept for waiters
+#define ROBOTIQ_CALLBACKS 8         //! Callbacks that may be registered at once
+
+//! Grasp monitor state masks (bit N set selects state N)
+#define ROBOTIQ_CONTACT_MASK 0x06   //! gDTx 1 or 2:  finger stopped on contact (opening or closing)
+#define ROBOTIQ_STOPPED_MASK 0x0E   //! gDTx or gSTA 1-3:  finger or gripper no longer moving
+
+namespace crpi_robot
+{
+  //! @brief Decoded gripper status registers
+  //!
+  //! @note Finger arrays are indexed A, B, C, scissor.
+  //!
+  struct LIBRARY_API robotiqStatus
+  {
+    //! @brief Activation (gACT), mode (gMOD), go-to (gGTO), setup (gIMC), and motion (gSTA) status
+    //!
+    int gACT, gMOD, gGTO, gIMC, gSTA;
+
+    //! @brief Object detection status of fingers A, B, C, and scissor (gDTA..gDTS)
+    //!
+    int gDT[4];
+
+    //! @brief Fault status (gFLT)
+    //!
+    int gFLT;
+
+    //! @brief Echo of the requested position, actual position, and current of each finger
+    //!
+    int reqEcho[4], pos[4], cur[4];
+
+    //! @brief Derived from gDT:  all fingers stopped on contact while closing or opening, or all
+    //!        fingers at the requested position
+    //!
+    bool graspedOnClose, graspedOnOpen, allFingersAtPos;
+
+    //! @brief Time (from ulapi_time) at which the poll answered by this status was sent
+    //!
+    double requested;
+
+    //! @brief Time (from ulapi_time) at which this status was received
+    //!
+    double received;
+  };
+
+
+  //! @brief Decode the data bytes of a Robotiq status read
+  //!
+  //! @param data   The register data (at least 2 * ROBOTIQ_STATUS_REGISTERS bytes)
+  //! @param status The structure populated by this function
+  //!
+  LIBRARY_API void robotiqDecodeStatus (const unsigned char *data, robotiqStatus &status);
+
+
+  //! @brief One object or motion status transition
+  //!
+  struct LIBRARY_API robotiqGraspEvent
+  {
+    //! @brief The channel that changed (ROBOTIQ_FINGER_A..ROBOTIQ_SCISSOR, or ROBOTIQ_GRIPPER)
+    //!
+    int channel;
+
+    //! @brief The previous and new gDTx (fingers) or gSTA (gripper) value
+    //!
+    int from, to;
+
+    //! @brief Time (from ulapi_time) at which the poll that saw the transition was sent and answered
+    //!
+    double requested, received;
+
+    //! @brief Time from the start of the motion to the transition (s), or -1 if the start of the
+    //!        motion was not seen.  The resolution is the poll period.
+    //!
+    double elapsed;
+
+    //! @brief Event sequence number (starting at 1)
+    //!
+    unsigned long seq;
+  };
+
+
+  //! @brief Grasp event callback, invoked on the Modbus receive thread
+  //!
+  typedef void (*robotiqGraspCallback) (const robotiqGraspEvent &event, void *data);
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Detects object contact and motion completion from consecutive status reads
+  //!
+  //! @note Each decoded status is compared against the previous one; every change of a finger's
+  //!       object status or of the gripper's motion status becomes a robotiqGraspEvent that is
+  //!       passed to the registered callbacks and kept for waitFor().  markMotion() is called
+  //!       when a go-to command is acknowledged:  it puts every channel back in motion and drops
+  //!       statuses requested before it, so a motion that ends between two polls still produces
+  //!       an event.
+  //!
+  class LIBRARY_API RobotiqGraspMonitor
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    RobotiqGraspMonitor ();
+
+    //! @brief Default destructor
+    //!
+    ~RobotiqGraspMonitor ();
+
+    //! @brief Compare a new status against the previous one and raise events
+    //!
+    void update (const robotiqStatus &status);
+
+    //! @brief Note that a motion was commanded
+    //!
+    //! @param when The time (from ulapi_time) at which the command was acknowledged
+    //!
+    void markMotion (double when);
+
+    //! @brief Register a callback for every event
+    //!
+    //! @return An ID for removeCallback(), or -1 if no more callbacks can be registered
+    //!
+    int addCallback (robotiqGraspCallback callback, void *data);
+
+    //! @brief Unregister a callback
+    //!
+    void removeCallback (int id);
+
+    //! @brief Wait for a channel to change into one of a set of states
+    //!
+    //! @param channel The channel to watch (ROBOTIQ_FINGER_A..ROBOTIQ_SCISSOR, or ROBOTIQ_GRIPPER)
+    //! @param mask    The accepted new states (bit N set accepts state N)
+    //! @param since   Only transitions seen by polls sent at or after this time count
+    //! @param timeout The maximum time to wait (s)
+    //! @param event   Optional event populated with the matching transition
+    //!
+    //! @return True if a matching transition occurred, false if the wait timed out
+    //!
+    bool waitFor (int channel, int mask, double since, double timeout, robotiqGraspEvent *event = NULL);
+
+    //! @brief Most recent state of a channel (-1 before the first status)
+    //!
+    int state (int channel);
+
+  private:
+    ulapi_mutex_struct *lock_;
+    bool primed_;
+    int states_[ROBOTIQ_CHANNELS];
+    double start_[ROBOTIQ_CHANNELS];
+    double marked_;
+    unsigned long seq_;
+    robotiqGraspEvent events_[ROBOTIQ_EVENTS];
+    robotiqGraspCallback callbacks_[ROBOTIQ_CALLBACKS];
+    void *callbackData_[ROBOTIQ_CALLBACKS];
+  }; // RobotiqGraspMonitor
+
+
+  //! @brief One Modbus transaction slot
+  //!
+  struct LIBRARY_API robotiqTransaction
+  {
+    //! @brief Slot state (0 = free, 1 = awaiting reply, 2 = reply received)
+    //!
+    int state;
+
+    //! @brief Whether the reply is a status poll consumed by the receive thread
+    //!
+    bool poll;
+
+    //! @brief Modbus transaction ID
+    //!
+    unsigned short tid;
+
+    //! @brief Time (from ulapi_time) at which the request was sent
+    //!
+    double sent;
+
+    //! @brief Reply ADU and its size
+    //!
+    char reply[ROBOTIQ_FRAME];
+    int size;
+  };
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Pipelined Modbus-TCP client for the Robotiq gripper
+  //!
+  //! @note A receive thread matches replies to requests by transaction ID, so several requests
+  //!       may be in flight at once.  A poll thread reads the status registers at a fixed rate
+  //!       and publishes the decoded status to a cache; pollNow() requests an extra read so that
+  //!       callers waiting on the gripper are bound by its response time rather than the rate.
+  //!
+  class LIBRARY_API RobotiqModbus
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    RobotiqModbus ();
+
+    //! @brief Default destructor
+    //!
+    ~RobotiqModbus ();
+
+    //! @brief Connect to the gripper and start the receive and poll threads
+    //!
+    //! @param addr The IP address of the gripper
+    //! @param port The Modbus-TCP port (502)
+    //! @param rate The status poll rate in Hz (0 for ROBOTIQ_POLL_RATE)
+    //! @param unit The Modbus unit ID
+    //!
+    //! @return True if the connection was made, false otherwise
+    //!
+    bool connect (const char *addr, int port, double rate, int unit = 2);
+
+    //! @brief Stop the threads and close the connection
+    //!
+    void disconnect ();
+
+    //! @brief Whether or not the client is currently connected
+    //!
+    bool connected ();
+
+    //! @brief Send a request without waiting for the reply
+    //!
+    //! @param pdu  The Modbus PDU (function code and data)
+    //! @param size The size of the PDU in bytes
+    //!
+    //! @return The transaction ID of the request, or -1 if it could not be sent
+    //!
+    int submit (const char *pdu, int size);
+
+    //! @brief Wait for the reply to a submitted request
+    //!
+    //! @param tid     The transaction ID returned by submit()
+    //! @param timeout The maximum time to wait (s)
+    //! @param reply   Optional buffer of ROBOTIQ_FRAME bytes populated with the reply ADU
+    //! @param size    Optional size of the reply
+    //!
+    //! @return True if the reply arrived and is not a Modbus exception, false otherwise
+    //!
+    bool wait (int tid, double timeout, char *reply = NULL, int *size = NULL);
+
+    //! @brief Grasp events derived from the status reads
+    //!
+    RobotiqGraspMonitor &monitor ();
+
+    //! @brief Write holding registers starting at address 0 and wait for the acknowledgement
+    //!
+    //! @param data  The register data, 2 bytes per register (big-endian)
+    //! @param count The number of registers
+    //!
+    //! @return True if the write was acknowledged, false otherwise
+    //!
+    bool writeRegisters (const char *data, int count, double timeout = ROBOTIQ_TIMEOUT);
+
+    //! @brief Request a status read now, in addition to the periodic ones
+    //!
+    //! @return True if the request was sent, false otherwise
+    //!
+    bool pollNow ();
+
+    //! @brief Copy the most recent status
+    //!
+    //! @return The number of status reads decoded since connecting (0 if none yet)
+    //!
+    unsigned long status (robotiqStatus &status) const;
+
+    //! @brief Wait for a status read that was sent at or after a given time
+    //!
+    //! @param since   The earliest acceptable request time (from ulapi_time)
+    //! @param status  The structure populated by this function
+    //! @param timeout The maximum time to wait (s)
+    //!
+    //! @return True if such a status arrived in time, false otherwise
+    //!
+    bool statusSince (double since, robotiqStatus &status, double timeout = ROBOTIQ_TIMEOUT);
+
+    //! @brief Match replies to requests (thread body)
+    //!
+    void receive ();
+
+    //! @brief Periodically read the status registers (thread body)
+    //!
+    void poll ();
+
+    bool runThread_;
+
+  private:
+    //! @brief Send one request and reserve a slot for its reply
+    //!
+    int send (const char *pdu, int size, bool poll);
+
+    //! @brief Deliver one complete reply ADU
+    //!
+    void deliver (const char *adu, int size);
+
+    ulapi_integer socket_;
+    ulapi_mutex_struct *lock_;
+    void *recvTask_;
+    void *pollTask_;
+    int unit_;
+    double period_;
+    unsigned short nextTid_;
+    robotiqTransaction slots_[ROBOTIQ_PENDING];
+    CrpiStateCache<robotiqStatus> cache_;
+    RobotiqGraspMonitor monitor_;
+  }; // RobotiqModbus
+
+} // namespace crpi_robot
+
+#endif
@@ -0,0 +1,515 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       XML
+//  Workfile:        crpi_sax.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Reentrant SAX tokenizer shared by the CRPI XML parsers.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_sax.h"
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+namespace Xml
+{
+  //! @brief Whether or not a character is XML white space
+  //!
+  static inline bool isSpace (char c)
+  {
+    return (c == ' ' || c == '\t' || c == '\r' || c == '\n');
+  }
+
+
+  //! @brief Decode one character or entity
+  //!
+  //! @param pos The current position, advanced past what was decoded
+  //! @param end The end of the value
+  //! @param out Receives the decoded bytes (up to 4, UTF-8 for character references)
+  //!
+  //! @return The number of bytes written to out
+  //!
+  static int decodeOne (const char *&pos, const char *end, char *out)
+  {
+    static const struct { const char *name; size_t len; char c; } named[] =
+    {
+      { "lt;", 3, '<' }, { "gt;", 3, '>' }, { "amp;", 4, '&' }, { "quot;", 5, '\"' }, { "apos;", 5, '\'' }
+    };
+    const char *semi;
+    unsigned long code = 0;
+    int i;
+
+    if (*pos != '&')
+    {
+      out[0] = *pos++;
+      return 1;
+    }
+
+    for (i = 0; i < 5; ++i)
+    {
+      if ((size_t)(end - pos - 1) >= named[i].len && strncmp(pos + 1, named[i].name, named[i].len) == 0)
+      {
+        pos += named[i].len + 1;
+        out[0] = named[i].c;
+        return 1;
+      }
+    }
+
+    //! Character references:  &#N; or &#xN;
+    for (semi = pos + 1; semi < end && *semi != ';' && (semi - pos) < 12; ++semi);
+    if (semi < end && *semi == ';' && (semi - pos) > 2 && pos[1] == '#')
+    {
+      bool hex = (pos[2] == 'x' || pos[2] == 'X');
+      const char *digit = pos + (hex ? 3 : 2);
+      for (; digit < semi; ++digit)
+      {
+        int d = (*digit >= '0' && *digit <= '9') ? (*digit - '0') :
+                (hex && *digit >= 'a' && *digit <= 'f') ? (*digit - 'a' + 10) :
+                (hex && *digit >= 'A' && *digit <= 'F') ? (*digit - 'A' + 10) : -1;
+        if (d < 0)
+        {
+          break;
+        }
+        code = (code * (hex ? 16 : 10)) + d;
+      }
+      if (digit == semi && code > 0 && code <= 0x10FFFF)
+      {
+        pos = semi + 1;
+        if (code < 0x80)
+        {
+          out[0] = (char)code;
+          return 1;
+        }
+        if (code < 0x800)
+        {
+          out[0] = (char)(0xC0 | (code >> 6));
+          out[1] = (char)(0x80 | (code & 0x3F));
+          return 2;
+        }
+        if (code < 0x10000)
+        {
+          out[0] = (char)(0xE0 | (code >> 12));
+          out[1] = (char)(0x80 | ((code >> 6) & 0x3F));
+          out[2] = (char)(0x80 | (code & 0x3F));
+          return 3;
+        }
+        out[0] = (char)(0xF0 | (code >> 18));
+        out[1] = (char)(0x80 | ((code >> 12) & 0x3F));
+        out[2] = (char)(0x80 | ((code >> 6) & 0x3F));
+        out[3] = (char)(0x80 | (code & 0x3F));
+        return 4;
+      }
+    }
+
+    //! Not an entity; keep the ampersand
+    out[0] = *pos++;
+    return 1;
+  }
+
+
+  LIBRARY_API bool xmlView::operator== (const char *text) const
+  {
+    const char *pos = ptr, *end = ptr + len;
+    char out[4];
+    int n, i;
+
+    if (!escaped)
+    {
+      return (strncmp(ptr, text, len) == 0 && text[len] == '\0');
+    }
+
+    while (pos < end)
+    {
+      n = decodeOne(pos, end, out);
+      for (i = 0; i < n; ++i, ++text)
+      {
+        if (*text != out[i])
+        {
+          return false;
+        }
+      }
+    }
+    return (*text == '\0');
+  }
+
+
+  LIBRARY_API size_t xmlView::copy (char *dst, size_t size) const
+  {
+    const char *pos = ptr, *end = ptr + len;
+    char out[4];
+    size_t count = 0;
+    int n;
+
+    if (size == 0)
+    {
+      return 0;
+    }
+
+    if (!escaped)
+    {
+      count = (len < size ? len : size - 1);
+      memcpy(dst, ptr, count);
+      dst[count] = '\0';
+      return count;
+    }
+
+    while (pos < end)
+    {
+      n = decodeOne(pos, end, out);
+      if (count + n > size - 1)
+      {
+        break;
+      }
+      memcpy(dst + count, out, n);
+      count += n;
+    }
+    dst[count] = '\0';
+    return count;
+  }
+
+
+  LIBRARY_API void xmlView::copy (string &dst) const
+  {
+    const char *pos = ptr, *end = ptr + len;
+    char out[4];
+    int n;
+
+    if (!escaped)
+    {
+      dst.assign(ptr, len);
+      return;
+    }
+
+    dst.clear();
+    while (pos < end)
+    {
+      n = decodeOne(pos, end, out);
+      dst.append(out, n);
+    }
+  }
+
+
+  LIBRARY_API string xmlView::str () const
+  {
+    string dst;
+    copy(dst);
+    return dst;
+  }
+
+
+  LIBRARY_API double xmlView::real () const
+  {
+    char value[XML_VALUE_MAX];
+    copy(value, XML_VALUE_MAX);
+    return atof(value);
+  }
+
+
+  LIBRARY_API int xmlView::integer () const
+  {
+    char value[XML_VALUE_MAX];
+    copy(value, XML_VALUE_MAX);
+    return atoi(value);
+  }
+
+
+  //! @brief Find a terminating sequence
+  //!
+  //! @return The start of the terminator, or NULL if it does not occur before end
+  //!
+  static const char *findText (const char *pos, const char *end, const char *term)
+  {
+    size_t len = strlen(term);
+
+    for (; (size_t)(end - pos) >= len; ++pos)
+    {
+      if (*pos == term[0] && memcmp(pos, term, len) == 0)
+      {
+        return pos;
+      }
+    }
+    return NULL;
+  }
+
+
+  //! @brief Read a tag or attribute name
+  //!
+  static void readName (const char *&pos, const char *end, xmlView &name)
+  {
+    name.ptr = pos;
+    name.escaped = false;
+    while (pos < end && !isSpace(*pos) && *pos != '=' && *pos != '/' && *pos != '>' && *pos != '<')
+    {
+      ++pos;
+    }
+    name.len = pos - name.ptr;
+  }
+
+
+  //! @brief Split a run of text into comma-separated items, handing full lists to the handler
+  //!
+  static bool splitText (const char *pos, const char *end, const xmlView &tag, xmlViewList &items,
+                         XmlHandler &handler)
+  {
+    const char *first, *last;
+
+    while (pos < end)
+    {
+      for (first = pos; first < end && *first != ','; ++first);
+      last = first;
+      while (pos < last && isSpace(*pos))
+      {
+        ++pos;
+      }
+      while (last > pos && isSpace(*(last - 1)))
+      {
+        --last;
+      }
+
+      if (last > pos)
+      {
+        if (items.count == XML_ITEMS_MAX)
+        {
+          if (!handler.interTagElement(tag, items))
+          {
+            return false;
+          }
+          items.count = 0;
+        }
+        xmlView &item = items.item[items.count++];
+        item.ptr = pos;
+        item.len = last - pos;
+        item.escaped = (memchr(pos, '&', item.len) != NULL);
+      }
+      pos = first + 1;
+    }
+    return true;
+  }
+
+
+  LIBRARY_API bool saxParse (const char *text, size_t length, XmlHandler &handler)
+  {
+    const char *pos = text, *end, *stop;
+    xmlAttributes attr;
+    xmlViewList items;
+    xmlView name, open;
+    bool haveOpen = false;
+    char quote;
+
+    //! Stop at a NUL, as the old string-based parsers did
+    stop = (const char*)memchr(text, '\0', length);
+    end = (stop != NULL ? stop : text + length);
+
+    try
+    {
+      while (pos < end)
+      {
+        if (*pos != '<')
+        {
+          //! ***** Text between tags (only kept for the most recent opening tag) *****
+          for (stop = pos; stop < end && *stop != '<'; ++stop);
+          if (haveOpen && !splitText(pos, stop, open, items, handler))
+          {
+            return false;
+          }
+          pos = stop;
+          continue;
+        }
+
+        if ((end - pos) >= 9 && memcmp(pos, "<![CDATA[", 9) == 0)
+        {
+          stop = findText(pos + 9, end, "]]>");
+          if (stop == NULL)
+          {
+            return false;
+          }
+          if (haveOpen && stop > pos + 9)
+          {
+            if (items.count == XML_ITEMS_MAX)
+            {
+              if (!handler.interTagElement(open, items))
+              {
+                return false;
+              }
+              items.count = 0;
+            }
+            xmlView &item = items.item[items.count++];
+            item.ptr = pos + 9;
+            item.len = stop - item.ptr;
+            item.escaped = false;
+          }
+          pos = stop + 3;
+          continue;
+        }
+
+        if ((end - pos) >= 2 && (pos[1] == '?' || pos[1] == '!'))
+        {
+          //! Processing instructions, comments, and declarations
+          if (pos[1] == '?')
+          {
+            stop = findText(pos + 2, end, "?>");
+          }
+          else if ((end - pos) >= 4 && memcmp(pos, "<!--", 4) == 0)
+          {
+            stop = findText(pos + 4, end, "-->");
+          }
+          else
+          {
+            stop = findText(pos + 2, end, ">");
+          }
+          if (stop == NULL)
+          {
+            return false;
+          }
+          pos = (const char*)memchr(stop, '>', end - stop) + 1;
+          continue;
+        }
+
+        //! ***** Tags *****
+        //! Text gathered for the enclosing tag is complete
+        if (haveOpen && items.count > 0)
+        {
+          if (!handler.interTagElement(open, items))
+          {
+            return false;
+          }
+          items.count = 0;
+        }
+
+        ++pos;
+        while (pos < end && isSpace(*pos))
+        {
+          ++pos;
+        }
+
+        if (pos < end && *pos == '/')
+        {
+          //! Closing tag
+          ++pos;
+          readName(pos, end, name);
+          while (pos < end && isSpace(*pos))
+          {
+            ++pos;
+          }
+          if (name.len == 0 || pos >= end || *pos != '>')
+          {
+            return false;
+          }
+          ++pos;
+          haveOpen = false;
+          if (!handler.endElement(name))
+          {
+            return false;
+          }
+          continue;
+        }
+
+        //! Opening tag
+        readName(pos, end, name);
+        if (name.len == 0)
+        {
+          return false;
+        }
+
+        attr.name.count = attr.val.count = 0;
+        while (true)
+        {
+          while (pos < end && isSpace(*pos))
+          {
+            ++pos;
+          }
+          if (pos >= end)
+          {
+            return false;
+          }
+          if (*pos == '>' || *pos == '/')
+          {
+            break;
+          }
+          if (attr.name.count == XML_ITEMS_MAX)
+          {
+            return false;
+          }
+
+          xmlView &aname = attr.name.item[attr.name.count];
+          xmlView &aval = attr.val.item[attr.val.count];
+          readName(pos, end, aname);
+          while (pos < end && isSpace(*pos))
+          {
+            ++pos;
+          }
+          if (aname.len == 0 || pos >= end || *pos != '=')
+          {
+            return false;
+          }
+          ++pos;
+          while (pos < end && isSpace(*pos))
+          {
+            ++pos;
+          }
+          if (pos >= end || (*pos != '\"' && *pos != '\''))
+          {
+            return false;
+          }
+          quote = *pos++;
+          stop = (const char*)memchr(pos, quote, end - pos);
+          if (stop == NULL)
+          {
+            return false;
+          }
+          aval.ptr = pos;
+          aval.len = stop - pos;
+          aval.escaped = (memchr(pos, '&', aval.len) != NULL);
+          pos = stop + 1;
+          ++attr.name.count;
+          ++attr.val.count;
+        }
+
+        if (*pos == '/')
+        {
+          //! Self-closing tag (ex. <tag/>)
+          ++pos;
+          if (pos >= end || *pos != '>')
+          {
+            return false;
+          }
+          ++pos;
+          haveOpen = false;
+          if (!handler.startElement(name, attr) || !handler.endElement(name))
+          {
+            return false;
+          }
+          continue;
+        }
+
+        ++pos;
+        open = name;
+        haveOpen = true;
+        if (!handler.startElement(name, attr))
+        {
+          return false;
+        }
+      } // while (pos < end)
+
+      //! Text left dangling at the end of the string
+      if (haveOpen && items.count > 0 && !handler.interTagElement(open, items))
+      {
+        return false;
+      }
+    } // try
+    catch (...)
+    {
+      return false;
+    }
+
+    return true;
+  }
+
+} // Xml namespace
@@ -0,0 +1,204 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       XML
+//  Workfile:        crpi_sax.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Reentrant SAX tokenizer shared by the CRPI XML parsers.  Tag names,
+//  attributes, and text are handed to the handler as views into the input
+//  string; nothing is copied or allocated while tokenizing.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_SAX_H
+#define CRPI_SAX_H
+
+#include <string>
+#include "crpi.h"
+
+#define XML_ITEMS_MAX 64  //! Attributes accepted in one tag, and text items per handler call
+#define XML_VALUE_MAX 64  //! Longest value converted by xmlView::real and xmlView::integer
+
+namespace Xml
+{
+  //! @brief Read-only view of a tag name, attribute value, or text item in the parsed string
+  //!
+  //! @note Only valid for the duration of the handler call that receives it.  Entities (&lt;
+  //!       &gt; &amp; &quot; &apos; &#N; &#xN;) are left in place and decoded when the value is
+  //!       compared, converted, or copied.
+  //!
+  struct LIBRARY_API xmlView
+  {
+    //! @brief First character of the value (not NUL-terminated)
+    //!
+    const char *ptr;
+
+    //! @brief Number of characters in the value
+    //!
+    size_t len;
+
+    //! @brief Whether or not the value contains entities
+    //!
+    bool escaped;
+
+    xmlView () :
+      ptr(NULL),
+      len(0),
+      escaped(false)
+    {
+    }
+
+    //! @brief Compare the (decoded) value with a NUL-terminated string
+    //!
+    bool operator== (const char *text) const;
+
+    bool operator!= (const char *text) const
+    {
+      return !(*this == text);
+    }
+
+    //! @brief Convert the value to a real number as atof would
+    //!
+    double real () const;
+
+    //! @brief Convert the value to an integer as atoi would
+    //!
+    int integer () const;
+
+    //! @brief Copy the decoded value into a string, reusing its storage
+    //!
+    void copy (std::string &dst) const;
+
+    //! @brief Copy the decoded value into a character buffer
+    //!
+    //! @param dst  The output buffer, always NUL-terminated
+    //! @param size The size of the output buffer
+    //!
+    //! @return The number of characters written (truncated to size - 1)
+    //!
+    size_t copy (char *dst, size_t size) const;
+
+    //! @brief The decoded value as a new string
+    //!
+    std::string str () const;
+  };
+
+
+  //! @brief Bounded list of views, iterated as a container
+  //!
+  struct LIBRARY_API xmlViewList
+  {
+    typedef const xmlView *const_iterator;
+
+    xmlView item[XML_ITEMS_MAX];
+    int count;
+
+    xmlViewList () :
+      count(0)
+    {
+    }
+
+    const_iterator begin () const
+    {
+      return item;
+    }
+
+    const_iterator end () const
+    {
+      return item + count;
+    }
+
+    size_t size () const
+    {
+      return (size_t)count;
+    }
+
+    bool empty () const
+    {
+      return (count == 0);
+    }
+
+    void clear ()
+    {
+      count = 0;
+    }
+  };
+
+
+  //! @brief Inner-tag parameter attributes for XML tags (ex <tag name="val">)
+  //!
+  struct LIBRARY_API xmlAttributes
+  {
+    //! @brief The list of parameter names
+    //!
+    xmlViewList name;
+
+    //! @brief The list of parameter values
+    //!
+    xmlViewList val;
+  };
+
+
+  //! @brief Receiver of the elements found by saxParse
+  //!
+  class LIBRARY_API XmlHandler
+  {
+  public:
+    virtual ~XmlHandler ()
+    {
+    }
+
+    //! @brief Parse the first tag of a tag pair
+    //!
+    //! @param tagName The tag label
+    //! @param attr    The attributes located within the tag
+    //!
+    //! @return True if parsing is successful
+    //!
+    virtual bool startElement (const xmlView& tagName,
+                               const xmlAttributes& attr) = 0;
+
+    //! @brief Parse the comma-separated text items between a tag pair
+    //!
+    //! @param tagName The label of the enclosing tag
+    //! @param vals    The text items, with surrounding white space removed
+    //!
+    //! @return True if parsing is successful
+    //!
+    //! @note Called more than once for the same tag if the text holds more than XML_ITEMS_MAX
+    //!       items.
+    //!
+    virtual bool interTagElement (const xmlView& tagName,
+                                  const xmlViewList& vals) = 0;
+
+    //! @brief Parse the second tag of a tag pair (or a self-closing tag)
+    //!
+    //! @param tagName The tag label
+    //!
+    //! @return True if parsing is successful
+    //!
+    virtual bool endElement (const xmlView& tagName) = 0;
+  };
+
+
+  //! @brief Tokenize an XML string, passing its elements to a handler in document order
+  //!
+  //! @param text    The XML text (parsing also stops at a NUL character)
+  //! @param length  The number of characters in text
+  //! @param handler The receiver of the elements
+  //!
+  //! @return True if the string was well formed and every handler call succeeded, false
+  //!         otherwise.  Tokenizing stops at the first failure.
+  //!
+  //! @note Processing instructions, comments, and declarations are skipped; CDATA sections are
+  //!       passed through as a single, undecoded text item.  Nesting is not validated.
+  //!
+  LIBRARY_API bool saxParse (const char *text, size_t length, XmlHandler &handler);
+
+} // Xml namespace
+
+#endif
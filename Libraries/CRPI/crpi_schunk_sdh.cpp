@@ -16,18 +16,30 @@
 #include <fstream>
 #include <iostream>
 #include <string.h>
-#include <sstream>
 
 using namespace std;
 
 namespace crpi_robot
 {
 
-  LIBRARY_API CrpiSchunkSDH::CrpiSchunkSDH (CrpiRobotParams &params)
+  LIBRARY_API CrpiSchunkSDH::CrpiSchunkSDH (CrpiRobotParams &params) :
+    link_(NULL)
   {
-    server = ulapi_socket_get_client_id (6009, "127.0.0.1");
+    if (params.use_shm)
+    {
+      link_ = new HandShmLink();
+      if (link_->open((params.shm_key > 0) ? params.shm_key : HAND_SHM_KEY_SDH, false) && client_.attach(link_))
+      {
+        cout << "shared memory connection success" << endl;
+        return;
+      }
+      cout << "no shared memory connection, using TCP" << endl;
+      delete link_;
+      link_ = NULL;
+    }
 
-    if (server < 0)
+    if (!client_.connect((params.tcp_ip_addr[0] != '\0') ? params.tcp_ip_addr : "127.0.0.1",
+                         (params.tcp_ip_port > 0) ? params.tcp_ip_port : SDH_PORT))
     {
       cout << "no connection" << endl;
     }
@@ -39,6 +51,24 @@ namespace crpi_robot
 
   LIBRARY_API CrpiSchunkSDH::~CrpiSchunkSDH ()
   {
+    client_.disconnect();
+    if (link_ != NULL)
+    {
+      delete link_;
+      link_ = NULL;
+    }
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSchunkSDH::command (const char *verb, const double *values, int count, bool completion)
+  {
+    int seq = client_.request(verb, values, count);
+
+    if (seq < 0)
+    {
+      return CANON_FAILURE;
+    }
+    return client_.wait(seq, completion, completion ? SDH_MOTION_TIMEOUT : SDH_TIMEOUT) ? CANON_SUCCESS : CANON_FAILURE;
   }
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::ApplyCartesianForceTorque (robotPose &robotForceTorque, vector<bool> activeAxes, vector<bool> manipulator)
@@ -55,38 +85,21 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::SetTool (double percent)
   {
-    strcpy(outbuffer,"");
-    strcpy(inbuffer,"");
-
+    //! Grasp, pause, and stop return once the bridge reports that the hand has finished
     if (percent == 1) 
     {
-      strcpy(outbuffer,"Grasp");
-      send = ulapi_socket_write(server, outbuffer, sizeof(outbuffer));
-      Sleep(50);
+      return command("GRASP", NULL, 0, true);
     }
     else if (percent == 0) 
     {
-      strcpy(outbuffer,"Pause");
-      send = ulapi_socket_write(server, outbuffer, sizeof(outbuffer));
-      Sleep(50);
+      return command("PAUSE", NULL, 0, true);
     }
     else if (percent == -1) 
     {
-      strcpy(outbuffer,"Stop");
-      send = ulapi_socket_write(server, outbuffer, sizeof(outbuffer));
-      Sleep(50);
-      //get = ulapi_socket_read(server, inbuffer, MSG_SIZE);
-      //cout << inbuffer << endl;
-    }
-    else
-    {
-      return CANON_FAILURE;
+      return command("STOP", NULL, 0, true);
     }
 
-    strcpy(outbuffer,"");
-    strcpy(inbuffer,"");
-    
-    return CANON_SUCCESS;
+    return CANON_FAILURE;
   }
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::Couple (const char *targetID)
@@ -128,8 +141,20 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::GetRobotAxes (robotAxes *axes)
   {
-    //! TODO
-    return CANON_FAILURE;
+    double values[SDH_AXES];
+    int count = 0;
+    int seq = client_.request("AXES");
+
+    if (!client_.wait(seq, false, SDH_TIMEOUT, values, &count) || count < SDH_AXES)
+    {
+      return CANON_FAILURE;
+    }
+
+    for (int i = 0; i < SDH_AXES && i < (int)axes->axis.size(); ++i)
+    {
+      axes->axis.at(i) = values[i];
+    }
+    return CANON_SUCCESS;
   }
 
  
@@ -142,19 +167,26 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::GetRobotIO (robotIO *io)
   {
-  //readSDH();
+    double values[SDH_AXES];
+    int count = 0;
+    int seq = client_.request("STATE");
+    sdhState state;
 
-  strcpy(inbuffer,"");
+    if (!client_.wait(seq, false, SDH_TIMEOUT, values, &count) || count < 2)
+    {
+      return CANON_FAILURE;
+    }
+    client_.state(state);
 
-  get = ulapi_socket_read(server, inbuffer, MSG_SIZE);
-  
-  if (strcmp(inbuffer,"Success")==0)
-  {
-    strcpy(inbuffer,"");
-    return CANON_SUCCESS;
-  }
+    //! DO 0:  holding an object, DO 1:  fingers moving
+    //! AO 0:  grasp state (SDH_GRASP_*), AO 1-2:  acknowledgement and completion latency (s)
+    io->dio[0] = ((int)values[0] == SDH_GRASP_HOLDING);
+    io->dio[1] = (values[1] != 0.0);
+    io->aio[0] = values[0];
+    io->aio[1] = state.ackLatency;
+    io->aio[2] = state.doneLatency;
 
-  else {return CANON_FAILURE;}
+    return io->dio[0] ? CANON_SUCCESS : CANON_FAILURE;
   }
 
 
@@ -193,27 +225,18 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::MoveToAxisTarget (robotAxes &axes)
   {
-    std::ostringstream sstream;
-    std::string AngleAsString;
+    double values[SDH_AXES];
 
-    strcpy(outbuffer,"");
-
-    for (unsigned int i=0;i<7;++i)
+    if ((int)axes.axis.size() < SDH_AXES)
     {
-      sstream << axes.axis.at(i);
-      AngleAsString = sstream.str();
-      strcat(outbuffer, AngleAsString.c_str());
-      strcat(outbuffer, " ");
-      sstream.str(std::string());
+      return CANON_REJECT;
+    }
+    for (int i = 0; i < SDH_AXES; ++i)
+    {
+      values[i] = axes.axis.at(i);
     }
 
-    send = ulapi_socket_write(server, outbuffer, sizeof(outbuffer));
-
-    Sleep(50);
-    
-    strcpy(outbuffer,"");
-
-    return CANON_SUCCESS;
+    return command("MOVE", values, SDH_AXES, true);
   }
 
 
@@ -275,46 +298,14 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::SetParameter (const char *paramName, void *paramVal)
   {
-    int *temp_int = (int*) paramVal;
-    int val = *temp_int;
-
-    strcpy(outbuffer,"");
+    double val = *((int*) paramVal);
 
-    if ((strcmp (paramName, "GRIP_TYPE") == 0))
+    if ((strcmp (paramName, "GRIP_TYPE") == 0) || (strcmp (paramName, "NUM_FINGERS") == 0))
     {
-      strcpy(outbuffer, paramName);
-      strcat(outbuffer, ",");
-      if (val == 1)
-        strcat(outbuffer, "1");
-      else if(val == 2)
-        strcat(outbuffer, "2");
-      else if(val == 3)
-        strcat(outbuffer, "3");
-
-      send = ulapi_socket_write(server, outbuffer, sizeof(outbuffer));
-
-      Sleep(50);
-
-      get = ulapi_socket_read(server, inbuffer, MSG_SIZE);
-
-      cout << inbuffer << endl;
+      return command(paramName, &val, 1, false);
     }
 
-  if ((strcmp (paramName, "NUM_FINGERS") == 0))
-  {
-    if (val == 1) {strcpy(outbuffer, "1");}
-    else if (val == 2) {strcpy(outbuffer, "2");}
-    else if (val == 3) {strcpy(outbuffer, "3");}
-    else if (val == 0) {strcpy(outbuffer, "0");} //no closing fingers
-
-    send = ulapi_socket_write(server, outbuffer, sizeof(outbuffer));
-    Sleep(50);
-  }
-
-    strcpy(outbuffer,"");
-    strcpy(inbuffer,"");
-
-    return CANON_SUCCESS;
+    return CANON_REJECT;
   }
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::SetRelativeAcceleration (double percent)
@@ -347,8 +338,7 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiSchunkSDH::StopMotion (int condition)
   {
-    //! TODO
-    return CANON_FAILURE;
+    return command("STOP", NULL, 0, true);
   }
 
 } // crpi_robot
@@ -19,6 +19,7 @@
 
 #include "ulapi.h"
 #include "crpi.h"
+#include "crpi_schunk_sdh_link.h"
 
 
 namespace crpi_robot
@@ -148,6 +149,11 @@ namespace crpi_robot
     //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
     //!         not accepted, and FAILURE if the command is accepted but not executed successfully
     //!
+    //! @note Reports the grasp state:  DO 0 is set while an object is held and DO 1 while the
+    //!       fingers move; AO 0 is the grasp state (SDH_GRASP_*), and AO 1 and AO 2 are the
+    //!       acknowledgement and completion latencies (s) of the most recent requests.  SUCCESS is
+    //!       returned only while an object is held.
+    //!
     CanonReturn GetRobotIO (robotIO *io);
 
     //! @brief Get feedback from the robot regarding its current position in Cartesian space
@@ -349,15 +355,26 @@ namespace crpi_robot
 
   private:
 
-    ulapi_integer server, server_feedback;
+    //! @brief Send a request to the SDH bridge and wait for its acknowledgement
+    //!
+    //! @param verb       The request verb (see crpi_schunk_sdh_link.h)
+    //! @param values     Values sent with the request (may be NULL)
+    //! @param count      Number of values
+    //! @param completion Whether or not to also wait for the bridge to report the motion done
+    //!
+    CanonReturn command (const char *verb, const double *values, int count, bool completion);
+
+    //! @brief Request/acknowledge client of the SDH bridge
+    //!
+    SdhClient client_;
+
+    //! @brief Shared-memory link to the SDH bridge (NULL when using TCP)
+    //!
+    HandShmLink *link_;
 
     void *task;
     keepalive ka_;
     unsigned long threadID_;
-
-    char inbuffer[MSG_SIZE], outbuffer[MSG_SIZE];
-    
-    int get, send;
   }; // CrpiSchunkSDH
 
 } // namespace crpi_robot
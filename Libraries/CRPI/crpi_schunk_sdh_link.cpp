@@ -0,0 +1,413 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_schunk_sdh_link.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Framed request/acknowledge protocol between CrpiSchunkSDH and the SDH
+//  bridge.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_schunk_sdh_link.h"
+#include <iostream>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+namespace crpi_robot
+{
+  void sdhReceiveThread (void *param)
+  {
+    ((SdhClient*)param)->receive();
+  }
+
+
+  LIBRARY_API int sdhFormatFrame (char *frame, unsigned int seq, const char *verb, const double *values, int count)
+  {
+    int length = sprintf(frame, "%u %s", seq, verb);
+
+    for (int i = 0; i < count && i < SDH_AXES; ++i)
+    {
+      length += sprintf(frame + length, " %.6f", values[i]);
+    }
+    frame[length++] = '\n';
+    frame[length] = '\0';
+    return length;
+  }
+
+
+  LIBRARY_API int sdhParseFrame (const char *frame, unsigned int &seq, char *verb, double *values)
+  {
+    const char *ptr = frame;
+    char *end;
+    int count = 0, i;
+
+    seq = (unsigned int)strtoul(ptr, &end, 10);
+    if (end == ptr || *end != ' ')
+    {
+      return -1;
+    }
+    ptr = end + 1;
+
+    for (i = 0; i < 15 && *ptr != '\0' && *ptr != ' ' && *ptr != '\n' && *ptr != '\r'; ++i, ++ptr)
+    {
+      verb[i] = *ptr;
+    }
+    verb[i] = '\0';
+    if (i == 0)
+    {
+      return -1;
+    }
+
+    while (count < SDH_AXES)
+    {
+      values[count] = strtod(ptr, &end);
+      if (end == ptr)
+      {
+        break;
+      }
+      ptr = end;
+      ++count;
+    }
+    return count;
+  }
+
+
+  LIBRARY_API SdhClient::SdhClient () :
+    runThread_(false),
+    socket_(-1),
+    link_(NULL),
+    task_(NULL),
+    nextSeq_(1)
+  {
+    memset(slots_, 0, sizeof(slots_));
+    memset(&current_, 0, sizeof(current_));
+    lock_ = ulapi_mutex_new(45);
+  }
+
+
+  LIBRARY_API SdhClient::~SdhClient ()
+  {
+    disconnect();
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API bool SdhClient::connect (const char *addr, int port)
+  {
+    disconnect();
+
+    socket_ = ulapi_socket_get_client_id(port, addr);
+    if (socket_ < 0)
+    {
+      return false;
+    }
+    ulapi_socket_set_blocking(socket_);
+
+    runThread_ = true;
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, sdhReceiveThread, this, ulapi_prio_lowest(), 0);
+    return true;
+  }
+
+
+  LIBRARY_API bool SdhClient::attach (HandShmLink *link)
+  {
+    disconnect();
+
+    if (link == NULL || !link->connected())
+    {
+      return false;
+    }
+    link_ = link;
+
+    runThread_ = true;
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, sdhReceiveThread, this, ulapi_prio_lowest(), 0);
+    return true;
+  }
+
+
+  LIBRARY_API void SdhClient::disconnect ()
+  {
+    runThread_ = false;
+
+    //! Release the receive thread from its blocking read of the socket or wait on the link, and
+    //! let it finish before the socket is closed (or the caller closes the link)
+    if (socket_ >= 0)
+    {
+      SocketRelease(socket_);
+    }
+    if (link_ != NULL)
+    {
+      link_->wake();
+    }
+    if (task_ != NULL)
+    {
+      ulapi_task_join((ulapi_task_struct*)task_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)task_);
+      task_ = NULL;
+    }
+
+    ulapi_mutex_take(lock_);
+    if (socket_ >= 0)
+    {
+      ulapi_socket_close(socket_);
+      socket_ = -1;
+    }
+    link_ = NULL;
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API bool SdhClient::connected ()
+  {
+    return runThread_ && (socket_ >= 0 || (link_ != NULL && link_->connected()));
+  }
+
+
+  LIBRARY_API int SdhClient::request (const char *verb, const double *values, int count)
+  {
+    char frame[SDH_FRAME];
+    unsigned int seq;
+    bool ok;
+    int i, length;
+
+    if (!connected())
+    {
+      return -1;
+    }
+
+    ulapi_mutex_take(lock_);
+    for (i = 0; i < SDH_PENDING; ++i)
+    {
+      if (slots_[i].state == 0)
+      {
+        break;
+      }
+    }
+    if (i == SDH_PENDING)
+    {
+      //! Too many requests in flight
+      ulapi_mutex_give(lock_);
+      return -1;
+    }
+
+    //! Sequence number 0 is reserved for unsolicited frames
+    seq = nextSeq_++;
+    if (nextSeq_ == 0)
+    {
+      nextSeq_ = 1;
+    }
+    memset(&slots_[i], 0, sizeof(sdhTransaction));
+    slots_[i].state = 1;
+    slots_[i].seq = seq;
+    slots_[i].sent = ulapi_time();
+
+    //! Send under the lock so frames are not interleaved and the slot exists before the reply
+    length = sdhFormatFrame(frame, seq, verb, values, count);
+    if (link_ != NULL)
+    {
+      frame[length - 1] = '\0';
+      ok = link_->send(HAND_CHANNEL_CONFIG, frame);
+    }
+    else
+    {
+      ok = (ulapi_socket_write(socket_, frame, length) == length);
+    }
+    if (!ok)
+    {
+      slots_[i].state = 0;
+    }
+    ulapi_mutex_give(lock_);
+
+    return ok ? (int)seq : -1;
+  }
+
+
+  LIBRARY_API bool SdhClient::wait (int seq, bool completion, double timeout, double *values, int *count)
+  {
+    double start = ulapi_time();
+    bool ok;
+    int i;
+
+    if (seq < 0)
+    {
+      return false;
+    }
+
+    while (true)
+    {
+      ulapi_mutex_take(lock_);
+      for (i = 0; i < SDH_PENDING; ++i)
+      {
+        if (slots_[i].state != 0 && slots_[i].seq == (unsigned int)seq)
+        {
+          break;
+        }
+      }
+      if (i == SDH_PENDING)
+      {
+        //! Unknown or reclaimed request
+        ulapi_mutex_give(lock_);
+        return false;
+      }
+      if (slots_[i].ack < 0 || slots_[i].done < 0 ||
+          (slots_[i].ack > 0 && (!completion || slots_[i].done > 0)))
+      {
+        ok = (slots_[i].ack > 0 && slots_[i].done >= 0);
+        if (values != NULL)
+        {
+          memcpy(values, slots_[i].values, slots_[i].count * sizeof(double));
+        }
+        if (count != NULL)
+        {
+          *count = slots_[i].count;
+        }
+        slots_[i].state = 0;
+        ulapi_mutex_give(lock_);
+        return ok;
+      }
+      if ((ulapi_time() - start) > timeout || !runThread_)
+      {
+        slots_[i].state = 0;
+        ulapi_mutex_give(lock_);
+        return false;
+      }
+      ulapi_mutex_give(lock_);
+      Sleep(1);
+    }
+  }
+
+
+  LIBRARY_API unsigned long SdhClient::state (sdhState &state) const
+  {
+    return cache_.read(state);
+  }
+
+
+  LIBRARY_API void SdhClient::receive ()
+  {
+    char *buffer = new char[2 * SDH_FRAME];
+    char *newline;
+    int have = 0;
+    int get, channel;
+
+    while (runThread_)
+    {
+      if (link_ != NULL)
+      {
+        if (link_->receive(channel, buffer, SDH_FRAME, -1.0))
+        {
+          deliver(buffer);
+        }
+        else if (!link_->connected())
+        {
+          break;
+        }
+        continue;
+      }
+
+      get = ulapi_socket_read(socket_, buffer + have, (2 * SDH_FRAME) - have - 1);
+      if (get <= 0)
+      {
+        //! Connection closed or broken
+        break;
+      }
+      have += get;
+      buffer[have] = '\0';
+
+      //! Deliver every complete line
+      while ((newline = strchr(buffer, '\n')) != NULL)
+      {
+        *newline = '\0';
+        deliver(buffer);
+        have -= (int)(newline + 1 - buffer);
+        memmove(buffer, newline + 1, have + 1);
+      }
+      if (have >= SDH_FRAME)
+      {
+        //! Lost framing
+        break;
+      }
+    }
+
+    runThread_ = false;
+    delete [] buffer;
+  }
+
+
+  LIBRARY_API void SdhClient::deliver (const char *frame)
+  {
+    char verb[16];
+    double values[SDH_AXES];
+    unsigned int seq;
+    int count, i;
+    bool changed = false;
+    double now = ulapi_time();
+
+    if ((count = sdhParseFrame(frame, seq, verb, values)) < 0)
+    {
+      return;
+    }
+
+    //! Hand state carried by data replies and notifications
+    if (strcmp(verb, "AXES") == 0)
+    {
+      memcpy(current_.axes, values, count * sizeof(double));
+      changed = true;
+    }
+    else if (strcmp(verb, "STATE") == 0 && count >= 2)
+    {
+      current_.grasp = (int)values[0];
+      current_.moving = (values[1] != 0.0);
+      changed = true;
+    }
+
+    ulapi_mutex_take(lock_);
+    for (i = 0; seq != 0 && i < SDH_PENDING; ++i)
+    {
+      if (slots_[i].state == 0 || slots_[i].seq != seq)
+      {
+        continue;
+      }
+      if (strcmp(verb, "DONE") == 0)
+      {
+        slots_[i].done = (count > 0 && values[0] != 0.0) ? 1 : -1;
+        current_.doneLatency = now - slots_[i].sent;
+        changed = true;
+      }
+      else
+      {
+        //! ACK, NAK, or a data reply (which implies acceptance)
+        if (slots_[i].ack == 0)
+        {
+          current_.ackLatency = now - slots_[i].sent;
+          changed = true;
+        }
+        slots_[i].ack = (strcmp(verb, "NAK") == 0) ? -1 : 1;
+        if (strcmp(verb, "ACK") != 0 && strcmp(verb, "NAK") != 0)
+        {
+          memcpy(slots_[i].values, values, count * sizeof(double));
+          slots_[i].count = count;
+        }
+      }
+      break;
+    }
+    ulapi_mutex_give(lock_);
+
+    if (changed)
+    {
+      current_.received = now;
+      cache_.write(current_);
+    }
+  }
+
+} // crpi_robot
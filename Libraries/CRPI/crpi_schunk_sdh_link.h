@@ -0,0 +1,210 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_schunk_sdh_link.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Framed request/acknowledge protocol between CrpiSchunkSDH and the SDH
+//  bridge.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SCHUNK_SDH_LINK_H
+#define SCHUNK_SDH_LINK_H
+
+#include "crpi.h"
+#include "ulapi.h"
+#include "crpi_hand_shm.h"
+
+#pragma warning (disable: 4251)
+
+//! Every frame is one line of text, "<seq> <verb> [values...]\n".  Over TCP the newline delimits
+//! frames; over shared memory each message is one frame.
+//!
+//! Requests:   GRASP, PAUSE, STOP, MOVE a0..a6, GRIP_TYPE n, NUM_FINGERS n, AXES, STATE
+//! Replies:    <seq> ACK | <seq> NAK             accepted or rejected (every request)
+//!             <seq> AXES a0..a6                 joint positions (answers AXES)
+//!             <seq> STATE grasp moving          grasp state (answers STATE)
+//!             <seq> DONE ok                     GRASP, PAUSE, STOP, or MOVE finished
+//!             0 STATE grasp moving              unsolicited grasp state change
+#define SDH_PORT 6009
+#define SDH_FRAME 256               //! Longest frame, including the newline
+#define SDH_PENDING 16              //! Requests that may be in flight at once
+#define SDH_AXES 7
+#define SDH_TIMEOUT 1.0             //! Default wait for an acknowledgement (s)
+#define SDH_MOTION_TIMEOUT 10.0     //! Default wait for a completion notification (s)
+
+//! Grasp states
+#define SDH_GRASP_OPEN 0            //! Fingers open (after PAUSE or at start-up)
+#define SDH_GRASP_CLOSING 1         //! Grasp in progress
+#define SDH_GRASP_HOLDING 2         //! Grasp finished on an object
+#define SDH_GRASP_EMPTY 3           //! Grasp finished without contact
+#define SDH_GRASP_STOPPED 4         //! Motion stopped by STOP
+
+namespace crpi_robot
+{
+  //! @brief Most recent state reported by the SDH bridge
+  //!
+  struct LIBRARY_API sdhState
+  {
+    //! @brief Joint positions (degrees)
+    //!
+    double axes[SDH_AXES];
+
+    //! @brief Grasp state (SDH_GRASP_*) and whether or not the fingers are moving
+    //!
+    int grasp;
+    bool moving;
+
+    //! @brief Time (s) from sending the most recent request to its acknowledgement, and from
+    //!        sending the most recent motion request to its completion
+    //!
+    double ackLatency, doneLatency;
+
+    //! @brief Time (from ulapi_time) at which this state was received
+    //!
+    double received;
+  };
+
+
+  //! @brief One request awaiting its acknowledgement or completion
+  //!
+  struct LIBRARY_API sdhTransaction
+  {
+    //! @brief Slot state (0 = free, 1 = in use)
+    //!
+    int state;
+
+    //! @brief Sequence number of the request
+    //!
+    unsigned int seq;
+
+    //! @brief Time (from ulapi_time) at which the request was sent
+    //!
+    double sent;
+
+    //! @brief Acknowledgement (0 = none yet, 1 = ACK or data reply, -1 = NAK)
+    //!
+    int ack;
+
+    //! @brief Completion (0 = none yet, 1 = succeeded, -1 = failed)
+    //!
+    int done;
+
+    //! @brief Values carried by a data reply and their number
+    //!
+    double values[SDH_AXES];
+    int count;
+  };
+
+
+  //! @brief Format a frame
+  //!
+  //! @param frame  Buffer of at least SDH_FRAME bytes
+  //! @param seq    Sequence number (0 for unsolicited frames)
+  //! @param verb   Frame verb
+  //! @param values Values appended after the verb (may be NULL)
+  //! @param count  Number of values
+  //!
+  //! @return Length of the frame, including the newline
+  //!
+  LIBRARY_API int sdhFormatFrame (char *frame, unsigned int seq, const char *verb, const double *values, int count);
+
+  //! @brief Split a frame into its parts
+  //!
+  //! @param frame  NUL-terminated frame (the newline is optional)
+  //! @param seq    Set to the sequence number
+  //! @param verb   Buffer of at least 16 bytes populated with the verb
+  //! @param values Populated with up to SDH_AXES values
+  //!
+  //! @return Number of values parsed, or -1 if the frame is malformed
+  //!
+  LIBRARY_API int sdhParseFrame (const char *frame, unsigned int &seq, char *verb, double *values);
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Client side of the SDH bridge protocol over TCP or a shared-memory link
+  //!
+  //! @note Requests may be issued from any thread; a background thread matches replies to
+  //!       requests by sequence number and keeps the most recent hand state.
+  //!
+  class LIBRARY_API SdhClient
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    SdhClient ();
+
+    //! @brief Default destructor
+    //!
+    ~SdhClient ();
+
+    //! @brief Connect to the bridge over TCP
+    //!
+    bool connect (const char *addr, int port);
+
+    //! @brief Reach the bridge through an open shared-memory link (not owned by the client)
+    //!
+    bool attach (HandShmLink *link);
+
+    //! @brief Stop the receive thread and close the connection
+    //!
+    void disconnect ();
+
+    //! @brief Whether or not the bridge is reachable
+    //!
+    bool connected ();
+
+    //! @brief Send a request without waiting for the reply
+    //!
+    //! @return The sequence number of the request, or -1 if it could not be sent
+    //!
+    int request (const char *verb, const double *values = NULL, int count = 0);
+
+    //! @brief Wait for the acknowledgement (and optionally the completion) of a request
+    //!
+    //! @param seq        Sequence number returned by request()
+    //! @param completion Whether or not to also wait for the DONE notification
+    //! @param timeout    How long to wait (s)
+    //! @param values     Populated with the values of a data reply (may be NULL)
+    //! @param count      Set to the number of values of a data reply (may be NULL)
+    //!
+    //! @return True if the request was acknowledged (and completed successfully), false if it
+    //!         was rejected, failed, or timed out
+    //!
+    bool wait (int seq, bool completion, double timeout, double *values = NULL, int *count = NULL);
+
+    //! @brief Copy the most recent hand state
+    //!
+    //! @return The number of state updates received so far
+    //!
+    unsigned long state (sdhState &state) const;
+
+    //! @brief Receive and dispatch frames (thread body)
+    //!
+    void receive ();
+
+  private:
+    //! @brief Handle one received frame
+    //!
+    void deliver (const char *frame);
+
+    bool runThread_;
+    ulapi_integer socket_;
+    HandShmLink *link_;
+    void *task_;
+    ulapi_mutex_struct *lock_;
+    unsigned int nextSeq_;
+    sdhTransaction slots_[SDH_PENDING];
+    sdhState current_;
+    CrpiStateCache<sdhState> cache_;
+  }; // SdhClient
+
+} // crpi_robot
+
+#endif
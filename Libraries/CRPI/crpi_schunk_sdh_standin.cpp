@@ -0,0 +1,346 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_schunk_sdh_standin.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Reference SDH bridge standing in for the Schunk hand server.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_schunk_sdh_standin.h"
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+//#define SDH_STANDIN_NOISY
+
+using namespace std;
+
+namespace crpi_robot
+{
+  void sdhStandInThread (void *param)
+  {
+    ((SdhStandIn*)param)->serve();
+  }
+
+
+  void sdhStandInTickThread (void *param)
+  {
+    ((SdhStandIn*)param)->tick();
+  }
+
+
+  LIBRARY_API SdhStandIn::SdhStandIn (int port, int shmKey, double graspTime, double moveTime) :
+    port_(port),
+    shmKey_(shmKey),
+    runThread_(true),
+    server_(-1),
+    client_(-1),
+    graspTime_(graspTime),
+    moveTime_(moveTime),
+    object_(true),
+    grasp_(SDH_GRASP_OPEN),
+    moving_(false),
+    grasping_(false),
+    motionSeq_(0),
+    motionEnd_(0.0),
+    done_(0)
+  {
+    memset(axes_, 0, sizeof(axes_));
+    memset(target_, 0, sizeof(target_));
+
+    lock_ = ulapi_mutex_new(47);
+    if (shmKey_ != 0)
+    {
+      link_.open(shmKey_, true);
+    }
+    else
+    {
+      server_ = ulapi_socket_get_server_id(port_);
+    }
+
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, sdhStandInThread, this, ulapi_prio_lowest(), 0);
+    tickTask_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)tickTask_, sdhStandInTickThread, this, ulapi_prio_lowest(), 0);
+  }
+
+
+  LIBRARY_API SdhStandIn::~SdhStandIn ()
+  {
+    runThread_ = false;
+
+    //! Release the serving thread from its wait on the link, listening socket, or client
+    link_.wake();
+    if (server_ >= 0)
+    {
+      SocketRelease(server_);
+    }
+    ulapi_mutex_take(lock_);
+    if (client_ >= 0)
+    {
+      SocketRelease(client_);
+    }
+    ulapi_mutex_give(lock_);
+
+    //! The serving thread closes its own client
+    ulapi_task_join((ulapi_task_struct*)task_, NULL);
+    ulapi_task_join((ulapi_task_struct*)tickTask_, NULL);
+    ulapi_task_delete((ulapi_task_struct*)task_);
+    ulapi_task_delete((ulapi_task_struct*)tickTask_);
+
+    if (server_ >= 0)
+    {
+      ulapi_socket_close(server_);
+    }
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API void SdhStandIn::setObject (bool present)
+  {
+    ulapi_mutex_take(lock_);
+    object_ = present;
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API void SdhStandIn::getState (sdhState &state)
+  {
+    memset(&state, 0, sizeof(sdhState));
+    ulapi_mutex_take(lock_);
+    memcpy(state.axes, axes_, sizeof(axes_));
+    state.grasp = grasp_;
+    state.moving = moving_;
+    ulapi_mutex_give(lock_);
+    state.received = ulapi_time();
+  }
+
+
+  LIBRARY_API unsigned long SdhStandIn::commandsDone ()
+  {
+    return done_;
+  }
+
+
+  LIBRARY_API void SdhStandIn::serve ()
+  {
+    char *buffer = new char[2 * SDH_FRAME];
+    char *newline;
+    ulapi_integer client;
+    int have, get, channel;
+
+    while (runThread_ && shmKey_ != 0)
+    {
+      if (link_.receive(channel, buffer, SDH_FRAME, -1.0))
+      {
+        handle(buffer);
+      }
+    }
+
+    while (runThread_ && server_ >= 0)
+    {
+      client = ulapi_socket_get_connection_id(server_);
+      if (client < 0)
+      {
+        Sleep(100);
+        continue;
+      }
+      ulapi_socket_set_blocking(client);
+      ulapi_mutex_take(lock_);
+      client_ = client;
+      ulapi_mutex_give(lock_);
+      have = 0;
+
+      while (runThread_)
+      {
+        get = ulapi_socket_read(client, buffer + have, (2 * SDH_FRAME) - have - 1);
+        if (get <= 0)
+        {
+          break;
+        }
+        have += get;
+        buffer[have] = '\0';
+
+        while ((newline = strchr(buffer, '\n')) != NULL)
+        {
+          *newline = '\0';
+          handle(buffer);
+          have -= (int)(newline + 1 - buffer);
+          memmove(buffer, newline + 1, have + 1);
+        }
+        if (have >= SDH_FRAME)
+        {
+          break;
+        }
+      }
+
+#ifdef SDH_STANDIN_NOISY
+      printf("SDH stand-in client disconnected\n");
+#endif
+      ulapi_mutex_take(lock_);
+      client_ = -1;
+      ulapi_mutex_give(lock_);
+      ulapi_socket_close(client);
+    }
+
+    delete [] buffer;
+  }
+
+
+  LIBRARY_API void SdhStandIn::tick ()
+  {
+    handFeedback feedback;
+
+    memset(&feedback, 0, sizeof(handFeedback));
+
+    while (runThread_)
+    {
+      ulapi_mutex_take(lock_);
+      if (moving_ && ulapi_time() >= motionEnd_)
+      {
+        if (grasping_)
+        {
+          grasp_ = object_ ? SDH_GRASP_HOLDING : SDH_GRASP_EMPTY;
+        }
+        else
+        {
+          memcpy(axes_, target_, sizeof(axes_));
+        }
+        finish(true);
+      }
+      if (shmKey_ != 0)
+      {
+        memcpy(feedback.joints, axes_, sizeof(axes_));
+        link_.publish(feedback);
+      }
+      ulapi_mutex_give(lock_);
+      Sleep(1);
+    }
+  }
+
+
+  LIBRARY_API void SdhStandIn::handle (const char *frame)
+  {
+    char verb[16];
+    double values[SDH_AXES];
+    unsigned int seq;
+    int count, val;
+
+    if ((count = sdhParseFrame(frame, seq, verb, values)) < 0)
+    {
+      return;
+    }
+    val = (count > 0) ? (int)values[0] : -1;
+
+#ifdef SDH_STANDIN_NOISY
+    printf("SDH stand-in: %s\n", frame);
+#endif
+
+    ulapi_mutex_take(lock_);
+    if (strcmp(verb, "GRASP") == 0)
+    {
+      reply(seq, "ACK");
+      if (moving_)
+      {
+        finish(false);
+      }
+      grasp_ = SDH_GRASP_CLOSING;
+      grasping_ = moving_ = true;
+      motionSeq_ = seq;
+      motionEnd_ = ulapi_time() + graspTime_;
+      notify(0);
+    }
+    else if (strcmp(verb, "PAUSE") == 0 || strcmp(verb, "STOP") == 0)
+    {
+      reply(seq, "ACK");
+      if (moving_)
+      {
+        finish(false);
+      }
+      grasp_ = (verb[0] == 'P') ? SDH_GRASP_OPEN : SDH_GRASP_STOPPED;
+      motionSeq_ = seq;
+      finish(true);
+    }
+    else if (strcmp(verb, "MOVE") == 0 && count == SDH_AXES)
+    {
+      reply(seq, "ACK");
+      if (moving_)
+      {
+        finish(false);
+      }
+      memcpy(target_, values, sizeof(target_));
+      grasping_ = false;
+      moving_ = true;
+      motionSeq_ = seq;
+      motionEnd_ = ulapi_time() + moveTime_;
+      notify(0);
+    }
+    else if (strcmp(verb, "GRIP_TYPE") == 0)
+    {
+      reply(seq, (val >= 1 && val <= 3) ? "ACK" : "NAK");
+    }
+    else if (strcmp(verb, "NUM_FINGERS") == 0)
+    {
+      reply(seq, (val >= 0 && val <= 3) ? "ACK" : "NAK");
+    }
+    else if (strcmp(verb, "AXES") == 0)
+    {
+      reply(seq, "AXES", axes_, SDH_AXES);
+    }
+    else if (strcmp(verb, "STATE") == 0)
+    {
+      notify(seq);
+    }
+    else
+    {
+      reply(seq, "NAK");
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API void SdhStandIn::reply (unsigned int seq, const char *verb, const double *values, int count)
+  {
+    char frame[SDH_FRAME];
+    int length = sdhFormatFrame(frame, seq, verb, values, count);
+
+    if (shmKey_ != 0)
+    {
+      frame[length - 1] = '\0';
+      link_.send(HAND_CHANNEL_CONFIG, frame);
+    }
+    else if (client_ >= 0)
+    {
+      ulapi_socket_write(client_, frame, length);
+    }
+  }
+
+
+  LIBRARY_API void SdhStandIn::notify (unsigned int seq)
+  {
+    double values[2];
+
+    values[0] = grasp_;
+    values[1] = moving_ ? 1.0 : 0.0;
+    reply(seq, "STATE", values, 2);
+  }
+
+
+  LIBRARY_API void SdhStandIn::finish (bool ok)
+  {
+    double result = ok ? 1.0 : 0.0;
+
+    //! The state change goes out first so it is in the client's cache when the waiter wakes
+    moving_ = grasping_ = false;
+    notify(0);
+    reply(motionSeq_, "DONE", &result, 1);
+    ++done_;
+  }
+
+} // crpi_robot
@@ -0,0 +1,112 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_schunk_sdh_standin.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Reference SDH bridge standing in for the Schunk hand server.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef SCHUNK_SDH_STANDIN_H
+#define SCHUNK_SDH_STANDIN_H
+
+#include "ulapi.h"
+#include "crpi_schunk_sdh_link.h"
+
+#pragma warning (disable: 4251)
+
+namespace crpi_robot
+{
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Reference SDH bridge for testing CrpiSchunkSDH without a hand
+  //!
+  //! @note Serves one client at a time over TCP, or over a shared-memory link if a key is given.
+  //!       Every request is acknowledged (or rejected) at once.  Grasps and joint moves finish
+  //!       after a fixed time; a grasp ends holding an object if one is present (see
+  //!       setObject()) and empty otherwise.
+  //!
+  class LIBRARY_API SdhStandIn
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    //! @param port      The TCP port to listen on (ignored if shmKey is not 0)
+    //! @param shmKey    Shared memory key to serve instead of TCP (0 for TCP)
+    //! @param graspTime Time a grasp takes (s)
+    //! @param moveTime  Time a joint move takes (s)
+    //!
+    SdhStandIn (int port = SDH_PORT, int shmKey = 0, double graspTime = 0.1, double moveTime = 0.1);
+
+    //! @brief Default destructor
+    //!
+    ~SdhStandIn ();
+
+    //! @brief Whether or not an object is between the fingers when the next grasp finishes
+    //!
+    void setObject (bool present);
+
+    //! @brief Copy the emulated hand state
+    //!
+    void getState (sdhState &state);
+
+    //! @brief Number of motions completed since construction
+    //!
+    unsigned long commandsDone ();
+
+    //! @brief Serve clients (thread body)
+    //!
+    void serve ();
+
+    //! @brief Finish motions when they are due (thread body)
+    //!
+    void tick ();
+
+    int port_;
+    int shmKey_;
+    bool runThread_;
+
+  private:
+    //! @brief Apply one request frame and send the replies
+    //!
+    void handle (const char *frame);
+
+    //! @brief Send one frame to the client (lock_ held)
+    //!
+    void reply (unsigned int seq, const char *verb, const double *values = NULL, int count = 0);
+
+    //! @brief Send the grasp state to the client (lock_ held)
+    //!
+    void notify (unsigned int seq);
+
+    //! @brief Report the motion in progress as finished (lock_ held)
+    //!
+    void finish (bool ok);
+
+    ulapi_mutex_struct *lock_;
+    void *task_;
+    void *tickTask_;
+    ulapi_integer server_;
+    ulapi_integer client_;
+    HandShmLink link_;
+    double graspTime_;
+    double moveTime_;
+    bool object_;
+    double axes_[SDH_AXES];
+    double target_[SDH_AXES];
+    int grasp_;
+    bool moving_;
+    bool grasping_;
+    unsigned int motionSeq_;
+    double motionEnd_;
+    unsigned long done_;
+  }; // SdhStandIn
+
+} // crpi_robot
+
+#endif
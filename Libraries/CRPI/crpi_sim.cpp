@@ -0,0 +1,914 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_sim.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Simulated robot controller definitions, for exercising the CRPI stack
+//  without hardware.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_sim.h"
+#include <math.h>
+#include <stdlib.h>
+#include <string.h>
+
+using namespace std;
+
+#define SIM_PI 3.14159265358979
+#define SIM_IK_ITERATIONS 50        //! Iterations of the serial model position solver
+#define SIM_IK_TOLERANCE 0.01       //! Position error (mm) at which the solver stops
+#define SIM_IK_STEP 10.0            //! Largest joint change (degrees) per solver iteration
+
+namespace crpi_robot
+{
+  void simThread (void *param)
+  {
+    ((CrpiSim*)param)->run();
+  }
+
+
+  //! @brief Millimeters per length unit
+  //!
+  static double lengthScale (CanonLengthUnit units)
+  {
+    return (units == METER ? 1000.0 : (units == INCH ? 25.4 : 1.0));
+  }
+
+
+  //! @brief Degrees per angle unit
+  //!
+  static double angleScale (CanonAngleUnit units)
+  {
+    return (units == RADIAN ? (180.0 / SIM_PI) : 1.0);
+  }
+
+
+  LIBRARY_API CrpiSim::CrpiSim (CrpiRobotParams &params) :
+    serial_(params.sim_serial),
+    axes_(params.sim_axes),
+    maxJointSpeed_(params.sim_joint_speed),
+    maxCartSpeed_(params.sim_cart_speed),
+    maxRotSpeed_(params.sim_rot_speed),
+    rate_(params.sim_rate),
+    latency_(params.sim_latency),
+    jitter_(params.sim_jitter),
+    angleUnits_(DEGREE),
+    lengthUnits_(MM),
+    nextId_(1),
+    tool_(0.0),
+    runThread_(true),
+    running_(true)
+  {
+    simState state;
+    int i;
+
+    if (axes_ < 1)
+    {
+      axes_ = 1;
+    }
+    else if (axes_ > CRPI_AXES_MAX)
+    {
+      axes_ = CRPI_AXES_MAX;
+    }
+    if (rate_ <= 0.0)
+    {
+      rate_ = 125.0;
+    }
+
+    for (i = 0; i < CRPI_AXES_MAX; ++i)
+    {
+      links_[i] = params.sim_links[i];
+      jointSpeeds_[i] = maxJointSpeed_;
+      axialUnits_[i] = DEGREE;
+    }
+    cartSpeed_ = maxCartSpeed_;
+
+    memset(&cmd_, 0, sizeof(cmd_));
+    memset(dio_, 0, sizeof(dio_));
+    memset(aio_, 0, sizeof(aio_));
+    memset(forces_, 0, sizeof(forces_));
+    memset(torques_, 0, sizeof(torques_));
+    lock_ = ulapi_mutex_new(53);
+
+    //! The arm starts at rest with every joint at 0
+    memset(&state, 0, sizeof(state));
+    if (serial_)
+    {
+      forward(state.axes, state.pose);
+    }
+    state.time = ulapi_time();
+    cache_.write(state);
+
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, simThread, this, ulapi_prio_lowest(), 0);
+  }
+
+
+  LIBRARY_API CrpiSim::~CrpiSim ()
+  {
+    runThread_ = false;
+    for (int i = 0; i < 1000 && running_; ++i)
+    {
+      Sleep(1);
+    }
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::ApplyCartesianForceTorque (robotPose &robotForceTorque, vector<bool> activeAxes, vector<bool> manipulator)
+  {
+    delay();
+    //! Reported back as the measured forces
+    ulapi_mutex_take(lock_);
+    forces_[0] = robotForceTorque.x;
+    forces_[1] = robotForceTorque.y;
+    forces_[2] = robotForceTorque.z;
+    forces_[3] = robotForceTorque.xrot;
+    forces_[4] = robotForceTorque.yrot;
+    forces_[5] = robotForceTorque.zrot;
+    ulapi_mutex_give(lock_);
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::ApplyJointTorque (robotAxes &robotJointTorque)
+  {
+    delay();
+    ulapi_mutex_take(lock_);
+    for (int i = 0; i < axes_ && i < robotJointTorque.axes; ++i)
+    {
+      torques_[i] = robotJointTorque.axis.at(i);
+    }
+    ulapi_mutex_give(lock_);
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::Couple (const char *targetID)
+  {
+    delay();
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::Message (const char *message)
+  {
+    delay();
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::MoveStraightTo (robotPose &pose)
+  {
+    double values[6];
+
+    toInternal(pose, values);
+    return command(SIM_CMD_CARTESIAN, values);
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::MoveThroughTo (robotPose *poses,
+                                                  int numPoses,
+                                                  robotPose *accelerations,
+                                                  robotPose *speeds,
+                                                  robotPose *tolerances)
+  {
+    CanonReturn val = CANON_SUCCESS;
+
+    for (int i = 0; i < numPoses && val == CANON_SUCCESS; ++i)
+    {
+      val = MoveStraightTo(poses[i]);
+    }
+    return val;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::MoveTo (robotPose &pose)
+  {
+    return MoveStraightTo(pose);
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::GetRobotAxes (robotAxes *axes)
+  {
+    simState state;
+
+    delay();
+    cache_.read(state);
+    if ((int)axes->axis.size() < axes_)
+    {
+      axes->axis.resize(axes_);
+    }
+    axes->axes = axes_;
+    for (int i = 0; i < axes_; ++i)
+    {
+      axes->axis.at(i) = state.axes[i] / angleScale(axialUnits_[i]);
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::GetRobotForces (robotPose *forces)
+  {
+    simState state;
+
+    delay();
+    cache_.read(state);
+    forces->x = state.forces[0];
+    forces->y = state.forces[1];
+    forces->z = state.forces[2];
+    forces->xrot = state.forces[3];
+    forces->yrot = state.forces[4];
+    forces->zrot = state.forces[5];
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::GetRobotIO (robotIO *io)
+  {
+    simState state;
+    int i;
+
+    delay();
+    cache_.read(state);
+    for (i = 0; i < io->ndio && i < CRPI_IO_MAX; ++i)
+    {
+      io->dio[i] = state.dio[i];
+    }
+    for (i = 0; i < io->naio && i < CRPI_IO_MAX; ++i)
+    {
+      io->aio[i] = state.aio[i];
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::GetRobotPose (robotPose *pose)
+  {
+    simState state;
+    double ls = lengthScale(lengthUnits_), as = angleScale(angleUnits_);
+
+    delay();
+    cache_.read(state);
+    pose->x = state.pose[0] / ls;
+    pose->y = state.pose[1] / ls;
+    pose->z = state.pose[2] / ls;
+    pose->xrot = state.pose[3] / as;
+    pose->yrot = state.pose[4] / as;
+    pose->zrot = state.pose[5] / as;
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::GetRobotSpeed (robotPose *speed)
+  {
+    simState state;
+    double ls = lengthScale(lengthUnits_), as = angleScale(angleUnits_);
+
+    delay();
+    cache_.read(state);
+    speed->x = state.poseSpeeds[0] / ls;
+    speed->y = state.poseSpeeds[1] / ls;
+    speed->z = state.poseSpeeds[2] / ls;
+    speed->xrot = state.poseSpeeds[3] / as;
+    speed->yrot = state.poseSpeeds[4] / as;
+    speed->zrot = state.poseSpeeds[5] / as;
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::GetRobotSpeed (robotAxes *speed)
+  {
+    simState state;
+
+    delay();
+    cache_.read(state);
+    if ((int)speed->axis.size() < axes_)
+    {
+      speed->axis.resize(axes_);
+    }
+    speed->axes = axes_;
+    for (int i = 0; i < axes_; ++i)
+    {
+      speed->axis.at(i) = state.axisSpeeds[i] / angleScale(axialUnits_[i]);
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::GetRobotTorques (robotAxes *torques)
+  {
+    simState state;
+
+    delay();
+    cache_.read(state);
+    if ((int)torques->axis.size() < axes_)
+    {
+      torques->axis.resize(axes_);
+    }
+    torques->axes = axes_;
+    for (int i = 0; i < axes_; ++i)
+    {
+      torques->axis.at(i) = state.torques[i];
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::MoveAttractor (robotPose &pose)
+  {
+    //! Force control is not simulated
+    return CANON_REJECT;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::MoveToAxisTarget (robotAxes &axes)
+  {
+    simState state;
+    double values[CRPI_AXES_MAX];
+
+    //! Axes not given keep their current values
+    cache_.read(state);
+    for (int i = 0; i < axes_; ++i)
+    {
+      values[i] = (i < axes.axes ? axes.axis.at(i) * angleScale(axialUnits_[i]) : state.axes[i]);
+    }
+    return command(SIM_CMD_JOINT, values);
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetAbsoluteAcceleration (double acceleration)
+  {
+    delay();
+    return (acceleration < 0.0 ? CANON_FAILURE : CANON_SUCCESS);
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetAbsoluteSpeed (double speed)
+  {
+    double mms = speed * lengthScale(lengthUnits_);
+
+    delay();
+    if (mms > maxCartSpeed_ || mms < 0.0)
+    {
+      return CANON_FAILURE;
+    }
+    ulapi_mutex_take(lock_);
+    cartSpeed_ = mms;
+    ulapi_mutex_give(lock_);
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetAngleUnits (const char *unitName)
+  {
+    if (strcmp(unitName, "degree") == 0)
+    {
+      angleUnits_ = DEGREE;
+    }
+    else if (strcmp(unitName, "radian") == 0)
+    {
+      angleUnits_ = RADIAN;
+    }
+    else
+    {
+      return CANON_FAILURE;
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetAxialSpeeds (double *speeds)
+  {
+    double dps[CRPI_AXES_MAX];
+    int i;
+
+    delay();
+    for (i = 0; i < axes_; ++i)
+    {
+      dps[i] = speeds[i] * angleScale(axialUnits_[i]);
+      if (dps[i] > maxJointSpeed_ || dps[i] < 0.0)
+      {
+        return CANON_FAILURE;
+      }
+    }
+    ulapi_mutex_take(lock_);
+    for (i = 0; i < axes_; ++i)
+    {
+      jointSpeeds_[i] = dps[i];
+    }
+    ulapi_mutex_give(lock_);
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetAxialUnits (const char **unitNames)
+  {
+    CanonAngleUnit units[CRPI_AXES_MAX];
+    int i;
+
+    for (i = 0; i < axes_; ++i)
+    {
+      if (strcmp(unitNames[i], "degree") == 0)
+      {
+        units[i] = DEGREE;
+      }
+      else if (strcmp(unitNames[i], "radian") == 0)
+      {
+        units[i] = RADIAN;
+      }
+      else
+      {
+        return CANON_FAILURE;
+      }
+    }
+    for (i = 0; i < axes_; ++i)
+    {
+      axialUnits_[i] = units[i];
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetEndPoseTolerance (robotPose &tolerance)
+  {
+    //! Simulated motions end exactly on target
+    delay();
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetIntermediatePoseTolerance (robotPose *tolerances)
+  {
+    delay();
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetLengthUnits (const char *unitName)
+  {
+    if (strcmp(unitName, "mm") == 0)
+    {
+      lengthUnits_ = MM;
+    }
+    else if (strcmp(unitName, "meter") == 0)
+    {
+      lengthUnits_ = METER;
+    }
+    else if (strcmp(unitName, "inch") == 0)
+    {
+      lengthUnits_ = INCH;
+    }
+    else
+    {
+      return CANON_FAILURE;
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetParameter (const char *paramName, void *paramVal)
+  {
+    if (strcmp(paramName, "latency") == 0)
+    {
+      latency_ = *((double*)paramVal);
+    }
+    else if (strcmp(paramName, "jitter") == 0)
+    {
+      jitter_ = *((double*)paramVal);
+    }
+    else
+    {
+      return CANON_REJECT;
+    }
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetRelativeAcceleration (double percent)
+  {
+    delay();
+    return ((percent > 1.0 || percent < 0.0) ? CANON_FAILURE : CANON_SUCCESS);
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetRelativeSpeed (double percent)
+  {
+    delay();
+    if (percent > 1.0 || percent < 0.0)
+    {
+      return CANON_FAILURE;
+    }
+    ulapi_mutex_take(lock_);
+    cartSpeed_ = maxCartSpeed_ * percent;
+    for (int i = 0; i < axes_; ++i)
+    {
+      jointSpeeds_[i] = maxJointSpeed_ * percent;
+    }
+    ulapi_mutex_give(lock_);
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetTool (double percent)
+  {
+    delay();
+    ulapi_mutex_take(lock_);
+    tool_ = percent;
+    ulapi_mutex_give(lock_);
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetRobotIO (robotIO &io)
+  {
+    int i;
+
+    delay();
+    ulapi_mutex_take(lock_);
+    for (i = 0; i < io.ndio && i < CRPI_IO_MAX; ++i)
+    {
+      dio_[i] = io.dio[i];
+    }
+    for (i = 0; i < io.naio && i < CRPI_IO_MAX; ++i)
+    {
+      aio_[i] = io.aio[i];
+    }
+    ulapi_mutex_give(lock_);
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::SetRobotDO (int dig_out, bool val)
+  {
+    if (dig_out < 0 || dig_out >= CRPI_IO_MAX)
+    {
+      return CANON_FAILURE;
+    }
+
+    delay();
+    ulapi_mutex_take(lock_);
+    dio_[dig_out] = val;
+    ulapi_mutex_give(lock_);
+    return CANON_SUCCESS;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::StopMotion (int condition)
+  {
+    return command(SIM_CMD_STOP, NULL);
+  }
+
+
+  LIBRARY_API void CrpiSim::run ()
+  {
+    simState state;
+    simCommand cmd;
+    double speeds[CRPI_AXES_MAX], cart, start[CRPI_AXES_MAX], delta[CRPI_AXES_MAX], next[6];
+    double period = 1.0 / rate_, now, last, wake, dt, span, t, frac, worst;
+    int i;
+
+    cache_.read(state);
+    memset(&cmd, 0, sizeof(cmd));
+    last = wake = ulapi_time();
+
+    while (runThread_)
+    {
+      //! Step on a fixed schedule; if the thread falls behind, resume from now rather than
+      //! stepping to catch up
+      wake += period;
+      now = ulapi_time();
+      if (wake > now)
+      {
+        ulapi_sleep(wake - now);
+      }
+      else
+      {
+        wake = now;
+      }
+      now = ulapi_time();
+      dt = now - last;
+      last = now;
+      if (dt <= 0.0)
+      {
+        continue;
+      }
+
+      ulapi_mutex_take(lock_);
+      if (cmd_.id != cmd.id)
+      {
+        //! Anything issued before the newest command was preempted by it
+        cmd = cmd_;
+        state.finished = cmd.id - 1;
+      }
+      for (i = 0; i < axes_; ++i)
+      {
+        speeds[i] = jointSpeeds_[i];
+        state.torques[i] = torques_[i];
+      }
+      cart = cartSpeed_;
+      memcpy(state.dio, dio_, sizeof(dio_));
+      memcpy(state.aio, aio_, sizeof(aio_));
+      memcpy(state.forces, forces_, sizeof(forces_));
+      state.tool = tool_;
+      ulapi_mutex_give(lock_);
+
+      memset(state.axisSpeeds, 0, sizeof(state.axisSpeeds));
+      memset(state.poseSpeeds, 0, sizeof(state.poseSpeeds));
+
+      if (cmd.id > state.finished)
+      {
+        frac = 1.0;
+        if (cmd.type == SIM_CMD_JOINT)
+        {
+          //! Scale every joint to arrive together at the slowest joint's limit
+          span = 0.0;
+          for (i = 0; i < axes_; ++i)
+          {
+            delta[i] = cmd.axes[i] - state.axes[i];
+            t = (speeds[i] > 0.0 ? fabs(delta[i]) / speeds[i] : (delta[i] != 0.0 ? 1.0e9 : 0.0));
+            span = (t > span ? t : span);
+          }
+          frac = (span > dt ? dt / span : 1.0);
+          for (i = 0; i < axes_; ++i)
+          {
+            state.axes[i] += delta[i] * frac;
+            state.axisSpeeds[i] = delta[i] * frac / dt;
+          }
+          if (serial_)
+          {
+            memcpy(next, state.pose, sizeof(next));
+            forward(state.axes, state.pose);
+            for (i = 0; i < 6; ++i)
+            {
+              state.poseSpeeds[i] = (state.pose[i] - next[i]) / dt;
+            }
+          }
+        }
+        else if (cmd.type == SIM_CMD_CARTESIAN)
+        {
+          //! Straight line, with translation and rotation arriving together
+          for (i = 0; i < 6; ++i)
+          {
+            delta[i] = cmd.pose[i] - state.pose[i];
+          }
+          for (i = 3; i < 6; ++i)
+          {
+            //! Rotate the short way around
+            delta[i] = fmod(delta[i] + 540.0, 360.0) - 180.0;
+          }
+          t = sqrt(delta[0] * delta[0] + delta[1] * delta[1] + delta[2] * delta[2]);
+          span = (cart > 0.0 ? t / cart : (t > 0.0 ? 1.0e9 : 0.0));
+          for (i = 3; i < 6; ++i)
+          {
+            t = (maxRotSpeed_ > 0.0 ? fabs(delta[i]) / maxRotSpeed_ : (delta[i] != 0.0 ? 1.0e9 : 0.0));
+            span = (t > span ? t : span);
+          }
+          frac = (span > dt ? dt / span : 1.0);
+
+          if (serial_)
+          {
+            //! Slow the step down if the joints cannot keep up with it
+            memcpy(start, state.axes, sizeof(start));
+            for (int attempt = 0; attempt < 2; ++attempt)
+            {
+              for (i = 0; i < 6; ++i)
+              {
+                next[i] = state.pose[i] + delta[i] * frac;
+              }
+              memcpy(state.axes, start, sizeof(start));
+              if (!inverse(next, state.axes))
+              {
+                //! Out of reach:  stop where the arm is
+                memcpy(state.axes, start, sizeof(start));
+                frac = -1.0;
+                break;
+              }
+              worst = 1.0;
+              for (i = 0; i < axes_; ++i)
+              {
+                t = (speeds[i] > 0.0 ? fabs(state.axes[i] - start[i]) / (speeds[i] * dt) : 1.0);
+                worst = (t > worst ? t : worst);
+              }
+              if (worst <= 1.0 || attempt == 1)
+              {
+                break;
+              }
+              frac /= worst;
+            }
+            if (frac >= 0.0)
+            {
+              for (i = 0; i < axes_; ++i)
+              {
+                state.axisSpeeds[i] = (state.axes[i] - start[i]) / dt;
+              }
+            }
+          }
+
+          if (frac >= 0.0)
+          {
+            for (i = 0; i < 6; ++i)
+            {
+              state.pose[i] += delta[i] * frac;
+              state.poseSpeeds[i] = delta[i] * frac / dt;
+            }
+            if (frac >= 1.0)
+            {
+              //! Land exactly on the target
+              memcpy(state.pose, cmd.pose, sizeof(cmd.pose));
+            }
+          }
+        }
+
+        if (frac < 0.0)
+        {
+          state.finished = cmd.id;
+        }
+        else if (frac >= 1.0)
+        {
+          state.finished = state.reached = cmd.id;
+        }
+      }
+
+      state.time = now;
+      cache_.write(state);
+    }
+
+    running_ = false;
+  }
+
+
+  LIBRARY_API void CrpiSim::delay ()
+  {
+    double ms = latency_;
+
+    if (jitter_ > 0.0)
+    {
+      ms += jitter_ * ((2.0 * rand() / RAND_MAX) - 1.0);
+    }
+    if (ms > 0.0)
+    {
+      ulapi_sleep(ms / 1000.0);
+    }
+  }
+
+
+  LIBRARY_API CanonReturn CrpiSim::command (int type, const double *values)
+  {
+    simState state;
+    unsigned long id;
+    double start;
+
+    delay();
+
+    ulapi_mutex_take(lock_);
+    id = nextId_++;
+    cmd_.type = type;
+    if (type == SIM_CMD_JOINT)
+    {
+      memcpy(cmd_.axes, values, axes_ * sizeof(double));
+    }
+    else if (type == SIM_CMD_CARTESIAN)
+    {
+      memcpy(cmd_.pose, values, sizeof(cmd_.pose));
+    }
+    cmd_.id = id;
+    ulapi_mutex_give(lock_);
+
+    start = ulapi_time();
+    while (true)
+    {
+      cache_.read(state);
+      if (state.finished >= id)
+      {
+        return (state.reached >= id ? CANON_SUCCESS : CANON_FAILURE);
+      }
+      if (!running_ || (ulapi_time() - start) > SIM_WAIT_MAX)
+      {
+        return CANON_FAILURE;
+      }
+      Sleep(1);
+    }
+  }
+
+
+  LIBRARY_API void CrpiSim::toInternal (robotPose &pose, double *values)
+  {
+    double ls = lengthScale(lengthUnits_), as = angleScale(angleUnits_);
+
+    values[0] = pose.x * ls;
+    values[1] = pose.y * ls;
+    values[2] = pose.z * ls;
+    values[3] = pose.xrot * as;
+    values[4] = pose.yrot * as;
+    values[5] = pose.zrot * as;
+  }
+
+
+  LIBRARY_API void CrpiSim::forward (const double *joints, double *pose)
+  {
+    double reach = 0.0, pitch = 0.0, yaw = joints[0] * SIM_PI / 180.0;
+    int i;
+
+    pose[2] = links_[0];
+    for (i = 1; i < axes_; ++i)
+    {
+      pitch += joints[i] * SIM_PI / 180.0;
+      reach += links_[i] * cos(pitch);
+      pose[2] += links_[i] * sin(pitch);
+    }
+    pose[0] = reach * cos(yaw);
+    pose[1] = reach * sin(yaw);
+    pose[3] = 0.0;
+    pose[4] = pitch * 180.0 / SIM_PI;
+    pose[5] = joints[0];
+  }
+
+
+  LIBRARY_API bool CrpiSim::inverse (const double *pose, double *joints)
+  {
+    double jac[3][CRPI_AXES_MAX], a[3][3], e[3], y[3], here[6], there[6], step[CRPI_AXES_MAX];
+    double det, largest, h = 1.0e-3, damping = 1.0;
+    int iter, i, j, k;
+
+    //! Damped least squares on the position, with a numerical Jacobian
+    for (iter = 0; iter < SIM_IK_ITERATIONS; ++iter)
+    {
+      forward(joints, here);
+      for (i = 0; i < 3; ++i)
+      {
+        e[i] = pose[i] - here[i];
+      }
+      if (sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]) < SIM_IK_TOLERANCE)
+      {
+        return true;
+      }
+
+      for (j = 0; j < axes_; ++j)
+      {
+        joints[j] += h;
+        forward(joints, there);
+        joints[j] -= h;
+        for (i = 0; i < 3; ++i)
+        {
+          jac[i][j] = (there[i] - here[i]) / h;
+        }
+      }
+
+      //! (J J^T + damping I) y = e
+      for (i = 0; i < 3; ++i)
+      {
+        for (k = 0; k < 3; ++k)
+        {
+          a[i][k] = (i == k ? damping : 0.0);
+          for (j = 0; j < axes_; ++j)
+          {
+            a[i][k] += jac[i][j] * jac[k][j];
+          }
+        }
+      }
+      det = a[0][0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+            a[0][1] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+            a[0][2] * (a[1][0] * a[2][1] - a[1][1] * a[2][0]);
+      if (fabs(det) < 1.0e-12)
+      {
+        return false;
+      }
+      y[0] = (e[0] * (a[1][1] * a[2][2] - a[1][2] * a[2][1]) -
+              a[0][1] * (e[1] * a[2][2] - a[1][2] * e[2]) +
+              a[0][2] * (e[1] * a[2][1] - a[1][1] * e[2])) / det;
+      y[1] = (a[0][0] * (e[1] * a[2][2] - a[1][2] * e[2]) -
+              e[0] * (a[1][0] * a[2][2] - a[1][2] * a[2][0]) +
+              a[0][2] * (a[1][0] * e[2] - e[1] * a[2][0])) / det;
+      y[2] = (a[0][0] * (a[1][1] * e[2] - e[1] * a[2][1]) -
+              a[0][1] * (a[1][0] * e[2] - e[1] * a[2][0]) +
+              e[0] * (a[1][0] * a[2][1] - a[1][1] * a[2][0])) / det;
+
+      //! dq = J^T y, limited so that one iteration cannot swing the arm around
+      largest = 0.0;
+      for (j = 0; j < axes_; ++j)
+      {
+        step[j] = jac[0][j] * y[0] + jac[1][j] * y[1] + jac[2][j] * y[2];
+        largest = (fabs(step[j]) > largest ? fabs(step[j]) : largest);
+      }
+      for (j = 0; j < axes_; ++j)
+      {
+        joints[j] += (largest > SIM_IK_STEP ? step[j] * SIM_IK_STEP / largest : step[j]);
+      }
+    }
+
+    forward(joints, here);
+    for (i = 0; i < 3; ++i)
+    {
+      e[i] = pose[i] - here[i];
+    }
+    return (sqrt(e[0] * e[0] + e[1] * e[1] + e[2] * e[2]) < SIM_IK_TOLERANCE);
+  }
+
+} // crpi_robot
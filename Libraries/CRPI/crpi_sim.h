@@ -0,0 +1,497 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_sim.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Simulated robot controller declarations, for exercising the CRPI stack
+//  without hardware.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_SIM_H
+#define CRPI_SIM_H
+
+#include "crpi.h"
+#include "ulapi.h"
+
+#pragma warning (disable: 4251)
+
+#include <vector>
+
+using namespace std;
+
+//! Command types handed from the caller to the simulation thread
+#define SIM_CMD_STOP 0
+#define SIM_CMD_JOINT 1
+#define SIM_CMD_CARTESIAN 2
+
+#define SIM_WAIT_MAX 300.0          //! Longest wait for a simulated motion to finish (s)
+
+namespace crpi_robot
+{
+  //! @brief Simulated controller state published by the simulation thread
+  //!
+  //! @note Plain data only so that it can be published through CrpiStateCache.  Lengths are in
+  //!       mm and angles in degrees.
+  //!
+  struct LIBRARY_API simState
+  {
+    double axes[CRPI_AXES_MAX];
+    double axisSpeeds[CRPI_AXES_MAX];
+    double pose[6];
+    double poseSpeeds[6];
+    double forces[6];
+    double torques[CRPI_AXES_MAX];
+    bool dio[CRPI_IO_MAX];
+    double aio[CRPI_IO_MAX];
+    double tool;
+
+    //! @brief ID of the last command the thread finished with (reached, preempted, or stopped),
+    //!        and of the last command whose target was reached
+    //!
+    unsigned long finished, reached;
+
+    //! @brief Time (from ulapi_time) of the simulation step that produced this state
+    //!
+    double time;
+  };
+
+
+  //! @brief The most recent motion command, handed to the simulation thread
+  //!
+  struct LIBRARY_API simCommand
+  {
+    int type;
+    unsigned long id;
+    double axes[CRPI_AXES_MAX];
+    double pose[6];
+  };
+
+
+  //! @ingroup Robot
+  //!
+  //! @brief Simulated robot controller with the same interface as the hardware drivers
+  //!
+  //! @note Configured by the <Simulation> tag of the robot configuration file, which also makes
+  //!       CrpiRobot<T> of any robot type use this controller in place of the hardware.  A thread
+  //!       steps the simulated arm toward its target at the configured rate, limited by the joint
+  //!       and Cartesian speed limits, and publishes the result as feedback.  Every call is
+  //!       delayed by the configured latency plus a uniformly distributed jitter.
+  //!
+  //!       Two kinematic models are supported.  The "Cartesian" model moves the joints and the
+  //!       Cartesian pose independently.  The "Serial" model is an articulated arm whose first
+  //!       axis yaws about Z and whose remaining axes pitch in the vertical plane, with the given
+  //!       link lengths (the first is the base height); joint motions update the pose through
+  //!       the forward kinematics, and Cartesian motions solve for the joints from the position
+  //!       (the commanded orientation is reported as given).
+  //!
+  class LIBRARY_API CrpiSim
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    //! @param params Configuration parameters for the CRPI instance of this robot
+    //!
+    CrpiSim (CrpiRobotParams &params);
+
+    //! @brief Default destructor
+    //!
+    ~CrpiSim ();
+
+    //! @brief Apply a Cartesian Force/Torque at the TCP, expressed in robot base coordinate system
+    //!
+    //! @param robotForceTorque are the Cartesian command forces and torques applied at the end-effector
+    //!        activeAxes is used to toggle which axes will be slated for active force control. TRUE = ACTIVE, FALSE = INACTIVE
+    //!       manipulator is used to toggle which manipulators will be slated for active force control. TRUE = ACTIVE, FALSE = INACTIVE (useful for hands)
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn ApplyCartesianForceTorque (robotPose &robotForceTorque, vector<bool> activeAxes, vector<bool> manipulator);
+
+    //! @brief Apply joint torques
+    //!
+    //! @param robotJointTorque are the command torques for the respective joint axes
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn ApplyJointTorque (robotAxes &robotJointTorque);
+
+    //! @brief Dock with a specified target object
+    //!
+    //! @param targetID The name of the object with which the robot should dock
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn Couple (const char *targetID);
+
+    //! @brief Display a message on the operator console
+    //!
+    //! @param message The plain-text message to be displayed on the operator console
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn Message (const char *message);
+
+    //! @brief Move the robot in a straight line from the current pose to a new pose and stop there
+    //!
+    //! @param pose The target 6DOF pose for the robot
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn MoveStraightTo (robotPose &pose);
+
+    //! @brief Move the controlled point along a trajectory passing through or near all but the last
+    //!        of a series of poses, and then stop at the last pose
+    //!
+    //! @param poses         An array of 6DOF poses through/near which the robot is expected to pass
+    //! @param numPoses      The number of sub-poses in the submitted array
+    //! @param accelerations (optional) An array of 6DOF accelaration profiles for each motion
+    //!                      associated with the target poses
+    //! @param speeds        (optional) An array of 6DOF speed profiles for each motion assiciated
+    //!                      with the target poses
+    //! @param tolerances    (optional) An array of 6DOF tolerances in length and angle units for the
+    //!                      specified target poses
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    //! @note The simulated arm stops at every pose
+    //!
+    CanonReturn MoveThroughTo (robotPose *poses,
+                               int numPoses,
+                               robotPose *accelerations = NULL,
+                               robotPose *speeds = NULL,
+                               robotPose *tolerances = NULL);
+
+    //! @brief Move the controlled pose along any convenient trajectory from the current pose to the
+    //!        target pose, and then stop.
+    //!
+    //! @param pose The target 6DOF Cartesian pose for the robot's TCP in Cartesian space coordinates
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn MoveTo (robotPose &pose);
+
+    //! @brief Get feedback from the robot regarding its current axis configuration
+    //!
+    //! @param axes Axis array to be populated by the method
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn GetRobotAxes (robotAxes *axes);
+
+    //! @brief Get the measured Cartesian forces from the robot
+    //!
+    //! @param forces Cartesian force data structure to be populated by the method
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn GetRobotForces (robotPose *forces);
+
+    //! @brief Get I/O feedback from the robot
+    //!
+    //! @Param io Digital and analog I/O data structure to be populated by the method
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn GetRobotIO (robotIO *io);
+
+    //! @brief Get feedback from the robot regarding its current position in Cartesian space
+    //!
+    //! @param pose Cartesian pose data structure to be populated by the method
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn GetRobotPose (robotPose *pose);
+
+    //! @brief Get instantaneous Cartesian velocity
+    //!
+    //! @param speed Cartesian velocities to be populated by the method
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn GetRobotSpeed (robotPose *speed);
+
+    //! @brief Get instantaneous joint speeds
+    //!
+    //! @param speed Joint velocities array to be populated by the method
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn GetRobotSpeed (robotAxes *speed);
+
+    //! @brief Get joint torques from the robot regarding
+    //!
+    //! @param torques Axis array to be populated by the method
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn GetRobotTorques (robotAxes *torques);
+
+    //! @brief Move a virtual attractor to a specified coordinate in Cartesian space for force control
+    //!
+    //! @param pose The 6DOF destination of the virtual attractor
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn MoveAttractor (robotPose &pose);
+
+    //! @brief Move the robot axes to the specified target values
+    //!
+    //! @param axes An array of target axis values specified in the current axial unit
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn MoveToAxisTarget (robotAxes &axes);
+
+    //! @brief Set the accerlation for the controlled pose to the given value in length units per
+    //!        second per second
+    //!
+    //! @param acceleration The target TCP acceleration
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    //! @note Accepted but not simulated; motions run at constant speed
+    //!
+    CanonReturn SetAbsoluteAcceleration (double acceleration);
+
+    //! @brief Set the speed for the controlled pose to the given value in length units per second
+    //!
+    //! @param speed The target Cartesian speed
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetAbsoluteSpeed (double speed);
+
+    //! @brief Set angel units to the unit specified
+    //!
+    //! @param unitName The name of the angle units in plain text ("degree" or "radian")
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetAngleUnits (const char *unitName);
+
+    //! @brief Set the axis-specific speeds for the motion of axis-space motions
+    //!
+    //! @param speeds Array of target axial motion speeds
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetAxialSpeeds (double *speeds);
+
+    //! @brief Set specific axial units to the specified values
+    //!
+    //! @param unitNames Array of axis-specific names of the axis units in plain text
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetAxialUnits (const char **unitNames);
+
+    //! @brief Set the default 6DOF tolerances for the pose of the robot in current length and angle
+    //!        units
+    //!
+    //! @param tolerances Tolerances of the 6DOF end pose during Cartesian motion commands
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetEndPoseTolerance (robotPose &tolerance);
+
+    //! @brief Set the default 6DOF tolerance for smooth motion near intermediate points
+    //!
+    //! @param tolerances Tolerances of the 6DOF poses during multi-pose motions
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetIntermediatePoseTolerance (robotPose *tolerances);
+
+    //! @brief Set length units to the unit specified
+    //!
+    //! @param unitName The name of the length units in plain text ("inch," "mm," and "meter")
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetLengthUnits (const char *unitName);
+
+    //! @brief Set a robot-specific parameter (handling of parameter type casting to be handled by the
+    //!        robot interface)
+    //!
+    //! @param paramName The name of the parameter variable to set
+    //! @param paramVal  The value to be set to the parameter
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    //! @note Supported parameters are "latency" and "jitter" (double, in ms)
+    //!
+    CanonReturn SetParameter (const char *paramName, void *paramVal);
+
+    //! @brief Set the accerlation for the controlled pose to the given percentage of the robot's
+    //!        maximum acceleration
+    //!
+    //! @param percent The percentage of the robot's maximum acceleration in the range of [0, 1]
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    //! @note Accepted but not simulated; motions run at constant speed
+    //!
+    CanonReturn SetRelativeAcceleration (double percent);
+
+    //! @brief Set the speed for the controlled point to the given percentage of the robot's maximum
+    //!        speed
+    //!
+    //! @param percent The percentage of the robot's maximum speed in the range of [0, 1]
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetRelativeSpeed (double percent);
+
+    //! @brief Set the tool to the specified value
+    //!
+    //! @param value The tool value in the range of [0, 1]
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetTool (double percent);
+
+    //! @brief Set the robot's digital and analog outputs
+    //!
+    //! @param io Digital and analog I/O data structure to be populated by the method
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetRobotIO (robotIO &io);
+
+    //! @brief Set a specific digital output
+    //!
+    //! @param dig_out Digital output channel to set
+    //! @param val     Value to set the digital output
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn SetRobotDO (int dig_out, bool val);
+
+    //! @brief Stop the robot's motions based on robot stopping rules
+    //!
+    //! @param condition The rule by which the robot is expected to stop (Estop category 0, 1, or 2);
+    //!                  Estop category 2 is default
+    //!
+    //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
+    //!         not accepted, and FAILURE if the command is accepted but not executed successfully
+    //!
+    CanonReturn StopMotion (int condition = 2);
+
+    //! @brief Step the simulated arm and publish its state (thread body)
+    //!
+    void run ();
+
+  private:
+    //! @brief Wait out the configured latency and jitter of one exchange with the controller
+    //!
+    void delay ();
+
+    //! @brief Hand a motion command to the simulation thread and wait for it to finish
+    //!
+    //! @param type   SIM_CMD_JOINT or SIM_CMD_CARTESIAN
+    //! @param values Target joints (degrees) or pose (mm and degrees)
+    //!
+    //! @return SUCCESS if the target was reached, FAILURE if the motion was stopped or preempted
+    //!
+    CanonReturn command (int type, const double *values);
+
+    //! @brief Convert a pose from the current units to mm and degrees
+    //!
+    void toInternal (robotPose &pose, double *values);
+
+    //! @brief Forward kinematics of the serial model
+    //!
+    //! @param joints Joint angles (degrees)
+    //! @param pose   6DOF pose (mm and degrees) populated by this method
+    //!
+    void forward (const double *joints, double *pose);
+
+    //! @brief Solve the serial model for the joints that place the TCP at a position
+    //!
+    //! @param pose   Target pose (only the position is used)
+    //! @param joints Joint angles (degrees); the initial guess, replaced with the solution
+    //!
+    //! @return True if the solution is within 0.01 mm of the target, false otherwise
+    //!
+    bool inverse (const double *pose, double *joints);
+
+    //! @brief Configuration copied from the robot configuration file
+    //!
+    bool serial_;
+    int axes_;
+    double links_[CRPI_AXES_MAX];
+    double maxJointSpeed_;
+    double maxCartSpeed_;
+    double maxRotSpeed_;
+    double rate_;
+    double latency_;
+    double jitter_;
+
+    //! @brief Speed settings (degrees/s and mm/s), applied to the next motion step
+    //!
+    double jointSpeeds_[CRPI_AXES_MAX];
+    double cartSpeed_;
+
+    CanonAngleUnit angleUnits_;
+    CanonLengthUnit lengthUnits_;
+    CanonAngleUnit axialUnits_[CRPI_AXES_MAX];
+
+    //! @brief Guards cmd_ and the settings read by the simulation thread
+    //!
+    ulapi_mutex_struct *lock_;
+    simCommand cmd_;
+    unsigned long nextId_;
+
+    //! @brief Outputs and commanded forces, applied by the simulation thread on its next step
+    //!
+    bool dio_[CRPI_IO_MAX];
+    double aio_[CRPI_IO_MAX];
+    double forces_[6];
+    double torques_[CRPI_AXES_MAX];
+    double tool_;
+
+    bool runThread_;
+    bool running_;
+    void *task_;
+    CrpiStateCache<simState> cache_;
+  }; // CrpiSim
+
+} // namespace crpi_robot
+
+#endif
@@ -13,8 +13,13 @@
 ///////////////////////////////////////////////////////////////////////////////
 
 #include "crpi_universal.h"
+#include "crpi_universal_rtde.h"
+#include "crpi_watchdog.h"
 #include <fstream>
 #include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
 
 #define BLOCKING_MOTION
 //#define VERIFY_MOVING
@@ -27,370 +32,495 @@
 #define angthresh 0.05f
 #define timethresh 10
 
+//! Realtime (port 30003) stream settings:  reassembly buffer size (bytes) and the bounds (ms)
+//! of the exponential reconnect backoff
+#define UR_STREAM_BUFFER 4096
+#define UR_BACKOFF_MIN 100
+#define UR_BACKOFF_MAX 5000
+
+//! RTDE recipes:  only the fields published to the state cache, plus the registers shared with
+//! the resident program (see crpi_universal_rtde.h for the register layout)
+#define UR_RTDE_OUTPUTS "timestamp,target_q,actual_qd,actual_current,target_TCP_pose,actual_TCP_speed," \
+                        "actual_TCP_force,actual_digital_input_bits,safety_mode," \
+                        "output_int_register_24,output_int_register_25"
+#define UR_RTDE_INPUTS "input_int_register_24,input_int_register_25,input_int_register_26," \
+                       "input_double_register_24,input_double_register_25,input_double_register_26," \
+                       "input_double_register_27,input_double_register_28,input_double_register_29," \
+                       "input_double_register_30"
+#define UR_RTDE_INPUT_COUNT 10
+#define UR_RESIDENT_TIMEOUT 2.0
+
+//! Keepalive heartbeat period and the age (s) after which realtime feedback is reported stale
+#define UR_HEARTBEAT_PERIOD 1.0
+#define UR_FEEDBACK_STALE 0.5
+
 using namespace std;
 
 namespace crpi_robot
 {
-  void livemanUniversal(void *param)
+  //! @brief Keepalive heartbeat:  report the age of the realtime (or RTDE) feedback without
+  //!        touching the command socket
+  //!
+  bool heartbeatUniversal (void *param, double &feedbackTime)
   {
     universalHandler *uh = (universalHandler*)param;
-    robotPose pose;
-    crpi_timer timer;
-    ulapi_integer get;
-    char buffer[4];
 
-    while (uh->runThread)
-    {
-      ulapi_mutex_take(uh->TCPIPhandle);
-      get = ulapi_socket_read(uh->clientID, buffer, 4);
-      ulapi_mutex_give(uh->TCPIPhandle);
+    ulapi_mutex_take(uh->handle);
+    feedbackTime = uh->feedbackTime;
+    ulapi_mutex_give(uh->handle);
 
-      //! Don't slam your processor!  You don't need to poll at full speed.
-      timer.waitUntil(5000);
-    }
-    return;
+    return ((uh->rtde != NULL || uh->clientID >= 0) && (ulapi_time() - feedbackTime) < UR_FEEDBACK_STALE);
   }
 
 
-  int readInt (char *buffer, int &index, bool little)
+  //! @brief One block of consecutive doubles in the realtime packet
+  //!
+  struct urFieldLayout
   {
-    static char ucval[sizeof(int)];
-    static int x;
-    static int returnMe;
+    //! @brief Byte offset of the destination in urRealtimeState, or UR_SKIP for reserved words
+    //!
+    size_t offset;
 
-    for (x = 0; x < sizeof(int); ++x)
-    {
-      ucval[x] = (little ? buffer[index+(sizeof(int) - (x+1))] : buffer[index + x]);
-    }
-    index += sizeof(int);
-    memcpy(&returnMe, ucval, sizeof(int));
-    return returnMe;
-  }
+    //! @brief Number of doubles in the block
+    //!
+    int count;
+  };
 
+#define UR_SKIP ((size_t)-1)
+#define UR_FIELD(name, count) { offsetof(urRealtimeState, name), count }
 
-  double readDouble (char *buffer, int &index, bool little)
+  //! @brief Realtime packet fields in wire order, following the 4-byte message size.  Newer
+  //!        controller versions only ever append fields, so each packet version decodes a prefix
+  //!        of this table.
+  //!
+  static const urFieldLayout urFields[] =
   {
-    static char ucval[sizeof(double)];
-    static int x;
-    static double returnMe;
-
-    for (x = 0; x < sizeof(double); ++x)
-    {
-      ucval[x] = (little ? buffer[index+(sizeof(double) - (x+1))] : buffer[index + x]);
-    }
-    index += sizeof(double);
-    memcpy(&returnMe, ucval, sizeof(double));
-    return returnMe;
+    UR_FIELD(time, 1),
+    UR_FIELD(qTarget, 6),
+    UR_FIELD(qdTarget, 6),
+    UR_FIELD(qddTarget, 6),
+    UR_FIELD(iTarget, 6),
+    UR_FIELD(mTarget, 6),
+    UR_FIELD(qActual, 6),
+    UR_FIELD(qdActual, 6),
+    UR_FIELD(iActual, 6),
+    UR_FIELD(iControl, 6),
+    UR_FIELD(toolVectorActual, 6),
+    UR_FIELD(tcpSpeedActual, 6),
+    UR_FIELD(tcpForce, 6),
+    UR_FIELD(toolVectorTarget, 6),
+    UR_FIELD(tcpSpeedTarget, 6),
+    UR_FIELD(digitalInputs, 1),
+    UR_FIELD(motorTemperatures, 6),
+    UR_FIELD(controllerTimer, 1),
+    UR_FIELD(testValue, 1),
+    UR_FIELD(robotMode, 1),
+    UR_FIELD(jointModes, 6),
+    //! 812 bytes up to this point
+    UR_FIELD(safetyMode, 1),
+    { UR_SKIP, 6 },
+    UR_FIELD(toolAccelerometer, 3),
+    { UR_SKIP, 6 },
+    UR_FIELD(speedScaling, 1),
+    UR_FIELD(linearMomentumNorm, 1),
+    { UR_SKIP, 1 },
+    { UR_SKIP, 1 },
+    UR_FIELD(vMain, 1),
+    UR_FIELD(vRobot, 1),
+    UR_FIELD(iRobot, 1),
+    UR_FIELD(vActual, 6),
+    //! 1044 bytes up to this point
+    UR_FIELD(digitalOutputs, 1),
+    UR_FIELD(programState, 1),
+    //! 1060 bytes up to this point
+    UR_FIELD(elbowPosition, 3),
+    UR_FIELD(elbowVelocity, 3),
+    //! 1108 bytes up to this point
+    UR_FIELD(safetyStatus, 1)
+    //! 1116 bytes up to this point
+  };
+
+  //! @brief Known realtime packet versions
+  //!
+  struct urPacketVersion
+  {
+    //! @brief Total packet length in bytes
+    //!
+    int bytes;
+
+    //! @brief Number of leading urFields entries present in the packet
+    //!
+    int fields;
+  };
+
+  //! @brief Packet versions by controller software release, in increasing size
+  //!
+  static const urPacketVersion urVersions[] =
+  {
+    { 812, 21 },   //! 1.8
+    { 1044, 33 },  //! 3.0 - 3.1
+    { 1060, 35 },  //! 3.2 - 3.4
+    { 1108, 37 },  //! 3.5 - 3.9
+    { 1116, 38 }   //! 3.10 and later
+  };
+
+  static const int urFieldCount = (int)(sizeof(urFields) / sizeof(urFieldLayout));
+  static const int urVersionCount = (int)(sizeof(urVersions) / sizeof(urPacketVersion));
+
+
+  //! @brief Decode one big-endian double from the packet without an intermediate copy loop
+  //!
+  //! @param src Pointer to the first byte of the value in the packet
+  //!
+  //! @return The value in host byte order
+  //!
+  inline double readDouble (const char *src)
+  {
+    uint64_t raw;
+    double val;
+    memcpy(&raw, src, sizeof(raw));
+#if defined(_MSC_VER)
+    raw = _byteswap_uint64(raw);
+#else
+    raw = __builtin_bswap64(raw);
+#endif
+    memcpy(&val, &raw, sizeof(val));
+    return val;
   }
 
 
-  long readLong (char *buffer, int &index, bool little)
+  //! @brief Decode a realtime packet into a typed state structure in a single pass
+  //!
+  //! @param bytes  The length of the packet in bytes
+  //! @param buffer The packet, starting with its 4-byte length prefix
+  //! @param state  The structure populated by this function
+  //!
+  //! @return True if the packet matches a known version (or extends one), false otherwise
+  //!
+  //! @note Packets longer than the largest known version come from newer controllers; their
+  //!       known prefix is decoded and the remainder ignored.  This function keeps no state
+  //!       between calls, so it is safe to use from several feedback threads at once.
+  //!
+  bool parseFeedback (int bytes, const char *buffer, urRealtimeState &state)
   {
-    static char ucval[sizeof(double)];
-    static int x;
-    static long returnMe;
+    const urPacketVersion *version = NULL;
+    const char *src = buffer + 4;
+    char *dst = (char*)&state;
+    double *out;
+    int f, j;
 
-    for (x = 0; x < sizeof(long); ++x)
+    //! JAM:  Note that the UR sends feedback in big endian format.  All supported hosts (x86,
+    //!       little-endian ARM) need the bytes swapped.
+    for (f = 0; f < urVersionCount; ++f)
     {
-      ucval[x] = (little ? buffer[index+(sizeof(long) - (x+1))] : buffer[index + x]);
+      if (urVersions[f].bytes <= bytes)
+      {
+        version = &urVersions[f];
+      }
     }
-    index += sizeof(long);
-    memcpy(&returnMe, ucval, sizeof(long));
-    return returnMe;
-  }
 
-  bool parseFeedback (int bytes, char *buffer, robotPose &pose, robotAxes &axes, robotIO &io, robotPose &forces, robotPose &speeds)
-  {
-    double dval;
-    int ival;
-    bool little = false;
-
-    //! JAM:  Note that the UR sends feedback in big endian format.  Test for endianess.
-    int i = 0x01234567;
-    int j;
-    char* c = (char*)&i;
-    little = (c[0] == 'g');
-    //for (j = 0; j < sizeof(int); j++)
-    //{
-    //  printf(" %.2x", c[j]);
-    //}
-    //printf("\n");
-       
-    //! If big endian:  01 23 45 67
-    //! If little endian: 67 45 23 01
-    
-    //cout << bytes << endl;
-    if (bytes != 1044 && bytes != 812)
+    if (version == NULL)
     {
       //! unknown byte length
       return false;
     }
 
-    int index = 0;
-    //! Number of bytes sent
-    ival = readInt(buffer, index, little);
-
-    //! Time
-    dval = readDouble(buffer, index, little);
-
-    //! Target joint positions
-    for (j = 0; j < 6; ++j)
-    {
-      //dval = readDouble(buffer, index, little);
-      axes.axis.at(j) = readDouble(buffer, index, little);
-    }
-
-    //! Target joint velocities
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
-
-    //! Target joint accelerations
-    for (j = 0; j < 6; ++j)
+    state.messageSize = bytes;
+    for (f = 0; f < urFieldCount; ++f)
     {
-      dval = readDouble(buffer, index, little);
-    }
-
-    //! Target joint current
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
+      out = (urFields[f].offset == UR_SKIP ? NULL : (double*)(dst + urFields[f].offset));
+      if (f >= version->fields)
+      {
+        //! Not sent by this controller version
+        if (out != NULL)
+        {
+          memset(out, 0, urFields[f].count * sizeof(double));
+        }
+        continue;
+      }
 
-    //! Target joint moments
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
+      for (j = 0; j < urFields[f].count; ++j, src += sizeof(double))
+      {
+        if (out != NULL)
+        {
+          out[j] = readDouble(src);
+        }
+      }
     }
 
-    //! Actual joint positions
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
+    return true;
+  }
 
-    //! Actual joint velocities
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
 
-    //! Actual joint currents
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
+  //! @brief Read the big-endian length prefix that opens every realtime packet
+  //!
+  //! @param buffer Pointer to the first byte of the packet
+  //!
+  //! @return The total packet length in bytes (including the prefix itself)
+  //!
+  int packetLength (const char *buffer)
+  {
+    const unsigned char *b = (const unsigned char*)buffer;
+    return (int)(((unsigned int)b[0] << 24) | ((unsigned int)b[1] << 16) |
+                 ((unsigned int)b[2] << 8) | (unsigned int)b[3]);
+  }
 
-    //! Joint control currents
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
 
-    //! Actual Cartesian coordinates of TCP
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
+  //! @brief Store a decoded state in the handler's feedback cache
+  //!
+  //! @param uH    The handler shared with the CrpiUniversal instance
+  //! @param state The decoded robot state
+  //!
+  void publishFeedback (universalHandler *uH, urRealtimeState &state)
+  {
+    robotIO io;
+    int i;
+    int bits;
+
+    bits = (int)state.digitalInputs;
+    for (i = 0; i < CRPI_IO_MAX; ++i)
+    {
+      io.dio[i] = (((bits >> i) & 1) == 1);
+    }
+
+    ulapi_mutex_take(uH->handle);
+    //! Store feedback from robot
+    uH->curState = state;
+    uH->curPose.x = state.toolVectorTarget[0];
+    uH->curPose.y = state.toolVectorTarget[1];
+    uH->curPose.z = state.toolVectorTarget[2];
+    uH->curPose.xrot = state.toolVectorTarget[3];
+    uH->curPose.yrot = state.toolVectorTarget[4];
+    uH->curPose.zrot = state.toolVectorTarget[5];
+    uH->curForces.x = state.tcpForce[0];
+    uH->curForces.y = state.tcpForce[1];
+    uH->curForces.z = state.tcpForce[2];
+    uH->curForces.xrot = state.tcpForce[3];
+    uH->curForces.yrot = state.tcpForce[4];
+    uH->curForces.zrot = state.tcpForce[5];
+    uH->curSpeeds.x = state.tcpSpeedActual[0];
+    uH->curSpeeds.y = state.tcpSpeedActual[1];
+    uH->curSpeeds.z = state.tcpSpeedActual[2];
+    uH->curSpeeds.xrot = state.tcpSpeedActual[3];
+    uH->curSpeeds.yrot = state.tcpSpeedActual[4];
+    uH->curSpeeds.zrot = state.tcpSpeedActual[5];
+    for (i = 0; i < 6; ++i)
+    {
+      uH->curAxes.axis.at(i) = state.qTarget[i];
+      uH->curJointSpeeds.axis.at(i) = state.qdActual[i];
+      uH->curJointCurrents.axis.at(i) = state.iActual[i];
+    }
+    uH->curIO = io;
+    uH->poseGood = true;
+    ++uH->feedbackCount;
+    uH->feedbackTime = ulapi_time();
+    ulapi_mutex_give(uH->handle);
+  }
 
-    //! Actual speed of TCP in Cartesian space
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
 
-    //! Forces at TCP
-    /*
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
-    */
-    forces.x = readDouble(buffer, index, little);
-    forces.y = readDouble(buffer, index, little);
-    forces.z = readDouble(buffer, index, little);
-    forces.xrot = readDouble(buffer, index, little);
-    forces.yrot = readDouble(buffer, index, little);
-    forces.zrot = readDouble(buffer, index, little);
-
-    //! TCP target coordinates
-    /*
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
-    */
-    pose.x = readDouble(buffer, index, little);
-    pose.y = readDouble(buffer, index, little);
-    pose.z = readDouble(buffer, index, little);
-    pose.xrot = readDouble(buffer, index, little);
-    pose.yrot = readDouble(buffer, index, little);
-    pose.zrot = readDouble(buffer, index, little);
-    //cout << "raw: " << pose.x << " " << pose.y << " " << pose.z << " " << pose.xrot << " " << pose.yrot << " " << pose.zrot << endl;
-
-    //! TCP target speed
-    /*
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
-    */
-    speeds.x = readDouble(buffer, index, little);
-    speeds.y = readDouble(buffer, index, little);
-    speeds.z = readDouble(buffer, index, little);
-    speeds.xrot = readDouble(buffer, index, little);
-    speeds.yrot = readDouble(buffer, index, little);
-    speeds.zrot = readDouble(buffer, index, little);
-    
-    //! Digital input states
-    ival = (int)(readDouble(buffer, index, little));
-    for (j = (CRPI_IO_MAX-1); j >= 0; j--)
+  //! @brief Wait out a reconnect backoff, returning early once the thread is told to stop
+  //!
+  void backoffSleep (universalHandler *uH, int backoff)
+  {
+    for (int slept = 0; slept < backoff && uH->runThread; slept += UR_BACKOFF_MIN)
     {
-      io.dio[j] = (ival >= (1 << j));
-      if (io.dio[j])
-      {
-        ival -= (int)(1 << j);
-      }
+      Sleep(UR_BACKOFF_MIN);
     }
+  }
 
-    //! Motor temperatures
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
 
-    //! Controller timer
-    dval = readDouble(buffer, index, little);
+  //! @brief Close the realtime connection, clearing it from the handler first
+  //!
+  void closeFeedback (universalHandler *uH, ulapi_integer &client)
+  {
+    ulapi_mutex_take(uH->handle);
+    uH->feedbackSocket = -1;
+    ulapi_socket_close(client);
+    ulapi_mutex_give(uH->handle);
+    client = -1;
+  }
 
-    //! Test value
-    dval = readDouble(buffer, index, little);
 
-    //! Robot mode
-    dval = readDouble(buffer, index, little);
+  void feedbackThread (void *param)
+  {
+    universalHandler *uH = (universalHandler*)param;
+    ulapi_integer client = -1;
+    char *buffer;
+    int get;
+    int have = 0;
+    int offset;
+    int length;
+    int backoff = UR_BACKOFF_MIN;
+    bool retry = false;
+    urRealtimeState state;
 
-    //! Joint modes
-    for (j = 0; j < 6; ++j)
-    {
-      dval = readDouble(buffer, index, little);
-    }
+    buffer = new char[UR_STREAM_BUFFER];
 
-    //! 1044 bytes beyond this point
-    if (ival > 812)
+    while (uH->runThread)
     {
-      //! Safety mode
-      dval = readDouble(buffer, index, little);
-
-      //! Reserved
-      for (j = 0; j < 6; ++j)
+      /*
+      HOST = "169.254.152.50" //! The remote host
+      PORT = 30003            //! 125 Hz update of robot state
+      PORT = 30002            //! Control port
+      */
+      if (client < 0)
       {
-        dval = readDouble(buffer, index, little);
-      }
+        if (retry)
+        {
+          //! Controller unreachable, or the connection was dropped:  back off (doubling up to
+          //! UR_BACKOFF_MAX until a packet arrives) before reconnecting
+          backoffSleep(uH, backoff);
+          backoff = ((backoff * 2) > UR_BACKOFF_MAX ? UR_BACKOFF_MAX : (backoff * 2));
+        }
+        retry = true;
 
-      //! Tool accelerometer
-      for (j = 0; j < 3; ++j)
-      {
-        dval = readDouble(buffer, index, little);
+        //! Open a single long-lived connection to the realtime port.  The controller pushes a
+        //! packet every 8 ms for as long as the connection stays open.
+        client = ulapi_socket_get_client_id (30003, uH->params.tcp_ip_addr);
+        if (client < 0)
+        {
+          continue;
+        }
+        ulapi_mutex_take(uH->handle);
+        uH->feedbackSocket = client;
+        ulapi_mutex_give(uH->handle);
+        have = 0;
       }
 
-      //! Reserved
-      for (j = 0; j < 6; ++j)
+      //! Append whatever has arrived to the reassembly buffer.  Reads block until the next
+      //! packet (or part of one) arrives, so this loop runs at the controller's rate.
+      get = ulapi_socket_read(client, buffer + have, UR_STREAM_BUFFER - have);
+      if (get <= 0)
       {
-        dval = readDouble(buffer, index, little);
+        //! Connection closed or broken:  drop any partial packet and reconnect
+        closeFeedback(uH, client);
+        continue;
       }
+      have += get;
 
-      //! Speed scaling
-      dval = readDouble(buffer, index, little);
-
-      //! Linear momentum norm
-      dval = readDouble(buffer, index, little);
-
-      //! Reserved
-      dval = readDouble(buffer, index, little);
-
-      //! Reserved
-      dval = readDouble(buffer, index, little);
-
-      //! Main voltage
-      dval = readDouble(buffer, index, little);
+      //! Publish every complete packet in the buffer
+      offset = 0;
+      while ((have - offset) >= 4)
+      {
+        length = packetLength(buffer + offset);
+        if (length < 4 || length > UR_STREAM_BUFFER)
+        {
+          //! Lost framing.  There is no sync marker in the stream, so start over on a fresh
+          //! connection.
+          closeFeedback(uH, client);
+          break;
+        }
 
-      //! Robot voltage
-      dval = readDouble(buffer, index, little);
+        if ((have - offset) < length)
+        {
+          //! Partial packet, wait for the rest
+          break;
+        }
 
-      //! Robot current
-      dval = readDouble(buffer, index, little);
+        //! Parse feedback from robot
+        if (parseFeedback(length, buffer + offset, state))
+        {
+          publishFeedback(uH, state);
+          backoff = UR_BACKOFF_MIN;
+        }
+        offset += length;
+      }
 
-      //! Joint voltages
-      for (j = 0; j < 6; ++j)
+      if (client < 0)
       {
-        dval = readDouble(buffer, index, little);
+        have = 0;
       }
-    } // if (ival > 812)
+      else if (offset > 0)
+      {
+        //! Keep the head of the next packet for the following read
+        have -= offset;
+        memmove(buffer, buffer + offset, have);
+      }
+    }
 
-    return true;
+    if (client >= 0)
+    {
+      closeFeedback(uH, client);
+    }
+    ulapi_mutex_take(uH->handle);
+    uH->running = false;
+    ulapi_mutex_give(uH->handle);
+    delete [] buffer;
+    return;
   }
 
-  void feedbackThread (void *param)
+
+  //! @brief Feedback thread used in place of feedbackThread when RTDE is configured
+  //!
+  void rtdeFeedbackThread (void *param)
   {
-    static crpi_timer timer;
     universalHandler *uH = (universalHandler*)param;
-    bool connected = false;
-    char *buffer;
-    int get;
-    robotPose pose;
-    robotAxes axes;
-    robotPose force;
-    robotPose speed;
-    robotIO io;
-
-    buffer = new char[1044];
+    RtdeClient *rtde = uH->rtde;
+    int backoff = UR_BACKOFF_MIN;
+    bool inputs;
+    urRealtimeState state;
 
     while (uH->runThread)
     {
-//      cout << "running... " << endl;
-      /*
-      HOST = "169.254.152.50" //! The remote host
-      PORT = 30003            //! 125 Hz update of robot state
-      PORT = 30002            //! Control port
-      */
-      ulapi_integer client = ulapi_socket_get_client_id (30003, uH->params.tcp_ip_addr);
-      ulapi_socket_set_nonblocking(client);
-
-      if (client > 0)
+      if (!rtde->connected())
       {
-        //! Read feedback from robot
-        get = ulapi_socket_read(client, buffer, 1044);
-        ulapi_socket_close(client);
+        //! Subscribe to the output recipe only; the controller then sends nothing we don't use
+        if (!rtde->connect(uH->params.tcp_ip_addr, uH->params.rtde_port) ||
+            !rtde->setupOutputs(uH->params.rtde_frequency, UR_RTDE_OUTPUTS))
+        {
+          rtde->disconnect();
+          backoffSleep(uH, backoff);
+          backoff = ((backoff * 2) > UR_BACKOFF_MAX ? UR_BACKOFF_MAX : (backoff * 2));
+          continue;
+        }
 
-        //! Parse feedback from robot
-        if (parseFeedback(get, buffer, pose, axes, io, force, speed))
+        //! The input registers may be claimed by another client, in which case motion falls
+        //! back to the script port
+        inputs = rtde->setupInputs(UR_RTDE_INPUTS);
+        if (!rtde->start())
         {
-          ulapi_mutex_take(uH->handle);
-          //! Store feedback from robot
-          uH->curPose = pose;
-          uH->poseGood = true;
-          uH->curAxes = axes;
-          uH->curForces = force;
-          uH->curSpeeds = speed;
-          uH->curIO = io;
-          ulapi_mutex_give(uH->handle);
-
-          //cout << "(" << pose.x << ", " << pose.y << ", " << pose.z << ", " << pose.xrot << ", " << pose.yrot << ", " << pose.zrot << ")" << endl;
-          //cout << "(" << axes.axis.at(0) << ", " << axes.axis.at(1) << ", " << axes.axis.at(2) << ", " << axes.axis.at(3) << ", " << axes.axis.at(4) << ", " << axes.axis.at(5) << ")" << endl;
+          rtde->disconnect();
+          continue;
         }
+
+        ulapi_mutex_take(uH->handle);
+        uH->rtdeInputs = inputs;
+        ulapi_mutex_give(uH->handle);
+        state = urRealtimeState();
+      }
+
+      //! Blocks until the next data package (2 ms at 500 Hz)
+      if (!rtde->receive(state))
+      {
+        ulapi_mutex_take(uH->handle);
+        uH->rtdeInputs = false;
+        ulapi_mutex_give(uH->handle);
+        rtde->disconnect();
+        continue;
       }
 
-      //! Don't slam your processor!  You don't need to poll at full speed. 10 Hz
-      //timer.waitUntil(100);//Sleep (100);
-      Sleep(50);
+      publishFeedback(uH, state);
+      ulapi_mutex_take(uH->handle);
+      uH->rtdeAck = rtde->intRegister(RTDE_REGISTER_BASE);
+      uH->rtdeSession = rtde->intRegister(RTDE_REGISTER_BASE + 1);
+      ulapi_mutex_give(uH->handle);
+      backoff = UR_BACKOFF_MIN;
     }
-    delete [] buffer;
+
+    //! The client itself is deleted by the robot once this thread has been joined
+    rtde->disconnect();
+    ulapi_mutex_take(uH->handle);
+    uH->rtdeInputs = false;
+    uH->running = false;
+    ulapi_mutex_give(uH->handle);
     return;
   }
 
 
   LIBRARY_API CrpiUniversal::CrpiUniversal (CrpiRobotParams &params) :
-    firstIO_(true)
+    firstIO_(true),
+    rtdeSeq_(0),
+    residentRunning_(false)
   {
     double Xtheta, Ytheta, Ztheta;
     params_ = params;
@@ -421,22 +551,38 @@ namespace crpi_robot
     handle_.runThread = true;
     handle_.poseGood = false;
     handle_.curTool = -1;
+    handle_.feedbackCount = 0;
+    handle_.feedbackTime = 0.0;
+    handle_.rtde = NULL;
+    handle_.rtdeInputs = false;
+    handle_.rtdeAck = 0;
+    handle_.rtdeSession = 0;
+    handle_.running = false;
+    handle_.feedbackSocket = -1;
+    rtdeSession_ = ((int)ulapi_time() & 0xFFFF) + 1;
 
     //! Connect to UR server
 #ifdef NEWTCPIP
     handle_.clientID = ulapi_socket_get_client_id(params_.tcp_ip_port, params_.tcp_ip_addr);
     ulapi_socket_set_nonblocking(handle_.clientID);
 #endif
-    ulapi_task_start((ulapi_task_struct*)task, feedbackThread, &handle_, ulapi_prio_lowest(), 0);
+    if (params_.use_rtde)
+    {
+      //! Feedback and motion setpoints over RTDE (port 30004)
+      handle_.rtde = new RtdeClient();
+      handle_.running = (ulapi_task_start((ulapi_task_struct*)task, rtdeFeedbackThread, &handle_, ulapi_prio_lowest(), 0) == ULAPI_OK);
+    }
+    else
+    {
+      handle_.running = (ulapi_task_start((ulapi_task_struct*)task, feedbackThread, &handle_, ulapi_prio_lowest(), 0) == ULAPI_OK);
+    }
 
     while (handle_.poseGood != true)
     {
       Sleep(100);
     }
 
-#ifdef NEWTCPIP
-    ulapi_task_start((ulapi_task_struct*)task, livemanUniversal, &handle_, ulapi_prio_lowest(), 0);
-#endif
+    watchId_ = CrpiWatchdog::instance().add("Universal", UR_HEARTBEAT_PERIOD, heartbeatUniversal, &handle_, UR_FEEDBACK_STALE);
 
     pin_ = new matrix(3,1);
     pout_ = new matrix(3,1);
@@ -473,7 +619,44 @@ namespace crpi_robot
 
   LIBRARY_API CrpiUniversal::~CrpiUniversal ()
   {
+    bool started;
+
+    CrpiWatchdog::instance().remove(watchId_);
     handle_.runThread = false;
+
+    ulapi_mutex_take(handle_.handle);
+    started = handle_.running;
+    ulapi_mutex_give(handle_.handle);
+
+    //! Release the feedback thread from a blocking read until it notices that it is to stop
+    //! (it may be between connecting and blocking on the new connection), then wait for it
+    while (true)
+    {
+      ulapi_mutex_take(handle_.handle);
+      if (!handle_.running)
+      {
+        ulapi_mutex_give(handle_.handle);
+        break;
+      }
+      if (handle_.feedbackSocket >= 0)
+      {
+        SocketRelease(handle_.feedbackSocket);
+      }
+      ulapi_mutex_give(handle_.handle);
+      if (handle_.rtde != NULL)
+      {
+        handle_.rtde->release();
+      }
+      Sleep(1);
+    }
+    if (started)
+    {
+      ulapi_task_join((ulapi_task_struct*)task, NULL);
+    }
+    ulapi_task_delete((ulapi_task_struct*)task);
+    delete handle_.rtde;
+    handle_.rtde = NULL;
+
     delete forward_;
     delete backward_;
     delete pin_;
@@ -594,6 +777,7 @@ namespace crpi_robot
     //! Construct message
     vector<double> target;
     robotPose temp;
+    CanonReturn status;
 
 #ifdef BLOCKING_MOTION 
     double dist, dist2, tim, dist_rot;
@@ -608,6 +792,13 @@ namespace crpi_robot
     target.push_back (temp.yrot);
     target.push_back (temp.zrot);
 
+    //! Drive the resident program through the RTDE input registers when they are available
+    status = rtdeMove(RTDE_CMD_MOVEL_POSE, target);
+    if (status != CANON_REJECT)
+    {
+      return status;
+    }
+
     //! LIN, Cartesian, Absolute
     if (generateMove ('L', 'C', 'A', target))
     {
@@ -699,6 +890,7 @@ namespace crpi_robot
     //! Construct message
     vector<double> target;
     robotPose temp = pose;
+    CanonReturn status;
 
 #ifdef BLOCKING_MOTION 
     double dist, dist2, tim;
@@ -713,6 +905,13 @@ namespace crpi_robot
     target.push_back (temp.yrot);
     target.push_back (temp.zrot);
 
+    //! Drive the resident program through the RTDE input registers when they are available
+    status = rtdeMove(RTDE_CMD_MOVEJ_POSE, target);
+    if (status != CANON_REJECT)
+    {
+      return status;
+    }
+
 /*
     if (lengthUnits_ == MM)
     {
@@ -912,15 +1111,24 @@ namespace crpi_robot
 
   LIBRARY_API CanonReturn CrpiUniversal::GetRobotSpeed (robotAxes *speed)
   {
-    //! TODO
-    return CANON_FAILURE;
+    ulapi_mutex_take(handle_.handle);
+    *speed = handle_.curJointSpeeds;
+    ulapi_mutex_give(handle_.handle);
+
+    for (int i = 0; i < 6; ++i)
+    {
+      //! Report in deg/s, matching GetRobotAxes
+      speed->axis.at(i) *= (180.0f / 3.141592654f);
+    }
+
+    return CANON_SUCCESS;
   }
 
 
   LIBRARY_API CanonReturn CrpiUniversal::GetRobotTorques (robotAxes *torques)
   {
     ulapi_mutex_take(handle_.handle);
-    *torques = handle_.curAxes;
+    *torques = handle_.curJointCurrents;
     ulapi_mutex_give(handle_.handle);
 
     return CANON_SUCCESS;
@@ -994,6 +1202,7 @@ namespace crpi_robot
     double dist, dist2;
     int count;
     ulapi_real tim;
+    CanonReturn status;
 
     //! Construct message
     vector<double> target;
@@ -1011,6 +1220,13 @@ namespace crpi_robot
       }
     }
 
+    //! Drive the resident program through the RTDE input registers when they are available
+    status = rtdeMove(RTDE_CMD_MOVEJ_AXES, target);
+    if (status != CANON_REJECT)
+    {
+      return status;
+    }
+
     //! PTP, Angular, Absolute
     if (generateMove ('P', 'A', 'A', target))
     {
@@ -1469,6 +1685,9 @@ namespace crpi_robot
 
   LIBRARY_API bool CrpiUniversal::send ()
   {
+    //! Any program sent to the script port replaces the resident program
+    residentRunning_ = false;
+
 #ifndef NEWTCPIP
     ulapi_mutex_take(handle_.handle);
     ulapi_integer client = ulapi_socket_get_client_id (handle_.params.tcp_ip_port, handle_.params.tcp_ip_addr);
@@ -1528,6 +1747,145 @@ namespace crpi_robot
     }
   }
 
+  LIBRARY_API bool CrpiUniversal::uploadResident ()
+  {
+    double values[UR_RTDE_INPUT_COUNT];
+    double tim;
+    int session = 0;
+    int r;
+
+    //! A fresh token per upload, since the output register still holds the previous one
+    ++rtdeSession_;
+
+    //! Publish the current sequence number first so the new program does not replay the last
+    //! command, along with the session token it will report back
+    memset(values, 0, sizeof(values));
+    values[0] = rtdeSeq_;
+    values[2] = rtdeSession_;
+    if (!handle_.rtde->sendInputs(values, UR_RTDE_INPUT_COUNT))
+    {
+      return false;
+    }
+
+    ulapi_mutex_take(handle_.handle);
+    handle_.moveMe.str(string());
+    handle_.moveMe << "def crpiResident():\n";
+    handle_.moveMe << "  seq = read_input_integer_register(" << RTDE_REGISTER_BASE << ")\n";
+    handle_.moveMe << "  write_output_integer_register(" << RTDE_REGISTER_BASE << ", seq)\n";
+    handle_.moveMe << "  write_output_integer_register(" << (RTDE_REGISTER_BASE + 1) << ", " << rtdeSession_ << ")\n";
+    handle_.moveMe << "  while (True):\n";
+    handle_.moveMe << "    cmd = read_input_integer_register(" << RTDE_REGISTER_BASE << ")\n";
+    handle_.moveMe << "    if ((cmd != seq) and (read_input_integer_register(" << (RTDE_REGISTER_BASE + 2)
+                   << ") == " << rtdeSession_ << ")):\n";
+    handle_.moveMe << "      seq = cmd\n";
+    handle_.moveMe << "      kind = read_input_integer_register(" << (RTDE_REGISTER_BASE + 1) << ")\n";
+    handle_.moveMe << "      v = read_input_float_register(" << (RTDE_REGISTER_BASE + 6) << ")\n";
+    handle_.moveMe << "      t = [";
+    for (r = 0; r < 6; ++r)
+    {
+      handle_.moveMe << (r > 0 ? ", " : "") << "read_input_float_register(" << (RTDE_REGISTER_BASE + r) << ")";
+    }
+    handle_.moveMe << "]\n";
+    handle_.moveMe << "      if (kind == " << RTDE_CMD_MOVEJ_POSE << "):\n";
+    handle_.moveMe << "        movej(p[t[0], t[1], t[2], t[3], t[4], t[5]], v=v)\n";
+    handle_.moveMe << "      elif (kind == " << RTDE_CMD_MOVEL_POSE << "):\n";
+    handle_.moveMe << "        movel(p[t[0], t[1], t[2], t[3], t[4], t[5]], v=v)\n";
+    handle_.moveMe << "      elif (kind == " << RTDE_CMD_MOVEJ_AXES << "):\n";
+    handle_.moveMe << "        movej(t, v=v)\n";
+    handle_.moveMe << "      end\n";
+    handle_.moveMe << "      write_output_integer_register(" << RTDE_REGISTER_BASE << ", seq)\n";
+    handle_.moveMe << "    end\n";
+    handle_.moveMe << "    sync()\n";
+    handle_.moveMe << "  end\n";
+    handle_.moveMe << "end\n";
+    ulapi_mutex_give(handle_.handle);
+
+    if (!send())
+    {
+      return false;
+    }
+
+    //! Wait for the program to report our session token
+    tim = ulapi_time();
+    while ((ulapi_time() - tim) < UR_RESIDENT_TIMEOUT)
+    {
+      ulapi_mutex_take(handle_.handle);
+      session = handle_.rtdeSession;
+      ulapi_mutex_give(handle_.handle);
+      if (session == rtdeSession_)
+      {
+        residentRunning_ = true;
+        return true;
+      }
+      Sleep(2);
+    }
+    return false;
+  }
+
+
+  LIBRARY_API CanonReturn CrpiUniversal::rtdeMove (int kind, vector<double> &target)
+  {
+    double values[UR_RTDE_INPUT_COUNT];
+    bool inputs;
+    int ack = 0;
+    double tim;
+
+    ulapi_mutex_take(handle_.handle);
+    inputs = (handle_.rtde != NULL && handle_.rtdeInputs);
+    ulapi_mutex_give(handle_.handle);
+
+    if (!inputs || target.size() < 6)
+    {
+      return CANON_REJECT;
+    }
+
+    if (!residentRunning_ && !uploadResident())
+    {
+      return CANON_FAILURE;
+    }
+
+    //! Write the whole command in one input package so the program never sees a partial update
+    ++rtdeSeq_;
+    values[0] = rtdeSeq_;
+    values[1] = kind;
+    values[2] = rtdeSession_;
+    for (int i = 0; i < 6; ++i)
+    {
+      values[3 + i] = target.at(i);
+    }
+    values[9] = speed_;
+    if (!handle_.rtde->sendInputs(values, UR_RTDE_INPUT_COUNT))
+    {
+      return CANON_FAILURE;
+    }
+
+#ifdef BLOCKING_MOTION
+    //! The resident program acknowledges the command once the motion has completed
+    tim = ulapi_time();
+    while (true)
+    {
+      ulapi_mutex_take(handle_.handle);
+      ack = handle_.rtdeAck;
+      ulapi_mutex_give(handle_.handle);
+      if (ack == rtdeSeq_)
+      {
+        break;
+      }
+
+#ifdef USE_TIMEOUT
+      if ((ulapi_time() - tim) > timethresh)
+      {
+        return CANON_FAILURE;
+      }
+#endif
+      Sleep(2);
+    }
+#endif
+
+    return CANON_SUCCESS;
+  }
+
+
   LIBRARY_API bool CrpiUniversal::transformToMount(robotPose &in, robotPose &out, bool scale)
   {
     matrix pintemp(4,4), r(3,3), rtmp1(3,3);
@@ -23,6 +23,7 @@
 
 #include <vector>
 #include <sstream>
+#include <string.h>
 
 using namespace std;
 using namespace Math;
@@ -30,6 +31,96 @@ using namespace Math;
 
 namespace crpi_robot
 {
+  class RtdeClient;
+
+  //! @brief Decoded contents of one realtime (port 30003) state packet
+  //!
+  //! @note Fields are listed in wire order and carry the controller's units (m, rad, A, Nm, N,
+  //!       deg C, V).  Fields that are not part of the packet version received are left at zero.
+  //!
+  struct LIBRARY_API urRealtimeState
+  {
+    //! @brief Total packet length in bytes; identifies the packet version
+    //!
+    int messageSize;
+
+    //! @brief Time elapsed since the controller was started (s)
+    //!
+    double time;
+
+    //! @brief Target joint positions, velocities, accelerations, currents, and moments
+    //!
+    double qTarget[6];
+    double qdTarget[6];
+    double qddTarget[6];
+    double iTarget[6];
+    double mTarget[6];
+
+    //! @brief Actual joint positions, velocities, and currents, and joint control currents
+    //!
+    double qActual[6];
+    double qdActual[6];
+    double iActual[6];
+    double iControl[6];
+
+    //! @brief Actual TCP pose (axis-angle), TCP speed, and generalized forces at the TCP
+    //!
+    double toolVectorActual[6];
+    double tcpSpeedActual[6];
+    double tcpForce[6];
+
+    //! @brief Target TCP pose (axis-angle) and TCP speed
+    //!
+    double toolVectorTarget[6];
+    double tcpSpeedTarget[6];
+
+    //! @brief Digital input bit field
+    //!
+    double digitalInputs;
+
+    //! @brief Joint motor temperatures (deg C)
+    //!
+    double motorTemperatures[6];
+
+    double controllerTimer;
+    double testValue;
+    double robotMode;
+    double jointModes[6];
+
+    //! @brief Safety mode (1044-byte packets and later)
+    //!
+    double safetyMode;
+    double toolAccelerometer[3];
+    double speedScaling;
+    double linearMomentumNorm;
+    double vMain;
+    double vRobot;
+    double iRobot;
+    double vActual[6];
+
+    //! @brief Digital output bit field and program state (1060-byte packets and later)
+    //!
+    double digitalOutputs;
+    double programState;
+
+    //! @brief Elbow position and velocity (1108-byte packets and later)
+    //!
+    double elbowPosition[3];
+    double elbowVelocity[3];
+
+    //! @brief Safety status (1116-byte packets and later)
+    //!
+    double safetyStatus;
+
+    //! @brief Default constructor
+    //!
+    urRealtimeState()
+    {
+      memset(this, 0, sizeof(urRealtimeState));
+    }
+  };
+
+
   struct LIBRARY_API universalHandler
   {
     ulapi_mutex_struct *handle;
@@ -44,10 +135,47 @@ namespace crpi_robot
     robotAxes curAxes;
     robotPose curForces;
     robotPose curSpeeds;
+    robotAxes curJointSpeeds;
+    robotAxes curJointCurrents;
     robotIO curIO;
+    urRealtimeState curState;
     int curTool;
     double DIO;
 
+    //! @brief Number of realtime packets published to the state cache since start-up
+    //!
+    unsigned long feedbackCount;
+
+    //! @brief Time (in seconds, from ulapi_time) at which the most recent packet was published
+    //!
+    double feedbackTime;
+
+    //! @brief RTDE client used for feedback and motion in place of ports 30003/30002 (NULL if
+    //!        RTDE is not configured)
+    //!
+    RtdeClient *rtde;
+
+    //! @brief Whether or not the RTDE input registers driving the resident program are ours
+    //!
+    bool rtdeInputs;
+
+    //! @brief Sequence number of the last command completed by the resident program
+    //!
+    int rtdeAck;
+
+    //! @brief Session token reported by the running resident program
+    //!
+    int rtdeSession;
+
+    //! @brief Whether or not the feedback thread is still running (cleared by the thread on exit)
+    //!
+    bool running;
+
+    //! @brief Realtime (30003) connection held by the feedback thread, -1 if none.  Guarded by
+    //!        handle so the destructor can release a blocked read.
+    //!
+    ulapi_integer feedbackSocket;
+
     char robotIP[16];
   };
 
@@ -209,6 +337,9 @@ namespace crpi_robot
     //!
     //! @param torques Axis array to be populated by the method
     //!
+    //! @note The realtime interface does not report measured joint torques.  The actual joint
+    //!       motor currents (A) are returned instead as a torque-proportional measure.
+    //!
     //! @return SUCCESS if command is accepted and is executed successfully, REJECT if the command is
     //!         not accepted, and FAILURE if the command is accepted but not executed successfully
     //!
@@ -384,6 +515,10 @@ namespace crpi_robot
     void *task;
     unsigned long threadID_;
 
+    //! @brief Registration with the shared keepalive service
+    //!
+    int watchId_;
+
     bool connectRobot();
 
     universalHandler handle_;
@@ -471,6 +606,36 @@ namespace crpi_robot
     //!
     bool get ();
 
+    //! @brief Upload the resident program that executes setpoints written to the RTDE input
+    //!        registers, and wait for it to report in
+    //!
+    //! @return True if the resident program is running, false otherwise
+    //!
+    bool uploadResident ();
+
+    //! @brief Command a motion through the RTDE input registers
+    //!
+    //! @param kind   The command kind (RTDE_CMD_*)
+    //! @param target Six target values (m and rad, or rad for joint targets)
+    //!
+    //! @return SUCCESS if the motion completed, REJECT if the RTDE inputs are unavailable (use the
+    //!         script port instead), and FAILURE otherwise
+    //!
+    CanonReturn rtdeMove (int kind, vector<double> &target);
+
+    //! @brief Sequence number of the last command written to the RTDE input registers
+    //!
+    int rtdeSeq_;
+
+    //! @brief Session token identifying the resident program uploaded by this instance
+    //!
+    int rtdeSession_;
+
+    //! @brief Whether or not the resident program is believed to be running (any other program
+    //!        sent to the script port replaces it)
+    //!
+    bool residentRunning_;
+
     bool transformToMount(robotPose &in, robotPose &out, bool scale = true);
     bool transformFromMount(robotPose &in, robotPose &out, bool scale = true);
 
@@ -478,4 +643,4 @@ namespace crpi_robot
 
 } // namespace crpi_robot
 
-#endif
\ No newline at end of file
+#endif
\ No newline at end of file
@@ -0,0 +1,1159 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_universal_rtde.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Universal Robots Real-Time Data Exchange (RTDE, port 30004) client and
+//  loopback stand-in definitions.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_universal_rtde.h"
+#include <iostream>
+#include <stddef.h>
+#include <stdint.h>
+#include <stdlib.h>
+#include <string.h>
+
+//#define RTDE_NOISY
+
+using namespace std;
+
+namespace crpi_robot
+{
+  //! @brief Wire layout of one RTDE type
+  //!
+  struct rtdeTypeInfo
+  {
+    //! @brief Type name as used in the recipe replies
+    //!
+    const char *name;
+
+    //! @brief Number of elements
+    //!
+    int count;
+
+    //! @brief Size of each element in bytes
+    //!
+    int size;
+
+    //! @brief Whether the elements are IEEE doubles (true) or integers (false)
+    //!
+    bool real;
+  };
+
+  //! @brief Type layouts, indexed by RtdeType
+  //!
+  static const rtdeTypeInfo rtdeTypes[] =
+  {
+    { "NOT_FOUND", 0, 0, false },
+    { "BOOL", 1, 1, false },
+    { "UINT8", 1, 1, false },
+    { "UINT32", 1, 4, false },
+    { "UINT64", 1, 8, false },
+    { "INT32", 1, 4, false },
+    { "DOUBLE", 1, 8, true },
+    { "VECTOR3D", 3, 8, true },
+    { "VECTOR6D", 6, 8, true },
+    { "VECTOR6INT32", 6, 4, false },
+    { "VECTOR6UINT32", 6, 4, false }
+  };
+
+  static const int rtdeTypeCount = (int)(sizeof(rtdeTypes) / sizeof(rtdeTypeInfo));
+
+  //! @brief One RTDE output variable that maps onto urRealtimeState
+  //!
+  struct rtdeFieldMap
+  {
+    //! @brief RTDE variable name
+    //!
+    const char *name;
+
+    //! @brief Byte offset of the destination in urRealtimeState
+    //!
+    size_t offset;
+
+    //! @brief Type reported for the variable by the controller
+    //!
+    RtdeType type;
+  };
+
+#define RTDE_FIELD(name, field, type) { name, offsetof(urRealtimeState, field), type }
+
+  //! @brief RTDE output variables that have a counterpart in the realtime packet
+  //!
+  static const rtdeFieldMap rtdeFields[] =
+  {
+    RTDE_FIELD("timestamp", time, RTDE_DOUBLE),
+    RTDE_FIELD("target_q", qTarget, RTDE_VECTOR6D),
+    RTDE_FIELD("target_qd", qdTarget, RTDE_VECTOR6D),
+    RTDE_FIELD("target_qdd", qddTarget, RTDE_VECTOR6D),
+    RTDE_FIELD("target_current", iTarget, RTDE_VECTOR6D),
+    RTDE_FIELD("target_moment", mTarget, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_q", qActual, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_qd", qdActual, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_current", iActual, RTDE_VECTOR6D),
+    RTDE_FIELD("joint_control_output", iControl, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_TCP_pose", toolVectorActual, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_TCP_speed", tcpSpeedActual, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_TCP_force", tcpForce, RTDE_VECTOR6D),
+    RTDE_FIELD("target_TCP_pose", toolVectorTarget, RTDE_VECTOR6D),
+    RTDE_FIELD("target_TCP_speed", tcpSpeedTarget, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_digital_input_bits", digitalInputs, RTDE_UINT64),
+    RTDE_FIELD("joint_temperatures", motorTemperatures, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_execution_time", controllerTimer, RTDE_DOUBLE),
+    RTDE_FIELD("robot_mode", robotMode, RTDE_INT32),
+    RTDE_FIELD("joint_mode", jointModes, RTDE_VECTOR6INT32),
+    RTDE_FIELD("safety_mode", safetyMode, RTDE_INT32),
+    RTDE_FIELD("actual_tool_accelerometer", toolAccelerometer, RTDE_VECTOR3D),
+    RTDE_FIELD("speed_scaling", speedScaling, RTDE_DOUBLE),
+    RTDE_FIELD("actual_momentum", linearMomentumNorm, RTDE_DOUBLE),
+    RTDE_FIELD("actual_main_voltage", vMain, RTDE_DOUBLE),
+    RTDE_FIELD("actual_robot_voltage", vRobot, RTDE_DOUBLE),
+    RTDE_FIELD("actual_robot_current", iRobot, RTDE_DOUBLE),
+    RTDE_FIELD("actual_joint_voltage", vActual, RTDE_VECTOR6D),
+    RTDE_FIELD("actual_digital_output_bits", digitalOutputs, RTDE_UINT64),
+    RTDE_FIELD("runtime_state", programState, RTDE_UINT32),
+    RTDE_FIELD("elbow_position", elbowPosition, RTDE_VECTOR3D),
+    RTDE_FIELD("elbow_velocity", elbowVelocity, RTDE_VECTOR3D),
+    RTDE_FIELD("safety_status", safetyStatus, RTDE_INT32)
+  };
+
+  static const int rtdeFieldCount = (int)(sizeof(rtdeFields) / sizeof(rtdeFieldMap));
+
+
+  //! @brief Big-endian encoding helpers.  The RTDE wire format is big endian throughout.
+  //!
+  static uint64_t rtdeGet (const char *src, int size)
+  {
+    const unsigned char *b = (const unsigned char*)src;
+    uint64_t val = 0;
+    for (int i = 0; i < size; ++i)
+    {
+      val = (val << 8) | b[i];
+    }
+    return val;
+  }
+
+  static void rtdePut (char *dst, uint64_t val, int size)
+  {
+    for (int i = size - 1; i >= 0; --i)
+    {
+      dst[i] = (char)(val & 0xFF);
+      val >>= 8;
+    }
+  }
+
+  static double rtdeGetDouble (const char *src)
+  {
+    uint64_t raw = rtdeGet(src, 8);
+    double val;
+    memcpy(&val, &raw, sizeof(val));
+    return val;
+  }
+
+  static void rtdePutDouble (char *dst, double val)
+  {
+    uint64_t raw;
+    memcpy(&raw, &val, sizeof(raw));
+    rtdePut(dst, raw, 8);
+  }
+
+
+  //! @brief Decode one variable of the given type
+  //!
+  //! @param src  Pointer to the first byte of the value
+  //! @param type The wire type of the value
+  //! @param vals Destination for each element, converted to double (may be NULL to skip)
+  //!
+  //! @return The number of bytes consumed
+  //!
+  static int rtdeDecode (const char *src, RtdeType type, double *vals)
+  {
+    const rtdeTypeInfo &info = rtdeTypes[type];
+    uint64_t raw;
+
+    for (int i = 0; i < info.count; ++i, src += info.size)
+    {
+      if (vals == NULL)
+      {
+        continue;
+      }
+      if (info.real)
+      {
+        vals[i] = rtdeGetDouble(src);
+        continue;
+      }
+      raw = rtdeGet(src, info.size);
+      if (type == RTDE_INT32 || type == RTDE_VECTOR6INT32)
+      {
+        vals[i] = (double)(int32_t)(uint32_t)raw;
+      }
+      else
+      {
+        vals[i] = (double)raw;
+      }
+    }
+    return info.count * info.size;
+  }
+
+
+  //! @brief Encode one variable of the given type
+  //!
+  //! @param dst  Pointer to the first byte of the value
+  //! @param type The wire type of the value
+  //! @param vals The elements to encode (may be NULL to encode zeros)
+  //!
+  //! @return The number of bytes written
+  //!
+  static int rtdeEncode (char *dst, RtdeType type, const double *vals)
+  {
+    const rtdeTypeInfo &info = rtdeTypes[type];
+    double val;
+
+    for (int i = 0; i < info.count; ++i, dst += info.size)
+    {
+      val = (vals == NULL ? 0.0 : vals[i]);
+      if (info.real)
+      {
+        rtdePutDouble(dst, val);
+      }
+      else if (type == RTDE_INT32 || type == RTDE_VECTOR6INT32)
+      {
+        rtdePut(dst, (uint64_t)(uint32_t)(int32_t)val, info.size);
+      }
+      else
+      {
+        rtdePut(dst, (uint64_t)val, info.size);
+      }
+    }
+    return info.count * info.size;
+  }
+
+
+  //! @brief Look up where an RTDE variable is stored and its nominal type
+  //!
+  //! @param name The variable name
+  //! @param var  The variable description populated by this function
+  //!
+  //! @return True if the variable is known, false otherwise
+  //!
+  static bool rtdeLookup (const string &name, RtdeVariable &var)
+  {
+    static const char *registers[] = { "input_int_register_", "output_int_register_",
+                                       "input_double_register_", "output_double_register_" };
+    size_t len;
+
+    var.type = RTDE_UNKNOWN;
+    var.offset = RTDE_UNMAPPED;
+    var.reg = -1;
+    var.intReg = false;
+
+    for (int i = 0; i < 4; ++i)
+    {
+      len = strlen(registers[i]);
+      if (name.compare(0, len, registers[i]) == 0)
+      {
+        var.reg = atoi(name.c_str() + len);
+        if (var.reg < 0 || var.reg >= RTDE_REGISTERS)
+        {
+          return false;
+        }
+        var.intReg = (i < 2);
+        var.type = (var.intReg ? RTDE_INT32 : RTDE_DOUBLE);
+        return true;
+      }
+    }
+
+    for (int i = 0; i < rtdeFieldCount; ++i)
+    {
+      if (name == rtdeFields[i].name)
+      {
+        var.offset = rtdeFields[i].offset;
+        var.type = rtdeFields[i].type;
+        return true;
+      }
+    }
+    return false;
+  }
+
+
+  //! @brief Split a comma-separated list
+  //!
+  static void rtdeSplit (const char *list, int size, vector<string> &out)
+  {
+    string item;
+
+    out.clear();
+    for (int i = 0; i < size && list[i] != '\0'; ++i)
+    {
+      if (list[i] == ',')
+      {
+        out.push_back(item);
+        item.clear();
+      }
+      else
+      {
+        item += list[i];
+      }
+    }
+    out.push_back(item);
+  }
+
+
+  LIBRARY_API RtdeClient::RtdeClient () :
+    socket_(-1),
+    have_(0),
+    consumed_(0),
+    major_(0),
+    frequency_(0.0),
+    outputRecipe_(-1),
+    inputRecipe_(-1)
+  {
+    writeLock_ = ulapi_mutex_new(31);
+    buffer_ = new char[RTDE_BUFFER];
+    memset(intRegisters_, 0, sizeof(intRegisters_));
+    memset(doubleRegisters_, 0, sizeof(doubleRegisters_));
+  }
+
+
+  LIBRARY_API RtdeClient::~RtdeClient ()
+  {
+    disconnect();
+    ulapi_mutex_delete(writeLock_);
+    delete [] buffer_;
+  }
+
+
+  LIBRARY_API bool RtdeClient::connect (const char *addr, int port)
+  {
+    char version[2];
+    const char *reply;
+    int size;
+
+    disconnect();
+
+    ulapi_mutex_take(writeLock_);
+    socket_ = ulapi_socket_get_client_id(port, addr);
+    ulapi_mutex_give(writeLock_);
+    if (socket_ < 0)
+    {
+      return false;
+    }
+
+    //! Negotiate protocol version 2 (recipe IDs in data packages, per-recipe frequency)
+    rtdePut(version, RTDE_PROTOCOL_VERSION, 2);
+    if (!request(RTDE_REQUEST_PROTOCOL_VERSION, version, 2, reply, size) || size < 1 || reply[0] != 1)
+    {
+      disconnect();
+      return false;
+    }
+
+    //! The controller version decides the maximum output frequency
+    if (!request(RTDE_GET_URCONTROL_VERSION, NULL, 0, reply, size) || size < 16)
+    {
+      disconnect();
+      return false;
+    }
+    major_ = (int)rtdeGet(reply, 4);
+
+#ifdef RTDE_NOISY
+    cout << "RTDE connected to URControl " << major_ << "." << rtdeGet(reply + 4, 4) << endl;
+#endif
+    return true;
+  }
+
+
+  LIBRARY_API void RtdeClient::disconnect ()
+  {
+    ulapi_mutex_take(writeLock_);
+    if (socket_ >= 0)
+    {
+      ulapi_socket_close(socket_);
+    }
+    socket_ = -1;
+    inputRecipe_ = -1;
+    inputs_.clear();
+    ulapi_mutex_give(writeLock_);
+
+    have_ = consumed_ = 0;
+    outputRecipe_ = -1;
+    outputs_.clear();
+  }
+
+
+  LIBRARY_API void RtdeClient::release ()
+  {
+    ulapi_mutex_take(writeLock_);
+    if (socket_ >= 0)
+    {
+      SocketRelease(socket_);
+    }
+    ulapi_mutex_give(writeLock_);
+  }
+
+
+  LIBRARY_API bool RtdeClient::connected ()
+  {
+    return (socket_ >= 0);
+  }
+
+
+  LIBRARY_API int RtdeClient::controllerMajor ()
+  {
+    return major_;
+  }
+
+
+  LIBRARY_API double RtdeClient::frequency ()
+  {
+    return frequency_;
+  }
+
+
+  LIBRARY_API bool RtdeClient::setupOutputs (double frequency, const char *names)
+  {
+    char payload[RTDE_BUFFER];
+    const char *reply;
+    int size, length;
+    double limit;
+
+    //! e-Series controllers publish at up to 500 Hz, CB-Series at 125 Hz
+    limit = (major_ >= 5 ? 500.0 : 125.0);
+    frequency_ = ((frequency <= 0.0 || frequency > limit) ? limit : frequency);
+
+    length = (int)strlen(names);
+    if ((length + 8) > (RTDE_BUFFER - 3))
+    {
+      return false;
+    }
+    rtdePutDouble(payload, frequency_);
+    memcpy(payload + 8, names, length);
+
+    if (!request(RTDE_CONTROL_PACKAGE_SETUP_OUTPUTS, payload, length + 8, reply, size) || size < 1)
+    {
+      return false;
+    }
+
+    outputRecipe_ = (unsigned char)reply[0];
+    return parseRecipe(names, reply + 1, size - 1, outputs_);
+  }
+
+
+  LIBRARY_API bool RtdeClient::setupInputs (const char *names)
+  {
+    const char *reply;
+    int size, recipe;
+    vector<RtdeVariable> inputs;
+
+    if (!request(RTDE_CONTROL_PACKAGE_SETUP_INPUTS, names, (int)strlen(names), reply, size) || size < 1)
+    {
+      return false;
+    }
+
+    //! A recipe ID of 0 means the setup was rejected
+    recipe = (unsigned char)reply[0];
+    if (recipe == 0 || !parseRecipe(names, reply + 1, size - 1, inputs))
+    {
+      recipe = -1;
+      inputs.clear();
+    }
+
+    //! sendInputs() reads the input recipe from other threads
+    ulapi_mutex_take(writeLock_);
+    inputRecipe_ = recipe;
+    inputs_ = inputs;
+    ulapi_mutex_give(writeLock_);
+    return (recipe >= 0);
+  }
+
+
+  LIBRARY_API bool RtdeClient::start ()
+  {
+    const char *reply;
+    int size;
+
+    return (request(RTDE_CONTROL_PACKAGE_START, NULL, 0, reply, size) && size >= 1 && reply[0] == 1);
+  }
+
+
+  LIBRARY_API bool RtdeClient::pause ()
+  {
+    const char *reply;
+    int size;
+
+    return (request(RTDE_CONTROL_PACKAGE_PAUSE, NULL, 0, reply, size) && size >= 1 && reply[0] == 1);
+  }
+
+
+  LIBRARY_API bool RtdeClient::receive (urRealtimeState &state)
+  {
+    unsigned char type;
+    const char *payload;
+    const char *end;
+    char *dst = (char*)&state;
+    double vals[6];
+    vector<RtdeVariable>::const_iterator iter;
+    int size;
+
+    while (readPackage(type, payload, size))
+    {
+      if (type != RTDE_DATA_PACKAGE || size < 1 || (unsigned char)payload[0] != outputRecipe_)
+      {
+        //! Late reply or a package for another recipe
+        continue;
+      }
+
+      end = payload + size;
+      ++payload;
+      for (iter = outputs_.begin(); iter != outputs_.end(); ++iter)
+      {
+        if ((payload + rtdeTypes[iter->type].count * rtdeTypes[iter->type].size) > end)
+        {
+          //! Truncated package
+          return false;
+        }
+
+        if (iter->reg >= 0)
+        {
+          payload += rtdeDecode(payload, iter->type, vals);
+          if (iter->intReg)
+          {
+            intRegisters_[iter->reg] = (int)vals[0];
+          }
+          else
+          {
+            doubleRegisters_[iter->reg] = vals[0];
+          }
+        }
+        else if (iter->offset != RTDE_UNMAPPED)
+        {
+          //! Decode straight into the state structure
+          payload += rtdeDecode(payload, iter->type, (double*)(dst + iter->offset));
+        }
+        else
+        {
+          payload += rtdeDecode(payload, iter->type, NULL);
+        }
+      }
+      return true;
+    }
+
+    return false;
+  }
+
+
+  LIBRARY_API bool RtdeClient::sendInputs (const double *values, int count)
+  {
+    char payload[RTDE_BUFFER];
+    int size = 1;
+    bool valid;
+
+    //! The recipe is cleared by disconnect() on the feedback thread, so encode under the lock
+    ulapi_mutex_take(writeLock_);
+    valid = (inputRecipe_ >= 0 && count == (int)inputs_.size());
+    if (valid)
+    {
+      payload[0] = (char)inputRecipe_;
+      for (int i = 0; i < count; ++i)
+      {
+        if ((size + 48) > (RTDE_BUFFER - 3))
+        {
+          valid = false;
+          break;
+        }
+        size += rtdeEncode(payload + size, inputs_.at(i).type, &values[i]);
+      }
+    }
+    ulapi_mutex_give(writeLock_);
+
+    //! sendPackage() fails cleanly if the connection was closed in between
+    return (valid && sendPackage(RTDE_DATA_PACKAGE, payload, size));
+  }
+
+
+  LIBRARY_API int RtdeClient::intRegister (int reg)
+  {
+    return ((reg >= 0 && reg < RTDE_REGISTERS) ? intRegisters_[reg] : 0);
+  }
+
+
+  LIBRARY_API double RtdeClient::doubleRegister (int reg)
+  {
+    return ((reg >= 0 && reg < RTDE_REGISTERS) ? doubleRegisters_[reg] : 0.0);
+  }
+
+
+  LIBRARY_API bool RtdeClient::sendPackage (unsigned char type, const char *payload, int size)
+  {
+    char package[RTDE_BUFFER];
+    int sent = -1;
+
+    if ((size + 3) > RTDE_BUFFER)
+    {
+      return false;
+    }
+
+    rtdePut(package, (uint64_t)(size + 3), 2);
+    package[2] = (char)type;
+    if (size > 0)
+    {
+      memcpy(package + 3, payload, size);
+    }
+
+    ulapi_mutex_take(writeLock_);
+    if (socket_ >= 0)
+    {
+      sent = ulapi_socket_write(socket_, package, size + 3);
+    }
+    ulapi_mutex_give(writeLock_);
+
+    return (sent == (size + 3));
+  }
+
+
+  LIBRARY_API bool RtdeClient::readPackage (unsigned char &type, const char *&payload, int &size)
+  {
+    int get, length;
+
+    while (socket_ >= 0)
+    {
+      //! Drop the package handed out by the previous call
+      if (consumed_ > 0)
+      {
+        have_ -= consumed_;
+        memmove(buffer_, buffer_ + consumed_, have_);
+        consumed_ = 0;
+      }
+
+      length = (have_ >= 3 ? (int)rtdeGet(buffer_, 2) : 0);
+      if (have_ >= 3 && (length < 3 || length > RTDE_BUFFER))
+      {
+        //! Lost framing
+        return false;
+      }
+
+      if (have_ < 3 || have_ < length)
+      {
+        get = ulapi_socket_read(socket_, buffer_ + have_, RTDE_BUFFER - have_);
+        if (get <= 0)
+        {
+          //! Connection closed or broken
+          return false;
+        }
+        have_ += get;
+        continue;
+      }
+
+      consumed_ = length;
+      type = (unsigned char)buffer_[2];
+      if (type == RTDE_TEXT_MESSAGE)
+      {
+#ifdef RTDE_NOISY
+        cout << "RTDE message: " << string(buffer_ + 4, (size_t)(length > 4 ? length - 4 : 0)) << endl;
+#endif
+        continue;
+      }
+
+      payload = buffer_ + 3;
+      size = length - 3;
+      return true;
+    }
+
+    return false;
+  }
+
+
+  LIBRARY_API bool RtdeClient::request (unsigned char type, const char *payload, int size, const char *&reply, int &replySize)
+  {
+    unsigned char got;
+
+    if (!sendPackage(type, payload, size))
+    {
+      return false;
+    }
+
+    while (readPackage(got, reply, replySize))
+    {
+      if (got == type)
+      {
+        return true;
+      }
+      //! Data packages still in flight (e.g., while pausing) are dropped
+    }
+    return false;
+  }
+
+
+  LIBRARY_API bool RtdeClient::parseRecipe (const char *names, const char *types, int typesSize, vector<RtdeVariable> &recipe)
+  {
+    vector<string> nameList, typeList;
+    RtdeVariable var;
+    int t;
+
+    rtdeSplit(names, (int)strlen(names), nameList);
+    rtdeSplit(types, typesSize, typeList);
+    recipe.clear();
+
+    if (nameList.size() != typeList.size())
+    {
+      return false;
+    }
+
+    for (size_t i = 0; i < nameList.size(); ++i)
+    {
+      for (t = 1; t < rtdeTypeCount; ++t)
+      {
+        if (typeList.at(i) == rtdeTypes[t].name)
+        {
+          break;
+        }
+      }
+      if (t == rtdeTypeCount)
+      {
+        //! NOT_FOUND or IN_USE
+#ifdef RTDE_NOISY
+        cout << "RTDE variable " << nameList.at(i) << ": " << typeList.at(i) << endl;
+#endif
+        recipe.clear();
+        return false;
+      }
+
+      //! Variables we have no place for are still decoded (and skipped) by their wire type
+      rtdeLookup(nameList.at(i), var);
+      var.type = (RtdeType)t;
+      recipe.push_back(var);
+    }
+    return true;
+  }
+
+
+  void rtdeStandInThread (void *param)
+  {
+    ((RtdeStandIn*)param)->serve();
+  }
+
+
+  void rtdeScriptThread (void *param)
+  {
+    ((RtdeStandIn*)param)->drainScripts();
+  }
+
+
+  LIBRARY_API RtdeStandIn::RtdeStandIn (int port, int scriptPort, int major) :
+    port_(port),
+    scriptPort_(scriptPort),
+    major_(major),
+    runThread_(true),
+    server_(-1),
+    scriptServer_(-1),
+    scriptClient_(-1),
+    frequency_(125.0),
+    streaming_(false),
+    sent_(0),
+    done_(0)
+  {
+    memset(intIn_, 0, sizeof(intIn_));
+    memset(doubleIn_, 0, sizeof(doubleIn_));
+    memset(intOut_, 0, sizeof(intOut_));
+    memset(doubleOut_, 0, sizeof(doubleOut_));
+
+    lock_ = ulapi_mutex_new(33);
+    server_ = ulapi_socket_get_server_id(port_);
+    task_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)task_, rtdeStandInThread, this, ulapi_prio_lowest(), 0);
+
+    scriptTask_ = NULL;
+    if (scriptPort_ > 0)
+    {
+      scriptServer_ = ulapi_socket_get_server_id(scriptPort_);
+      scriptTask_ = ulapi_task_new();
+      ulapi_task_start((ulapi_task_struct*)scriptTask_, rtdeScriptThread, this, ulapi_prio_lowest(), 0);
+    }
+  }
+
+
+  LIBRARY_API RtdeStandIn::~RtdeStandIn ()
+  {
+    runThread_ = false;
+
+    //! Release the threads from their accepts and the script reader from its client; the
+    //! RTDE client is polled, so serve() sees runThread_ within a millisecond
+    if (server_ >= 0)
+    {
+      SocketRelease(server_);
+    }
+    if (scriptServer_ >= 0)
+    {
+      SocketRelease(scriptServer_);
+    }
+    ulapi_mutex_take(lock_);
+    if (scriptClient_ >= 0)
+    {
+      SocketRelease(scriptClient_);
+    }
+    ulapi_mutex_give(lock_);
+
+    ulapi_task_join((ulapi_task_struct*)task_, NULL);
+    ulapi_task_delete((ulapi_task_struct*)task_);
+    if (scriptTask_ != NULL)
+    {
+      ulapi_task_join((ulapi_task_struct*)scriptTask_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)scriptTask_);
+    }
+
+    if (server_ >= 0)
+    {
+      ulapi_socket_close(server_);
+    }
+    if (scriptServer_ >= 0)
+    {
+      ulapi_socket_close(scriptServer_);
+    }
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API void RtdeStandIn::setState (urRealtimeState &state)
+  {
+    ulapi_mutex_take(lock_);
+    state_ = state;
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API void RtdeStandIn::getState (urRealtimeState &state)
+  {
+    ulapi_mutex_take(lock_);
+    state = state_;
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API unsigned long RtdeStandIn::packagesSent ()
+  {
+    return sent_;
+  }
+
+
+  LIBRARY_API unsigned long RtdeStandIn::commandsDone ()
+  {
+    return done_;
+  }
+
+
+  LIBRARY_API void RtdeStandIn::serve ()
+  {
+    ulapi_integer client;
+    char *buffer = new char[RTDE_BUFFER];
+    int have, get, length;
+    double next, now;
+
+    while (runThread_ && server_ >= 0)
+    {
+      client = ulapi_socket_get_connection_id(server_);
+      if (client < 0)
+      {
+        Sleep(100);
+        continue;
+      }
+
+      //! Poll the client so that requests and the output stream share this thread
+      ulapi_socket_set_nonblocking(client);
+      ulapi_mutex_take(lock_);
+      streaming_ = false;
+      outputs_.clear();
+      inputs_.clear();
+      ulapi_mutex_give(lock_);
+      have = 0;
+      next = ulapi_time();
+
+      while (runThread_)
+      {
+        get = ulapi_socket_read(client, buffer + have, RTDE_BUFFER - have);
+        if (get == 0)
+        {
+          //! Client hung up
+          break;
+        }
+        if (get > 0)
+        {
+          have += get;
+        }
+
+        //! Handle every complete request
+        while (have >= 3)
+        {
+          length = (int)rtdeGet(buffer, 2);
+          if (length < 3 || length > RTDE_BUFFER)
+          {
+            have = -1;
+            break;
+          }
+          if (have < length)
+          {
+            break;
+          }
+          if (!handle(client, (unsigned char)buffer[2], buffer + 3, length - 3))
+          {
+            have = -1;
+            break;
+          }
+          have -= length;
+          memmove(buffer, buffer + length, have);
+        }
+        if (have < 0)
+        {
+          break;
+        }
+
+        now = ulapi_time();
+        if (streaming_ && now >= next)
+        {
+          if (!stream(client))
+          {
+            break;
+          }
+          next += (1.0 / frequency_);
+          if (next < now)
+          {
+            //! Fell behind; don't try to catch up with a burst
+            next = now + (1.0 / frequency_);
+          }
+        }
+        else
+        {
+          Sleep(1);
+        }
+      }
+
+      ulapi_socket_close(client);
+    }
+
+    delete [] buffer;
+  }
+
+
+  LIBRARY_API void RtdeStandIn::drainScripts ()
+  {
+    ulapi_integer client;
+    char buffer[1024];
+
+    while (runThread_ && scriptServer_ >= 0)
+    {
+      client = ulapi_socket_get_connection_id(scriptServer_);
+      if (client < 0)
+      {
+        Sleep(100);
+        continue;
+      }
+      ulapi_mutex_take(lock_);
+      scriptClient_ = client;
+      ulapi_mutex_give(lock_);
+
+      while (runThread_ && ulapi_socket_read(client, buffer, sizeof(buffer)) > 0)
+      {
+        //! Programs are accepted but not run; the resident program is emulated by serve()
+      }
+
+      ulapi_mutex_take(lock_);
+      scriptClient_ = -1;
+      ulapi_mutex_give(lock_);
+      ulapi_socket_close(client);
+    }
+  }
+
+
+  LIBRARY_API bool RtdeStandIn::handle (ulapi_integer client, unsigned char type, const char *payload, int size)
+  {
+    char reply[RTDE_BUFFER];
+    int length = 0;
+    vector<string> names;
+    vector<RtdeVariable> *recipe;
+    RtdeVariable var;
+    string types;
+    double limit;
+
+    switch (type)
+    {
+    case RTDE_REQUEST_PROTOCOL_VERSION:
+      reply[length++] = (char)((size >= 2 && rtdeGet(payload, 2) == RTDE_PROTOCOL_VERSION) ? 1 : 0);
+      break;
+    case RTDE_GET_URCONTROL_VERSION:
+      rtdePut(reply, (uint64_t)major_, 4);
+      rtdePut(reply + 4, 0, 4);
+      rtdePut(reply + 8, 0, 4);
+      rtdePut(reply + 12, 0, 4);
+      length = 16;
+      break;
+    case RTDE_CONTROL_PACKAGE_SETUP_OUTPUTS:
+    case RTDE_CONTROL_PACKAGE_SETUP_INPUTS:
+      if (type == RTDE_CONTROL_PACKAGE_SETUP_OUTPUTS)
+      {
+        if (size < 8)
+        {
+          return false;
+        }
+        limit = (major_ >= 5 ? 500.0 : 125.0);
+        frequency_ = rtdeGetDouble(payload);
+        frequency_ = ((frequency_ <= 0.0 || frequency_ > limit) ? limit : frequency_);
+        payload += 8;
+        size -= 8;
+      }
+      rtdeSplit(payload, size, names);
+
+      ulapi_mutex_take(lock_);
+      recipe = (type == RTDE_CONTROL_PACKAGE_SETUP_OUTPUTS ? &outputs_ : &inputs_);
+      recipe->clear();
+      for (size_t i = 0; i < names.size(); ++i)
+      {
+        types += (i > 0 ? "," : "");
+        if (rtdeLookup(names.at(i), var))
+        {
+          types += rtdeTypes[var.type].name;
+        }
+        else
+        {
+          types += "NOT_FOUND";
+        }
+        recipe->push_back(var);
+      }
+      ulapi_mutex_give(lock_);
+
+      //! Recipe 1 is the output recipe, recipe 2 the input recipe
+      reply[length++] = (char)(type == RTDE_CONTROL_PACKAGE_SETUP_OUTPUTS ? 1 : 2);
+      if ((types.size() + 1) > sizeof(reply))
+      {
+        return false;
+      }
+      memcpy(reply + length, types.c_str(), types.size());
+      length += (int)types.size();
+      break;
+    case RTDE_CONTROL_PACKAGE_START:
+      streaming_ = !outputs_.empty();
+      reply[length++] = (char)(streaming_ ? 1 : 0);
+      break;
+    case RTDE_CONTROL_PACKAGE_PAUSE:
+      streaming_ = false;
+      reply[length++] = 1;
+      break;
+    case RTDE_DATA_PACKAGE:
+      if (size >= 1 && payload[0] == 2)
+      {
+        applyInputs(payload + 1, size - 1);
+      }
+      //! Data packages are not acknowledged
+      return true;
+    default:
+      //! Unknown request
+      return true;
+    }
+
+    //! Send the reply
+    char package[RTDE_BUFFER];
+    rtdePut(package, (uint64_t)(length + 3), 2);
+    package[2] = (char)type;
+    memcpy(package + 3, reply, length);
+    return (ulapi_socket_write(client, package, length + 3) == (length + 3));
+  }
+
+
+  LIBRARY_API void RtdeStandIn::applyInputs (const char *payload, int size)
+  {
+    const char *end = payload + size;
+    vector<RtdeVariable>::const_iterator iter;
+    double vals[6];
+    int seq;
+
+    ulapi_mutex_take(lock_);
+    for (iter = inputs_.begin(); iter != inputs_.end(); ++iter)
+    {
+      if ((payload + rtdeTypes[iter->type].count * rtdeTypes[iter->type].size) > end)
+      {
+        break;
+      }
+      payload += rtdeDecode(payload, iter->type, vals);
+      if (iter->reg >= 0 && iter->intReg)
+      {
+        intIn_[iter->reg] = (int)vals[0];
+      }
+      else if (iter->reg >= 0)
+      {
+        doubleIn_[iter->reg] = vals[0];
+      }
+    }
+
+    //! Emulate the resident CRPI program.  Motion is instantaneous:  the targets (and actual
+    //! values) jump to the commanded setpoint and the command is acknowledged right away.
+    intOut_[RTDE_REGISTER_BASE + 1] = intIn_[RTDE_REGISTER_BASE + 2];
+    seq = intIn_[RTDE_REGISTER_BASE];
+    if (seq != intOut_[RTDE_REGISTER_BASE])
+    {
+      switch (intIn_[RTDE_REGISTER_BASE + 1])
+      {
+      case RTDE_CMD_MOVEJ_POSE:
+      case RTDE_CMD_MOVEL_POSE:
+        memcpy(state_.toolVectorTarget, &doubleIn_[RTDE_REGISTER_BASE], 6 * sizeof(double));
+        memcpy(state_.toolVectorActual, &doubleIn_[RTDE_REGISTER_BASE], 6 * sizeof(double));
+        break;
+      case RTDE_CMD_MOVEJ_AXES:
+        memcpy(state_.qTarget, &doubleIn_[RTDE_REGISTER_BASE], 6 * sizeof(double));
+        memcpy(state_.qActual, &doubleIn_[RTDE_REGISTER_BASE], 6 * sizeof(double));
+        break;
+      default:
+        break;
+      }
+      intOut_[RTDE_REGISTER_BASE] = seq;
+      ++done_;
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API bool RtdeStandIn::stream (ulapi_integer client)
+  {
+    char package[RTDE_BUFFER];
+    vector<RtdeVariable>::const_iterator iter;
+    const char *src;
+    double val;
+    int length = 4;
+
+    ulapi_mutex_take(lock_);
+    state_.time += (1.0 / frequency_);
+    src = (const char*)&state_;
+    package[2] = RTDE_DATA_PACKAGE;
+    package[3] = 1;
+    for (iter = outputs_.begin(); iter != outputs_.end(); ++iter)
+    {
+      if ((length + 48) > RTDE_BUFFER)
+      {
+        break;
+      }
+      if (iter->reg >= 0)
+      {
+        val = (iter->intReg ? (double)intOut_[iter->reg] : doubleOut_[iter->reg]);
+        length += rtdeEncode(package + length, iter->type, &val);
+      }
+      else
+      {
+        length += rtdeEncode(package + length, iter->type,
+                             (iter->offset == RTDE_UNMAPPED ? NULL : (const double*)(src + iter->offset)));
+      }
+    }
+    ulapi_mutex_give(lock_);
+
+    rtdePut(package, (uint64_t)length, 2);
+    if (ulapi_socket_write(client, package, length) != length)
+    {
+      return false;
+    }
+    ++sent_;
+    return true;
+  }
+
+} // crpi_robot
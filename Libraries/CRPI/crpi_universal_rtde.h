@@ -0,0 +1,325 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_universal_rtde.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Universal Robots Real-Time Data Exchange (RTDE, port 30004) client and
+//  loopback stand-in declarations.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef UNIVERSAL_ROBOT_RTDE
+#define UNIVERSAL_ROBOT_RTDE
+
+#include "ulapi.h"
+#include "crpi_universal.h"
+
+#pragma warning (disable: 4251)
+
+#include <vector>
+#include <string>
+
+using namespace std;
+
+//! RTDE package types
+#define RTDE_REQUEST_PROTOCOL_VERSION 86      //! 'V'
+#define RTDE_GET_URCONTROL_VERSION 118        //! 'v'
+#define RTDE_TEXT_MESSAGE 77                  //! 'M'
+#define RTDE_DATA_PACKAGE 85                  //! 'U'
+#define RTDE_CONTROL_PACKAGE_SETUP_OUTPUTS 79 //! 'O'
+#define RTDE_CONTROL_PACKAGE_SETUP_INPUTS 73  //! 'I'
+#define RTDE_CONTROL_PACKAGE_START 83         //! 'S'
+#define RTDE_CONTROL_PACKAGE_PAUSE 80         //! 'P'
+
+#define RTDE_PROTOCOL_VERSION 2
+#define RTDE_BUFFER 4096
+#define RTDE_REGISTERS 48
+#define RTDE_UNMAPPED ((size_t)-1)
+
+//! Register block used by the resident CRPI program.  Registers 24-47 are reserved for external
+//! RTDE clients; 0-23 are left for fieldbus adapters.
+//!   input int    24:  command sequence number (a change triggers the command)
+//!   input int    25:  command kind (RTDE_CMD_*)
+//!   input int    26:  session token of the driver issuing the command
+//!   input double 24-29:  target pose (m, rad; axis-angle) or joint positions (rad)
+//!   input double 30:  speed (m/s or rad/s)
+//!   output int   24:  sequence number of the last completed command
+//!   output int   25:  session token of the running resident program
+#define RTDE_REGISTER_BASE 24
+#define RTDE_CMD_MOVEJ_POSE 1
+#define RTDE_CMD_MOVEL_POSE 2
+#define RTDE_CMD_MOVEJ_AXES 3
+
+namespace crpi_robot
+{
+  //! @brief Wire type of an RTDE recipe variable
+  //!
+  enum RtdeType
+  {
+    RTDE_UNKNOWN = 0,
+    RTDE_BOOL,
+    RTDE_UINT8,
+    RTDE_UINT32,
+    RTDE_UINT64,
+    RTDE_INT32,
+    RTDE_DOUBLE,
+    RTDE_VECTOR3D,
+    RTDE_VECTOR6D,
+    RTDE_VECTOR6INT32,
+    RTDE_VECTOR6UINT32
+  };
+
+  //! @brief One negotiated recipe variable and where its value is stored
+  //!
+  struct LIBRARY_API RtdeVariable
+  {
+    //! @brief Variable wire type as reported by the controller
+    //!
+    RtdeType type;
+
+    //! @brief Byte offset of the destination in urRealtimeState (RTDE_UNMAPPED if none)
+    //!
+    size_t offset;
+
+    //! @brief Register number for input/output register variables (-1 otherwise)
+    //!
+    int reg;
+
+    //! @brief Whether reg refers to an integer (true) or a double (false) register
+    //!
+    bool intReg;
+  };
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Client side of the RTDE protocol (version 2)
+  //!
+  //! @note The handshake, receive() and disconnect() must be called from a single (feedback)
+  //!       thread.  sendInputs() and release() may also be called from other threads; the
+  //!       input recipe and the socket are guarded by the write lock.
+  //!
+  class LIBRARY_API RtdeClient
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    RtdeClient ();
+
+    //! @brief Default destructor
+    //!
+    ~RtdeClient ();
+
+    //! @brief Connect to the RTDE server and negotiate the protocol version
+    //!
+    //! @param addr The IP address of the robot controller
+    //! @param port The RTDE port (30004)
+    //!
+    //! @return True if the connection was made and protocol version 2 was accepted
+    //!
+    bool connect (const char *addr, int port);
+
+    //! @brief Close the connection to the RTDE server
+    //!
+    void disconnect ();
+
+    //! @brief Shut down the connection without closing it, waking a blocked receive()
+    //!
+    void release ();
+
+    //! @brief Whether or not the client is currently connected
+    //!
+    bool connected ();
+
+    //! @brief Major version of the controller software (e.g. 5 for e-Series)
+    //!
+    int controllerMajor ();
+
+    //! @brief Subscribe to a set of output variables
+    //!
+    //! @param frequency The requested update rate in Hz.  It is limited to 500 Hz on e-Series
+    //!                  controllers and 125 Hz on CB-Series controllers.
+    //! @param names     Comma-separated list of output variable names
+    //!
+    //! @return True if every variable was found, false otherwise
+    //!
+    bool setupOutputs (double frequency, const char *names);
+
+    //! @brief Claim a set of input variables
+    //!
+    //! @param names Comma-separated list of input variable names
+    //!
+    //! @return True if every variable was found and available, false otherwise
+    //!
+    bool setupInputs (const char *names);
+
+    //! @brief Start the output data stream
+    //!
+    bool start ();
+
+    //! @brief Pause the output data stream
+    //!
+    bool pause ();
+
+    //! @brief Block until the next output data package arrives and decode it
+    //!
+    //! @param state The structure updated with the subscribed fields; other fields are not
+    //!              touched
+    //!
+    //! @return True if a data package was decoded, false if the connection was lost
+    //!
+    bool receive (urRealtimeState &state);
+
+    //! @brief Send one input data package
+    //!
+    //! @param values One value per input variable, in recipe order.  Integer variables are
+    //!               truncated from the double value.
+    //! @param count  The number of values
+    //!
+    //! @return True if the package was sent, false otherwise
+    //!
+    bool sendInputs (const double *values, int count);
+
+    //! @brief Last received value of output_int_register_N
+    //!
+    int intRegister (int reg);
+
+    //! @brief Last received value of output_double_register_N
+    //!
+    double doubleRegister (int reg);
+
+    //! @brief Actual output frequency agreed with the controller (Hz)
+    //!
+    double frequency ();
+
+  private:
+    //! @brief Send one framed package
+    //!
+    bool sendPackage (unsigned char type, const char *payload, int size);
+
+    //! @brief Block until the next package other than a text message arrives
+    //!
+    //! @param type    The type of the package received
+    //! @param payload Set to the payload inside the receive buffer (valid until the next call)
+    //! @param size    The size of the payload in bytes
+    //!
+    bool readPackage (unsigned char &type, const char *&payload, int &size);
+
+    //! @brief Send a request and wait for the reply of the same type
+    //!
+    bool request (unsigned char type, const char *payload, int size, const char *&reply, int &replySize);
+
+    //! @brief Fill a recipe from the comma-separated names and types
+    //!
+    bool parseRecipe (const char *names, const char *types, int typesSize, vector<RtdeVariable> &recipe);
+
+    ulapi_integer socket_;
+    ulapi_mutex_struct *writeLock_;
+    char *buffer_;
+    int have_;
+    int consumed_;
+    int major_;
+    double frequency_;
+    int outputRecipe_;
+    int inputRecipe_;
+    vector<RtdeVariable> outputs_;
+    vector<RtdeVariable> inputs_;
+    int intRegisters_[RTDE_REGISTERS];
+    double doubleRegisters_[RTDE_REGISTERS];
+  }; // RtdeClient
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Loopback RTDE server standing in for a UR controller
+  //!
+  //! @note Serves one RTDE client at a time, streams the state set with setState() at the
+  //!       negotiated rate, and emulates the resident CRPI program:  the session token in input
+  //!       int register 26 is echoed to output int register 25, and a new sequence number in
+  //!       input int register 24 moves the targets and is acknowledged in output int register
+  //!       24.  An optional script port accepts and discards URScript programs.
+  //!
+  class LIBRARY_API RtdeStandIn
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    //! @param port       The RTDE port to listen on
+    //! @param scriptPort The script port to listen on (0 for none)
+    //! @param major      The controller major version to report (5 for e-Series)
+    //!
+    RtdeStandIn (int port, int scriptPort = 0, int major = 5);
+
+    //! @brief Default destructor
+    //!
+    ~RtdeStandIn ();
+
+    //! @brief Replace the state reported to clients
+    //!
+    void setState (urRealtimeState &state);
+
+    //! @brief Copy the state currently reported to clients
+    //!
+    void getState (urRealtimeState &state);
+
+    //! @brief Number of data packages streamed since construction
+    //!
+    unsigned long packagesSent ();
+
+    //! @brief Number of commands acknowledged since construction
+    //!
+    unsigned long commandsDone ();
+
+    //! @brief Serve RTDE clients (thread body)
+    //!
+    void serve ();
+
+    //! @brief Accept and discard URScript programs (thread body)
+    //!
+    void drainScripts ();
+
+    int port_;
+    int scriptPort_;
+    int major_;
+    bool runThread_;
+
+  private:
+    //! @brief Handle one request package from the client
+    //!
+    bool handle (ulapi_integer client, unsigned char type, const char *payload, int size);
+
+    //! @brief Apply an input data package to the emulated resident program
+    //!
+    void applyInputs (const char *payload, int size);
+
+    //! @brief Encode and send one output data package
+    //!
+    bool stream (ulapi_integer client);
+
+    ulapi_mutex_struct *lock_;
+    void *task_;
+    void *scriptTask_;
+    ulapi_integer server_;
+    ulapi_integer scriptServer_;
+    ulapi_integer scriptClient_;
+    urRealtimeState state_;
+    double frequency_;
+    bool streaming_;
+    vector<RtdeVariable> outputs_;
+    vector<RtdeVariable> inputs_;
+    int intIn_[RTDE_REGISTERS];
+    double doubleIn_[RTDE_REGISTERS];
+    int intOut_[RTDE_REGISTERS];
+    double doubleOut_[RTDE_REGISTERS];
+    unsigned long sent_;
+    unsigned long done_;
+  }; // RtdeStandIn
+
+} // crpi_robot
+
+#endif
@@ -0,0 +1,349 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_watchdog.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Process-wide keepalive and watchdog service shared by the CRPI robot
+//  drivers.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_watchdog.h"
+#include <string.h>
+
+using namespace std;
+
+namespace crpi_robot
+{
+  void watchdogThread (void *param)
+  {
+    ((CrpiWatchdog*)param)->run();
+  }
+
+
+  LIBRARY_API CrpiWatchdog &CrpiWatchdog::instance ()
+  {
+    static CrpiWatchdog watchdog;
+    return watchdog;
+  }
+
+
+  LIBRARY_API CrpiWatchdog::CrpiWatchdog () :
+    task_(NULL),
+    running_(false),
+    count_(0),
+    firing_(-1),
+    tick_(0)
+  {
+    int i;
+
+    memset(devices_, 0, sizeof(devices_));
+    for (i = 0; i < WATCHDOG_SLOTS; ++i)
+    {
+      wheel_[i] = -1;
+    }
+    lock_ = ulapi_mutex_new(51);
+  }
+
+
+  LIBRARY_API CrpiWatchdog::~CrpiWatchdog ()
+  {
+    //! Drivers unregister from their destructors; anything left at exit is dropped so the thread
+    //! winds down on its next tick
+    ulapi_mutex_take(lock_);
+    for (int i = 0; i < WATCHDOG_DEVICES; ++i)
+    {
+      if (devices_[i].used)
+      {
+        unlink(i);
+        devices_[i].used = false;
+      }
+    }
+    count_ = 0;
+
+    //! Wait for the thread to notice, then release it
+    while (running_)
+    {
+      ulapi_mutex_give(lock_);
+      Sleep(WATCHDOG_TICK);
+      ulapi_mutex_take(lock_);
+    }
+    reap();
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API int CrpiWatchdog::add (const char *name, double period, crpiHeartbeat beat, void *data, double staleAfter)
+  {
+    int id;
+
+    if (beat == NULL || period <= 0.0)
+    {
+      return -1;
+    }
+
+    ulapi_mutex_take(lock_);
+    for (id = 0; id < WATCHDOG_DEVICES; ++id)
+    {
+      if (!devices_[id].used)
+      {
+        break;
+      }
+    }
+    if (id == WATCHDOG_DEVICES)
+    {
+      ulapi_mutex_give(lock_);
+      return -1;
+    }
+
+    memset(&devices_[id], 0, sizeof(device));
+    devices_[id].used = true;
+    devices_[id].beat = beat;
+    devices_[id].data = data;
+    devices_[id].period = period;
+    devices_[id].staleAfter = staleAfter;
+    devices_[id].metrics.healthy = true;
+    strncpy(devices_[id].metrics.name, (name == NULL ? "" : name), 31);
+    schedule(id, period);
+    ++count_;
+
+    if (!running_)
+    {
+      //! The previous thread, if any, has left its loop
+      reap();
+      running_ = true;
+      task_ = ulapi_task_new();
+      ulapi_task_start((ulapi_task_struct*)task_, watchdogThread, this, ulapi_prio_lowest(), 0);
+    }
+    ulapi_mutex_give(lock_);
+    return id;
+  }
+
+
+  LIBRARY_API void CrpiWatchdog::remove (int id)
+  {
+    if (id < 0 || id >= WATCHDOG_DEVICES)
+    {
+      return;
+    }
+
+    ulapi_mutex_take(lock_);
+    //! Let a heartbeat of this device finish before its data goes away
+    while (firing_ == id)
+    {
+      ulapi_mutex_give(lock_);
+      {
+        std::unique_lock<std::mutex> guard(firedLock_);
+        fired_.wait(guard, [this, id] { return firing_ != id; });
+      }
+      ulapi_mutex_take(lock_);
+    }
+    if (devices_[id].used)
+    {
+      unlink(id);
+      devices_[id].used = false;
+      --count_;
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+
+  LIBRARY_API bool CrpiWatchdog::liveness (int id, crpiLiveness &metrics)
+  {
+    bool ok = false;
+
+    if (id < 0 || id >= WATCHDOG_DEVICES)
+    {
+      return false;
+    }
+
+    ulapi_mutex_take(lock_);
+    if (devices_[id].used)
+    {
+      metrics = devices_[id].metrics;
+      ok = true;
+    }
+    ulapi_mutex_give(lock_);
+    return ok;
+  }
+
+
+  LIBRARY_API int CrpiWatchdog::snapshot (crpiLiveness *list, int max)
+  {
+    int i, count = 0;
+
+    ulapi_mutex_take(lock_);
+    for (i = 0; i < WATCHDOG_DEVICES && count < max; ++i)
+    {
+      if (devices_[i].used)
+      {
+        list[count++] = devices_[i].metrics;
+      }
+    }
+    ulapi_mutex_give(lock_);
+    return count;
+  }
+
+
+  LIBRARY_API void CrpiWatchdog::run ()
+  {
+    crpi_timer timer;
+    crpiHeartbeat beat;
+    void *data;
+    double start, feedbackTime, now;
+    bool healthy;
+    int due[WATCHDOG_DEVICES];
+    int count, id, i, *link;
+
+    while (true)
+    {
+      timer.waitUntil(WATCHDOG_TICK);
+
+      ulapi_mutex_take(lock_);
+      if (count_ == 0)
+      {
+        running_ = false;
+        ulapi_mutex_give(lock_);
+        break;
+      }
+
+      //! Take the devices in this slot that are due off the wheel; the rest wait for another
+      //! revolution
+      ++tick_;
+      count = 0;
+      link = &wheel_[tick_ % WATCHDOG_SLOTS];
+      while ((id = *link) >= 0)
+      {
+        if (devices_[id].rounds > 0)
+        {
+          --devices_[id].rounds;
+          link = &devices_[id].next;
+          continue;
+        }
+        *link = devices_[id].next;
+        devices_[id].slot = -2;
+        due[count++] = id;
+      }
+
+      for (i = 0; i < count; ++i)
+      {
+        id = due[i];
+        if (!devices_[id].used || devices_[id].slot != -2)
+        {
+          //! Removed (or removed and registered again) since it was taken off the wheel
+          continue;
+        }
+
+        //! Run the heartbeat without holding the lock
+        beat = devices_[id].beat;
+        data = devices_[id].data;
+        setFiring(id);
+        ulapi_mutex_give(lock_);
+
+        feedbackTime = 0.0;
+        start = ulapi_time();
+        healthy = beat(data, feedbackTime);
+        now = ulapi_time();
+
+        ulapi_mutex_take(lock_);
+        setFiring(-1);
+        if (!devices_[id].used)
+        {
+          continue;
+        }
+
+        crpiLiveness &m = devices_[id].metrics;
+        ++m.beats;
+        m.healthy = healthy;
+        m.lastBeat = now;
+        if (healthy)
+        {
+          m.lastHealthy = now;
+        }
+        else
+        {
+          ++m.failures;
+        }
+        if (feedbackTime > m.lastFeedback)
+        {
+          m.lastFeedback = feedbackTime;
+        }
+        m.stale = (devices_[id].staleAfter > 0.0 && (now - m.lastFeedback) > devices_[id].staleAfter);
+        m.beatTime = now - start;
+        if (m.beatTime > m.beatTimeMax)
+        {
+          m.beatTimeMax = m.beatTime;
+        }
+        schedule(id, devices_[id].period);
+      }
+      ulapi_mutex_give(lock_);
+    }
+  }
+
+
+  LIBRARY_API void CrpiWatchdog::schedule (int id, double delay)
+  {
+    unsigned long ticks = (unsigned long)((delay * 1000.0) / WATCHDOG_TICK);
+    int slot;
+
+    if (ticks < 1)
+    {
+      ticks = 1;
+    }
+    slot = (int)((tick_ + ticks) % WATCHDOG_SLOTS);
+    devices_[id].rounds = (int)((ticks - 1) / WATCHDOG_SLOTS);
+    devices_[id].slot = slot;
+    devices_[id].next = wheel_[slot];
+    wheel_[slot] = id;
+  }
+
+
+  LIBRARY_API void CrpiWatchdog::unlink (int id)
+  {
+    int slot = devices_[id].slot;
+    int *link;
+
+    //! -1 is off the wheel, -2 is taken off the wheel and waiting to fire
+    if (slot < 0)
+    {
+      return;
+    }
+    for (link = &wheel_[slot]; *link >= 0; link = &devices_[*link].next)
+    {
+      if (*link == id)
+      {
+        *link = devices_[id].next;
+        break;
+      }
+    }
+    devices_[id].slot = -1;
+  }
+
+
+  LIBRARY_API void CrpiWatchdog::setFiring (int id)
+  {
+    {
+      std::lock_guard<std::mutex> guard(firedLock_);
+      firing_ = id;
+    }
+    fired_.notify_all();
+  }
+
+
+  LIBRARY_API void CrpiWatchdog::reap ()
+  {
+    //! The thread gives up the lock for good once it clears running_, so it can be joined here
+    if (task_ != NULL && !running_)
+    {
+      ulapi_task_join((ulapi_task_struct*)task_, NULL);
+      ulapi_task_delete((ulapi_task_struct*)task_);
+      task_ = NULL;
+    }
+  }
+
+} // crpi_robot
@@ -0,0 +1,192 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_watchdog.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Process-wide keepalive and watchdog service shared by the CRPI robot
+//  drivers.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_WATCHDOG_H
+#define CRPI_WATCHDOG_H
+
+#include "crpi.h"
+#include "ulapi.h"
+
+#pragma warning (disable: 4251)
+
+#define WATCHDOG_DEVICES 64         //! Devices that may be registered at once
+#define WATCHDOG_TICK 50            //! Timer wheel resolution (ms)
+#define WATCHDOG_SLOTS 128          //! Timer wheel size (one revolution is 6.4 s)
+#define WATCHDOG_PERIOD 5.0         //! Default heartbeat period (s)
+
+namespace crpi_robot
+{
+  //! @brief Heartbeat callback, invoked on the watchdog thread
+  //!
+  //! @param data         The pointer given at registration
+  //! @param feedbackTime Set to the time (from ulapi_time) at which the device's most recent
+  //!                     feedback was received, if known (it is 0 on entry)
+  //!
+  //! @return True if the device is healthy (connected and answering), false otherwise
+  //!
+  //! @note Every device is serviced from the same thread, so the callback must not wait on a
+  //!       channel that a command may hold (e.g. behind a motion); report the age of cached
+  //!       feedback instead.
+  //!
+  typedef bool (*crpiHeartbeat) (void *data, double &feedbackTime);
+
+
+  //! @brief Liveness metrics for one registered device
+  //!
+  struct LIBRARY_API crpiLiveness
+  {
+    //! @brief The name given at registration
+    //!
+    char name[32];
+
+    //! @brief Result of the most recent heartbeat, and whether the most recent feedback was older
+    //!        than the staleness limit when it was checked
+    //!
+    bool healthy, stale;
+
+    //! @brief Number of heartbeats run and number that reported the device unhealthy
+    //!
+    unsigned long beats, failures;
+
+    //! @brief Time (from ulapi_time) of the most recent heartbeat, of the most recent healthy
+    //!        heartbeat, and of the most recent feedback (0 if never)
+    //!
+    double lastBeat, lastHealthy, lastFeedback;
+
+    //! @brief Time (s) taken by the most recent heartbeat callback, and the longest so far
+    //!
+    double beatTime, beatTimeMax;
+  };
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Keepalive and watchdog service shared by every driver in the process
+  //!
+  //! @note One thread services every registered device from a hashed timer wheel, in place of a
+  //!       polling thread per driver.  Each device's heartbeat callback is run at its own period
+  //!       to send keepalive traffic and check the connection, and reports when the device last
+  //!       produced feedback so that stale feedback is flagged.  The thread starts with the first
+  //!       registration and exits when the last device is removed; it is joined when the next
+  //!       device is registered, or when the service is destroyed.
+  //!
+  class LIBRARY_API CrpiWatchdog
+  {
+  public:
+    //! @brief The process-wide instance
+    //!
+    static CrpiWatchdog &instance ();
+
+    //! @brief Register a device
+    //!
+    //! @param name       Name reported in the liveness metrics
+    //! @param period     Time between heartbeats (s)
+    //! @param beat       Heartbeat callback
+    //! @param data       Pointer passed to the callback
+    //! @param staleAfter Age (s) beyond which feedback is flagged as stale (0 to not check)
+    //!
+    //! @return An ID for remove() and liveness(), or -1 if no more devices can be registered
+    //!
+    int add (const char *name, double period, crpiHeartbeat beat, void *data, double staleAfter = 0.0);
+
+    //! @brief Unregister a device
+    //!
+    //! @note Waits for a heartbeat of the device that is in progress, so the callback's data may
+    //!       be released once this returns.
+    //!
+    void remove (int id);
+
+    //! @brief Copy the liveness metrics of one device
+    //!
+    //! @return True if the ID is registered, false otherwise
+    //!
+    bool liveness (int id, crpiLiveness &metrics);
+
+    //! @brief Copy the liveness metrics of every registered device
+    //!
+    //! @param list Array populated by this method
+    //! @param max  Size of the array
+    //!
+    //! @return The number of devices copied
+    //!
+    int snapshot (crpiLiveness *list, int max);
+
+    //! @brief Service the timer wheel (thread body)
+    //!
+    void run ();
+
+  private:
+    //! @brief Default constructor
+    //!
+    CrpiWatchdog ();
+
+    //! @brief Default destructor
+    //!
+    ~CrpiWatchdog ();
+
+    //! @brief Place a device on the wheel to fire after a delay (lock held)
+    //!
+    void schedule (int id, double delay);
+
+    //! @brief Take a device off the wheel (lock held)
+    //!
+    void unlink (int id);
+
+    //! @brief Set the device whose heartbeat is running, waking remove() (lock held)
+    //!
+    void setFiring (int id);
+
+    //! @brief Join and delete a wheel thread that has stopped (lock held)
+    //!
+    void reap ();
+
+    //! @brief One registered device
+    //!
+    struct device
+    {
+      bool used;
+      crpiHeartbeat beat;
+      void *data;
+      double period;
+      double staleAfter;
+      crpiLiveness metrics;
+
+      //! @brief Wheel slot (negative when off the wheel), whole revolutions left before firing,
+      //!        and the next device in the slot
+      //!
+      int slot;
+      int rounds;
+      int next;
+    };
+
+    ulapi_mutex_struct *lock_;
+    void *task_;
+    bool running_;
+    int count_;
+
+    //! @brief Device whose heartbeat is running (-1 if none).  Changed with both lock_ and
+    //!        firedLock_ held; remove() waits on fired_ for it to change.
+    //!
+    int firing_;
+    std::mutex firedLock_;
+    std::condition_variable fired_;
+    unsigned long tick_;
+    int wheel_[WATCHDOG_SLOTS];
+    device devices_[WATCHDOG_DEVICES];
+  }; // CrpiWatchdog
+
+} // crpi_robot
+
+#endif
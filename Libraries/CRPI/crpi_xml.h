@@ -21,8 +21,24 @@
 #include <string>
 #include <sstream>
 #include "crpi.h"
+#include "crpi_sax.h"
+#include "crpi_xml_writer.h"
 #include "..\Math\MatrixMath.h"
 
+//! State channels published to subscribers.  A client subscribes with
+//!
+//!   <CRPICommand type="Subscribe"><String Value="pose,axes"/><Real Value="50"/><Int Value="2"/>
+//!   </CRPICommand>
+//!
+//! naming the channels (pose, axes, forces, io, speed), the rate (Hz) at which they are sampled,
+//! and the decimation factor (every Nth sample is sent; default 1).  An empty channel list or a
+//! rate of zero cancels the subscription.
+#define CRPI_CHANNEL_POSE 0x01
+#define CRPI_CHANNEL_AXES 0x02
+#define CRPI_CHANNEL_FORCES 0x04
+#define CRPI_CHANNEL_IO 0x08
+#define CRPI_CHANNEL_SPEED 0x10
+
 namespace Xml
 {
   //! @brief Parsed CRPI commands based on XML schemas
@@ -71,6 +87,10 @@ namespace Xml
     //!
     robotIO *io;
 
+    //! @brief Measured Cartesian speed
+    //!
+    robotPose *speed;
+
     //! @brief CRCL status flag to command straight motions
     //!
     bool moveStraight;
@@ -134,6 +154,7 @@ namespace Xml
       forces = new robotPose();
       torques = new robotAxes();
       io = new robotIO();
+      speed = new robotPose();
       moveStraight = true;
       setting = numPositions = 0.0f;
       counter = 0;
@@ -144,11 +165,13 @@ namespace Xml
     //!
     ~CrpiXmlParams()
     {
-      delete[] pose;
-      delete[] axes;
-      delete[] forces;
-      delete[] torques;
-      delete[] io;
+      delete pose;
+      delete axes;
+      delete forces;
+      delete torques;
+      delete io;
+      delete speed;
+      delete matrx;
     }
   };
 
@@ -713,7 +736,7 @@ namespace Xml
   //!
   //! @brief XML parsing class based on the SAX structure
   //!
-  class LIBRARY_API CrpiXml
+  class LIBRARY_API CrpiXml : private XmlHandler
   {
   public:
 
@@ -739,11 +762,21 @@ namespace Xml
 
     //! @brief Encode an XML string from an input schema
     //!
-    //! @param line The output XML string
+    //! @param line Replaced with the XML string (see XmlWriter)
     //!
     //! @return True if encoding was successful, false otherwise
     //!
-    bool encode (char* line);
+    bool encode (std::string &line);
+
+    //! @brief Encode a state frame for subscribers (see the Subscribe command)
+    //!
+    //! @param channels The state to include (CRPI_CHANNEL_POSE | CRPI_CHANNEL_AXES | ...)
+    //! @param time     Time (from ulapi_time) at which the state was sampled
+    //! @param line     Populated with the <CRPIState> frame
+    //!
+    //! @return True if encoding was successful, false otherwise
+    //!
+    bool encodeState (int channels, double time, std::string &line);
 
   private:
 
@@ -757,14 +790,6 @@ namespace Xml
     bool poseactive;
     bool axesactive;
 
-    //! @brief Parse the text between the tag pair
-    //!
-    //! @param ch The string of character located between the tag pair
-    //!
-    //! @return True if parsing is successful
-    //!
-    bool characters (const std::vector<std::string>& ch);
-
     //! @brief Parse the first tag of a tag pair
     //!
     //! @param tagName The tag label
@@ -772,18 +797,18 @@ namespace Xml
     //!
     //! @return True if parsing is successful
     //!
-    bool startElement (const std::string& tagName, 
+    bool startElement (const xmlView& tagName, 
                        const xmlAttributes& attr);
 
-    //! @brief Parse the first tag of a tag pair
+    //! @brief Parse the text between the tag pair
     //!
     //! @param tagName The tag label
-    //! @param attr    String of additional attributes located within the tag
+    //! @param vals    The comma-separated text items
     //!
     //! @return True if parsing is successful
     //!
-    bool interTagElement (const std::string& tagName, 
-                          const std::vector<std::string>& attr);
+    bool interTagElement (const xmlView& tagName, 
+                          const xmlViewList& vals);
 
     //! @brief Parse the second tag of a tag pair
     //!
@@ -791,7 +816,7 @@ namespace Xml
     //!
     //! @return True if parsing is successful
     //!
-    bool endElement (const std::string& tagName);
+    bool endElement (const xmlView& tagName);
 
   }; // CrpiXml
 
@@ -800,7 +825,7 @@ namespace Xml
   //!
   //! @brief XML parsing class based on the SAX structure
   //!
-  class LIBRARY_API CrclXml
+  class LIBRARY_API CrclXml : private XmlHandler
   {
   public:
 
@@ -826,11 +851,11 @@ namespace Xml
 
     //! @brief Encode an XML string from an input schema
     //!
-    //! @param line The output XML string
+    //! @param line Replaced with the XML string (see XmlWriter)
     //!
     //! @return True if encoding was successful, false otherwise
     //!
-    bool encode (char* line);
+    bool encode (std::string &line);
 
   private:
 
@@ -839,14 +864,6 @@ namespace Xml
     bool xaxisactive;
     bool zaxisactive;
 
-    //! @brief Parse the text between the tag pair
-    //!
-    //! @param ch The string of character located between the tag pair
-    //!
-    //! @return True if parsing is successful
-    //!
-    bool characters (const std::vector<std::string>& ch);
-
     //! @brief Parse the first tag of a tag pair
     //!
     //! @param tagName The tag label
@@ -854,18 +871,18 @@ namespace Xml
     //!
     //! @return True if parsing is successful
     //!
-    bool startElement (const std::string& tagName, 
+    bool startElement (const xmlView& tagName, 
                        const xmlAttributes& attr);
 
-    //! @brief Parse the first tag of a tag pair
+    //! @brief Parse the text between the tag pair
     //!
     //! @param tagName The tag label
-    //! @param attr    String of additional attributes located within the tag
+    //! @param vals    The comma-separated text items
     //!
     //! @return True if parsing is successful
     //!
-    bool interTagElement (const std::string& tagName, 
-                          const std::vector<std::string>& attr);
+    bool interTagElement (const xmlView& tagName, 
+                          const xmlViewList& vals);
 
     //! @brief Parse the second tag of a tag pair
     //!
@@ -873,7 +890,7 @@ namespace Xml
     //!
     //! @return True if parsing is successful
     //!
-    bool endElement (const std::string& tagName);
+    bool endElement (const xmlView& tagName);
 
   }; // CrclXml
 
@@ -883,7 +900,7 @@ namespace Xml
   //!
   //! @brief XML parsing of collaborative robot program representations
   //!
-  class LIBRARY_API CrpiProgramXml
+  class LIBRARY_API CrpiProgramXml : private XmlHandler
   {
   public:
 
@@ -909,23 +926,19 @@ namespace Xml
 
     //! @brief Encode an XML string from an input schema
     //!
-    //! @param line The output XML string
+    //! @param line Replaced with the XML string (see XmlWriter)
     //!
     //! @return True if encoding was successful, false otherwise
     //!
-    bool encode(char* line);
+    bool encode (std::string &line);
 
   private:
 
     CrpiXmlProgramParams *params_;
 
-    //! @brief Parse the text between the tag pair
-    //!
-    //! @param ch The string of character located between the tag pair
-    //!
-    //! @return True if parsing is successful
-    //!
-    bool characters(const std::vector<std::string>& ch);
+    bool componentactive;
+    bool locationactive;
+    bool processactive;
 
     //! @brief Parse the first tag of a tag pair
     //!
@@ -934,18 +947,18 @@ namespace Xml
     //!
     //! @return True if parsing is successful
     //!
-    bool startElement(const std::string& tagName,
+    bool startElement(const xmlView& tagName,
                       const xmlAttributes& attr);
 
-    //! @brief Parse the first tag of a tag pair
+    //! @brief Parse the text between the tag pair
     //!
     //! @param tagName The tag label
-    //! @param attr    String of additional attributes located within the tag
+    //! @param vals    The comma-separated text items
     //!
     //! @return True if parsing is successful
     //!
-    bool interTagElement(const std::string& tagName,
-                         const std::vector<std::string>& attr);
+    bool interTagElement(const xmlView& tagName,
+                         const xmlViewList& vals);
 
     //! @brief Parse the second tag of a tag pair
     //!
@@ -953,7 +966,7 @@ namespace Xml
     //!
     //! @return True if parsing is successful
     //!
-    bool endElement(const std::string& tagName);
+    bool endElement(const xmlView& tagName);
 
   }; // CrclProgramXml
 
@@ -0,0 +1,276 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       XML
+//  Workfile:        crpi_xml_names.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Perfect-hash lookup of the command, tag, and attribute names understood
+//  by the CRPI and CRCL parsers.  The table below is generated by
+//  crpi_xml_names.py.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_xml_names.h"
+#include <stddef.h>
+#include <string.h>
+
+namespace Xml
+{
+  //! BEGIN NAME TABLE
+  //! Generated by crpi_xml_names.py; do not edit by hand
+
+  static const unsigned long nameSeed = 0x811CA67AUL;
+
+  static const xmlName names[] =
+  {
+    { "", 0, TokUnknown, -1 },
+    { "CRPICommand", 11, TokCRPICommand, -1 },
+    { "CRCLCommand", 11, TokCRCLCommand, -1 },
+    { "String", 6, TokString, -1 },
+    { "Real", 4, TokReal, -1 },
+    { "Int", 3, TokInt, -1 },
+    { "Boolean", 7, TokBoolean, -1 },
+    { "Pose", 4, TokPose, -1 },
+    { "Axes", 4, TokAxes, -1 },
+    { "Matrix4x4", 9, TokMatrix4x4, -1 },
+    { "RobotIO", 7, TokRobotIO, -1 },
+    { "Vector", 6, TokVector, -1 },
+    { "Element", 7, TokElement, -1 },
+    { "XAxis", 5, TokXAxis, -1 },
+    { "ZAxis", 5, TokZAxis, -1 },
+    { "NumPositions", 12, TokNumPositions, -1 },
+    { "CommandID", 9, TokCommandID, -1 },
+    { "Setting", 7, TokSetting, -1 },
+    { "MoveStraight", 12, TokMoveStraight, -1 },
+    { "Name", 4, TokName, -1 },
+    { "CRPIBatch", 9, TokCRPIBatch, -1 },
+    { "CRCLBatch", 9, TokCRCLBatch, -1 },
+    { "type", 4, TokType, -1 },
+    { "xsi:type", 8, TokXsiType, -1 },
+    { "Value", 5, TokValue, -1 },
+    { "StopOnFailure", 13, TokStopOnFailure, -1 },
+    { "X", 1, TokPoseField, offsetof(robotPose, x) },
+    { "Y", 1, TokPoseField, offsetof(robotPose, y) },
+    { "Z", 1, TokPoseField, offsetof(robotPose, z) },
+    { "XRot", 4, TokPoseField, offsetof(robotPose, xrot) },
+    { "YRot", 4, TokPoseField, offsetof(robotPose, yrot) },
+    { "ZRot", 4, TokPoseField, offsetof(robotPose, zrot) },
+    { "I", 1, TokVectorField, offsetof(orientVect, i) },
+    { "J", 1, TokVectorField, offsetof(orientVect, j) },
+    { "K", 1, TokVectorField, offsetof(orientVect, k) },
+    { "J0", 2, TokJoint, 0 },
+    { "J1", 2, TokJoint, 1 },
+    { "J2", 2, TokJoint, 2 },
+    { "J3", 2, TokJoint, 3 },
+    { "J4", 2, TokJoint, 4 },
+    { "J5", 2, TokJoint, 5 },
+    { "J6", 2, TokJoint, 6 },
+    { "J7", 2, TokJoint, 7 },
+    { "J8", 2, TokJoint, 8 },
+    { "J9", 2, TokJoint, 9 },
+    { "J10", 3, TokJoint, 10 },
+    { "J11", 3, TokJoint, 11 },
+    { "J12", 3, TokJoint, 12 },
+    { "J13", 3, TokJoint, 13 },
+    { "J14", 3, TokJoint, 14 },
+    { "J15", 3, TokJoint, 15 },
+    { "V00", 3, TokMatrixCell, 0 },
+    { "V01", 3, TokMatrixCell, 1 },
+    { "V02", 3, TokMatrixCell, 2 },
+    { "V03", 3, TokMatrixCell, 3 },
+    { "V10", 3, TokMatrixCell, 4 },
+    { "V11", 3, TokMatrixCell, 5 },
+    { "V12", 3, TokMatrixCell, 6 },
+    { "V13", 3, TokMatrixCell, 7 },
+    { "V20", 3, TokMatrixCell, 8 },
+    { "V21", 3, TokMatrixCell, 9 },
+    { "V22", 3, TokMatrixCell, 10 },
+    { "V23", 3, TokMatrixCell, 11 },
+    { "V30", 3, TokMatrixCell, 12 },
+    { "V31", 3, TokMatrixCell, 13 },
+    { "V32", 3, TokMatrixCell, 14 },
+    { "V33", 3, TokMatrixCell, 15 },
+    { "ApplyCartesianForceTorque", 25, TokCrpiCommand, CmdApplyCartesianForceTorque },
+    { "ApplyJointTorque", 16, TokCrpiCommand, CmdApplyJointTorque },
+    { "Couple", 6, TokCrpiCommand, CmdCouple },
+    { "GetRobotAxes", 12, TokCrpiCommand, CmdGetRobotAxes },
+    { "GetRobotForces", 14, TokCrpiCommand, CmdGetRobotForces },
+    { "GetRobotIO", 10, TokCrpiCommand, CmdGetRobotIO },
+    { "GetRobotPose", 12, TokCrpiCommand, CmdGetRobotPose },
+    { "GetRobotSpeed", 13, TokCrpiCommand, CmdGetRobotSpeed },
+    { "GetRobotTorques", 15, TokCrpiCommand, CmdGetRobotTorques },
+    { "Message", 7, TokCrpiCommand, CmdMessage },
+    { "MoveAttractor", 13, TokCrpiCommand, CmdMoveAttractor },
+    { "MoveStraightTo", 14, TokCrpiCommand, CmdMoveStraightTo },
+    { "MoveThroughTo", 13, TokCrpiCommand, CmdMoveThroughTo },
+    { "MoveTo", 6, TokCrpiCommand, CmdMoveTo },
+    { "MoveToAxisTarget", 16, TokCrpiCommand, CmdMoveToAxisTarget },
+    { "SetAbsoluteAcceleration", 23, TokCrpiCommand, CmdSetAbsoluteAcceleration },
+    { "SetAbsoluteSpeed", 16, TokCrpiCommand, CmdSetAbsoluteSpeed },
+    { "SetAngleUnits", 13, TokCrpiCommand, CmdSetAngleUnits },
+    { "SetAxialSpeeds", 14, TokCrpiCommand, CmdSetAxialSpeeds },
+    { "SetAxialUnits", 13, TokCrpiCommand, CmdSetAxialUnits },
+    { "SetEndPoseTolerance", 19, TokCrpiCommand, CmdSetEndPoseTolerance },
+    { "SetIntermediatePoseTolerance", 28, TokCrpiCommand, CmdSetIntermediatePoseTolerance },
+    { "SetLengthUnits", 14, TokCrpiCommand, CmdSetLengthUnits },
+    { "SetParameter", 12, TokCrpiCommand, CmdSetParameter },
+    { "SetRelativeAcceleration", 23, TokCrpiCommand, CmdSetRelativeAcceleration },
+    { "SetRelativeSpeed", 16, TokCrpiCommand, CmdSetRelativeSpeed },
+    { "SetRobotIO", 10, TokCrpiCommand, CmdSetRobotIO },
+    { "SetRobotDO", 10, TokCrpiCommand, CmdSetRobotDO },
+    { "SetTool", 7, TokCrpiCommand, CmdSetTool },
+    { "StopMotion", 10, TokCrpiCommand, CmdStopMotion },
+    { "ToWorldMatrix", 13, TokCrpiCommand, CmdToWorldMatrix },
+    { "ToSystemMatrix", 14, TokCrpiCommand, CmdToSystemMatrix },
+    { "ToWorld", 7, TokCrpiCommand, CmdToWorld },
+    { "FromWorld", 9, TokCrpiCommand, CmdFromWorld },
+    { "ToSystem", 8, TokCrpiCommand, CmdToSystem },
+    { "FromSystem", 10, TokCrpiCommand, CmdFromSystem },
+    { "UpdateWorldTransform", 20, TokCrpiCommand, CmdUpdateWorldTransform },
+    { "UpdateSystemTransform", 21, TokCrpiCommand, CmdUpdateSystemTransform },
+    { "SaveConfig", 10, TokCrpiCommand, CmdSaveConfig },
+    { "Subscribe", 9, TokCrpiCommand, CmdSubscribe },
+    { "ActuateJointsType", 17, TokCrclCommand, CmdMoveToAxisTarget },
+    { "CloseToolChangerType", 20, TokCrclCommand, CmdCouple },
+    { "ConfigureJointReportsType", 25, TokCrclCommand, -1 },
+    { "DwellType", 9, TokCrclCommand, CmdDwell },
+    { "EndCanonType", 12, TokCrclCommand, CmdEndCanon },
+    { "GetStatusType", 13, TokCrclCommand, CmdGetRobotPose },
+    { "InitCanonType", 13, TokCrclCommand, CmdInitCanon },
+    { "MessageType", 11, TokCrclCommand, CmdMessage },
+    { "MoveScrewType", 13, TokCrclCommand, -1 },
+    { "MoveThroughToType", 17, TokCrclCommand, CmdMoveThroughTo },
+    { "MoveToType", 10, TokCrclCommand, CmdMoveTo },
+    { "RunProgramType", 14, TokCrclCommand, CmdRunProgram },
+    { "SetAbsoluteAccelerationType", 27, TokCrclCommand, CmdSetAbsoluteAcceleration },
+    { "SetAbsoluteSpeedType", 20, TokCrclCommand, CmdSetAbsoluteSpeed },
+    { "SetAngleUnitsType", 17, TokCrclCommand, CmdSetAngleUnits },
+    { "SetEndEffectorParametersType", 28, TokCrclCommand, CmdSetParameter },
+    { "SetEndEffectorType", 18, TokCrclCommand, CmdSetTool },
+    { "SetEndPoseToleranceType", 23, TokCrclCommand, CmdSetEndPoseTolerance },
+    { "SetForceUnitsType", 17, TokCrclCommand, -1 },
+    { "SetIntermediatePoseToleranceType", 32, TokCrclCommand, CmdSetIntermediatePoseTolerance },
+    { "SetJointControlModesType", 24, TokCrclCommand, -1 },
+    { "SetLengthUnitsType", 18, TokCrclCommand, CmdSetLengthUnits },
+    { "SetRelativeAccelerationType", 27, TokCrclCommand, CmdSetRelativeAcceleration },
+    { "SetTransSpeedRelativeType", 25, TokCrclCommand, CmdSetRelativeSpeed },
+    { "SetRobotParametersType", 22, TokCrclCommand, CmdSetParameter },
+    { "SetTorqueUnitsType", 18, TokCrclCommand, -1 },
+    { "StopMotionType", 14, TokCrclCommand, CmdStopMotion }
+  };
+
+  static const unsigned char nameSlots[XML_NAME_SLOTS] =
+  {
+      0,   0,   0,   0,   0, 101,   2,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,  40,   0,   0,   0,   0,   0,   0,
+      0,   0,  46,  84,   0,  95,   0,   0,  18,   0,  75,   0,   0,  29,   0,   0,
+      0,   0,   0,   0,  23,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   1, 110,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     62,   0,  20,  28,   0, 132,   0,   0,   0,   0,   0,  64,   0,   0,   0,   0,
+      0,   0,   0,   0, 129,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  32,   0,   0,   0,  52,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 119,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 109,   0,
+     81,   0,   0,   0,   0,   0,   0,   0,   0,   0, 116,   0,   0,  45,   0,  30,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  86,   0, 120,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,  96,   0,   0,   0,   0,   0,   0,   0,
+     55,   0,   0,  61,   0,   0,   0,   0, 115,   0,   9,   0,  51,  74,   0,   0,
+      0,   0,   0, 124,  41,   0,   0,   0,   0,   0, 103,   0,   0,   0,   0,   0,
+     16,   0,   0,   0,   0,   0,  77,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     34,   0,  65,   0,   0,   0,   4,  14,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,  10,   0,   0,   0,  82,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,  38,
+      0,   0,   0,   0,   0,   0,  21,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,  54,   0,   0,   0,   6,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0, 107,   0,   0,   0,   0,   0,   0,  31,   0,   0,   0,   0,   0,
+    131,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,  85,   0,   0,   0,   0,   0,   0,  39,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,  71,   0, 105,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,  33,   0,  66,   0,   0,   0,  24,   0,   0,   0,   0,  89,   0,
+      0,   0, 130,   0,   0,   0,   0,   0,   0,   0,  60,   0,   0,   0, 125,   0,
+      0,   0,   0,  53,   0,  59,   0,   0,  63, 121,   0,   0,   0,   0,   0,   0,
+      0,  11,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 108,   5,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,  50,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,  49,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0, 126,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 114, 123,   0,   0,
+      0,   0,   0,   0,   0, 117,  92,  88,   0,   0,   0,   0,   0,   0,   0, 128,
+      0,   0,   0,   0,   0,   0,   0,  15,   0,  58,   0,   0,   0,  80, 118,   0,
+      0,   0,   0,   0,   0,   0,  35,   0,   0,   0,   0,   7,   0,   0,   0,   0,
+     97,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,  90,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+     37,   0,   0,   0,   0,   0,   0,  79,   0,  91,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,  25,   0, 112,   0,   0,   0,   0,
+      0,   0,  17,   0,   0,   0,   0,  87,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,  36,   0, 106,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,  70,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0, 133,  83,   0,   0,   0,   0,   0,   0,   0,   0,   0, 122,  73,   0,   0,
+      0,   0,   0,   0,  48,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,  56,   0,   0,   0,   0,  69,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,  12,   0,  13,   0,  27,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0, 100,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,  42,   0,   0,   0,   0,   0,   0,   0,   0,  94,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,  72,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,   0,   0,  19,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0, 104,   0,   0,   0,   0,  68,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,  98,   0,   0,   0,   0,  57,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,  99,   0,   0,  47,   0,   0,   0,   0,   0,   0,   0,   0,
+     67,  93,   0, 102,   0,   0,   0,   0,  76,   0,   0,   0, 113,  44,   0,   0,
+      0,   0,   0,   0,   0,  26,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   0,   0,   0,  78,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+      0,   0,   3,   0,   0,   0,   0,   0,   8,   0,   0,   0,   0,   0,  43,   0,
+      0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0, 127,
+      0,   0,   0, 111,   0,   0,   0,   0,   0,   0,   0,  22,   0,   0,   0,   0
+  };
+  //! END NAME TABLE
+
+
+  //! @brief Seeded FNV-1a, folded to the table size (same as slot() in crpi_xml_names.py)
+  //!
+  static inline unsigned int xmlNameHash (const char *text, size_t length)
+  {
+    unsigned long h = nameSeed;
+    size_t i;
+
+    for (i = 0; i < length; ++i)
+    {
+      h = ((h ^ (unsigned char)text[i]) * 16777619UL) & 0xFFFFFFFFUL;
+    }
+    return (unsigned int)((h ^ (h >> 15)) & (XML_NAME_SLOTS - 1));
+  }
+
+
+  LIBRARY_API const xmlName &xmlLookup (const xmlView &name)
+  {
+    char decoded[XML_VALUE_MAX];
+    const char *text = name.ptr;
+    size_t length = name.len;
+    const xmlName *entry;
+
+    if (name.escaped)
+    {
+      length = name.copy(decoded, XML_VALUE_MAX);
+      text = decoded;
+    }
+    if (length == 0 || length > 255)
+    {
+      return names[0];
+    }
+
+    entry = &names[nameSlots[xmlNameHash(text, length)]];
+    if (entry->length != length || memcmp(entry->text, text, length) != 0)
+    {
+      return names[0];
+    }
+    return *entry;
+  }
+
+} // Xml namespace
@@ -0,0 +1,108 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       XML
+//  Workfile:        crpi_xml_names.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Perfect-hash lookup of the command, tag, and attribute names understood
+//  by the CRPI and CRCL parsers.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_XML_NAMES_H
+#define CRPI_XML_NAMES_H
+
+#include "crpi_sax.h"
+
+#define XML_NAME_SLOTS 1024  //! Hash table size (power of two; see crpi_xml_names.py)
+
+namespace Xml
+{
+  //! @brief What a recognized name is
+  //!
+  typedef enum
+  {
+    TokUnknown = 0,
+    TokCRPICommand,
+    TokCRCLCommand,
+    TokString,
+    TokReal,
+    TokInt,
+    TokBoolean,
+    TokPose,
+    TokAxes,
+    TokMatrix4x4,
+    TokRobotIO,
+    TokVector,
+    TokElement,
+    TokXAxis,
+    TokZAxis,
+    TokNumPositions,
+    TokCommandID,
+    TokSetting,
+    TokMoveStraight,
+    TokName,
+    TokCRPIBatch,
+    TokCRCLBatch,
+    TokType,
+    TokXsiType,
+    TokValue,
+    TokStopOnFailure,
+    TokPoseField,       //! field:  offset of the member in robotPose
+    TokVectorField,     //! field:  offset of the member in orientVect
+    TokJoint,           //! field:  axis index
+    TokMatrixCell,      //! field:  row * 4 + column
+    TokCrpiCommand,     //! field:  CanonCommand
+    TokCrclCommand      //! field:  equivalent CanonCommand, or -1 if there is none
+  } XmlToken;
+
+
+  //! @brief One entry of the name table
+  //!
+  struct xmlName
+  {
+    //! @brief The name as it appears in the XML
+    //!
+    const char *text;
+
+    //! @brief Length of text
+    //!
+    unsigned char length;
+
+    //! @brief What the name is
+    //!
+    unsigned char token;
+
+    //! @brief Token-specific value (see XmlToken), -1 if unused
+    //!
+    short field;
+  };
+
+
+  //! @brief Look up a tag, attribute, or command name
+  //!
+  //! @param name The name as found by the tokenizer
+  //!
+  //! @return The table entry for the name, or an entry with token TokUnknown
+  //!
+  //! @note Costs one hash of the name and at most one comparison, regardless of how many names
+  //!       the table holds.
+  //!
+  LIBRARY_API const xmlName &xmlLookup (const xmlView &name);
+
+
+  //! @brief Access a double member of a structure by its offset (see TokPoseField and
+  //!        TokVectorField)
+  //!
+  inline double &xmlField (void *base, short offset)
+  {
+    return *(double*)((char*)base + offset);
+  }
+
+} // Xml namespace
+
+#endif
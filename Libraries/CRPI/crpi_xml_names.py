@@ -0,0 +1,173 @@
+#!/usr/bin/env python
+
+#################################################################
+# System:   Collaborative Robot Programming Interface           #
+# File:     crpi_xml_names.py                                   #
+# Revision: 1.0 18/10/2026                                      #
+# Author:   J. Marvel                                           #
+#                                                               #
+# Description                                                   #
+# ===========                                                   #
+# Generates the perfect-hash name table in crpi_xml_names.cpp   #
+# from the list of names below.  Run after adding a name:       #
+#                                                               #
+#   python crpi_xml_names.py                                    #
+#################################################################
+
+import os
+import sys
+
+SLOTS = 1024        # Must match XML_NAME_SLOTS in crpi_xml_names.h
+
+#################################################################
+# (name, token, field)
+NAMES = [
+	# Tags
+	("CRPICommand", "TokCRPICommand", "-1"),
+	("CRCLCommand", "TokCRCLCommand", "-1"),
+	("String", "TokString", "-1"),
+	("Real", "TokReal", "-1"),
+	("Int", "TokInt", "-1"),
+	("Boolean", "TokBoolean", "-1"),
+	("Pose", "TokPose", "-1"),
+	("Axes", "TokAxes", "-1"),
+	("Matrix4x4", "TokMatrix4x4", "-1"),
+	("RobotIO", "TokRobotIO", "-1"),
+	("Vector", "TokVector", "-1"),
+	("Element", "TokElement", "-1"),
+	("XAxis", "TokXAxis", "-1"),
+	("ZAxis", "TokZAxis", "-1"),
+	("NumPositions", "TokNumPositions", "-1"),
+	("CommandID", "TokCommandID", "-1"),
+	("Setting", "TokSetting", "-1"),
+	("MoveStraight", "TokMoveStraight", "-1"),
+	("Name", "TokName", "-1"),
+	("CRPIBatch", "TokCRPIBatch", "-1"),
+	("CRCLBatch", "TokCRCLBatch", "-1"),
+
+	# Attributes
+	("type", "TokType", "-1"),
+	("xsi:type", "TokXsiType", "-1"),
+	("Value", "TokValue", "-1"),
+	("StopOnFailure", "TokStopOnFailure", "-1"),
+
+	# Pose members (CRPI attributes, CRCL tags)
+	("X", "TokPoseField", "offsetof(robotPose, x)"),
+	("Y", "TokPoseField", "offsetof(robotPose, y)"),
+	("Z", "TokPoseField", "offsetof(robotPose, z)"),
+	("XRot", "TokPoseField", "offsetof(robotPose, xrot)"),
+	("YRot", "TokPoseField", "offsetof(robotPose, yrot)"),
+	("ZRot", "TokPoseField", "offsetof(robotPose, zrot)"),
+
+	# Orientation vector members (CRCL tags)
+	("I", "TokVectorField", "offsetof(orientVect, i)"),
+	("J", "TokVectorField", "offsetof(orientVect, j)"),
+	("K", "TokVectorField", "offsetof(orientVect, k)"),
+]
+
+# Joint attributes:  J0 - J15
+for i in range(16):
+	NAMES.append(("J%d" % i, "TokJoint", "%d" % i))
+
+# Matrix attributes:  V00 - V33 (row * 4 + column)
+for r in range(4):
+	for c in range(4):
+		NAMES.append(("V%d%d" % (r, c), "TokMatrixCell", "%d" % (r * 4 + c)))
+
+# CRPI command names
+for cmd in ["ApplyCartesianForceTorque", "ApplyJointTorque", "Couple", "GetRobotAxes", "GetRobotForces",
+            "GetRobotIO", "GetRobotPose", "GetRobotSpeed", "GetRobotTorques", "Message", "MoveAttractor",
+            "MoveStraightTo", "MoveThroughTo", "MoveTo", "MoveToAxisTarget", "SetAbsoluteAcceleration",
+            "SetAbsoluteSpeed", "SetAngleUnits", "SetAxialSpeeds", "SetAxialUnits", "SetEndPoseTolerance",
+            "SetIntermediatePoseTolerance", "SetLengthUnits", "SetParameter", "SetRelativeAcceleration",
+            "SetRelativeSpeed", "SetRobotIO", "SetRobotDO", "SetTool", "StopMotion", "ToWorldMatrix",
+            "ToSystemMatrix", "ToWorld", "FromWorld", "ToSystem", "FromSystem", "UpdateWorldTransform",
+            "UpdateSystemTransform", "SaveConfig", "Subscribe"]:
+	NAMES.append((cmd, "TokCrpiCommand", "Cmd" + cmd))
+
+# CRCL command types and their CRPI equivalents (-1 if there is none)
+for cmd, crpi in [("ActuateJointsType", "CmdMoveToAxisTarget"), ("CloseToolChangerType", "CmdCouple"),
+                  ("ConfigureJointReportsType", "-1"), ("DwellType", "CmdDwell"),
+                  ("EndCanonType", "CmdEndCanon"), ("GetStatusType", "CmdGetRobotPose"),
+                  ("InitCanonType", "CmdInitCanon"), ("MessageType", "CmdMessage"),
+                  ("MoveScrewType", "-1"), ("MoveThroughToType", "CmdMoveThroughTo"),
+                  ("MoveToType", "CmdMoveTo"), ("RunProgramType", "CmdRunProgram"),
+                  ("SetAbsoluteAccelerationType", "CmdSetAbsoluteAcceleration"),
+                  ("SetAbsoluteSpeedType", "CmdSetAbsoluteSpeed"), ("SetAngleUnitsType", "CmdSetAngleUnits"),
+                  ("SetEndEffectorParametersType", "CmdSetParameter"), ("SetEndEffectorType", "CmdSetTool"),
+                  ("SetEndPoseToleranceType", "CmdSetEndPoseTolerance"), ("SetForceUnitsType", "-1"),
+                  ("SetIntermediatePoseToleranceType", "CmdSetIntermediatePoseTolerance"),
+                  ("SetJointControlModesType", "-1"), ("SetLengthUnitsType", "CmdSetLengthUnits"),
+                  ("SetRelativeAccelerationType", "CmdSetRelativeAcceleration"),
+                  ("SetTransSpeedRelativeType", "CmdSetRelativeSpeed"),
+                  ("SetRobotParametersType", "CmdSetParameter"), ("SetTorqueUnitsType", "-1"),
+                  ("StopMotionType", "CmdStopMotion")]:
+	NAMES.append((cmd, "TokCrclCommand", crpi))
+
+
+#################################################################
+# Seeded FNV-1a, folded to the table size (same as xmlNameHash)
+def slot(name, seed):
+	h = seed
+	for c in name.encode("ascii"):
+		h = ((h ^ c) * 16777619) & 0xFFFFFFFF
+	return (h ^ (h >> 15)) & (SLOTS - 1)
+
+
+#################################################################
+# Find a seed for which no two names share a slot
+def findSeed():
+	seed = 2166136261
+	while True:
+		used = set()
+		for name, token, field in NAMES:
+			s = slot(name, seed)
+			if s in used:
+				break
+			used.add(s)
+		else:
+			return seed
+		seed = (seed + 1) & 0xFFFFFFFF
+
+
+#################################################################
+def generate():
+	if len(set(n for n, t, f in NAMES)) != len(NAMES) or len(NAMES) > 254:
+		sys.exit("Names must be unique, and there may be at most 254 of them")
+
+	seed = findSeed()
+	slots = [0] * SLOTS
+	for index, (name, token, field) in enumerate(NAMES):
+		slots[slot(name, seed)] = index + 1
+
+	out = ["  //! Generated by crpi_xml_names.py; do not edit by hand", ""]
+	out.append("  static const unsigned long nameSeed = 0x%08XUL;" % seed)
+	out.append("")
+	out.append("  static const xmlName names[] =")
+	out.append("  {")
+	out.append("    { \"\", 0, TokUnknown, -1 },")
+	for name, token, field in NAMES:
+		out.append("    { \"%s\", %d, %s, %s }," % (name, len(name), token, field))
+	out[-1] = out[-1][:-1]
+	out.append("  };")
+	out.append("")
+	out.append("  static const unsigned char nameSlots[XML_NAME_SLOTS] =")
+	out.append("  {")
+	for row in range(0, SLOTS, 16):
+		line = ", ".join("%3d" % v for v in slots[row:row + 16])
+		out.append("    " + line + ("," if row + 16 < SLOTS else ""))
+	out.append("  };")
+	return out
+
+
+#################################################################
+if __name__ == "__main__":
+	path = os.path.join(os.path.dirname(os.path.abspath(__file__)), "crpi_xml_names.cpp")
+	text = open(path, "rb").read().decode("ascii")
+	begin = "  //! BEGIN NAME TABLE\r\n"
+	end = "  //! END NAME TABLE\r\n"
+	first = text.index(begin) + len(begin)
+	last = text.index(end)
+	table = "\r\n".join(generate()) + "\r\n"
+	open(path, "wb").write((text[:first] + table + text[last:]).encode("ascii"))
+	print("%d names written to %s" % (len(NAMES), path))
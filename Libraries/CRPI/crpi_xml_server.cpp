@@ -0,0 +1,649 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_xml_server.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Multi-client server for remote CRPI XML commands.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <iostream>
+#include <map>
+#include <ctype.h>
+#include "crpi_xml_server.h"
+
+#ifdef WIN32
+#include <winsock2.h>
+#else
+#include <sys/epoll.h>
+#include <unistd.h>
+#endif
+
+using namespace std;
+using namespace Xml;
+
+//! Distinguishes binary state frames from XML frames with the same channels
+#define XML_FRAME_BINARY 0x10000
+
+namespace crpi_robot
+{
+  //! @brief Whether a command only reads the robot's state
+  //!
+  static bool xmlIsQuery (int cmd)
+  {
+    switch (cmd)
+    {
+    case CmdGetRobotAxes:
+    case CmdGetRobotForces:
+    case CmdGetRobotIO:
+    case CmdGetRobotPose:
+    case CmdGetRobotSpeed:
+    case CmdGetRobotTorques:
+      return true;
+    default:
+      return false;
+    }
+  }
+
+
+  //! @brief Convert a comma-separated list of channel names to CRPI_CHANNEL_* flags
+  //!
+  static int xmlChannels (const string &names)
+  {
+    static const char *channel[] = {"pose", "axes", "forces", "io", "speed"};
+    string name;
+    size_t start = 0, end;
+    int channels = 0, i, j;
+
+    while (start <= names.length())
+    {
+      end = names.find(',', start);
+      if (end == string::npos)
+      {
+        end = names.length();
+      }
+      name.clear();
+      for (j = (int)start; j < (int)end; ++j)
+      {
+        if (names[j] != ' ')
+        {
+          name += (char)tolower(names[j]);
+        }
+      }
+      for (i = 0; i < 5; ++i)
+      {
+        if (name == channel[i])
+        {
+          channels |= (1 << i);
+        }
+      }
+      start = end + 1;
+    }
+    return channels;
+  }
+
+
+  LIBRARY_API XmlServer::XmlServer (XmlTarget *target, int port, const char *name)
+  {
+    target_ = target;
+    port_ = port;
+    name_ = name;
+    server_ = -1;
+    poll_ = -1;
+    count_ = 0;
+    controller_ = NULL;
+    running_ = true;
+    lock_ = ulapi_mutex_new(57);
+
+    motion_.server = query_.server = this;
+    motion_.task = ulapi_task_new();
+    query_.task = ulapi_task_new();
+    publisher_ = ulapi_task_new();
+    ulapi_task_start((ulapi_task_struct*)motion_.task, strandThread, &motion_, ulapi_prio_lowest(), 0);
+    ulapi_task_start((ulapi_task_struct*)query_.task, strandThread, &query_, ulapi_prio_lowest(), 0);
+    ulapi_task_start((ulapi_task_struct*)publisher_, publishThread, this, ulapi_prio_lowest(), 0);
+  }
+
+
+  LIBRARY_API XmlServer::~XmlServer ()
+  {
+    vector<XmlClient*>::iterator iter;
+
+    ulapi_mutex_take(lock_);
+    running_ = false;
+    ulapi_mutex_give(lock_);
+
+    //! Each strand finishes the command it is handling before it exits
+    motion_.wake.give();
+    query_.wake.give();
+    publisherWake_.give();
+    ulapi_task_join((ulapi_task_struct*)motion_.task, NULL);
+    ulapi_task_join((ulapi_task_struct*)query_.task, NULL);
+    ulapi_task_join((ulapi_task_struct*)publisher_, NULL);
+    ulapi_task_delete((ulapi_task_struct*)motion_.task);
+    ulapi_task_delete((ulapi_task_struct*)query_.task);
+    ulapi_task_delete((ulapi_task_struct*)publisher_);
+
+    for (iter = clients_.begin(); iter != clients_.end(); ++iter)
+    {
+      ulapi_socket_close((*iter)->id);
+      ulapi_mutex_delete((*iter)->write);
+      delete *iter;
+    }
+    clients_.clear();
+
+    if (server_ >= 0)
+    {
+      ulapi_socket_close(server_);
+    }
+#ifndef WIN32
+    if (poll_ >= 0)
+    {
+      close(poll_);
+    }
+#endif
+    ulapi_mutex_delete(lock_);
+  }
+
+
+  LIBRARY_API bool XmlServer::run (bool &runThread)
+  {
+    XmlClient *ready[XML_SERVER_EVENTS + 1];
+    bool accepting;
+    int count, i;
+
+    server_ = ulapi_socket_get_server_id(port_);
+    if (server_ < 0)
+    {
+      cout << "Could not open port " << port_ << " for the " << name_ << " arm" << endl;
+      return false;
+    }
+    ulapi_socket_set_blocking(server_);
+
+#ifndef WIN32
+    epoll_event events[XML_SERVER_EVENTS], event;
+
+    poll_ = epoll_create(XML_SERVER_EVENTS);
+    if (poll_ < 0)
+    {
+      return false;
+    }
+    event.events = EPOLLIN;
+    event.data.ptr = NULL;
+    epoll_ctl(poll_, EPOLL_CTL_ADD, (int)server_, &event);
+#else
+    fd_set set;
+    timeval wait;
+    vector<XmlClient*>::iterator iter;
+#endif
+
+    cout << "Running XML Interface on port " << port_ << " for the " << name_ << " arm" << endl;
+
+    while (runThread)
+    {
+      //! Wait for the listening socket or any client (level triggered:  a client with more
+      //! data than one read takes is reported again on the next wait)
+      accepting = false;
+      count = 0;
+
+#ifndef WIN32
+      int n = epoll_wait(poll_, events, XML_SERVER_EVENTS, XML_SERVER_TICK);
+      for (i = 0; i < n; ++i)
+      {
+        if (events[i].data.ptr == NULL)
+        {
+          accepting = true;
+        }
+        else
+        {
+          ready[count++] = (XmlClient*)events[i].data.ptr;
+        }
+      }
+#else
+      //! Only this thread adds or removes clients, so the list is read without the lock
+      FD_ZERO(&set);
+      FD_SET((SOCKET)server_, &set);
+      for (iter = clients_.begin(); iter != clients_.end() && set.fd_count < FD_SETSIZE; ++iter)
+      {
+        FD_SET((SOCKET)(*iter)->id, &set);
+      }
+      wait.tv_sec = 0;
+      wait.tv_usec = XML_SERVER_TICK * 1000;
+      if (select(0, &set, NULL, NULL, &wait) > 0)
+      {
+        accepting = (FD_ISSET((SOCKET)server_, &set) != 0);
+        for (iter = clients_.begin(); iter != clients_.end() && count < XML_SERVER_EVENTS; ++iter)
+        {
+          if (FD_ISSET((SOCKET)(*iter)->id, &set))
+          {
+            ready[count++] = *iter;
+          }
+        }
+      }
+#endif
+
+      for (i = 0; i < count; ++i)
+      {
+        receive(ready[i]);
+      }
+      if (accepting)
+      {
+        accept();
+      }
+    } // while (runThread)
+
+    return true;
+  }
+
+
+  LIBRARY_API int XmlServer::clients ()
+  {
+    int count;
+
+    ulapi_mutex_take(lock_);
+    count = (int)clients_.size();
+    ulapi_mutex_give(lock_);
+    return count;
+  }
+
+
+  void XmlServer::accept ()
+  {
+    XmlClient *client;
+    ulapi_integer id;
+
+    id = ulapi_socket_get_connection_id(server_);
+    if (id < 0)
+    {
+      return;
+    }
+    ulapi_socket_set_blocking(id);
+
+    client = new XmlClient();
+    client->id = id;
+    client->number = ++count_;
+    client->busy = client->closed = false;
+    client->pushing = 0;
+    client->write = ulapi_mutex_new(58);
+    client->channels = client->skipped = 0;
+    client->decimation = 1;
+    client->period = client->next = 0.0;
+
+#ifndef WIN32
+    epoll_event event;
+    event.events = EPOLLIN;
+    event.data.ptr = client;
+    epoll_ctl(poll_, EPOLL_CTL_ADD, (int)id, &event);
+#endif
+
+    ulapi_mutex_take(lock_);
+    clients_.push_back(client);
+    ulapi_mutex_give(lock_);
+
+    cout << "Remote " << name_ << " client " << client->number << " connected..." << endl;
+  }
+
+
+  void XmlServer::receive (XmlClient *client)
+  {
+    char buffer[XML_SERVER_READ];
+    ulapi_integer rec;
+
+    //! Only the reactor thread reads or frees a client that is not closed
+    rec = ulapi_socket_read(client->id, buffer, XML_SERVER_READ);
+
+    ulapi_mutex_take(lock_);
+    if (rec <= 0 || !client->stream.feed(buffer, rec))
+    {
+      //! Connection closed, or the client sent something that cannot be framed
+      drop(client);
+    }
+    else
+    {
+      dispatch(client);
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+
+  void XmlServer::dispatch (XmlClient *client)
+  {
+    XmlJob job;
+    XmlStrand *strand;
+    CrpiCommand *command;
+    string text;
+    bool binary, parsed, valid, query;
+    int cmd, i;
+
+    if (client->busy || client->closed || !client->stream.next(text))
+    {
+      return;
+    }
+
+    //! Parsed once, here; the strand only executes the command and encodes its response
+    job.client = client;
+    binary = (client->stream.framing() == XmlFramingBinary);
+    if (!binary && client->batch.parse(text))
+    {
+      //! A batch is handled as one command:  all of it is parsed first, and it is rejected whole
+      //! if any command is malformed (or has no CRPI equivalent) or needs control the client
+      //! does not hold
+      job.command = NULL;
+      valid = (client->batch.size() > 0);
+      query = true;
+      for (i = 0; i < client->batch.size(); ++i)
+      {
+        command = client->pool.take();
+        client->commands.push_back(command);
+        if (client->batch.crcl())
+        {
+          parsed = command->parseCrcl(client->batch.command(i));
+        }
+        else
+        {
+          parsed = command->parse(client->batch.command(i), false);
+        }
+        cmd = (int)command->request().cmd;
+        valid = valid && parsed && cmd >= 0 && cmd != CmdSubscribe;
+        query = query && xmlIsQuery(cmd);
+      }
+    }
+    else
+    {
+      job.command = client->pool.take();
+      parsed = job.command->parse(text, binary);
+      cmd = (int)job.command->request().cmd;
+      valid = ((parsed || !binary) && cmd >= 0);
+      query = (xmlIsQuery(cmd) || cmd == CmdSubscribe);
+      if (valid && cmd == CmdSubscribe)
+      {
+        //! Subscriptions belong to the client, not the robot; the query strand acknowledges it
+        subscribe(client, job.command->request());
+      }
+    }
+
+    if (!valid)
+    {
+      job.type = XmlJobReject;
+      strand = &query_;
+    }
+    else if (query)
+    {
+      job.type = XmlJobQuery;
+      strand = &query_;
+    }
+    else if (controller_ == NULL || controller_ == client)
+    {
+      if (controller_ == NULL)
+      {
+        controller_ = client;
+        cout << "Remote " << name_ << " client " << client->number << " has control" << endl;
+      }
+      job.type = XmlJobExecute;
+      strand = &motion_;
+    }
+    else
+    {
+      job.type = XmlJobReject;
+      strand = &query_;
+    }
+
+    client->busy = true;
+    strand->jobs.push_back(job);
+    strand->wake.give();
+  }
+
+
+  void XmlServer::drop (XmlClient *client)
+  {
+    vector<XmlClient*>::iterator iter;
+
+    if (client->closed)
+    {
+      return;
+    }
+    client->closed = true;
+    cout << "Remote " << name_ << " client " << client->number << " disconnected" << endl;
+
+#ifndef WIN32
+    epoll_ctl(poll_, EPOLL_CTL_DEL, (int)client->id, NULL);
+#endif
+    for (iter = clients_.begin(); iter != clients_.end(); ++iter)
+    {
+      if (*iter == client)
+      {
+        clients_.erase(iter);
+        break;
+      }
+    }
+
+    if (controller_ == client)
+    {
+      controller_ = NULL;
+    }
+    release(client);
+  }
+
+
+  void XmlServer::release (XmlClient *client)
+  {
+    //! A strand handling a command from the client, or the publisher pushing it a frame, frees
+    //! it when done
+    if (client->closed && !client->busy && client->pushing == 0)
+    {
+      ulapi_socket_close(client->id);
+      ulapi_mutex_delete(client->write);
+      delete client;
+    }
+  }
+
+
+  void XmlServer::subscribe (XmlClient *client, const CrpiXmlParams &request)
+  {
+    client->channels = (request.real > 0.0 ? xmlChannels(request.str) : 0);
+    if (client->channels == 0)
+    {
+      cout << "Remote " << name_ << " client " << client->number << " unsubscribed" << endl;
+      return;
+    }
+
+    client->period = 1.0 / (request.real < XML_PUBLISH_RATE_MAX ? request.real : XML_PUBLISH_RATE_MAX);
+    client->decimation = (request.integer > 1 ? request.integer : 1);
+    client->skipped = client->decimation - 1;
+    client->next = ulapi_time();
+    cout << "Remote " << name_ << " client " << client->number << " subscribed at "
+         << (1.0 / client->period) << " Hz" << endl;
+  }
+
+
+  void XmlServer::publish ()
+  {
+    vector<XmlClient*> due;
+    vector<XmlClient*>::iterator iter;
+    map<int, string> frames;
+    map<int, string>::iterator fiter;
+    XmlClient *client;
+    double now, wake;
+    int channels;
+    bool binary;
+
+    ulapi_mutex_take(lock_);
+    while (running_)
+    {
+      //! Find the subscribers due a sample, and when the next one is due
+      now = ulapi_time();
+      wake = now + (XML_SERVER_TICK / 1000.0);
+      channels = 0;
+      due.clear();
+      for (iter = clients_.begin(); iter != clients_.end(); ++iter)
+      {
+        client = *iter;
+        if (client->channels == 0)
+        {
+          continue;
+        }
+        if (now >= client->next)
+        {
+          //! A subscriber that fell behind skips the samples it missed rather than bursting
+          client->next += client->period;
+          if (client->next < now)
+          {
+            client->next = now + client->period;
+          }
+          if (++client->skipped >= client->decimation)
+          {
+            client->skipped = 0;
+            client->pushing += 1;
+            channels |= client->channels;
+            due.push_back(client);
+          }
+        }
+        wake = (client->next < wake ? client->next : wake);
+      }
+      ulapi_mutex_give(lock_);
+
+      if (!due.empty())
+      {
+        //! One read of the robot, and one encoding per set of channels, serves every subscriber
+        target_->sample(channels);
+        for (fiter = frames.begin(); fiter != frames.end(); ++fiter)
+        {
+          //! Keep each frame's buffer from one sample to the next
+          fiter->second.clear();
+        }
+        for (iter = due.begin(); iter != due.end(); ++iter)
+        {
+          client = *iter;
+          binary = (client->stream.framing() == XmlFramingBinary);
+          string &frame = frames[client->channels | (binary ? XML_FRAME_BINARY : 0)];
+          if (frame.empty())
+          {
+            target_->state(client->channels, frame, binary);
+          }
+          ulapi_mutex_take(client->write);
+          client->stream.send(client->id, frame.data(), (int)frame.length());
+          ulapi_mutex_give(client->write);
+        }
+      }
+
+      now = ulapi_time();
+      if (wake > now)
+      {
+        publisherWake_.take((wake - now) * 1000.0);
+      }
+
+      ulapi_mutex_take(lock_);
+      for (iter = due.begin(); iter != due.end(); ++iter)
+      {
+        (*iter)->pushing -= 1;
+        release(*iter);
+      }
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+
+  void XmlServer::publishThread (void *param)
+  {
+    ((XmlServer*)param)->publish();
+  }
+
+
+  void XmlServer::handle (XmlJobType type, CrpiCommand &command)
+  {
+    switch (type)
+    {
+    case XmlJobExecute:
+      target_->execute(command);
+      break;
+    case XmlJobQuery:
+      target_->query(command);
+      break;
+    default:
+      target_->reject(command);
+      break;
+    }
+  }
+
+
+  void XmlServer::work (XmlStrand &strand)
+  {
+    XmlJob job;
+    CrpiBatch *batch;
+    vector<CrpiCommand*> *commands;
+    string response, single;
+    bool binary;
+    int i;
+
+    ulapi_mutex_take(lock_);
+    while (running_)
+    {
+      if (strand.jobs.empty())
+      {
+        ulapi_mutex_give(lock_);
+        strand.wake.take();
+        ulapi_mutex_take(lock_);
+        continue;
+      }
+      job = strand.jobs.front();
+      strand.jobs.pop_front();
+      ulapi_mutex_give(lock_);
+
+      binary = (job.client->stream.framing() == XmlFramingBinary);
+      if (job.command != NULL)
+      {
+        handle(job.type, *job.command);
+        job.command->respond(response, binary);
+        job.client->pool.give(job.command);
+      }
+      else
+      {
+        //! The client has nothing else outstanding, so its batch is this strand's until answered
+        batch = &job.client->batch;
+        commands = &job.client->commands;
+        for (i = 0; i < (int)commands->size() && !batch->stopped(); ++i)
+        {
+          handle(job.type, *(*commands)[i]);
+          (*commands)[i]->respond(single, false);
+          batch->add((*commands)[i]->response().status, single);
+        }
+        batch->respond(response, (commands->empty() ? 0 : commands->back()->response().counter));
+        for (i = 0; i < (int)commands->size(); ++i)
+        {
+          job.client->pool.give((*commands)[i]);
+        }
+        commands->clear();
+      }
+
+      //! The client has no other command outstanding; only the publisher may also write to it
+      ulapi_mutex_take(job.client->write);
+      job.client->stream.send(job.client->id, response.data(), (int)response.length());
+      ulapi_mutex_give(job.client->write);
+
+      ulapi_mutex_take(lock_);
+      job.client->busy = false;
+      if (job.client->closed)
+      {
+        release(job.client);
+      }
+      else
+      {
+        dispatch(job.client);
+      }
+    }
+    ulapi_mutex_give(lock_);
+  }
+
+
+  void XmlServer::strandThread (void *param)
+  {
+    XmlStrand *strand = (XmlStrand*)param;
+    strand->server->work(*strand);
+  }
+
+} // crpi_robot
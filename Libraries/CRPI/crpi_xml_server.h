@@ -0,0 +1,394 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_xml_server.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Multi-client server for remote CRPI XML commands.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_XML_SERVER_H
+#define CRPI_XML_SERVER_H
+
+#include <string>
+#include <deque>
+#include <vector>
+#include "crpi.h"
+#include "crpi_robot.h"
+#include "crpi_xml_stream.h"
+#include "crpi_binary.h"
+#include "crpi_command.h"
+#include "crpi_batch.h"
+#include "ulapi.h"
+
+#pragma warning (disable: 4251)
+
+#define XML_SERVER_TICK 100         //! Longest wait for socket activity before checking for shutdown (ms)
+#define XML_SERVER_EVENTS 32        //! Socket events handled per wait
+#define XML_SERVER_READ 4096        //! Bytes read from a client at a time
+#define XML_PUBLISH_RATE_MAX 1000.0 //! Fastest subscription rate (Hz)
+
+namespace crpi_robot
+{
+  //! @brief What an XmlServer does with the commands it receives
+  //!
+  //! @note The server parses each command into its own CrpiCommand and encodes the response
+  //!       from it; state frames are CRPI XML, or CrpiBinary messages if binary is true.
+  //!
+  //! @note execute is called from the server's motion strand, query/reject from its query
+  //!       strand, and sample/state from its publisher thread, so queries and samples may run
+  //!       while a command is being executed.
+  //!
+  class LIBRARY_API XmlTarget
+  {
+  public:
+    virtual ~XmlTarget ()
+    {
+    }
+
+    //! @brief Execute a command that may move or reconfigure the robot
+    //!
+    //! @param command The parsed command; its response is populated
+    //!
+    virtual void execute (CrpiCommand &command) = 0;
+
+    //! @brief Answer a read-only query (GetRobotPose, GetRobotAxes, ...), or acknowledge a
+    //!        Subscribe command
+    //!
+    //! @param command The parsed command; its response is populated
+    //!
+    virtual void query (CrpiCommand &command) = 0;
+
+    //! @brief Refuse a command from a client that does not hold control of the robot, or that
+    //!        could not be parsed
+    //!
+    //! @param command The parsed command; its response is populated
+    //!
+    virtual void reject (CrpiCommand &command) = 0;
+
+    //! @brief Read the robot's state for subscribers
+    //!
+    //! @param channels The state to read (CRPI_CHANNEL_POSE | CRPI_CHANNEL_AXES | ...)
+    //!
+    virtual void sample (int channels) = 0;
+
+    //! @brief Encode part of the state read by the most recent sample
+    //!
+    //! @param channels The state to include (a subset of the channels sampled)
+    //! @param frame    Populated with the encoded state frame
+    //! @param binary   Whether to encode the frame in binary
+    //!
+    virtual void state (int channels, std::string &frame, bool binary) = 0;
+  };
+
+
+  //! @brief XmlTarget for a CRPI robot
+  //!
+  //! @note Commands and queries are executed through CrpiCommandHandler, each in its own
+  //!       context, so that queries do not disturb a command being executed; the robot's Get*
+  //!       methods must therefore be safe to call while it is moving.
+  //!
+  template <class T> class CrpiXmlTarget : public XmlTarget
+  {
+  public:
+    //! @brief Constructor
+    //!
+    //! @param arm The robot to command
+    //!
+    CrpiXmlTarget (CrpiRobot<T> *arm)
+    {
+      arm_ = arm;
+      stateParams_ = new Xml::CrpiXmlParams();
+      stateXml_ = new Xml::CrpiXml(stateParams_);
+      stateBin_ = new Xml::CrpiBinary(stateParams_);
+      sampled_ = 0.0;
+    }
+
+    //! @brief Default destructor
+    //!
+    ~CrpiXmlTarget ()
+    {
+      delete stateBin_;
+      delete stateXml_;
+      delete stateParams_;
+    }
+
+    void execute (CrpiCommand &command)
+    {
+      arm_->CrpiCommandHandler(command);
+    }
+
+    void query (CrpiCommand &command)
+    {
+      if (command.request().cmd == CmdSubscribe)
+      {
+        //! The server keeps the subscription; only acknowledge it
+        command.response().cmd = CmdSubscribe;
+        command.response().status = CANON_SUCCESS;
+        return;
+      }
+      arm_->CrpiCommandHandler(command);
+    }
+
+    void reject (CrpiCommand &command)
+    {
+      command.response().cmd = command.request().cmd;
+      command.response().commandID = command.request().commandID;
+      command.response().status = CANON_REJECT;
+    }
+
+    void sample (int channels)
+    {
+      if (channels & CRPI_CHANNEL_POSE)
+      {
+        arm_->GetRobotPose(stateParams_->pose);
+      }
+      if (channels & CRPI_CHANNEL_AXES)
+      {
+        arm_->GetRobotAxes(stateParams_->axes);
+      }
+      if (channels & CRPI_CHANNEL_FORCES)
+      {
+        arm_->GetRobotForces(stateParams_->forces);
+      }
+      if (channels & CRPI_CHANNEL_IO)
+      {
+        arm_->GetRobotIO(stateParams_->io);
+      }
+      if (channels & CRPI_CHANNEL_SPEED)
+      {
+        arm_->GetRobotSpeed(stateParams_->speed);
+      }
+      stateParams_->counter += 1;
+      sampled_ = ulapi_time();
+    }
+
+    void state (int channels, std::string &frame, bool binary)
+    {
+      if (binary)
+      {
+        stateBin_->encodeState(channels, sampled_, frame);
+      }
+      else
+      {
+        stateXml_->encodeState(channels, sampled_, frame);
+      }
+    }
+
+  private:
+    CrpiRobot<T> *arm_;
+
+    //! @brief Most recent state sampled for subscribers, and when it was sampled
+    //!
+    Xml::CrpiXmlParams *stateParams_;
+    Xml::CrpiXml *stateXml_;
+    Xml::CrpiBinary *stateBin_;
+    double sampled_;
+  }; // CrpiXmlTarget
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Serves CRPI XML commands for one robot to any number of remote clients
+  //!
+  //! @note One reactor thread (the caller of run) waits on the listening socket and every
+  //!       client at once (epoll on Linux, select elsewhere), reassembling commands with an
+  //!       XmlStream per client.  Commands are handed to two strands, each a worker thread with
+  //!       its own queue:  the motion strand executes, one at a time, everything that may move
+  //!       or reconfigure the robot; the query strand answers Get* queries, so that monitors are
+  //!       answered while the robot moves.  Each client has at most one command outstanding, so
+  //!       its responses are sent in the order its commands arrived.
+  //!
+  //!       Any number of clients may query the robot.  The first client to send any other
+  //!       command takes control of the robot and keeps it until it disconnects; commands other
+  //!       than queries from the other clients (monitors) are rejected.  A monitor that only
+  //!       queries therefore never takes control from the client that holds it.
+  //!
+  //!       Clients may also subscribe to the robot's state (see CRPI_CHANNEL_POSE).  A publisher
+  //!       thread samples the robot once for every subscriber that is due, at the fastest rate
+  //!       subscribed, and pushes each subscriber its channels as one frame per write.
+  //!
+  //!       A client that opens with the handshake byte XML_STREAM_BINARY speaks the binary
+  //!       protocol (CrpiBinary) instead of XML, with the same commands and semantics.
+  //!
+  //!       An XML client may send a <CRPIBatch> or <CRCLBatch> of commands (see CrpiBatch),
+  //!       answered with one response; it is queued, and needs control, as any command in it
+  //!       would.
+  //!
+  class LIBRARY_API XmlServer
+  {
+  public:
+    //! @brief Constructor
+    //!
+    //! @param target The robot commanded by the clients
+    //! @param port   The TCP port to listen on
+    //! @param name   Name of the robot for console messages
+    //!
+    XmlServer (XmlTarget *target, int port, const char *name);
+
+    //! @brief Default destructor
+    //!
+    ~XmlServer ();
+
+    //! @brief Serve clients until told to stop
+    //!
+    //! @param runThread Serve while this is true (checked every XML_SERVER_TICK ms)
+    //!
+    //! @return False if the server could not be started, true otherwise
+    //!
+    bool run (bool &runThread);
+
+    //! @brief Number of clients connected
+    //!
+    int clients ();
+
+  private:
+    //! @brief One connected client
+    //!
+    struct XmlClient
+    {
+      ulapi_integer id;
+      int number;
+      XmlStream stream;
+
+      //! @brief Contexts for the client's commands
+      //!
+      CrpiCommandPool pool;
+
+      //! @brief The client's batch being handled, and a context for each of its commands
+      //!
+      CrpiBatch batch;
+      std::vector<CrpiCommand*> commands;
+
+      //! @brief Whether a command from the client is queued or being handled, and whether the
+      //!        client has disconnected (it is freed once no command or frame is outstanding)
+      //!
+      bool busy;
+      bool closed;
+
+      //! @brief Number of state frames being pushed to the client
+      //!
+      int pushing;
+
+      //! @brief Serializes responses and state frames written to the client
+      //!
+      ulapi_mutex_struct *write;
+
+      //! @brief Subscription:  channels (0 if none), sampling period (s), decimation factor,
+      //!        samples skipped since the last one sent, and time (from ulapi_time) of the next
+      //!        sample
+      //!
+      int channels;
+      double period;
+      int decimation;
+      int skipped;
+      double next;
+    };
+
+    typedef enum
+    {
+      XmlJobExecute = 0,
+      XmlJobQuery,
+      XmlJobReject
+    } XmlJobType;
+
+    //! @brief A parsed command waiting for a strand
+    //!
+    struct XmlJob
+    {
+      XmlClient *client;
+      XmlJobType type;
+
+      //! @brief The command, or NULL for the client's batch
+      //!
+      CrpiCommand *command;
+    };
+
+    //! @brief A worker thread and its queue
+    //!
+    struct XmlStrand
+    {
+      XmlServer *server;
+      std::deque<XmlJob> jobs;
+      void *task;
+
+      //! @brief Given once per job queued, and on shutdown
+      //!
+      crpi_semaphore wake;
+    };
+
+    //! @brief Accept a new client
+    //!
+    void accept ();
+
+    //! @brief Read from a client and dispatch what it sent
+    //!
+    void receive (XmlClient *client);
+
+    //! @brief Hand the client's next command to a strand (lock_ held)
+    //!
+    void dispatch (XmlClient *client);
+
+    //! @brief Forget a client that has disconnected (lock_ held)
+    //!
+    void drop (XmlClient *client);
+
+    //! @brief Free a client that has disconnected once nothing refers to it (lock_ held)
+    //!
+    void release (XmlClient *client);
+
+    //! @brief Start, change, or cancel a client's subscription (lock_ held)
+    //!
+    void subscribe (XmlClient *client, const Xml::CrpiXmlParams &request);
+
+    //! @brief Publisher loop
+    //!
+    void publish ();
+
+    //! @brief Pass a command to the target as the job type directs
+    //!
+    void handle (XmlJobType type, CrpiCommand &command);
+
+    //! @brief Strand worker loop
+    //!
+    void work (XmlStrand &strand);
+
+    static void strandThread (void *param);
+
+    static void publishThread (void *param);
+
+    XmlTarget *target_;
+    int port_;
+    std::string name_;
+
+    ulapi_integer server_;
+    int poll_;
+    int count_;
+    bool running_;
+
+    //! @brief Connected clients, and the one holding control (NULL if none)
+    //!
+    std::vector<XmlClient*> clients_;
+    XmlClient *controller_;
+
+    XmlStrand motion_;
+    XmlStrand query_;
+    void *publisher_;
+
+    //! @brief Wakes the publisher early on shutdown
+    //!
+    crpi_semaphore publisherWake_;
+
+    //! @brief Protects the clients, their subscriptions, and the strand queues
+    //!
+    ulapi_mutex_struct *lock_;
+  }; // XmlServer
+
+} // crpi_robot
+
+#endif
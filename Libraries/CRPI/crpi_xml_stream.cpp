@@ -0,0 +1,327 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_xml_stream.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Framing of the XML command stream received from a remote client.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include "crpi_xml_stream.h"
+
+using namespace std;
+
+//! Text scanner states
+#define SCAN_CONTENT 0      //! Between tags
+#define SCAN_TAG_START 1    //! Just after '<'
+#define SCAN_TAG 2          //! Inside an element tag
+#define SCAN_QUOTE 3        //! Inside a quoted attribute value
+#define SCAN_PI 4           //! Inside <? ... ?>
+#define SCAN_BANG 5         //! Just after "<!"
+#define SCAN_BANG_DASH 6    //! Just after "<!-"
+#define SCAN_COMMENT 7      //! Inside <!-- ... -->
+#define SCAN_CDATA 8        //! Inside <![CDATA[ ... ]]>
+#define SCAN_DECL 9         //! Inside <! ... >
+
+namespace crpi_robot
+{
+  LIBRARY_API XmlStream::XmlStream ()
+  {
+    reset();
+  }
+
+
+  LIBRARY_API XmlStream::~XmlStream ()
+  {
+  }
+
+
+  LIBRARY_API void XmlStream::reset ()
+  {
+    framing_ = XmlFramingUnknown;
+    buffer_.clear();
+    ready_.clear();
+    start_ = scan_ = 0;
+    depth_ = 0;
+    state_ = SCAN_CONTENT;
+    quote_ = last_ = '\0';
+    closing_ = naming_ = inCommand_ = false;
+    name_.clear();
+    root_.clear();
+  }
+
+
+  LIBRARY_API bool XmlStream::feed (const char *data, int length)
+  {
+    bool ok;
+
+    if (length <= 0)
+    {
+      return true;
+    }
+
+    if (framing_ == XmlFramingUnknown)
+    {
+      if (data[0] == XML_STREAM_LENGTH || data[0] == XML_STREAM_BINARY)
+      {
+        framing_ = (data[0] == XML_STREAM_LENGTH ? XmlFramingLength : XmlFramingBinary);
+        ++data;
+        --length;
+      }
+      else
+      {
+        framing_ = XmlFramingText;
+      }
+    }
+
+    buffer_.append(data, length);
+    ok = (framing_ == XmlFramingText ? scanText() : scanLength());
+
+    //! Drop what has been consumed
+    if (start_ > 0)
+    {
+      buffer_.erase(0, start_);
+      scan_ -= start_;
+      start_ = 0;
+    }
+    return ok;
+  }
+
+
+  LIBRARY_API bool XmlStream::next (string &command)
+  {
+    if (ready_.empty())
+    {
+      return false;
+    }
+    command.swap(ready_.front());
+    ready_.pop_front();
+    return true;
+  }
+
+
+  LIBRARY_API int XmlStream::ready ()
+  {
+    return (int)ready_.size();
+  }
+
+
+  LIBRARY_API XmlFraming XmlStream::framing ()
+  {
+    return framing_;
+  }
+
+
+  LIBRARY_API bool XmlStream::send (ulapi_integer id, const char *mssg, int length)
+  {
+    string frame;
+
+    if (framing_ == XmlFramingText || framing_ == XmlFramingUnknown)
+    {
+      return (ulapi_socket_write(id, mssg, length) == length);
+    }
+
+    frame.reserve(length + 4);
+    frame += (char)((length >> 24) & 0xFF);
+    frame += (char)((length >> 16) & 0xFF);
+    frame += (char)((length >> 8) & 0xFF);
+    frame += (char)(length & 0xFF);
+    frame.append(mssg, length);
+    return (ulapi_socket_write(id, frame.data(), (ulapi_integer)frame.length()) == (ulapi_integer)frame.length());
+  }
+
+
+  bool XmlStream::scanLength ()
+  {
+    const unsigned char *head;
+    size_t length;
+
+    while (buffer_.length() - start_ >= 4)
+    {
+      head = (const unsigned char*)buffer_.data() + start_;
+      length = ((size_t)head[0] << 24) | ((size_t)head[1] << 16) | ((size_t)head[2] << 8) | head[3];
+      if (length > XML_STREAM_MAX)
+      {
+        return false;
+      }
+      if (buffer_.length() - start_ - 4 < length)
+      {
+        break;
+      }
+      if (length > 0)
+      {
+        ready_.push_back(buffer_.substr(start_ + 4, length));
+      }
+      start_ += 4 + length;
+    }
+    scan_ = buffer_.length();
+    return true;
+  }
+
+
+  bool XmlStream::scanText ()
+  {
+    char c;
+
+    for (; scan_ < buffer_.length(); ++scan_)
+    {
+      c = buffer_[scan_];
+
+      switch (state_)
+      {
+      case SCAN_CONTENT:
+        if (c == '<')
+        {
+          if (!inCommand_)
+          {
+            //! Start of the next command
+            start_ = scan_;
+            inCommand_ = true;
+          }
+          state_ = SCAN_TAG_START;
+        }
+        else if (!inCommand_)
+        {
+          //! NULs, line ends, and anything else between commands
+          start_ = scan_ + 1;
+        }
+        break;
+      case SCAN_TAG_START:
+        closing_ = false;
+        naming_ = true;
+        last_ = c;
+        name_.clear();
+        if (c == '/')
+        {
+          closing_ = true;
+          state_ = SCAN_TAG;
+        }
+        else if (c == '?')
+        {
+          state_ = SCAN_PI;
+        }
+        else if (c == '!')
+        {
+          state_ = SCAN_BANG;
+        }
+        else if (c == '>')
+        {
+          //! "<>" is not a tag
+          state_ = SCAN_CONTENT;
+        }
+        else
+        {
+          name_ = c;
+          state_ = SCAN_TAG;
+        }
+        break;
+      case SCAN_TAG:
+        if (naming_)
+        {
+          if (c != ' ' && c != '\t' && c != '\r' && c != '\n' && c != '/' && c != '>')
+          {
+            name_ += c;
+            last_ = c;
+            break;
+          }
+          naming_ = false;
+        }
+
+        if (c == '\"' || c == '\'')
+        {
+          quote_ = c;
+          state_ = SCAN_QUOTE;
+        }
+        else if (c == '>')
+        {
+          state_ = SCAN_CONTENT;
+          if (closing_)
+          {
+            if (depth_ == 0)
+            {
+              //! Stray closing tag; discard it
+              inCommand_ = false;
+              start_ = scan_ + 1;
+              break;
+            }
+            //! Closing the root element ends the command, even if an inner element was left open
+            depth_ = (name_ == root_ ? 0 : depth_ - 1);
+          }
+          else if (last_ != '/')
+          {
+            if (depth_ == 0)
+            {
+              root_ = name_;
+            }
+            ++depth_;
+          }
+
+          if (depth_ == 0)
+          {
+            complete(scan_ + 1);
+          }
+        }
+        else if (c != ' ' && c != '\t' && c != '\r' && c != '\n')
+        {
+          last_ = c;
+        }
+        break;
+      case SCAN_QUOTE:
+        if (c == quote_)
+        {
+          state_ = SCAN_TAG;
+        }
+        break;
+      case SCAN_PI:
+        if (c == '>' && buffer_[scan_ - 1] == '?')
+        {
+          state_ = SCAN_CONTENT;
+        }
+        break;
+      case SCAN_BANG:
+        state_ = (c == '-' ? SCAN_BANG_DASH : (c == '[' ? SCAN_CDATA : SCAN_DECL));
+        break;
+      case SCAN_BANG_DASH:
+        state_ = (c == '-' ? SCAN_COMMENT : SCAN_DECL);
+        break;
+      case SCAN_COMMENT:
+        if (c == '>' && buffer_[scan_ - 1] == '-' && buffer_[scan_ - 2] == '-')
+        {
+          state_ = SCAN_CONTENT;
+        }
+        break;
+      case SCAN_CDATA:
+        if (c == '>' && buffer_[scan_ - 1] == ']' && buffer_[scan_ - 2] == ']')
+        {
+          state_ = SCAN_CONTENT;
+        }
+        break;
+      case SCAN_DECL:
+        if (c == '>')
+        {
+          state_ = SCAN_CONTENT;
+        }
+        break;
+      default:
+        state_ = SCAN_CONTENT;
+        break;
+      }
+    }
+
+    return !(inCommand_ && (scan_ - start_) > XML_STREAM_MAX);
+  }
+
+
+  void XmlStream::complete (size_t end)
+  {
+    ready_.push_back(buffer_.substr(start_, end - start_));
+    start_ = end;
+    inCommand_ = false;
+  }
+
+} // crpi_robot
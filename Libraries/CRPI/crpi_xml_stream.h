@@ -0,0 +1,152 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_xml_stream.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Framing of the XML command stream received from a remote client, with
+//  reassembly of commands split across reads and separation of commands
+//  that arrive together.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_XML_STREAM_H
+#define CRPI_XML_STREAM_H
+
+#include <string>
+#include <deque>
+#include "crpi.h"
+#include "ulapi.h"
+
+#pragma warning (disable: 4251)
+
+//! The framing is chosen by the first byte a client sends:
+//!
+//!   XML_STREAM_LENGTH   Every command (and every response) is a 4-byte, big-endian length
+//!                       followed by that many bytes of XML.
+//!   XML_STREAM_BINARY   Framed as XML_STREAM_LENGTH, but every message is in the binary
+//!                       encoding of CrpiBinary instead of XML.
+//!   anything else       Text framing:  every complete root element (ex. <CRPICommand>...
+//!                       </CRPICommand>) is one command.  The command ends at the closing tag
+//!                       of the root element even if an inner element was left open.  Prologs
+//!                       and comments before the root element belong to it; NUL characters and
+//!                       anything else between elements are ignored.  Responses are sent
+//!                       unframed, as before.
+#define XML_STREAM_LENGTH 0x01      //! Handshake byte selecting length-prefixed framing
+#define XML_STREAM_BINARY 0x02      //! Handshake byte selecting the binary protocol
+#define XML_STREAM_MAX 65536        //! Longest command accepted (bytes)
+
+namespace crpi_robot
+{
+  typedef enum
+  {
+    XmlFramingUnknown = 0,          //! Nothing received yet
+    XmlFramingText,
+    XmlFramingLength,
+    XmlFramingBinary                //! Length-prefixed binary messages (see CrpiBinary)
+  } XmlFraming;
+
+
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Reassembles the commands received on one connection
+  //!
+  //! @note Bytes are scanned once as they arrive; complete commands are queued in the order
+  //!       received so that a client may send several without waiting for each response.
+  //!
+  class LIBRARY_API XmlStream
+  {
+  public:
+    //! @brief Default constructor
+    //!
+    XmlStream ();
+
+    //! @brief Default destructor
+    //!
+    ~XmlStream ();
+
+    //! @brief Forget everything received (for a new connection)
+    //!
+    void reset ();
+
+    //! @brief Add received bytes to the stream
+    //!
+    //! @param data   The bytes read from the connection
+    //! @param length The number of bytes
+    //!
+    //! @return False if the stream can no longer be framed (a command longer than
+    //!         XML_STREAM_MAX); the connection should be closed
+    //!
+    bool feed (const char *data, int length);
+
+    //! @brief Take the oldest complete command
+    //!
+    //! @param command Populated with the command text
+    //!
+    //! @return True if a command was available, false otherwise
+    //!
+    bool next (std::string &command);
+
+    //! @brief Number of complete commands waiting to be taken
+    //!
+    int ready ();
+
+    //! @brief The framing negotiated by the client
+    //!
+    XmlFraming framing ();
+
+    //! @brief Send a response framed to match the commands
+    //!
+    //! @param id     The connected socket
+    //! @param mssg   The response text
+    //! @param length The number of bytes in the response
+    //!
+    //! @return True if the response was sent, false otherwise
+    //!
+    bool send (ulapi_integer id, const char *mssg, int length);
+
+  private:
+    //! @brief Frame text-mode commands from the bytes not yet scanned
+    //!
+    bool scanText ();
+
+    //! @brief Frame length-prefixed commands from the bytes not yet scanned
+    //!
+    bool scanLength ();
+
+    //! @brief Queue the command occupying buffer_[start_, end) and start looking for the next
+    //!
+    void complete (size_t end);
+
+    XmlFraming framing_;
+    std::string buffer_;
+    std::deque<std::string> ready_;
+
+    //! @brief Start of the command being assembled, and how far the buffer has been scanned
+    //!
+    size_t start_;
+    size_t scan_;
+
+    //! @brief Text scanner state:  element depth, lexical state, and tag details
+    //!
+    int depth_;
+    int state_;
+    char quote_;
+    char last_;
+    bool closing_;
+    bool naming_;
+    bool inCommand_;
+
+    //! @brief Name of the tag being scanned, and of the root element of the current command
+    //!
+    std::string name_;
+    std::string root_;
+  }; // XmlStream
+
+} // crpi_robot
+
+#endif
@@ -0,0 +1,154 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_xml_writer.cpp
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Appends encoded XML to a growable output buffer.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#include <stdlib.h>
+#include <string.h>
+#include <math.h>
+#include "crpi_xml_writer.h"
+#include "ulapi.h"
+
+using namespace std;
+
+//! Largest magnitude written as an integer (every integer below it is exact in a double)
+#define XML_REAL_INTEGRAL 1e15
+
+namespace Xml
+{
+  //! @brief Write the decimal digits of a value, returning their number
+  //!
+  static int formatDigits (unsigned long long value, char *buffer)
+  {
+    char digits[24];
+    int count = 0, i;
+
+    do
+    {
+      digits[count++] = (char)('0' + (value % 10));
+      value /= 10;
+    } while (value > 0);
+
+    for (i = 0; i < count; ++i)
+    {
+      buffer[i] = digits[count - 1 - i];
+    }
+    return count;
+  }
+
+
+  //! @brief Write a signed integer, returning its length
+  //!
+  static int formatInteger (long long value, char *buffer)
+  {
+    if (value < 0)
+    {
+      buffer[0] = '-';
+      return 1 + formatDigits((unsigned long long)(-(value + 1)) + 1, buffer + 1);
+    }
+    return formatDigits((unsigned long long)value, buffer);
+  }
+
+
+  LIBRARY_API XmlWriter::XmlWriter (string &out) :
+    out_(out)
+  {
+  }
+
+
+  LIBRARY_API XmlWriter::~XmlWriter ()
+  {
+  }
+
+
+  LIBRARY_API void XmlWriter::clear ()
+  {
+    out_.clear();
+  }
+
+
+  LIBRARY_API size_t XmlWriter::length () const
+  {
+    return out_.length();
+  }
+
+
+  LIBRARY_API XmlWriter &XmlWriter::operator<< (const char *text)
+  {
+    out_.append(text);
+    return *this;
+  }
+
+
+  LIBRARY_API XmlWriter &XmlWriter::operator<< (const string &text)
+  {
+    out_.append(text);
+    return *this;
+  }
+
+
+  LIBRARY_API XmlWriter &XmlWriter::operator<< (char c)
+  {
+    out_.push_back(c);
+    return *this;
+  }
+
+
+  LIBRARY_API XmlWriter &XmlWriter::operator<< (int value)
+  {
+    char buffer[XML_REAL_LENGTH];
+    out_.append(buffer, formatInteger(value, buffer));
+    return *this;
+  }
+
+
+  LIBRARY_API XmlWriter &XmlWriter::operator<< (unsigned int value)
+  {
+    char buffer[XML_REAL_LENGTH];
+    out_.append(buffer, formatDigits(value, buffer));
+    return *this;
+  }
+
+
+  LIBRARY_API XmlWriter &XmlWriter::operator<< (double value)
+  {
+    char buffer[XML_REAL_LENGTH];
+    out_.append(buffer, formatReal(value, buffer));
+    return *this;
+  }
+
+
+  LIBRARY_API int XmlWriter::formatReal (double value, char *buffer)
+  {
+    int length, precision;
+
+    //! Joint angles, set points, and counts are frequently whole numbers
+    if (value == floor(value) && fabs(value) < XML_REAL_INTEGRAL)
+    {
+      length = formatInteger((long long)value, buffer);
+      buffer[length] = '\0';
+      return length;
+    }
+
+    //! 15 significant digits suffice for most values; 17 always round trip
+    for (precision = 15; precision < 17; ++precision)
+    {
+      length = ulapi_snprintf(buffer, XML_REAL_LENGTH, "%.*g", precision, value);
+      if (strtod(buffer, NULL) == value)
+      {
+        return length;
+      }
+    }
+    return ulapi_snprintf(buffer, XML_REAL_LENGTH, "%.17g", value);
+  }
+
+} // Xml namespace
@@ -0,0 +1,84 @@
+///////////////////////////////////////////////////////////////////////////////
+//
+//  Original System: Collaborative Robot Programming Interface
+//  Subsystem:       Robot Interface
+//  Workfile:        crpi_xml_writer.h
+//  Revision:        1.0 - 18 October, 2026
+//  Author:          J. Marvel
+//
+//  Description
+//  ===========
+//  Appends encoded XML (responses, state frames, configuration files) to a
+//  growable output buffer.
+//
+///////////////////////////////////////////////////////////////////////////////
+
+#ifndef CRPI_XML_WRITER_H
+#define CRPI_XML_WRITER_H
+
+#include <string>
+#include "crpi.h"
+
+#pragma warning (disable: 4251)
+
+#define XML_REAL_LENGTH 32          //! Longest text form of a double, with its terminating NUL
+
+namespace Xml
+{
+  //! @ingroup crpi_robot
+  //!
+  //! @brief Stream-style encoder writing into a caller's string
+  //!
+  //! @note The string grows as needed, so nothing is ever truncated, and it keeps its capacity
+  //!       when cleared, so a caller that reuses one string (ex. per connection) stops
+  //!       allocating once it has seen its largest message.  The encoded length is always
+  //!       out.length(); the output is never rescanned.
+  //!
+  //!       Doubles are written in the shortest form that reads back as the same value (ex.
+  //!       0.1, not 0.10000000000000001 or 0.1000000), and integral values are written without
+  //!       a fraction or exponent.
+  //!
+  class LIBRARY_API XmlWriter
+  {
+  public:
+    //! @brief Constructor
+    //!
+    //! @param out The string to which everything written is appended
+    //!
+    XmlWriter (std::string &out);
+
+    //! @brief Default destructor
+    //!
+    ~XmlWriter ();
+
+    //! @brief Discard the output written so far, keeping its capacity
+    //!
+    void clear ();
+
+    //! @brief The number of bytes of output
+    //!
+    size_t length () const;
+
+    XmlWriter &operator<< (const char *text);
+    XmlWriter &operator<< (const std::string &text);
+    XmlWriter &operator<< (char c);
+    XmlWriter &operator<< (int value);
+    XmlWriter &operator<< (unsigned int value);
+    XmlWriter &operator<< (double value);
+
+    //! @brief Write the shortest text that reads back (strtod) as value
+    //!
+    //! @param value  The value to format
+    //! @param buffer Populated with the text; must hold at least XML_REAL_LENGTH characters
+    //!
+    //! @return The length of the text
+    //!
+    static int formatReal (double value, char *buffer);
+
+  private:
+    std::string &out_;
+  }; // XmlWriter
+
+} // Xml namespace
+
+#endif
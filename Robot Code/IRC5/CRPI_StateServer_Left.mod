@@ -3,6 +3,9 @@ MODULE CRPI_StateServer_Left
   VAR socketdev state_client_socket;
   VAR string state_client_ip;
   VAR bool state_connected:=FALSE;
+  ! Shared with the CRPI_Handler task so that poses are reported for the same TCP as the
+  ! command socket
+  PERS tooldata GripperL;
 
   ! @brief Main program loop
   !
@@ -17,7 +20,7 @@ MODULE CRPI_StateServer_Left
       ! ---------------------------------------------------------------  
       !                        Cartesian Feedback
       ! ---------------------------------------------------------------
-      r_l_p:=CRobT(\TaskRef:=T_ROB_LId \Tool:=tool0 \WObj:=wobj0);
+      r_l_p:=CRobT(\TaskRef:=T_ROB_LId \Tool:=GripperL \WObj:=wobj0);
       psarry_l{1}:=1;
       psarry_l{2}:=Trunc(r_l_p.trans.x\Dec:=5);
       psarry_l{3}:=Trunc(r_l_p.trans.y\Dec:=5);
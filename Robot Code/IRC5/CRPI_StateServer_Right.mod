@@ -3,6 +3,9 @@ MODULE CRPI_StateServer_Right
   VAR socketdev state_client_socket;
   VAR string state_client_ip;
   VAR bool state_connected:=FALSE;
+  ! Shared with the CRPI_Handler task so that poses are reported for the same TCP as the
+  ! command socket
+  PERS tooldata GripperR;
 
   ! @brief Main program loop
   !
@@ -17,7 +20,7 @@ MODULE CRPI_StateServer_Right
       ! ---------------------------------------------------------------  
       !                        Cartesian Feedback
       ! ---------------------------------------------------------------
-      r_r_p:=CRobT(\TaskRef:=T_ROB_RId \Tool:=tool0 \WObj:=wobj0);
+      r_r_p:=CRobT(\TaskRef:=T_ROB_RId \Tool:=GripperR \WObj:=wobj0);
       psarry_l{1}:=1;
       psarry_l{2}:=Trunc(r_r_p.trans.x\Dec:=5);
       psarry_l{3}:=Trunc(r_r_p.trans.y\Dec:=5);